@@ -17,6 +17,7 @@ mlook(1);
 freelook(0);
 cam_distance(1024.0);
 setCameraViewDistance(32768);
+setLevelPreload(1, 256);                       -- read next gameflow level in background, memory limit in MB
 noclip(0);
 --playVideo(base_path .. "data/tr3/fmv/logo.rpl");
 --playVideo(base_path .. "data/tr3/fmv/Crsh_Eng.rpl");
@@ -18,6 +18,7 @@ audio =
     use_effects = 1;
     listener_is_player = 0;
     stream_buffer_size = 128;
+    sample_cache_size = 64;     -- MB of decoded samples kept between levels, 0 - off
 }
 
 render =
@@ -31,6 +32,9 @@ render =
     z_depth = 24;                               -- Maximum and recommended is 24.
     texture_border = 16;
     fog_color = {r = 255, g = 255, b = 255};
+    transparency_mode = 0;                      -- 0 - dynamic BSP, 1 - sorted static batches (faster, no per polygon sorting).
+    atlas_packer = 2;                           -- Texture atlas layout: 0 - BSP tree, 1 - skyline, 2 - MaxRects (fewest pages).
+    skinning = 1;                               -- Skeletal models: 0 - draw per bone, 1 - bone matrices palette (one draw per texture).
 }
 
 controls =
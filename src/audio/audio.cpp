@@ -15,6 +15,7 @@ extern "C" {
 }
 
 #include "../core/system.h"
+#include "../core/parallel.h"
 #include "../core/vmath.h"
 #include "../core/gl_text.h"
 #include "../core/console.h"
@@ -28,6 +29,7 @@ extern "C" {
 #include "../game.h"
 
 #include "audio.h"
+#include "audio_cache.h"
 #include "audio_stream.h"
 #include "audio_fx.h"
 
@@ -36,6 +38,7 @@ extern "C" {
 
 static ALCdevice              *al_device      = NULL;
 static ALCcontext             *al_context     = NULL;
+static audio_cache_p           audio_samples_cache = NULL;  // Buffers of decoded samples, kept between levels.
 
 // Effect structure.
 // Contains all global effect parameters.
@@ -147,6 +150,19 @@ public:
 };
 
 
+// Level sample: cut from level samples block, decoded by SDL_LoadWAV_RW.
+// Decoding does not touch OpenAL, so samples are decoded in parallel.
+typedef struct audio_sample_s
+{
+    uint8_t        *data;           // RIFF WAV
+    uint32_t        size;
+    uint32_t        uncomp_size;    // TR4/5 ADPCM samples have silence at the end
+    uint64_t        key;            // samples cache key
+    SDL_AudioSpec   spec;
+    Uint8          *wav_buffer;
+    Uint32          wav_length;     // already cut by uncomp_size
+}audio_sample_t, *audio_sample_p;
+
 // ======== PRIVATE PROTOTYPES =============
 int  Audio_LogALError(int error_marker = 0);    // AL-specific error handler.
 void Audio_LogOGGError(int code);               // Ogg-specific error handler.
@@ -154,6 +170,10 @@ void Audio_LogOGGError(int code);               // Ogg-specific error handler.
 bool Audio_FillALBuffer(ALuint buf_number, Uint8* buffer_data, Uint32 buffer_size, int sample_bitsize, int channels, int frequency);
 int  Audio_LoadALbufferFromWAV_Mem(ALuint buf_number, uint8_t *sample_pointer, uint32_t sample_size, uint32_t uncomp_sample_size = 0);
 int  Audio_LoadALbufferFromWAV_File(ALuint buf_number, const char *fname);
+void Audio_HashSample(void *data, uint32_t index);
+void Audio_DecodeSample(void *data, uint32_t index);
+void Audio_DeleteCachedBuffer(void *data, uint32_t value);
+int  Audio_FillALBufferFromSample(ALuint buf_number, audio_sample_p sample);
 void Audio_LoadOverridedSamples();
 
 int  Audio_GetFreeSource();
@@ -420,6 +440,7 @@ struct audio_world_data_s
 
     uint32_t                        audio_buffers_count;    // Amount of samples.
     ALuint                         *audio_buffers;          // Samples.
+    uint64_t                       *audio_buffers_keys;     // Samples cache keys, 0 - buffer is not cached.
     uint32_t                        audio_sources_count;    // Amount of runtime channels.
     AudioSource                    *audio_sources;          // Channels.
 
@@ -719,6 +740,9 @@ void Audio_CoreDeinit()
 {
     StreamTrack_Clear(&audio_world_data.external_stream);
 
+    AudioCache_Destroy(audio_samples_cache);
+    audio_samples_cache = NULL;
+
     if(al_context)  // T4Larson <t4larson@gmail.com>: fixed
     {
         alcMakeContextCurrent(NULL);
@@ -1324,6 +1348,13 @@ void Audio_LoadOverridedSamples()
                         snprintf(sample_name, sizeof(sample_name), sample_name_mask, (sample_index + j));
                         if(Sys_FileFound(sample_name, 0))
                         {
+                            if(audio_world_data.audio_buffers_keys[buffer_counter])
+                            {
+                                // cached buffer may be shared, so overrided sample gets own one
+                                AudioCache_Release(audio_samples_cache, audio_world_data.audio_buffers_keys[buffer_counter]);
+                                audio_world_data.audio_buffers_keys[buffer_counter] = 0;
+                                alGenBuffers(1, audio_world_data.audio_buffers + buffer_counter);
+                            }
                             Audio_LoadALbufferFromWAV_File(audio_world_data.audio_buffers[buffer_counter], sample_name);
                         }
                     }
@@ -1344,10 +1375,12 @@ void Audio_InitGlobals()
     audio_settings.sound_volume = 0.8;
     audio_settings.use_effects  = true;
     audio_settings.listener_is_player = false;
+    audio_settings.sample_cache_size = AUDIO_CACHE_DEFAULT_BUDGET / (1024 * 1024);
 
     audio_world_data.audio_sources = NULL;
     audio_world_data.audio_sources_count = 0;
     audio_world_data.audio_buffers = NULL;
+    audio_world_data.audio_buffers_keys = NULL;
     audio_world_data.audio_buffers_count = 0;
     audio_world_data.audio_effects = NULL;
     audio_world_data.audio_effects_count = 0;
@@ -1399,12 +1432,391 @@ void Audio_CacheTrack(int id)
 }
 
 
-void Audio_GenSamples(class VT_Level *tr)
+/*
+ * Different TR versions have different ways of storing samples.
+ * TR1:     sample block size, sample block, num samples, sample offsets.
+ * TR2/TR3: num samples, sample offsets. (Sample block is in MAIN.SFX.)
+ * TR4/TR5: num samples, (uncomp_size-comp_size-sample_data) chain.
+ * Returns count of cut samples, the rest of buffers stay empty.
+ */
+static uint32_t Audio_SliceSamples(class VT_Level *tr, audio_sample_p samples, uint32_t count)
+{
+    uint8_t *pointer = tr->samples_data;
+    uint8_t *end = tr->samples_data + tr->samples_data_size;
+    uint32_t i = 0;
+
+    switch(tr->game_version)
+    {
+        case TR_I:
+        case TR_I_DEMO:
+        case TR_I_UB:
+            count = (count < tr->sample_indices_count) ? (count) : (tr->sample_indices_count);
+            for(; (i < count) && (tr->sample_indices[i] < tr->samples_data_size); i++)
+            {
+                uint32_t next = (i + 1 < count) ? (tr->sample_indices[i + 1]) : (tr->samples_data_size);
+                samples[i].data = tr->samples_data + tr->sample_indices[i];
+                samples[i].size = ((next > tr->sample_indices[i]) && (next <= tr->samples_data_size)) ?
+                                  (next - tr->sample_indices[i]) : (tr->samples_data_size - tr->sample_indices[i]);
+            }
+            break;
+
+        case TR_II:
+        case TR_II_DEMO:
+        case TR_III:
+            // sample starts from "RIFF" and lasts until the next one
+            for(; (pointer + 4 <= end) && memcmp(pointer, "RIFF", 4); pointer++);
+            for(; (i < count) && (pointer + 4 <= end); i++)
+            {
+                uint8_t *next = pointer + 4;
+                for(; (next + 4 <= end) && memcmp(next, "RIFF", 4); next++);
+                next = (next + 4 <= end) ? (next) : (end);
+                samples[i].data = pointer;
+                samples[i].size = next - pointer;
+                pointer = next;
+            }
+            break;
+
+        case TR_IV:
+        case TR_IV_DEMO:
+        case TR_V:
+            for(; (i < count) && (pointer + 8 <= end); i++)
+            {
+                // Always use comp_size as block length, as uncomp_size is used to cut raw sample data.
+                samples[i].uncomp_size = *((uint32_t*)pointer);
+                samples[i].size = *((uint32_t*)(pointer + 4));
+                samples[i].data = pointer + 8;
+                if(samples[i].size > (uint32_t)(end - samples[i].data))
+                {
+                    samples[i].size = end - samples[i].data;
+                }
+                pointer = samples[i].data + samples[i].size;
+            }
+            break;
+
+        default:
+            break;
+    };
+
+    return i;
+}
+
+/*
+ * Original per-version loops of Audio_GenSamples(), kept as reference for
+ * Audio_CheckSamplesDecode(): they store sample ranges instead of loading
+ * OpenAL buffers, everything else is as it was (TR1 last sample reuses the
+ * previous pointer and takes its size from samples_count, no clamping).
+ * Only reads outside of sample_indices and of the block are stopped: TR1
+ * samples_count is the count of "RIFF" tags in the block and may exceed
+ * sample_indices_count, such samples get no range (data is NULL).
+ */
+static void Audio_SetReferenceSample(audio_sample_p sample, uint8_t *pointer, uint32_t size, uint32_t uncomp_size)
+{
+    sample->data = pointer;
+    sample->size = size;
+    sample->uncomp_size = uncomp_size;
+}
+
+static uint32_t Audio_SliceSamplesReference(class VT_Level *tr, audio_sample_p samples, uint32_t count)
 {
     uint8_t      *pointer = tr->samples_data;
     int8_t        flag;
     uint32_t      ind1, ind2;
     uint32_t      comp_size, uncomp_size;
+    uint32_t      i = 0;
+
+    switch(tr->game_version)
+    {
+        case TR_I:
+        case TR_I_DEMO:
+        case TR_I_UB:
+            if(count == 0)
+            {
+                break;                                                          // count - 1 wrapped here
+            }
+            for(i = 0; i < count-1; i++)
+            {
+                if(i + 1 >= tr->sample_indices_count)
+                {
+                    Audio_SetReferenceSample(samples + i, NULL, 0, 0);
+                    continue;
+                }
+                pointer = tr->samples_data + tr->sample_indices[i];
+                uint32_t size = tr->sample_indices[i + 1] - tr->sample_indices[i];
+                Audio_SetReferenceSample(samples + i, pointer, size, 0);
+            }
+            i = count-1;
+            if(i < tr->sample_indices_count)
+            {
+                Audio_SetReferenceSample(samples + i, pointer, (tr->samples_count - tr->sample_indices[i]), 0);
+            }
+            else
+            {
+                Audio_SetReferenceSample(samples + i, NULL, 0, 0);
+            }
+            i++;
+            break;
+
+        case TR_II:
+        case TR_II_DEMO:
+        case TR_III:
+            ind1 = 0;
+            ind2 = 0;
+            flag = 0;
+            i = 0;
+            while(pointer < tr->samples_data + tr->samples_data_size - 4)
+            {
+                pointer = tr->samples_data + ind2;
+                if(!memcmp(pointer, "RIFF", 4))
+                {
+                    if(flag == 0x00)
+                    {
+                        ind1 = ind2;
+                        flag = 0x01;
+                    }
+                    else
+                    {
+                        uncomp_size = ind2 - ind1;
+                        Audio_SetReferenceSample(samples + i, tr->samples_data + ind1, uncomp_size, 0);
+                        i++;
+                        if(i > count - 1)
+                        {
+                            break;
+                        }
+                        ind1 = ind2;
+                    }
+                }
+                ind2++;
+            }
+            uncomp_size = tr->samples_data_size - ind1;
+            pointer = tr->samples_data + ind1;
+            if(i < count)
+            {
+                Audio_SetReferenceSample(samples + i, pointer, uncomp_size, 0);
+                i++;
+            }
+            break;
+
+        case TR_IV:
+        case TR_IV_DEMO:
+        case TR_V:
+            for(i = 0; i < count; i++)
+            {
+                if(pointer + 8 > tr->samples_data + tr->samples_data_size)
+                {
+                    break;
+                }
+                // Parse sample sizes.
+                // Always use comp_size as block length, as uncomp_size is used to cut raw sample data.
+                uncomp_size = *((uint32_t*)pointer);
+                pointer += 4;
+                comp_size   = *((uint32_t*)pointer);
+                pointer += 4;
+
+                Audio_SetReferenceSample(samples + i, pointer, comp_size, uncomp_size);
+
+                // Now we can safely move pointer through current sample data.
+                pointer += comp_size;
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    return i;
+}
+
+
+int Audio_GetSamplesCacheStats(struct audio_cache_stats_s *stats)
+{
+    if(audio_samples_cache)
+    {
+        AudioCache_GetStats(audio_samples_cache, stats);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * Cuts level samples by the original per-version loops and decodes them one
+ * by one, then cuts them by Audio_SliceSamples() and decodes by workers (no
+ * OpenAL). Ranges are compared sample by sample, PCM - where ranges match;
+ * original ranges outside of the block are not decoded. Returns count of
+ * differences, except of the fixed TR1 tail (samples past sample_indices and
+ * the last one).
+ */
+int Audio_CheckSamplesDecode(class VT_Level *tr, struct audio_samples_check_s *check)
+{
+    audio_sample_p reference = (audio_sample_p)calloc(tr->samples_count + 1, sizeof(audio_sample_t));
+    audio_sample_p parallel = (audio_sample_p)calloc(tr->samples_count + 1, sizeof(audio_sample_t));
+    uint8_t *same = (uint8_t*)calloc(tr->samples_count + 1, sizeof(uint8_t));
+    uint8_t *end = tr->samples_data + tr->samples_data_size;
+    uint32_t count;
+    float t0, t1, t2;
+
+    memset(check, 0, sizeof(*check));
+    if(tr->samples_data)
+    {
+        check->reference_count = Audio_SliceSamplesReference(tr, reference, tr->samples_count);
+        check->samples_count = Audio_SliceSamples(tr, parallel, tr->samples_count);
+    }
+    count = (check->reference_count > check->samples_count) ? (check->reference_count) : (check->samples_count);
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        audio_sample_p r = reference + i;
+        audio_sample_p p = parallel + i;
+        same[i] = (i < check->reference_count) && (i < check->samples_count) &&
+                  (r->data == p->data) && (r->size == p->size) && (r->uncomp_size == p->uncomp_size);
+        if(!same[i])
+        {
+            bool tr1_tail = (tr->game_version <= TR_I_UB) && (i < check->reference_count) &&
+                            ((i + 1 == check->reference_count) || (r->data == NULL));
+            check->slices_differ++;
+            check->slices_fixed += (tr1_tail) ? (1) : (0);
+        }
+        if(r->data && ((r->data < tr->samples_data) || (r->data > end) || (r->size > (uint32_t)(end - r->data))))
+        {
+            r->data = NULL;
+        }
+    }
+
+    t0 = Sys_FloatTime();
+    for(uint32_t i = 0; i < check->reference_count; i++)
+    {
+        Audio_DecodeSample(reference, i);
+    }
+    t1 = Sys_FloatTime();
+    Parallel_For(check->samples_count, Audio_DecodeSample, parallel);
+    t2 = Sys_FloatTime();
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        audio_sample_p s = reference + i;
+        audio_sample_p p = parallel + i;
+        if(same[i] && ((s->wav_length != p->wav_length) || (s->spec.format != p->spec.format) ||
+           (s->spec.channels != p->spec.channels) || (s->spec.freq != p->spec.freq) ||
+           ((s->wav_buffer == NULL) != (p->wav_buffer == NULL)) ||
+           (s->wav_buffer && memcmp(s->wav_buffer, p->wav_buffer, s->wav_length))))
+        {
+            check->pcm_differ++;
+        }
+        SDL_FreeWAV(s->wav_buffer);
+        SDL_FreeWAV(p->wav_buffer);
+    }
+    free(reference);
+    free(parallel);
+    free(same);
+
+    check->serial_time = t1 - t0;
+    check->parallel_time = t2 - t1;
+    return check->slices_differ - check->slices_fixed + check->pcm_differ;
+}
+
+
+/**
+ * Samples part of Audio_GenSamples() without OpenAL: cuts samples, takes hits
+ * from cache (values are indices in first loaded samples), decodes misses.
+ * Returns seconds spent; decoded data is freed as by OpenAL buffer fill.
+ */
+static float Audio_CacheSamplesPass(class VT_Level *tr, audio_cache_p cache, audio_sample_p samples, audio_sample_p first, audio_samples_cache_check_p check)
+{
+    float t0 = Sys_FloatTime();
+    uint32_t count = Audio_SliceSamples(tr, samples, tr->samples_count);
+
+    if(cache)
+    {
+        Parallel_For(count, Audio_HashSample, samples);
+        for(uint32_t i = 0; i < count; i++)
+        {
+            uint32_t value;
+            if(AudioCache_Acquire(cache, samples[i].key, &value))
+            {
+                audio_sample_p s = first + value;
+                if((s->size != samples[i].size) || (s->uncomp_size != samples[i].uncomp_size) ||
+                   (s->data && memcmp(s->data, samples[i].data, s->size)))
+                {
+                    check->key_collisions++;
+                }
+                samples[i].data = NULL;
+            }
+            else
+            {
+                AudioCache_Insert(cache, samples[i].key, i, 0);
+            }
+        }
+    }
+
+    Parallel_For(count, Audio_DecodeSample, samples);
+    for(uint32_t i = 0; i < count; i++)
+    {
+        if(samples[i].wav_buffer)
+        {
+            if(cache)
+            {
+                AudioCache_SetSize(cache, samples[i].key, samples[i].wav_length);
+            }
+            SDL_FreeWAV(samples[i].wav_buffer);
+            samples[i].wav_buffer = NULL;
+        }
+    }
+    check->samples_count = count;
+
+    return Sys_FloatTime() - t0;
+}
+
+/**
+ * Level transition to the same samples (shared MAIN.SFX of TR2 / TR3 or
+ * reload of level) with and without samples cache: samples loading time
+ * without cache, with empty cache and with cache, filled by the first load.
+ * Budget is not limited, so the second load must hit every sample. OpenAL
+ * buffers fill is not counted. Returns count of errors.
+ */
+int Audio_CheckSamplesCache(class VT_Level *tr, struct audio_samples_cache_check_s *check)
+{
+    audio_sample_p cold = (audio_sample_p)calloc(tr->samples_count + 1, sizeof(audio_sample_t));
+    audio_sample_p warm = (audio_sample_p)calloc(tr->samples_count + 1, sizeof(audio_sample_t));
+    audio_cache_p cache = AudioCache_Create((size_t)-1, NULL, NULL);
+    audio_cache_stats_t stats;
+    uint32_t misses;
+
+    memset(check, 0, sizeof(*check));
+    if(tr->samples_data)
+    {
+        Audio_CacheSamplesPass(tr, NULL, warm, NULL, check);                   // first one touches level data
+        check->off_time = Audio_CacheSamplesPass(tr, NULL, warm, NULL, check);
+
+        check->cold_time = Audio_CacheSamplesPass(tr, cache, cold, cold, check);
+        AudioCache_GetStats(cache, &stats);
+        check->entries = stats.entries;
+        misses = stats.misses;
+        for(uint32_t i = 0; i < check->samples_count; i++)
+        {
+            AudioCache_Release(cache, cold[i].key);
+        }
+
+        check->warm_time = Audio_CacheSamplesPass(tr, cache, warm, cold, check);
+        AudioCache_GetStats(cache, &stats);
+        check->warm_misses = stats.misses - misses;
+        for(uint32_t i = 0; i < check->samples_count; i++)
+        {
+            AudioCache_Release(cache, warm[i].key);
+        }
+        AudioCache_GetStats(cache, &stats);
+        check->referenced = stats.referenced;
+    }
+
+    AudioCache_Destroy(cache);
+    free(cold);
+    free(warm);
+
+    return check->warm_misses + check->key_collisions + check->referenced;
+}
+
+
+void Audio_GenSamples(class VT_Level *tr)
+{
+    uint8_t      *pointer = tr->samples_data;
     uint32_t      i;
 
     // Generate stream tracks buffers
@@ -1416,11 +1828,10 @@ void Audio_GenSamples(class VT_Level *tr)
         Audio_CacheTrack(Script_GetSecretTrackNumber(engine_lua));
     }
 
-    // Generate new buffer array.
+    // Generate new buffer array; buffers are taken from samples cache or generated below.
     audio_world_data.audio_buffers_count = tr->samples_count;
-    audio_world_data.audio_buffers = (ALuint*)malloc(audio_world_data.audio_buffers_count * sizeof(ALuint));
-    memset(audio_world_data.audio_buffers, 0, sizeof(ALuint) * audio_world_data.audio_buffers_count);
-    alGenBuffers(audio_world_data.audio_buffers_count, audio_world_data.audio_buffers);
+    audio_world_data.audio_buffers = (ALuint*)calloc(audio_world_data.audio_buffers_count, sizeof(ALuint));
+    audio_world_data.audio_buffers_keys = (uint64_t*)calloc(audio_world_data.audio_buffers_count, sizeof(uint64_t));
 
     // Generate stream track map array.
     // We use scripted amount of tracks to define map bounds.
@@ -1444,109 +1855,99 @@ void Audio_GenSamples(class VT_Level *tr)
     audio_world_data.audio_map = tr->soundmap;
     tr->soundmap = NULL;                   /// without it VT destructor free(tr->soundmap)
 
-    // Cycle through raw samples block and parse them to OpenAL buffers.
+    // Cycle through raw samples block and parse them to OpenAL buffers:
+    // samples are cut from the block, found in samples cache by hash of
+    // source bytes, missed ones are decoded by worker threads and OpenAL
+    // buffers are filled here, in samples order.
 
-    // Different TR versions have different ways of storing samples.
-    // TR1:     sample block size, sample block, num samples, sample offsets.
-    // TR2/TR3: num samples, sample offsets. (Sample block is in MAIN.SFX.)
-    // TR4/TR5: num samples, (uncomp_size-comp_size-sample_data) chain.
-    //
-    // Hence, we specify certain parse method for each game version.
+    switch(tr->game_version)
+    {
+        case TR_I:
+        case TR_I_DEMO:
+        case TR_I_UB:
+            audio_world_data.audio_map_count = TR_AUDIO_MAP_SIZE_TR1;
+            break;
+
+        case TR_II:
+        case TR_II_DEMO:
+        case TR_III:
+            audio_world_data.audio_map_count = (tr->game_version == TR_III) ? (TR_AUDIO_MAP_SIZE_TR3) : (TR_AUDIO_MAP_SIZE_TR2);
+            break;
+
+        case TR_IV:
+        case TR_IV_DEMO:
+        case TR_V:
+            audio_world_data.audio_map_count = (tr->game_version == TR_V) ? (TR_AUDIO_MAP_SIZE_TR5) : (TR_AUDIO_MAP_SIZE_TR4);
+            break;
+
+        default:
+            audio_world_data.audio_map_count = TR_AUDIO_MAP_SIZE_NONE;
+            break;
+    };
 
     if(pointer)
     {
-        switch(tr->game_version)
-        {
-            case TR_I:
-            case TR_I_DEMO:
-            case TR_I_UB:
-                audio_world_data.audio_map_count = TR_AUDIO_MAP_SIZE_TR1;
+        audio_sample_p samples = (audio_sample_p)calloc(audio_world_data.audio_buffers_count, sizeof(audio_sample_t));
+        uint32_t samples_count = Audio_SliceSamples(tr, samples, audio_world_data.audio_buffers_count);
+        size_t budget = (size_t)audio_settings.sample_cache_size * 1024 * 1024;
 
-                for(i = 0; i < audio_world_data.audio_buffers_count-1; i++)
-                {
-                    pointer = tr->samples_data + tr->sample_indices[i];
-                    uint32_t size = tr->sample_indices[i + 1] - tr->sample_indices[i];
-                    Audio_LoadALbufferFromWAV_Mem(audio_world_data.audio_buffers[i], pointer, size);
-                }
-                i = audio_world_data.audio_buffers_count-1;
-                Audio_LoadALbufferFromWAV_Mem(audio_world_data.audio_buffers[i], pointer, (tr->samples_count - tr->sample_indices[i]));
-                break;
+        if(!audio_samples_cache && (budget > 0))
+        {
+            audio_samples_cache = AudioCache_Create(budget, Audio_DeleteCachedBuffer, NULL);
+        }
 
-            case TR_II:
-            case TR_II_DEMO:
-            case TR_III:
-                audio_world_data.audio_map_count = (tr->game_version == TR_III) ? (TR_AUDIO_MAP_SIZE_TR3) : (TR_AUDIO_MAP_SIZE_TR2);
-                ind1 = 0;
-                ind2 = 0;
-                flag = 0;
-                i = 0;
-                while(pointer < tr->samples_data + tr->samples_data_size - 4)
+        if(audio_samples_cache)
+        {
+            AudioCache_SetBudget(audio_samples_cache, budget);
+            Parallel_For(samples_count, Audio_HashSample, samples);
+            for(i = 0; i < samples_count; i++)
+            {
+                // repeated sample of this level hits entry, inserted for the first one
+                uint64_t key = samples[i].key;
+                if(AudioCache_Acquire(audio_samples_cache, key, audio_world_data.audio_buffers + i))
                 {
-                    pointer = tr->samples_data + ind2;
-                    if(!memcmp(pointer, "RIFF", 4))
-                    {
-                        if(flag == 0x00)
-                        {
-                            ind1 = ind2;
-                            flag = 0x01;
-                        }
-                        else
-                        {
-                            uncomp_size = ind2 - ind1;
-                            Audio_LoadALbufferFromWAV_Mem(audio_world_data.audio_buffers[i], tr->samples_data + ind1, uncomp_size);
-                            i++;
-                            if(i > audio_world_data.audio_buffers_count - 1)
-                            {
-                                break;
-                            }
-                            ind1 = ind2;
-                        }
-                    }
-                    ind2++;
+                    samples[i].data = NULL;
                 }
-                uncomp_size = tr->samples_data_size - ind1;
-                pointer = tr->samples_data + ind1;
-                if(i < audio_world_data.audio_buffers_count)
+                else
                 {
-                    Audio_LoadALbufferFromWAV_Mem(audio_world_data.audio_buffers[i], pointer, uncomp_size);
+                    alGenBuffers(1, audio_world_data.audio_buffers + i);
+                    AudioCache_Insert(audio_samples_cache, key, audio_world_data.audio_buffers[i], 0);
                 }
-                break;
-
-            case TR_IV:
-            case TR_IV_DEMO:
-            case TR_V:
-                audio_world_data.audio_map_count = (tr->game_version == TR_V) ? (TR_AUDIO_MAP_SIZE_TR5) : (TR_AUDIO_MAP_SIZE_TR4);
+                audio_world_data.audio_buffers_keys[i] = key;
+            }
+        }
+        else
+        {
+            alGenBuffers(samples_count, audio_world_data.audio_buffers);
+        }
 
-                for(i = 0; i < tr->samples_count; i++)
+        Parallel_For(samples_count, Audio_DecodeSample, samples);
+        for(i = 0; i < samples_count; i++)
+        {
+            if(samples[i].data)
+            {
+                if(audio_samples_cache)
                 {
-                    // Parse sample sizes.
-                    // Always use comp_size as block length, as uncomp_size is used to cut raw sample data.
-                    uncomp_size = *((uint32_t*)pointer);
-                    pointer += 4;
-                    comp_size   = *((uint32_t*)pointer);
-                    pointer += 4;
-
-                    // Load WAV sample into OpenAL buffer.
-                    Audio_LoadALbufferFromWAV_Mem(audio_world_data.audio_buffers[i], pointer, comp_size, uncomp_size);
-
-                    // Now we can safely move pointer through current sample data.
-                    pointer += comp_size;
+                    AudioCache_SetSize(audio_samples_cache, samples[i].key, samples[i].wav_length);
                 }
-                break;
-
-            default:
-                audio_world_data.audio_map_count = TR_AUDIO_MAP_SIZE_NONE;
-                free(tr->samples_data);
-                tr->samples_data = NULL;
-                tr->samples_data_size = 0;
-                return;
+                Audio_FillALBufferFromSample(audio_world_data.audio_buffers[i], samples + i);
+            }
         }
+        free(samples);
 
         free(tr->samples_data);
         tr->samples_data = NULL;
         tr->samples_data_size = 0;
     }
 
+    for(i = 0; i < audio_world_data.audio_buffers_count; i++)
+    {
+        if(audio_world_data.audio_buffers[i] == 0)
+        {
+            alGenBuffers(1, audio_world_data.audio_buffers + i);
+        }
+    }
+
     // Cycle through SoundDetails and parse them into native OpenTomb
     // audio effects structure.
     for(i = 0; i < audio_world_data.audio_effects_count; i++)
@@ -1706,10 +2107,23 @@ int Audio_DeInit()
 
     if(audio_world_data.audio_buffers)
     {
-        alDeleteBuffers(audio_world_data.audio_buffers_count, audio_world_data.audio_buffers);
+        // cached buffers stay alive for the next levels, until they are evicted
+        for(uint32_t i = 0; i < audio_world_data.audio_buffers_count; i++)
+        {
+            if(audio_world_data.audio_buffers_keys && audio_world_data.audio_buffers_keys[i] && audio_samples_cache)
+            {
+                AudioCache_Release(audio_samples_cache, audio_world_data.audio_buffers_keys[i]);
+            }
+            else if(audio_world_data.audio_buffers[i])
+            {
+                alDeleteBuffers(1, audio_world_data.audio_buffers + i);
+            }
+        }
         audio_world_data.audio_buffers_count = 0;
         free(audio_world_data.audio_buffers);
         audio_world_data.audio_buffers = NULL;
+        free(audio_world_data.audio_buffers_keys);
+        audio_world_data.audio_buffers_keys = NULL;
     }
 
     if(audio_world_data.audio_effects)
@@ -1784,22 +2198,45 @@ int  Audio_LogALError(int error_marker)
 }*/
 
 
-int Audio_LoadALbufferFromWAV_Mem(ALuint buf_number, uint8_t *sample_pointer, uint32_t sample_size, uint32_t uncomp_sample_size)
+void Audio_HashSample(void *data, uint32_t index)
 {
-    SDL_AudioSpec wav_spec;
-    Uint8        *wav_buffer;
-    Uint32        wav_length;
+    audio_sample_p sample = (audio_sample_p)data + index;
+    sample->key = AudioCache_Hash(sample->data, sample->size, sample->uncomp_size);
+}
 
-    SDL_RWops *src = SDL_RWFromMem(sample_pointer, sample_size);
+
+void Audio_DeleteCachedBuffer(void *data, uint32_t value)
+{
+    ALuint buffer = value;
+    alDeleteBuffers(1, &buffer);
+}
+
+/**
+ * Thread safe, parallel_func_t for samples array; no OpenAL calls.
+ * On fail sample->wav_buffer stays NULL; samples without data are skipped.
+ */
+void Audio_DecodeSample(void *data, uint32_t index)
+{
+    audio_sample_p sample = (audio_sample_p)data + index;
+    SDL_RWops *src;
+
+    sample->wav_buffer = NULL;
+    sample->wav_length = 0;
+    if(!sample->data)
+    {
+        return;
+    }
 
     // Decode WAV structure with SDL methods.
     // SDL automatically defines file format (PCM/ADPCM), so we shouldn't bother
     // about if it is TR4 compressed samples or TRLE uncompressed samples.
 
-    if(SDL_LoadWAV_RW(src, 1, &wav_spec, &wav_buffer, &wav_length) == NULL)
+    src = SDL_RWFromMem(sample->data, sample->size);
+    if(!src || (SDL_LoadWAV_RW(src, 1, &sample->spec, &sample->wav_buffer, &sample->wav_length) == NULL))
     {
-        Sys_DebugLog(SYS_LOG_FILENAME, "Error: can't load sample #%03d from sample block!", buf_number);
-        return -1;
+        sample->wav_buffer = NULL;
+        sample->wav_length = 0;
+        return;
     }
 
     // Uncomp_sample_size explicitly specifies amount of raw sample data
@@ -1811,22 +2248,50 @@ int Audio_LoadALbufferFromWAV_Mem(ALuint buf_number, uint8_t *sample_pointer, ui
     // than native wav length, because for some reason many TR5 uncomp sizes
     // are messed up and actually more than actual sample size.
 
-    if((uncomp_sample_size == 0) || (wav_length < uncomp_sample_size))
+    if((sample->uncomp_size != 0) && (sample->uncomp_size < sample->wav_length))
+    {
+        sample->wav_length = sample->uncomp_size;
+    }
+}
+
+/**
+ * Fills OpenAL buffer by decoded sample and frees decoded data.
+ */
+int Audio_FillALBufferFromSample(ALuint buf_number, audio_sample_p sample)
+{
+    bool result;
+
+    if(!sample->wav_buffer)
     {
-        uncomp_sample_size = wav_length;
+        Sys_DebugLog(SYS_LOG_FILENAME, "Error: can't load sample #%03d from sample block!", buf_number);
+        return -1;
     }
 
     // Find out sample format and load it correspondingly.
     // Note that with OpenAL, we can have samples of different formats in same level.
 
-    bool result = Audio_FillALBuffer(buf_number, wav_buffer, uncomp_sample_size, wav_spec.format & SDL_AUDIO_MASK_BITSIZE, wav_spec.channels, wav_spec.freq);
+    result = Audio_FillALBuffer(buf_number, sample->wav_buffer, sample->wav_length, sample->spec.format & SDL_AUDIO_MASK_BITSIZE, sample->spec.channels, sample->spec.freq);
 
-    SDL_FreeWAV(wav_buffer);
+    SDL_FreeWAV(sample->wav_buffer);
+    sample->wav_buffer = NULL;
 
     return (result) ? (0) : (-3);   // Zero means success.
 }
 
 
+int Audio_LoadALbufferFromWAV_Mem(ALuint buf_number, uint8_t *sample_pointer, uint32_t sample_size, uint32_t uncomp_sample_size)
+{
+    audio_sample_t sample;
+
+    sample.data = sample_pointer;
+    sample.size = sample_size;
+    sample.uncomp_size = uncomp_sample_size;
+    Audio_DecodeSample(&sample, 0);
+
+    return Audio_FillALBufferFromSample(buf_number, &sample);
+}
+
+
 int Audio_LoadALbufferFromWAV_File(ALuint buf_number, const char *fname)
 {
     SDL_RWops     *file;
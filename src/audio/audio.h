@@ -146,8 +146,36 @@ typedef struct audio_settings_s
     float       sound_volume;
     uint32_t    use_effects : 1;
     uint32_t    listener_is_player : 1; // RESERVED FOR FUTURE USE
+    uint32_t    sample_cache_size;      // MB of decoded samples kept between levels, 0 - off.
 }audio_settings_t, *audio_settings_p;
 
+// Result of Audio_CheckSamplesDecode().
+
+typedef struct audio_samples_check_s
+{
+    uint32_t    samples_count;          // cut by Audio_SliceSamples()
+    uint32_t    reference_count;        // cut by the original per-version loops
+    uint32_t    slices_differ;          // samples with different block ranges
+    uint32_t    slices_fixed;           // of them the TR1 tail, fixed on purpose
+    uint32_t    pcm_differ;             // same ranges, but different PCM
+    float       serial_time;            // seconds, original slices decoded one by one
+    float       parallel_time;          // seconds, new slices decoded by workers
+}audio_samples_check_t, *audio_samples_check_p;
+
+// Result of Audio_CheckSamplesCache().
+
+typedef struct audio_samples_cache_check_s
+{
+    uint32_t    samples_count;
+    uint32_t    entries;                // cache entries after the first load
+    uint32_t    warm_misses;            // on the second load, must be 0
+    uint32_t    key_collisions;         // hits with different source bytes, must be 0
+    uint32_t    referenced;             // after both loads released, must be 0
+    float       off_time;               // seconds, no cache: slice and decode all
+    float       cold_time;              // empty cache: slice, hash, decode misses
+    float       warm_time;              // same level again: slice, hash, hits only
+}audio_samples_cache_check_t, *audio_samples_cache_check_p;
+
 
 extern struct audio_settings_s audio_settings;
 
@@ -159,6 +187,9 @@ void Audio_CoreInit();
 void Audio_CoreDeinit();
 void Audio_Init(uint32_t num_Sources = TR_AUDIO_MAX_CHANNELS);
 void Audio_GenSamples(class VT_Level *tr);
+int  Audio_GetSamplesCacheStats(struct audio_cache_stats_s *stats);
+int  Audio_CheckSamplesDecode(class VT_Level *tr, struct audio_samples_check_s *check);
+int  Audio_CheckSamplesCache(class VT_Level *tr, struct audio_samples_cache_check_s *check);
 void Audio_CacheTrack(int id);
 int  Audio_DeInit();
 void Audio_Update(float time);
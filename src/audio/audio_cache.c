@@ -0,0 +1,282 @@
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "audio_cache.h"
+
+
+#define AUDIO_CACHE_MIN_BUCKETS     (256)                                       // must be power of 2
+
+typedef struct audio_cache_entry_s
+{
+    uint64_t                        key;
+    uint32_t                        value;
+    uint32_t                        refs;
+    size_t                          size;
+    struct audio_cache_entry_s     *next;                                       // in bucket
+    struct audio_cache_entry_s     *lru_prev;                                   // unreferenced ones only
+    struct audio_cache_entry_s     *lru_next;
+}audio_cache_entry_t, *audio_cache_entry_p;
+
+struct audio_cache_s
+{
+    audio_cache_entry_p            *buckets;
+    uint32_t                        buckets_count;
+    audio_cache_entry_p             lru_first;                                  // least recently used
+    audio_cache_entry_p             lru_last;
+    size_t                          budget;
+    audio_cache_evict_func_t        evict;
+    void                           *evict_data;
+    audio_cache_stats_t             stats;
+};
+
+
+static audio_cache_entry_p *AudioCache_Bucket(audio_cache_p cache, uint64_t key)
+{
+    return cache->buckets + ((key ^ (key >> 32)) & (cache->buckets_count - 1));
+}
+
+
+static audio_cache_entry_p AudioCache_Find(audio_cache_p cache, uint64_t key)
+{
+    audio_cache_entry_p entry = *AudioCache_Bucket(cache, key);
+    for(; entry && (entry->key != key); entry = entry->next);
+    return entry;
+}
+
+
+static void AudioCache_LRUUnlink(audio_cache_p cache, audio_cache_entry_p entry)
+{
+    if(entry->lru_prev)
+    {
+        entry->lru_prev->lru_next = entry->lru_next;
+    }
+    else
+    {
+        cache->lru_first = entry->lru_next;
+    }
+    if(entry->lru_next)
+    {
+        entry->lru_next->lru_prev = entry->lru_prev;
+    }
+    else
+    {
+        cache->lru_last = entry->lru_prev;
+    }
+    entry->lru_prev = NULL;
+    entry->lru_next = NULL;
+}
+
+
+static void AudioCache_Remove(audio_cache_p cache, audio_cache_entry_p entry)
+{
+    audio_cache_entry_p *link = AudioCache_Bucket(cache, entry->key);
+    for(; *link != entry; link = &(*link)->next);
+    *link = entry->next;
+
+    AudioCache_LRUUnlink(cache, entry);
+    cache->stats.entries--;
+    cache->stats.size -= entry->size;
+    cache->stats.evictions++;
+    if(cache->evict)
+    {
+        cache->evict(cache->evict_data, entry->value);
+    }
+    free(entry);
+}
+
+
+static void AudioCache_Trim(audio_cache_p cache)
+{
+    while(cache->lru_first && (cache->stats.size > cache->budget))
+    {
+        AudioCache_Remove(cache, cache->lru_first);
+    }
+}
+
+
+static void AudioCache_Grow(audio_cache_p cache)
+{
+    audio_cache_entry_p *old_buckets = cache->buckets;
+    uint32_t old_count = cache->buckets_count;
+
+    cache->buckets_count *= 2;
+    cache->buckets = (audio_cache_entry_p*)calloc(cache->buckets_count, sizeof(audio_cache_entry_p));
+    for(uint32_t i = 0; i < old_count; i++)
+    {
+        while(old_buckets[i])
+        {
+            audio_cache_entry_p entry = old_buckets[i];
+            audio_cache_entry_p *bucket = AudioCache_Bucket(cache, entry->key);
+            old_buckets[i] = entry->next;
+            entry->next = *bucket;
+            *bucket = entry;
+        }
+    }
+    free(old_buckets);
+}
+
+
+audio_cache_p AudioCache_Create(size_t budget, audio_cache_evict_func_t evict, void *evict_data)
+{
+    audio_cache_p cache = (audio_cache_p)calloc(1, sizeof(struct audio_cache_s));
+    cache->buckets_count = AUDIO_CACHE_MIN_BUCKETS;
+    cache->buckets = (audio_cache_entry_p*)calloc(cache->buckets_count, sizeof(audio_cache_entry_p));
+    cache->budget = budget;
+    cache->evict = evict;
+    cache->evict_data = evict_data;
+    return cache;
+}
+
+
+void AudioCache_Destroy(audio_cache_p cache)
+{
+    if(cache)
+    {
+        for(uint32_t i = 0; i < cache->buckets_count; i++)
+        {
+            while(cache->buckets[i])
+            {
+                AudioCache_Remove(cache, cache->buckets[i]);
+            }
+        }
+        free(cache->buckets);
+        free(cache);
+    }
+}
+
+
+void AudioCache_SetBudget(audio_cache_p cache, size_t budget)
+{
+    cache->budget = budget;
+    AudioCache_Trim(cache);
+}
+
+#define AUDIO_CACHE_HASH_M          (0xC6A4A7935BD1E995ULL)
+
+static uint64_t AudioCache_HashWord(uint64_t hash, uint64_t k)
+{
+    k *= AUDIO_CACHE_HASH_M;
+    k ^= k >> 47;
+    k *= AUDIO_CACHE_HASH_M;
+    return (hash ^ k) * AUDIO_CACHE_HASH_M;
+}
+
+/*
+ * MurmurHash64A steps by 8 bytes (bytewise FNV-1a took longer than decoding
+ * of PCM samples); seed and tail are mixed as whole words, so short keys
+ * with different seeds do not collide. 0 is reserved for "not cached".
+ */
+uint64_t AudioCache_Hash(const uint8_t *data, size_t size, uint32_t seed)
+{
+    uint64_t hash = AudioCache_HashWord(size * AUDIO_CACHE_HASH_M, seed);
+    const uint8_t *end = data + (size & ~(size_t)7);
+    uint64_t k;
+
+    for(; data < end; data += 8)
+    {
+        memcpy(&k, data, 8);
+        hash = AudioCache_HashWord(hash, k);
+    }
+
+    if(size & 7)
+    {
+        k = 0;
+        memcpy(&k, data, size & 7);
+        hash = AudioCache_HashWord(hash, k);
+    }
+
+    hash ^= hash >> 47;
+    hash *= AUDIO_CACHE_HASH_M;
+    hash ^= hash >> 47;
+
+    return (hash) ? (hash) : (1);
+}
+
+
+int AudioCache_Acquire(audio_cache_p cache, uint64_t key, uint32_t *value)
+{
+    audio_cache_entry_p entry = AudioCache_Find(cache, key);
+
+    if(!entry)
+    {
+        cache->stats.misses++;
+        return 0;
+    }
+
+    if(entry->refs++ == 0)
+    {
+        AudioCache_LRUUnlink(cache, entry);
+        cache->stats.referenced++;
+    }
+    cache->stats.hits++;
+    *value = entry->value;
+
+    return 1;
+}
+
+
+void AudioCache_Insert(audio_cache_p cache, uint64_t key, uint32_t value, size_t size)
+{
+    audio_cache_entry_p entry = (audio_cache_entry_p)calloc(1, sizeof(audio_cache_entry_t));
+    audio_cache_entry_p *bucket;
+
+    if(cache->stats.entries >= cache->buckets_count)
+    {
+        AudioCache_Grow(cache);
+    }
+
+    bucket = AudioCache_Bucket(cache, key);
+    entry->key = key;
+    entry->value = value;
+    entry->refs = 1;
+    entry->size = size;
+    entry->next = *bucket;
+    *bucket = entry;
+
+    cache->stats.entries++;
+    cache->stats.referenced++;
+    cache->stats.size += size;
+    AudioCache_Trim(cache);
+}
+
+
+void AudioCache_SetSize(audio_cache_p cache, uint64_t key, size_t size)
+{
+    audio_cache_entry_p entry = AudioCache_Find(cache, key);
+    if(entry)
+    {
+        cache->stats.size = cache->stats.size - entry->size + size;
+        entry->size = size;
+        AudioCache_Trim(cache);
+    }
+}
+
+
+void AudioCache_Release(audio_cache_p cache, uint64_t key)
+{
+    audio_cache_entry_p entry = AudioCache_Find(cache, key);
+
+    if(entry && (entry->refs > 0) && (--entry->refs == 0))
+    {
+        // becomes the most recently used one
+        entry->lru_prev = cache->lru_last;
+        if(cache->lru_last)
+        {
+            cache->lru_last->lru_next = entry;
+        }
+        else
+        {
+            cache->lru_first = entry;
+        }
+        cache->lru_last = entry;
+        cache->stats.referenced--;
+        AudioCache_Trim(cache);
+    }
+}
+
+
+void AudioCache_GetStats(audio_cache_p cache, audio_cache_stats_p stats)
+{
+    *stats = cache->stats;
+}
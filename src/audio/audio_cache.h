@@ -0,0 +1,48 @@
+#ifndef AUDIO_CACHE_H
+#define AUDIO_CACHE_H
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Decoded samples cache: maps hash of sample source bytes to a value (OpenAL
+ * buffer), so samples, shared by levels (MAIN.SFX of TR2 / TR3), are decoded
+ * once. Entries in use are referenced; unreferenced ones are kept in LRU
+ * order and are evicted by evict callback, when size of all entries is
+ * above budget. Index only, no OpenAL calls; main thread only.
+ */
+#define AUDIO_CACHE_DEFAULT_BUDGET  (64 * 1024 * 1024)
+
+typedef struct audio_cache_s *audio_cache_p;
+typedef void (*audio_cache_evict_func_t)(void *data, uint32_t value);
+
+typedef struct audio_cache_stats_s
+{
+    uint32_t                entries;
+    uint32_t                referenced;
+    size_t                  size;                                               // of all entries
+    uint32_t                hits;
+    uint32_t                misses;
+    uint32_t                evictions;
+}audio_cache_stats_t, *audio_cache_stats_p;
+
+audio_cache_p AudioCache_Create(size_t budget, audio_cache_evict_func_t evict, void *evict_data);
+void     AudioCache_Destroy(audio_cache_p cache);                               // evicts all entries
+void     AudioCache_SetBudget(audio_cache_p cache, size_t budget);
+
+uint64_t AudioCache_Hash(const uint8_t *data, size_t size, uint32_t seed);     // never 0
+int      AudioCache_Acquire(audio_cache_p cache, uint64_t key, uint32_t *value); // 1 on hit, takes reference
+void     AudioCache_Insert(audio_cache_p cache, uint64_t key, uint32_t value, size_t size); // referenced entry
+void     AudioCache_SetSize(audio_cache_p cache, uint64_t key, size_t size);
+void     AudioCache_Release(audio_cache_p cache, uint64_t key);
+void     AudioCache_GetStats(audio_cache_p cache, audio_cache_stats_p stats);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif
@@ -1,4 +1,6 @@
 #include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_platform.h>
@@ -25,6 +27,9 @@ extern "C" {
 #include "controls.h"
 #include "game.h"
 
+static FILE *controls_record_file = NULL;
+static FILE *controls_playback_file = NULL;
+
 
 void Controls_Key(int32_t button, int state)
 {
@@ -564,3 +569,133 @@ void Controls_SecondaryMouseDown(struct engine_container_s **cont, float dot[3])
         }
     }
 }
+
+
+/*
+ * Control states recording / playback: whole control state is stored once
+ * per game frame together with frame time, so playback feeds Game_Frame()
+ * with exactly the same input and dt sequence.
+ */
+int Controls_RecordStart(const char *file_name)
+{
+    control_record_header_t header;
+
+    Controls_RecordStop();
+    controls_record_file = fopen(file_name, "wb");
+    if(!controls_record_file)
+    {
+        Sys_Warn("Can not open controls record file \"%s\"", file_name);
+        return 0;
+    }
+
+    header.magic = CONTROLS_RECORD_MAGIC;
+    header.version = CONTROLS_RECORD_VERSION;
+    header.frame_size = sizeof(control_record_frame_t);
+    fwrite(&header, sizeof(header), 1, controls_record_file);
+
+    return 1;
+}
+
+
+int Controls_PlaybackStart(const char *file_name)
+{
+    control_record_header_t header;
+
+    Controls_RecordStop();
+    controls_playback_file = fopen(file_name, "rb");
+    if(!controls_playback_file)
+    {
+        Sys_Warn("Can not open controls record file \"%s\"", file_name);
+        return 0;
+    }
+
+    if((fread(&header, sizeof(header), 1, controls_playback_file) != 1) ||
+       (header.magic != CONTROLS_RECORD_MAGIC) || (header.version != CONTROLS_RECORD_VERSION) ||
+       (header.frame_size != sizeof(control_record_frame_t)))
+    {
+        Sys_Warn("Wrong controls record file \"%s\"", file_name);
+        fclose(controls_playback_file);
+        controls_playback_file = NULL;
+        return 0;
+    }
+
+    return 1;
+}
+
+
+void Controls_RecordStop()
+{
+    if(controls_record_file)
+    {
+        fclose(controls_record_file);
+        controls_record_file = NULL;
+    }
+
+    if(controls_playback_file)
+    {
+        fclose(controls_playback_file);
+        controls_playback_file = NULL;
+    }
+}
+
+
+int Controls_IsPlayback()
+{
+    return controls_playback_file != NULL;
+}
+
+
+void Controls_RecordFrame(float time)
+{
+    if(controls_record_file)
+    {
+        control_record_frame_t frame;
+
+        memset(&frame, 0x00, sizeof(frame));
+        frame.frame_time = time;
+        frame.joy_look_x = control_mapper.joy_look_x;
+        frame.joy_look_y = control_mapper.joy_look_y;
+        frame.joy_move_x = control_mapper.joy_move_x;
+        frame.joy_move_y = control_mapper.joy_move_y;
+        frame.states = control_states;
+        for(int i = 0; i < ACT_LASTINDEX; i++)
+        {
+            frame.actions[i] = control_mapper.action_map[i].state;
+        }
+        fwrite(&frame, sizeof(frame), 1, controls_record_file);
+    }
+}
+
+/**
+ * Overwrites current control states by next recorded frame.
+ * @return 0 if there is no playback or record is over.
+ */
+int Controls_PlaybackFrame(float *time)
+{
+    control_record_frame_t frame;
+
+    if(!controls_playback_file)
+    {
+        return 0;
+    }
+
+    if(fread(&frame, sizeof(frame), 1, controls_playback_file) != 1)
+    {
+        fclose(controls_playback_file);
+        controls_playback_file = NULL;
+        return 0;
+    }
+
+    *time = frame.frame_time;
+    control_mapper.joy_look_x = frame.joy_look_x;
+    control_mapper.joy_look_y = frame.joy_look_y;
+    control_mapper.joy_move_x = frame.joy_move_x;
+    control_mapper.joy_move_y = frame.joy_move_y;
+    control_states = frame.states;
+    for(int i = 0; i < ACT_LASTINDEX; i++)
+    {
+        control_mapper.action_map[i].state = (frame.actions[i] != 0);
+    }
+
+    return 1;
+}
@@ -5,6 +5,8 @@
 #include <SDL2/SDL.h>
 #include <stdint.h>
 
+#include "engine.h"
+
 #define JOY_BUTTON_MASK  1000
 #define JOY_HAT_MASK     1100
 #define JOY_TRIGGER_MASK 1200
@@ -116,6 +118,28 @@ typedef struct control_settings_s
 }control_settings_t, *control_settings_p;
 
 
+// Control states record file: header followed by one frame record per game frame.
+#define CONTROLS_RECORD_MAGIC       (0x5243544F)                                // "OTCR"
+#define CONTROLS_RECORD_VERSION     (1)
+
+typedef struct control_record_header_s
+{
+    uint32_t    magic;
+    uint32_t    version;
+    uint32_t    frame_size;
+}control_record_header_t, *control_record_header_p;
+
+typedef struct control_record_frame_s
+{
+    float                           frame_time;
+    float                           joy_look_x;
+    float                           joy_look_y;
+    float                           joy_move_x;
+    float                           joy_move_y;
+    struct engine_control_state_s   states;
+    uint8_t                         actions[ACT_LASTINDEX];
+}control_record_frame_t, *control_record_frame_p;
+
 extern struct engine_control_state_s            control_states;
 extern struct control_settings_s                control_mapper;
 
@@ -131,4 +155,11 @@ void Controls_JoyHat(int value);
 void Controls_RefreshStates();
 void Controls_InitGlobals();
 
+int  Controls_RecordStart(const char *file_name);
+int  Controls_PlaybackStart(const char *file_name);
+void Controls_RecordStop();
+int  Controls_IsPlayback();
+void Controls_RecordFrame(float time);
+int  Controls_PlaybackFrame(float *time);
+
 #endif /* CONTROLS_H */
@@ -0,0 +1,328 @@
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+
+
+#define ARENA_ALIGN_SIZE(sz)        (((sz) + ARENA_ALIGN - 1) & ~((size_t)ARENA_ALIGN - 1))
+#define ARENA_CHUNK_HEADER_SIZE     ARENA_ALIGN_SIZE(sizeof(arena_chunk_t))
+#define ARENA_CHUNK_DATA(chunk)     ((uint8_t*)(chunk) + ARENA_CHUNK_HEADER_SIZE)
+
+typedef struct arena_chunk_s
+{
+    struct arena_chunk_s   *next;
+    size_t                  size;                                               // data size, without header
+    size_t                  used;
+    size_t                  last;                                               // offset of the last block, for in place realloc
+}arena_chunk_t, *arena_chunk_p;
+
+/*
+ * Ownership map: address space is split to pages of ARENA_BIG_BLOCK_SIZE;
+ * every chunk is bigger than a page, so one page touches two chunks at most
+ * (the one that ends in it and the one that starts in it). Pages are kept in
+ * open addressing hash, so Arena_Owns() / Arena_Free() cost does not depend
+ * on chunks count.
+ */
+#define ARENA_PAGE(ptr)             ((uintptr_t)(ptr) / ARENA_BIG_BLOCK_SIZE)
+#define ARENA_PAGES_MIN_SIZE        (256)                                       // must be power of 2
+
+typedef struct arena_page_s
+{
+    uintptr_t               page;
+    arena_chunk_p           chunk[2];                                           // NULL chunk[0] marks empty slot
+}arena_page_t, *arena_page_p;
+
+static const char *arena_tag_names[ARENA_TAGS_COUNT] =
+{
+    "world",
+    "rooms",
+    "meshes",
+    "animations",
+    "cameras",
+    "textures"
+};
+
+/*
+ * Small blocks are cut from the head chunk; big ones get own chunks, linked
+ * after the head, so free space of the head is not lost.
+ */
+static arena_chunk_p    arena_chunks = NULL;
+static arena_stats_t    arena_stats = {{0}, 0, 0, 0, 0, 0};
+static arena_page_p     arena_pages = NULL;
+static uint32_t         arena_pages_size = 0;
+static uint32_t         arena_pages_count = 0;
+
+
+static uint32_t Arena_PageHash(uintptr_t page)
+{
+    return (uint32_t)(page * 2654435761u) & (arena_pages_size - 1);
+}
+
+
+static arena_page_p Arena_FindPage(uintptr_t page)
+{
+    if(arena_pages_count > 0)
+    {
+        uint32_t i = Arena_PageHash(page);
+        while(arena_pages[i].chunk[0])
+        {
+            if(arena_pages[i].page == page)
+            {
+                return arena_pages + i;
+            }
+            i = (i + 1) & (arena_pages_size - 1);
+        }
+    }
+    return NULL;
+}
+
+
+static int Arena_AddPageChunk(uintptr_t page, arena_chunk_p chunk)
+{
+    arena_page_p p;
+    uint32_t i;
+
+    if(2 * (arena_pages_count + 1) > arena_pages_size)
+    {
+        uint32_t new_size = (arena_pages_size) ? (2 * arena_pages_size) : (ARENA_PAGES_MIN_SIZE);
+        arena_page_p old_pages = arena_pages;
+        uint32_t old_size = arena_pages_size;
+        arena_pages = (arena_page_p)calloc(new_size, sizeof(arena_page_t));
+        if(!arena_pages)
+        {
+            arena_pages = old_pages;
+            return 0;
+        }
+        arena_pages_size = new_size;
+        for(uint32_t j = 0; j < old_size; j++)
+        {
+            if(old_pages[j].chunk[0])
+            {
+                i = Arena_PageHash(old_pages[j].page);
+                while(arena_pages[i].chunk[0])
+                {
+                    i = (i + 1) & (arena_pages_size - 1);
+                }
+                arena_pages[i] = old_pages[j];
+            }
+        }
+        free(old_pages);
+    }
+
+    p = Arena_FindPage(page);
+    if(p)
+    {
+        p->chunk[1] = chunk;
+        return 1;
+    }
+
+    i = Arena_PageHash(page);
+    while(arena_pages[i].chunk[0])
+    {
+        i = (i + 1) & (arena_pages_size - 1);
+    }
+    arena_pages[i].page = page;
+    arena_pages[i].chunk[0] = chunk;
+    arena_pages[i].chunk[1] = NULL;
+    arena_pages_count++;
+    return 1;
+}
+
+
+static arena_chunk_p Arena_NewChunk(size_t size)
+{
+    arena_chunk_p chunk = (arena_chunk_p)malloc(ARENA_CHUNK_HEADER_SIZE + size);
+    if(chunk)
+    {
+        uintptr_t last_page = ARENA_PAGE(ARENA_CHUNK_DATA(chunk) + size - 1);
+        for(uintptr_t page = ARENA_PAGE(ARENA_CHUNK_DATA(chunk)); page <= last_page; page++)
+        {
+            if(!Arena_AddPageChunk(page, chunk))
+            {
+                // chunk may be partly mapped already, so it is never returned to heap
+                return NULL;
+            }
+        }
+        chunk->next = NULL;
+        chunk->size = size;
+        chunk->used = 0;
+        chunk->last = 0;
+        arena_stats.chunks++;
+        arena_stats.reserved_bytes += size;
+        if(arena_stats.reserved_bytes > arena_stats.peak_reserved_bytes)
+        {
+            arena_stats.peak_reserved_bytes = arena_stats.reserved_bytes;
+        }
+    }
+    return chunk;
+}
+
+
+void *Arena_Alloc(uint16_t tag, size_t size)
+{
+    arena_chunk_p chunk = arena_chunks;
+    uint8_t *ret;
+
+    if(size == 0)
+    {
+        return NULL;
+    }
+
+    size = ARENA_ALIGN_SIZE(size);
+    if(!chunk || (chunk->used + size > chunk->size))
+    {
+        if(size > ARENA_BIG_BLOCK_SIZE)
+        {
+            chunk = Arena_NewChunk(size);
+            if(!chunk)
+            {
+                return NULL;
+            }
+            if(arena_chunks)
+            {
+                chunk->next = arena_chunks->next;
+                arena_chunks->next = chunk;
+            }
+            else
+            {
+                arena_chunks = chunk;
+            }
+        }
+        else
+        {
+            chunk = Arena_NewChunk(ARENA_CHUNK_SIZE);
+            if(!chunk)
+            {
+                return NULL;
+            }
+            chunk->next = arena_chunks;
+            arena_chunks = chunk;
+        }
+    }
+
+    ret = ARENA_CHUNK_DATA(chunk) + chunk->used;
+    chunk->last = chunk->used;
+    chunk->used += size;
+
+    arena_stats.tag_bytes[(tag < ARENA_TAGS_COUNT) ? (tag) : (ARENA_TAG_WORLD)] += size;
+    arena_stats.used_bytes += size;
+    arena_stats.allocations++;
+
+    return ret;
+}
+
+
+void *Arena_Calloc(uint16_t tag, size_t count, size_t size)
+{
+    void *ret = Arena_Alloc(tag, count * size);
+    if(ret)
+    {
+        memset(ret, 0x00, count * size);
+    }
+    return ret;
+}
+
+/**
+ * Grows the last block of the head chunk in place; any other block is copied
+ * to the new one and the old arena space stays unused until release.
+ * Heap pointers are copied and freed. On fail returns NULL and, as realloc,
+ * keeps the old block.
+ */
+void *Arena_Realloc(uint16_t tag, void *ptr, size_t old_size, size_t new_size)
+{
+    arena_chunk_p chunk = arena_chunks;
+    void *ret;
+
+    if(ptr && chunk && ((uint8_t*)ptr == ARENA_CHUNK_DATA(chunk) + chunk->last) &&
+       (chunk->last + ARENA_ALIGN_SIZE(new_size) <= chunk->size))
+    {
+        size_t old_used = chunk->used;
+        chunk->used = chunk->last + ARENA_ALIGN_SIZE(new_size);
+        if(chunk->used > old_used)
+        {
+            arena_stats.tag_bytes[(tag < ARENA_TAGS_COUNT) ? (tag) : (ARENA_TAG_WORLD)] += chunk->used - old_used;
+            arena_stats.used_bytes += chunk->used - old_used;
+        }
+        else
+        {
+            chunk->used = old_used;
+        }
+        return ptr;
+    }
+
+    ret = Arena_Alloc(tag, new_size);
+    if(!ret && new_size)
+    {
+        return NULL;
+    }
+    if(ret && ptr)
+    {
+        memcpy(ret, ptr, (old_size < new_size) ? (old_size) : (new_size));
+    }
+    Arena_Free(ptr);
+
+    return ret;
+}
+
+
+void Arena_Free(void *ptr)
+{
+    if(ptr && !Arena_Owns(ptr))
+    {
+        free(ptr);
+    }
+}
+
+
+int Arena_Owns(const void *ptr)
+{
+    arena_page_p p = Arena_FindPage(ARENA_PAGE(ptr));
+    if(p)
+    {
+        for(int i = 0; (i < 2) && p->chunk[i]; i++)
+        {
+            const uint8_t *data = ARENA_CHUNK_DATA(p->chunk[i]);
+            if(((const uint8_t*)ptr >= data) && ((const uint8_t*)ptr < data + p->chunk[i]->size))
+            {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+
+void Arena_Release()
+{
+    while(arena_chunks)
+    {
+        arena_chunk_p next = arena_chunks->next;
+        free(arena_chunks);
+        arena_chunks = next;
+    }
+
+    if(arena_pages_count > 0)
+    {
+        memset(arena_pages, 0x00, arena_pages_size * sizeof(arena_page_t));
+        arena_pages_count = 0;
+    }
+
+    memset(arena_stats.tag_bytes, 0x00, sizeof(arena_stats.tag_bytes));
+    arena_stats.used_bytes = 0;
+    arena_stats.reserved_bytes = 0;
+    arena_stats.allocations = 0;
+    arena_stats.chunks = 0;
+}
+
+
+const arena_stats_t *Arena_GetStats()
+{
+    return &arena_stats;
+}
+
+
+const char *Arena_GetTagName(uint16_t tag)
+{
+    return (tag < ARENA_TAGS_COUNT) ? (arena_tag_names[tag]) : ("unknown");
+}
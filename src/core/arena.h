@@ -0,0 +1,54 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Level arena: region allocator for data that lives until the level is
+ * unloaded. Blocks are cut from big chunks and are never freed one by one;
+ * Arena_Release() drops all chunks at once. Arena_Free() is safe for any
+ * pointer: arena blocks are ignored, heap ones go to free(), so clear
+ * functions work for both. Main thread only.
+ */
+#define ARENA_CHUNK_SIZE            (1024 * 1024)
+#define ARENA_ALIGN                 (16)                                        // must be power of 2
+#define ARENA_BIG_BLOCK_SIZE        (ARENA_CHUNK_SIZE / 4)                      // bigger blocks get own chunks
+
+#define ARENA_TAG_WORLD             (0)
+#define ARENA_TAG_ROOMS             (1)
+#define ARENA_TAG_MESHES            (2)
+#define ARENA_TAG_ANIMATIONS        (3)
+#define ARENA_TAG_CAMERAS           (4)
+#define ARENA_TAG_TEXTURES          (5)
+#define ARENA_TAGS_COUNT            (6)
+
+typedef struct arena_stats_s
+{
+    size_t                  tag_bytes[ARENA_TAGS_COUNT];
+    size_t                  used_bytes;
+    size_t                  reserved_bytes;                                     // chunks size
+    size_t                  peak_reserved_bytes;                                // since start
+    uint32_t                allocations;
+    uint32_t                chunks;
+}arena_stats_t, *arena_stats_p;
+
+void *Arena_Alloc(uint16_t tag, size_t size);
+void *Arena_Calloc(uint16_t tag, size_t count, size_t size);
+void *Arena_Realloc(uint16_t tag, void *ptr, size_t old_size, size_t new_size);
+void  Arena_Free(void *ptr);
+int   Arena_Owns(const void *ptr);
+void  Arena_Release();
+
+const arena_stats_t *Arena_GetStats();
+const char *Arena_GetTagName(uint16_t tag);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif
@@ -15,6 +15,7 @@
 #include "gl_util.h"
 #include "console.h"
 #include "system.h"
+#include "log.h"
 #include "vmath.h"
 #include "gl_text.h"
 
@@ -516,6 +517,7 @@ void Con_Printf(const char *fmt, ...)
     buf[sizeof(buf) - 1] = 0;
     va_end(argptr);
     Con_AddLine(buf, FONTSTYLE_CONSOLE_NOTIFY);
+    Log_Printf(SYS_LOG_FILENAME, LOG_LEVEL_INFO, LOG_CAT_CONSOLE, "%s", buf);
 }
 
 
@@ -529,6 +531,7 @@ void Con_Warning(const char *fmt, ...)
     buf[sizeof(buf) - 1] = 0;
     va_end(argptr);
     Con_AddLine(buf, FONTSTYLE_CONSOLE_WARNING);
+    Log_Printf(SYS_LOG_FILENAME, LOG_LEVEL_WARNING, LOG_CAT_CONSOLE, "%s", buf);
 }
 
 
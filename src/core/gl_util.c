@@ -12,6 +12,7 @@
 
 #include "gl_util.h"
 #include "system.h"
+#include "log.h"
 
 #define GL_LOG_FILENAME "gl_log.txt"
 
@@ -216,6 +217,7 @@ PFNGLGETATTRIBLOCATIONARBPROC           qglGetAttribLocationARB = NULL;
 PFNGLENABLEVERTEXATTRIBARRAYARBPROC     qglEnableVertexAttribArrayARB = NULL;
 PFNGLENABLEVERTEXATTRIBARRAYARBPROC     qglDisableVertexAttribArrayARB = NULL;
 PFNGLVERTEXATTRIBPOINTERARBPROC         qglVertexAttribPointerARB = NULL;
+PFNGLVERTEXATTRIB1FARBPROC              qglVertexAttrib1fARB = NULL;
 
 PFNGLACTIVETEXTUREARBPROC               qglActiveTextureARB = NULL;
 PFNGLCLIENTACTIVETEXTUREARBPROC         qglClientActiveTextureARB = NULL;
@@ -271,6 +273,19 @@ PFNGLISVERTEXARRAYPROC                  qglIsVertexArray = NULL;
 
 PFNGLGENERATEMIPMAPEXTPROC              qglGenerateMipmap = NULL;
 
+PFNGLVERTEXATTRIBDIVISORARBPROC         qglVertexAttribDivisorARB = NULL;
+PFNGLDRAWELEMENTSINSTANCEDARBPROC       qglDrawElementsInstancedARB = NULL;
+
+PFNGLMULTIDRAWARRAYSPROC                qglMultiDrawArrays = NULL;
+PFNGLMULTIDRAWELEMENTSPROC              qglMultiDrawElements = NULL;
+
+PFNGLGENQUERIESARBPROC                  qglGenQueriesARB = NULL;
+PFNGLDELETEQUERIESARBPROC               qglDeleteQueriesARB = NULL;
+PFNGLBEGINQUERYARBPROC                  qglBeginQueryARB = NULL;
+PFNGLENDQUERYARBPROC                    qglEndQueryARB = NULL;
+PFNGLGETQUERYOBJECTIVARBPROC            qglGetQueryObjectivARB = NULL;
+PFNGLGETQUERYOBJECTUI64VPROC            qglGetQueryObjectui64v = NULL;
+
 static char *engine_gl_ext_str = NULL;
 static GLuint whiteTexture = 0;
 
@@ -575,13 +590,253 @@ void InitGLExtFuncs()
         qglDisableVertexAttribArrayARB = (PFNGLDISABLEVERTEXATTRIBARRAYARBPROC)SDL_GL_GetProcAddress("glDisableVertexAttribArrayARB");
 
         qglVertexAttribPointerARB = (PFNGLVERTEXATTRIBPOINTERARBPROC)SDL_GL_GetProcAddress("glVertexAttribPointerARB");
+        qglVertexAttrib1fARB = (PFNGLVERTEXATTRIB1FARBPROC)SDL_GL_GetProcAddress("glVertexAttrib1fARB");
     }
     else
     {
         Sys_Error("Shaders not supported");
     }
+
+    // optional: instanced static meshes fall back to per instance draw calls without it
+    if(IsGLExtensionSupported("GL_ARB_instanced_arrays") && IsGLExtensionSupported("GL_ARB_draw_instanced"))
+    {
+        qglVertexAttribDivisorARB = (PFNGLVERTEXATTRIBDIVISORARBPROC)SDL_GL_GetProcAddress("glVertexAttribDivisorARB");
+        qglDrawElementsInstancedARB = (PFNGLDRAWELEMENTSINSTANCEDARBPROC)SDL_GL_GetProcAddress("glDrawElementsInstancedARB");
+    }
+
+    // optional: merged geometry falls back to draw call per range without it (core since 1.4)
+    qglMultiDrawArrays = (PFNGLMULTIDRAWARRAYSPROC)SDL_GL_GetProcAddress("glMultiDrawArrays");
+    qglMultiDrawElements = (PFNGLMULTIDRAWELEMENTSPROC)SDL_GL_GetProcAddress("glMultiDrawElements");
+    if((!qglMultiDrawArrays || !qglMultiDrawElements) && IsGLExtensionSupported("GL_EXT_multi_draw_arrays"))
+    {
+        qglMultiDrawArrays = (PFNGLMULTIDRAWARRAYSPROC)SDL_GL_GetProcAddress("glMultiDrawArraysEXT");
+        qglMultiDrawElements = (PFNGLMULTIDRAWELEMENTSPROC)SDL_GL_GetProcAddress("glMultiDrawElementsEXT");
+    }
+
+    // optional: GPU profiler zones are not measured without it
+    if(IsGLExtensionSupported("GL_ARB_occlusion_query") &&
+       (IsGLExtensionSupported("GL_ARB_timer_query") || IsGLExtensionSupported("GL_EXT_timer_query")))
+    {
+        qglGenQueriesARB = (PFNGLGENQUERIESARBPROC)SDL_GL_GetProcAddress("glGenQueriesARB");
+        qglDeleteQueriesARB = (PFNGLDELETEQUERIESARBPROC)SDL_GL_GetProcAddress("glDeleteQueriesARB");
+        qglBeginQueryARB = (PFNGLBEGINQUERYARBPROC)SDL_GL_GetProcAddress("glBeginQueryARB");
+        qglEndQueryARB = (PFNGLENDQUERYARBPROC)SDL_GL_GetProcAddress("glEndQueryARB");
+        qglGetQueryObjectivARB = (PFNGLGETQUERYOBJECTIVARBPROC)SDL_GL_GetProcAddress("glGetQueryObjectivARB");
+        qglGetQueryObjectui64v = (PFNGLGETQUERYOBJECTUI64VPROC)SDL_GL_GetProcAddress(IsGLExtensionSupported("GL_ARB_timer_query") ? "glGetQueryObjectui64v" : "glGetQueryObjectui64vEXT");
+    }
 }
 
+/*
+ * Null GL: no-op implementations of functions used by engine, so world,
+ * GUI and fonts can be loaded and simulated without window and GL context
+ * (headless mode). Generated names and handles are unique non zero values.
+ */
+static GLuint null_gl_names = 0;
+
+static void APIENTRY null_glVoidEnum(GLenum a) { }
+static void APIENTRY null_glVoidUint(GLuint a) { }
+static void APIENTRY null_glVoidFloat(GLfloat a) { }
+static void APIENTRY null_glVoidBitfield(GLbitfield a) { }
+static void APIENTRY null_glVoid(void) { }
+static void APIENTRY null_glAlphaFunc(GLenum a, GLclampf b) { }
+static void APIENTRY null_glBindBufferARB(GLenum a, GLuint b) { }
+static void APIENTRY null_glBindTexture(GLenum a, GLuint b) { }
+static void APIENTRY null_glBlendFunc(GLenum a, GLenum b) { }
+static void APIENTRY null_glBufferDataARB(GLenum a, GLsizeiptrARB b, const void *c, GLenum d) { }
+static void APIENTRY null_glBufferSubDataARB(GLenum a, GLintptrARB b, GLsizeiptrARB c, const void *d) { }
+static void APIENTRY null_glClearColor(GLclampf a, GLclampf b, GLclampf c, GLclampf d) { }
+static void APIENTRY null_glPointer(GLint a, GLenum b, GLsizei c, const GLvoid *d) { }
+static void APIENTRY null_glNormalPointer(GLenum a, GLsizei b, const GLvoid *c) { }
+static void APIENTRY null_glDeleteNames(GLsizei a, const GLuint *b) { }
+static void APIENTRY null_glDepthMask(GLboolean a) { }
+static void APIENTRY null_glDrawArrays(GLenum a, GLint b, GLsizei c) { }
+static void APIENTRY null_glDrawElements(GLenum a, GLsizei b, GLenum c, const GLvoid *d) { }
+static void APIENTRY null_glDrawElementsInstancedARB(GLenum a, GLsizei b, GLenum c, const void *d, GLsizei e) { }
+static void APIENTRY null_glMultiDrawArrays(GLenum a, const GLint *b, const GLsizei *c, GLsizei d) { }
+static void APIENTRY null_glMultiDrawElements(GLenum a, const GLsizei *b, GLenum c, const void *const *d, GLsizei e) { }
+static void APIENTRY null_glPixelStorei(GLenum a, GLint b) { }
+static void APIENTRY null_glPixelZoom(GLfloat a, GLfloat b) { }
+static void APIENTRY null_glPolygonMode(GLenum a, GLenum b) { }
+static void APIENTRY null_glStencilFunc(GLenum a, GLint b, GLuint c) { }
+static void APIENTRY null_glStencilOp(GLenum a, GLenum b, GLenum c) { }
+static void APIENTRY null_glTexParameterf(GLenum a, GLenum b, GLfloat c) { }
+static void APIENTRY null_glTexParameteri(GLenum a, GLenum b, GLint c) { }
+static void APIENTRY null_glUniform1fARB(GLint a, GLfloat b) { }
+static void APIENTRY null_glUniform1iARB(GLint a, GLint b) { }
+static void APIENTRY null_glUniform4fARB(GLint a, GLfloat b, GLfloat c, GLfloat d, GLfloat e) { }
+static void APIENTRY null_glUniformfvARB(GLint a, GLsizei b, const GLfloat *c) { }
+static void APIENTRY null_glUniformMatrix4fvARB(GLint a, GLsizei b, GLboolean c, const GLfloat *d) { }
+static void APIENTRY null_glVertexAttribDivisorARB(GLuint a, GLuint b) { }
+static void APIENTRY null_glVertexAttribPointerARB(GLuint a, GLint b, GLenum c, GLboolean d, GLsizei e, const void *f) { }
+static void APIENTRY null_glViewport(GLint a, GLint b, GLsizei c, GLsizei d) { }
+static void APIENTRY null_glReadPixels(GLint a, GLint b, GLsizei c, GLsizei d, GLenum e, GLenum f, GLvoid *g) { }
+static void APIENTRY null_glTexImage2D(GLenum a, GLint b, GLint c, GLsizei d, GLsizei e, GLint f, GLenum g, GLenum h, const GLvoid *i) { }
+static void APIENTRY null_glHandle(GLhandleARB a) { }
+static void APIENTRY null_glAttachObjectARB(GLhandleARB a, GLhandleARB b) { }
+static void APIENTRY null_glShaderSourceARB(GLhandleARB a, GLsizei b, const GLcharARB **c, const GLint *d) { }
+static GLboolean APIENTRY null_glIsName(GLuint a) { return (a != 0) ? (GL_TRUE) : (GL_FALSE); }
+static GLboolean APIENTRY null_glUnmapBufferARB(GLenum a) { return GL_TRUE; }
+static GLenum APIENTRY null_glGetError(void) { return GL_NO_ERROR; }
+static void * APIENTRY null_glMapBufferARB(GLenum a, GLenum b) { return NULL; }
+static GLint APIENTRY null_glGetLocationARB(GLhandleARB a, const GLcharARB *b) { return -1; }
+static const GLubyte * APIENTRY null_glGetString(GLenum a) { return (const GLubyte*)""; }
+
+static void APIENTRY null_glGenNames(GLsizei n, GLuint *names)
+{
+    for(GLsizei i = 0; i < n; i++)
+    {
+        names[i] = ++null_gl_names;
+    }
+}
+
+static GLhandleARB APIENTRY null_glCreateProgramObjectARB(void)
+{
+    return (GLhandleARB)(++null_gl_names);
+}
+
+static GLhandleARB APIENTRY null_glCreateShaderObjectARB(GLenum a)
+{
+    return (GLhandleARB)(++null_gl_names);
+}
+
+static void APIENTRY null_glGetFloatv(GLenum pname, GLfloat *params)
+{
+    params[0] = (pname == GL_LINE_WIDTH) ? (1.0f) : (0.0f);
+}
+
+static void APIENTRY null_glGetIntegerv(GLenum pname, GLint *params)
+{
+    switch(pname)
+    {
+        case GL_MAX_TEXTURE_SIZE:
+            params[0] = 4096;
+            break;
+
+        case GL_VIEWPORT:
+            params[0] = params[1] = 0;
+            params[2] = 1024;
+            params[3] = 768;
+            break;
+
+        default:
+            params[0] = 0;
+            break;
+    }
+}
+
+static void APIENTRY null_glGetObjectParameterivARB(GLhandleARB a, GLenum b, GLint *params)
+{
+    params[0] = 1;                                                              // compile / link status OK
+}
+
+static void APIENTRY null_glGetInfoLogARB(GLhandleARB a, GLsizei max_length, GLsizei *length, GLcharARB *info_log)
+{
+    if(length)
+    {
+        *length = 0;
+    }
+    if(info_log && (max_length > 0))
+    {
+        info_log[0] = 0;
+    }
+}
+
+void InitGLNullFuncs()
+{
+    engine_gl_ext_str = NULL;
+    null_gl_names = 0;
+
+    qglAlphaFunc = (PFNGLALPHAFUNCPROC)null_glAlphaFunc;
+    qglBindTexture = (PFNGLBINDTEXTUREPROC)null_glBindTexture;
+    qglBlendFunc = (PFNGLBLENDFUNCPROC)null_glBlendFunc;
+    qglClear = (PFNGLCLEARPROC)null_glVoidBitfield;
+    qglClearColor = (PFNGLCLEARCOLORPROC)null_glClearColor;
+    qglColorPointer = (PFNGLCOLORPOINTERPROC)null_glPointer;
+    qglDeleteTextures = (PFNGLDELETETEXTURESPROC)null_glDeleteNames;
+    qglDepthFunc = (PFNGLDEPTHFUNCPROC)null_glVoidEnum;
+    qglDepthMask = (PFNGLDEPTHMASKPROC)null_glDepthMask;
+    qglDisable = (PFNGLDISABLEPROC)null_glVoidEnum;
+    qglDisableClientState = (PFNGLDISABLECLIENTSTATEPROC)null_glVoidEnum;
+    qglDrawArrays = (PFNGLDRAWARRAYSPROC)null_glDrawArrays;
+    qglDrawElements = (PFNGLDRAWELEMENTSPROC)null_glDrawElements;
+    qglEnable = (PFNGLENABLEPROC)null_glVoidEnum;
+    qglEnableClientState = (PFNGLENABLECLIENTSTATEPROC)null_glVoidEnum;
+    qglFrontFace = (PFNGLFRONTFACEPROC)null_glVoidEnum;
+    qglGenTextures = (PFNGLGENTEXTURESPROC)null_glGenNames;
+    qglGetError = (PFNGLGETERRORPROC)null_glGetError;
+    qglGetFloatv = (PFNGLGETFLOATVPROC)null_glGetFloatv;
+    qglGetIntegerv = (PFNGLGETIINTEGERVPROC)null_glGetIntegerv;
+    qglGetString = (PFNGLGETSTRINGPROC)null_glGetString;
+    qglIsTexture = (PFNGLISTEXTUREPROC)null_glIsName;
+    qglLineWidth = (PFNGLLINEWIDTHPROC)null_glVoidFloat;
+    qglNormalPointer = (PFNGLNORMALPOINTERPROC)null_glNormalPointer;
+    qglPixelStorei = (PFNGLPIXELSTOREIPROC)null_glPixelStorei;
+    qglPixelZoom = (PFNGLPIXELZOOMPROC)null_glPixelZoom;
+    qglPointSize = (PFNGLPOINTSIZEPROC)null_glVoidFloat;
+    qglPolygonMode = (PFNGLPOLYGONMODEPROC)null_glPolygonMode;
+    qglPopAttrib = (PFNGLPOPATTRIBPROC)null_glVoid;
+    qglPopClientAttrib = (PFNGLPOPCLIENTATTRIBPROC)null_glVoid;
+    qglPushAttrib = (PFNGLPUSHATTRIBPROC)null_glVoidBitfield;
+    qglPushClientAttrib = (PFNGLPUSHCLIENTATTRIBPROC)null_glVoidBitfield;
+    qglReadPixels = (PFNGLREADPIXELSPROC)null_glReadPixels;
+    qglStencilFunc = (PFNGLSTENCILFUNCPROC)null_glStencilFunc;
+    qglStencilOp = (PFNGLSTENCILOPPROC)null_glStencilOp;
+    qglTexCoordPointer = (PFNGLTEXCOORDPOINTERPROC)null_glPointer;
+    qglTexImage2D = (PFNGLTEXIMAGE2DPROC)null_glTexImage2D;
+    qglTexParameterf = (PFNGLTEXPARAMETERFPROC)null_glTexParameterf;
+    qglTexParameteri = (PFNGLTEXPARAMETERIPROC)null_glTexParameteri;
+    qglVertexPointer = (PFNGLVERTEXPOINTERPROC)null_glPointer;
+    qglViewport = (PFNGLVIEWPORTPROC)null_glViewport;
+
+    qglBindBufferARB = (PFNGLBINDBUFFERARBPROC)null_glBindBufferARB;
+    qglBufferDataARB = (PFNGLBUFFERDATAARBPROC)null_glBufferDataARB;
+    qglBufferSubDataARB = (PFNGLBUFFERSUBDATAARBPROC)null_glBufferSubDataARB;
+    qglDeleteBuffersARB = (PFNGLDELETEBUFFERSARBPROC)null_glDeleteNames;
+    qglGenBuffersARB = (PFNGLGENBUFFERSARBPROC)null_glGenNames;
+    qglIsBufferARB = (PFNGLISBUFFERARBPROC)null_glIsName;
+    qglMapBufferARB = (PFNGLMAPBUFFERARBPROC)null_glMapBufferARB;
+    qglUnmapBufferARB = (PFNGLUNMAPBUFFERARBPROC)null_glUnmapBufferARB;
+    qglGenerateMipmap = (PFNGLGENERATEMIPMAPPROC)null_glVoidEnum;
+
+    qglAttachObjectARB = (PFNGLATTACHOBJECTARBPROC)null_glAttachObjectARB;
+    qglCompileShaderARB = (PFNGLCOMPILESHADERARBPROC)null_glHandle;
+    qglCreateProgramObjectARB = (PFNGLCREATEPROGRAMOBJECTARBPROC)null_glCreateProgramObjectARB;
+    qglCreateShaderObjectARB = (PFNGLCREATESHADEROBJECTARBPROC)null_glCreateShaderObjectARB;
+    qglDeleteObjectARB = (PFNGLDELETEOBJECTARBPROC)null_glHandle;
+    qglGetAttribLocationARB = (PFNGLGETATTRIBLOCATIONARBPROC)null_glGetLocationARB;
+    qglGetInfoLogARB = (PFNGLGETINFOLOGARBPROC)null_glGetInfoLogARB;
+    qglGetObjectParameterivARB = (PFNGLGETOBJECTPARAMETERIVARBPROC)null_glGetObjectParameterivARB;
+    qglGetUniformLocationARB = (PFNGLGETUNIFORMLOCATIONARBPROC)null_glGetLocationARB;
+    qglLinkProgramARB = (PFNGLLINKPROGRAMARBPROC)null_glHandle;
+    qglShaderSourceARB = (PFNGLSHADERSOURCEARBPROC)null_glShaderSourceARB;
+    qglUseProgramObjectARB = (PFNGLUSEPROGRAMOBJECTARBPROC)null_glHandle;
+    qglUniform1fARB = (PFNGLUNIFORM1FARBPROC)null_glUniform1fARB;
+    qglUniform1iARB = (PFNGLUNIFORM1IARBPROC)null_glUniform1iARB;
+    qglUniform4fARB = (PFNGLUNIFORM4FARBPROC)null_glUniform4fARB;
+    qglUniform1fvARB = (PFNGLUNIFORM1FVARBPROC)null_glUniformfvARB;
+    qglUniform2fvARB = (PFNGLUNIFORM2FVARBPROC)null_glUniformfvARB;
+    qglUniform3fvARB = (PFNGLUNIFORM3FVARBPROC)null_glUniformfvARB;
+    qglUniform4fvARB = (PFNGLUNIFORM4FVARBPROC)null_glUniformfvARB;
+    qglUniformMatrix4fvARB = (PFNGLUNIFORMMATRIX4FVARBPROC)null_glUniformMatrix4fvARB;
+    qglEnableVertexAttribArrayARB = (PFNGLENABLEVERTEXATTRIBARRAYARBPROC)null_glVoidUint;
+    qglDisableVertexAttribArrayARB = (PFNGLDISABLEVERTEXATTRIBARRAYARBPROC)null_glVoidUint;
+    qglVertexAttribPointerARB = (PFNGLVERTEXATTRIBPOINTERARBPROC)null_glVertexAttribPointerARB;
+
+    qglVertexAttribDivisorARB = (PFNGLVERTEXATTRIBDIVISORARBPROC)null_glVertexAttribDivisorARB;
+    qglDrawElementsInstancedARB = (PFNGLDRAWELEMENTSINSTANCEDARBPROC)null_glDrawElementsInstancedARB;
+    qglMultiDrawArrays = (PFNGLMULTIDRAWARRAYSPROC)null_glMultiDrawArrays;
+    qglMultiDrawElements = (PFNGLMULTIDRAWELEMENTSPROC)null_glMultiDrawElements;
+
+    // no GPU to measure: timer queries stay unavailable
+    qglGenQueriesARB = NULL;
+    qglDeleteQueriesARB = NULL;
+    qglBeginQueryARB = NULL;
+    qglEndQueryARB = NULL;
+    qglGetQueryObjectivARB = NULL;
+    qglGetQueryObjectui64v = NULL;
+}
+
+
 /**
  * Use this function after InitGLExtFuncs()!!!
  * @param ext - extension name
@@ -620,27 +875,27 @@ int checkOpenGLError()
         switch(glErr)
         {
             case GL_INVALID_VALUE:
-                Sys_DebugLog(GL_LOG_FILENAME, "glError: GL_INVALID_VALUE");
+                Log_Printf(GL_LOG_FILENAME, LOG_LEVEL_ERROR, LOG_CAT_GL, "glError: GL_INVALID_VALUE");
                 break;
 
             case GL_INVALID_ENUM:
-                Sys_DebugLog(GL_LOG_FILENAME, "glError: GL_INVALID_ENUM");
+                Log_Printf(GL_LOG_FILENAME, LOG_LEVEL_ERROR, LOG_CAT_GL, "glError: GL_INVALID_ENUM");
                 break;
 
             case GL_INVALID_OPERATION:
-                Sys_DebugLog(GL_LOG_FILENAME, "glError: GL_INVALID_OPERATION");
+                Log_Printf(GL_LOG_FILENAME, LOG_LEVEL_ERROR, LOG_CAT_GL, "glError: GL_INVALID_OPERATION");
                 break;
 
             case GL_STACK_OVERFLOW:
-                Sys_DebugLog(GL_LOG_FILENAME, "glError: GL_STACK_OVERFLOW");
+                Log_Printf(GL_LOG_FILENAME, LOG_LEVEL_ERROR, LOG_CAT_GL, "glError: GL_STACK_OVERFLOW");
                 break;
 
             case GL_STACK_UNDERFLOW:
-                Sys_DebugLog(GL_LOG_FILENAME, "glError: GL_STACK_UNDERFLOW");
+                Log_Printf(GL_LOG_FILENAME, LOG_LEVEL_ERROR, LOG_CAT_GL, "glError: GL_STACK_UNDERFLOW");
                 break;
 
             case GL_OUT_OF_MEMORY:
-                Sys_DebugLog(GL_LOG_FILENAME, "glError: GL_OUT_OF_MEMORY");
+                Log_Printf(GL_LOG_FILENAME, LOG_LEVEL_ERROR, LOG_CAT_GL, "glError: GL_OUT_OF_MEMORY");
                 break;
 
                /* GL_CONTEXT_FLAG_ROBUST_ACCESS_BIT_ARB
@@ -652,7 +907,7 @@ int checkOpenGLError()
                   GL_NO_RESET_NOTIFICATION_ARB*/
 
             default:
-                Sys_DebugLog(GL_LOG_FILENAME, "glError: uncnown error = 0x%X", glErr);
+                Log_Printf(GL_LOG_FILENAME, LOG_LEVEL_ERROR, LOG_CAT_GL, "glError: uncnown error = 0x%X", glErr);
                 break;
         };
     }
@@ -674,8 +929,8 @@ void printInfoLog (GLhandleARB object)
     {
         infoLog = (GLcharARB*)malloc(logLength);
         qglGetInfoLogARB(object, logLength, &charsWritten, infoLog);
-        Sys_DebugLog(GL_LOG_FILENAME, "GL_InfoLog[%d]:", charsWritten);
-        Sys_DebugLog(GL_LOG_FILENAME, "%s", (const char*)infoLog);
+        Log_Printf(GL_LOG_FILENAME, LOG_LEVEL_INFO, LOG_CAT_GL, "GL_InfoLog[%d]:", charsWritten);
+        Log_Printf(GL_LOG_FILENAME, LOG_LEVEL_INFO, LOG_CAT_GL, "%s", (const char*)infoLog);
         free(infoLog);
     }
 }
@@ -697,9 +952,9 @@ int loadShaderFromBuff(GLhandleARB ShaderObj, const char *source, const char *ad
         {
             qglShaderSourceARB(ShaderObj, 1, (const char **)&source, &source_size);
         }
-        //Sys_DebugLog(GL_LOG_FILENAME, "source loaded");
+        //Log_Printf(GL_LOG_FILENAME, LOG_LEVEL_DEBUG, LOG_CAT_GL, "source loaded");
         qglCompileShaderARB(ShaderObj);
-        //Sys_DebugLog(GL_LOG_FILENAME, "trying to compile");
+        //Log_Printf(GL_LOG_FILENAME, LOG_LEVEL_DEBUG, LOG_CAT_GL, "trying to compile");
         if(checkOpenGLError())
         {
             return 0;
@@ -717,11 +972,11 @@ int loadShaderFromFile(GLhandleARB ShaderObj, const char *fileName, const char *
     GLint size = 0;
     int ret = 0;
 
-    //Sys_DebugLog(GL_LOG_FILENAME, "GL_Loading %s", fileName);
+    //Log_Printf(GL_LOG_FILENAME, LOG_LEVEL_DEBUG, LOG_CAT_GL, "GL_Loading %s", fileName);
     file = fopen (fileName, "rb");
     if (file == NULL)
     {
-        Sys_DebugLog(GL_LOG_FILENAME, "Error opening %s", fileName);
+        Log_Printf(GL_LOG_FILENAME, LOG_LEVEL_ERROR, LOG_CAT_GL, "Error opening %s", fileName);
         return ret;
     }
 
@@ -731,7 +986,7 @@ int loadShaderFromFile(GLhandleARB ShaderObj, const char *fileName, const char *
     if(size < 1)
     {
         fclose(file);
-        Sys_DebugLog(GL_LOG_FILENAME, "Error loading file %s: size < 1", fileName);
+        Log_Printf(GL_LOG_FILENAME, LOG_LEVEL_ERROR, LOG_CAT_GL, "Error loading file %s: size < 1", fileName);
         return ret;
     }
 
@@ -739,7 +994,7 @@ int loadShaderFromFile(GLhandleARB ShaderObj, const char *fileName, const char *
     fseek(file, 0, SEEK_SET);
     if(size != fread(buf, 1, size, file))
     {
-        Sys_DebugLog(GL_LOG_FILENAME, "Error loading file %s", fileName);
+        Log_Printf(GL_LOG_FILENAME, LOG_LEVEL_ERROR, LOG_CAT_GL, "Error loading file %s", fileName);
     }
     buf[size] = 0;
     fclose(file);
@@ -371,6 +371,7 @@ extern PFNGLGETATTRIBLOCATIONARBPROC qglGetAttribLocationARB;
 extern PFNGLENABLEVERTEXATTRIBARRAYARBPROC qglEnableVertexAttribArrayARB;
 extern PFNGLENABLEVERTEXATTRIBARRAYARBPROC qglDisableVertexAttribArrayARB;
 extern PFNGLVERTEXATTRIBPOINTERARBPROC qglVertexAttribPointerARB;
+extern PFNGLVERTEXATTRIB1FARBPROC qglVertexAttrib1fARB;
 
 /*multitexture EXT*/
 extern PFNGLACTIVETEXTUREARBPROC qglActiveTextureARB;
@@ -428,7 +429,24 @@ extern PFNGLISVERTEXARRAYPROC qglIsVertexArray;
 
 extern PFNGLGENERATEMIPMAPPROC qglGenerateMipmap;
 
+/* instancing (optional, may be NULL) */
+extern PFNGLVERTEXATTRIBDIVISORARBPROC qglVertexAttribDivisorARB;
+extern PFNGLDRAWELEMENTSINSTANCEDARBPROC qglDrawElementsInstancedARB;
+
+/* multi draw (optional, may be NULL) */
+extern PFNGLMULTIDRAWARRAYSPROC qglMultiDrawArrays;
+extern PFNGLMULTIDRAWELEMENTSPROC qglMultiDrawElements;
+
+/* timer queries (optional, may be NULL) */
+extern PFNGLGENQUERIESARBPROC qglGenQueriesARB;
+extern PFNGLDELETEQUERIESARBPROC qglDeleteQueriesARB;
+extern PFNGLBEGINQUERYARBPROC qglBeginQueryARB;
+extern PFNGLENDQUERYARBPROC qglEndQueryARB;
+extern PFNGLGETQUERYOBJECTIVARBPROC qglGetQueryObjectivARB;
+extern PFNGLGETQUERYOBJECTUI64VPROC qglGetQueryObjectui64v;
+
 void InitGLExtFuncs();
+void InitGLNullFuncs();
 int IsGLExtensionSupported(const char *ext);
 
 int checkOpenGLError();
@@ -0,0 +1,572 @@
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_atomic.h>
+#include <SDL2/SDL_thread.h>
+#include <SDL2/SDL_rwops.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "log.h"
+
+
+#define LOG_BUFFER_FREE             (0)
+#define LOG_BUFFER_USED             (1)
+#define LOG_BUFFER_ORPHAN           (2)                                         // owner thread is finished, drain and free
+
+#define LOG_BUFFER_MASK             (LOG_THREAD_BUFFER_SIZE - 1)
+#define LOG_MAX_FILE_NAME           (256)
+
+typedef struct log_record_header_s
+{
+    uint16_t            size;                                                   // text size, without header
+    uint8_t             level;
+    uint8_t             category;
+    uint8_t             file;
+    uint8_t             reserved[3];
+}log_record_header_t, *log_record_header_p;
+
+/*
+ * Single producer (owner thread) / single consumer (flusher thread) ring:
+ * only owner moves head, only flusher moves tail, so no locks are needed.
+ */
+typedef struct log_buffer_s
+{
+    SDL_atomic_t        state;
+    SDL_atomic_t        head;
+    SDL_atomic_t        tail;
+    SDL_atomic_t        dropped;
+
+    uint32_t            rate_hash[LOG_RATE_LIMIT_SLOTS];
+    uint32_t            rate_time[LOG_RATE_LIMIT_SLOTS];
+    uint8_t             rate_file[LOG_RATE_LIMIT_SLOTS];
+    SDL_atomic_t        rate_count[LOG_RATE_LIMIT_SLOTS];                       // owner adds, flusher takes repeats of ended window
+
+    uint8_t             data[LOG_THREAD_BUFFER_SIZE];
+}log_buffer_t, *log_buffer_p;
+
+
+static log_buffer_t     log_buffers[LOG_MAX_THREAD_BUFFERS];
+static SDL_TLSID        log_tls = 0;
+static SDL_Thread      *log_thread = NULL;
+static SDL_sem         *log_sem = NULL;
+static SDL_atomic_t     log_running = {0};
+static SDL_atomic_t     log_writers = {0};                                      // threads between log_running check and push
+static SDL_atomic_t     log_flush_requested = {0};
+static SDL_SpinLock     log_sync_lock = 0;
+
+static SDL_atomic_t     log_level = {LOG_LEVEL_DEBUG};
+static SDL_atomic_t     log_categories = {(int)(LOG_CAT_ALL & ~(1 << LOG_CAT_CONSOLE))};
+
+static SDL_SpinLock     log_files_lock = 0;
+static SDL_atomic_t     log_files_count = {0};
+static char             log_file_names[LOG_MAX_FILES][LOG_MAX_FILE_NAME];
+static FILE            *log_files[LOG_MAX_FILES];                               // owned by flusher thread
+
+
+static int  Log_FlusherThread(void *data);
+static void Log_DrainAll(int final);
+
+
+void Log_Init()
+{
+    if(SDL_AtomicGet(&log_running))
+    {
+        return;
+    }
+
+    for(int i = 0; i < LOG_MAX_THREAD_BUFFERS; ++i)
+    {
+        SDL_AtomicSet(&log_buffers[i].state, LOG_BUFFER_FREE);
+        SDL_AtomicSet(&log_buffers[i].head, 0);
+        SDL_AtomicSet(&log_buffers[i].tail, 0);
+        SDL_AtomicSet(&log_buffers[i].dropped, 0);
+    }
+
+    // new TLS id invalidates buffers cached by threads on previous init
+    log_tls = SDL_TLSCreate();
+    log_sem = SDL_CreateSemaphore(0);
+    if(!log_tls || !log_sem)
+    {
+        if(log_sem)
+        {
+            SDL_DestroySemaphore(log_sem);
+            log_sem = NULL;
+        }
+        return;
+    }
+
+    SDL_AtomicSet(&log_running, 1);
+    log_thread = SDL_CreateThread(Log_FlusherThread, "log_flusher", NULL);
+    if(!log_thread)
+    {
+        SDL_AtomicSet(&log_running, 0);
+        SDL_DestroySemaphore(log_sem);
+        log_sem = NULL;
+    }
+}
+
+
+void Log_Destroy()
+{
+    if(!SDL_AtomicGet(&log_running))
+    {
+        return;
+    }
+
+    // new messages go synchronous path from now, flusher drains the rest and exits
+    SDL_AtomicSet(&log_running, 0);
+    SDL_SemPost(log_sem);
+    SDL_WaitThread(log_thread, NULL);
+    log_thread = NULL;
+    SDL_DestroySemaphore(log_sem);
+    log_sem = NULL;
+
+    // writers, which passed log_running check before, may push after flusher exit;
+    // synchronous writers wait, so their lines do not split drained ones
+    while(SDL_AtomicGet(&log_writers) > 0)
+    {
+        SDL_Delay(0);
+    }
+    SDL_AtomicLock(&log_sync_lock);
+    Log_DrainAll(1);
+
+    for(int i = 0; i < LOG_MAX_FILES; ++i)
+    {
+        if(log_files[i])
+        {
+            fclose(log_files[i]);
+            log_files[i] = NULL;
+        }
+    }
+    SDL_AtomicUnlock(&log_sync_lock);
+}
+
+
+static void Log_RequestFlush()
+{
+    if(SDL_AtomicCAS(&log_flush_requested, 0, 1))
+    {
+        SDL_SemPost(log_sem);
+    }
+}
+
+
+void Log_Flush()
+{
+    if(SDL_AtomicGet(&log_running))
+    {
+        for(int wait = 0; wait < 2 * LOG_FLUSH_INTERVAL_MS; ++wait)
+        {
+            int empty = 1;
+            for(int i = 0; i < LOG_MAX_THREAD_BUFFERS; ++i)
+            {
+                if(SDL_AtomicGet(&log_buffers[i].head) != SDL_AtomicGet(&log_buffers[i].tail))
+                {
+                    empty = 0;
+                    break;
+                }
+            }
+            if(empty)
+            {
+                break;
+            }
+            Log_RequestFlush();
+            SDL_Delay(1);
+        }
+    }
+}
+
+
+void Log_SetLevel(int level)
+{
+    SDL_AtomicSet(&log_level, level);
+}
+
+
+void Log_SetCategories(uint32_t mask)
+{
+    SDL_AtomicSet(&log_categories, (int)mask);
+}
+
+
+int Log_IsEnabled(int level, int category)
+{
+    return (level >= SDL_AtomicGet(&log_level)) &&
+           ((uint32_t)SDL_AtomicGet(&log_categories) & (1u << category));
+}
+
+
+static int Log_GetFileIndex(const char *file)
+{
+    int count = SDL_AtomicGet(&log_files_count);
+    int ret = 0;
+
+    SDL_MemoryBarrierAcquire();
+    for(int i = 0; i < count; ++i)
+    {
+        if(0 == strncmp(log_file_names[i], file, LOG_MAX_FILE_NAME))
+        {
+            return i;
+        }
+    }
+
+    SDL_AtomicLock(&log_files_lock);
+    count = SDL_AtomicGet(&log_files_count);
+    for(; ret < count; ++ret)
+    {
+        if(0 == strncmp(log_file_names[ret], file, LOG_MAX_FILE_NAME))
+        {
+            break;
+        }
+    }
+    if((ret == count) && (count < LOG_MAX_FILES))
+    {
+        strncpy(log_file_names[count], file, LOG_MAX_FILE_NAME - 1);
+        log_file_names[count][LOG_MAX_FILE_NAME - 1] = 0;
+        SDL_MemoryBarrierRelease();
+        SDL_AtomicSet(&log_files_count, count + 1);                             // publish name after it is written
+    }
+    else if(ret == count)
+    {
+        ret = 0;                                                                // table is full, fall to the first log
+    }
+    SDL_AtomicUnlock(&log_files_lock);
+
+    return ret;
+}
+
+
+static void Log_ThreadBufferRelease(void *data)
+{
+    log_buffer_p buf = (log_buffer_p)data;
+    SDL_AtomicSet(&buf->state, LOG_BUFFER_ORPHAN);
+}
+
+
+static log_buffer_p Log_GetThreadBuffer()
+{
+    log_buffer_p buf = (log_buffer_p)SDL_TLSGet(log_tls);
+
+    if(!buf)
+    {
+        for(int i = 0; i < LOG_MAX_THREAD_BUFFERS; ++i)
+        {
+            if(SDL_AtomicCAS(&log_buffers[i].state, LOG_BUFFER_FREE, LOG_BUFFER_USED))
+            {
+                buf = log_buffers + i;
+                memset(buf->rate_hash, 0x00, sizeof(buf->rate_hash));
+                for(int j = 0; j < LOG_RATE_LIMIT_SLOTS; ++j)
+                {
+                    SDL_AtomicSet(buf->rate_count + j, 0);
+                }
+                SDL_TLSSet(log_tls, buf, Log_ThreadBufferRelease);
+                break;
+            }
+        }
+    }
+
+    return buf;
+}
+
+
+static void Log_RingWrite(log_buffer_p buf, uint32_t pos, const void *src, uint32_t size)
+{
+    uint32_t offset = pos & LOG_BUFFER_MASK;
+    uint32_t part = LOG_THREAD_BUFFER_SIZE - offset;
+
+    if(part >= size)
+    {
+        memcpy(buf->data + offset, src, size);
+    }
+    else
+    {
+        memcpy(buf->data + offset, src, part);
+        memcpy(buf->data, (const uint8_t*)src + part, size - part);
+    }
+}
+
+
+static void Log_RingRead(log_buffer_p buf, uint32_t pos, void *dst, uint32_t size)
+{
+    uint32_t offset = pos & LOG_BUFFER_MASK;
+    uint32_t part = LOG_THREAD_BUFFER_SIZE - offset;
+
+    if(part >= size)
+    {
+        memcpy(dst, buf->data + offset, size);
+    }
+    else
+    {
+        memcpy(dst, buf->data + offset, part);
+        memcpy((uint8_t*)dst + part, buf->data, size - part);
+    }
+}
+
+
+static void Log_Push(log_buffer_p buf, int file, int level, int category, const char *text, uint32_t size)
+{
+    log_record_header_t header;
+    uint32_t head = (uint32_t)SDL_AtomicGet(&buf->head);
+    uint32_t used = head - (uint32_t)SDL_AtomicGet(&buf->tail);
+
+    if(used + sizeof(header) + size > LOG_THREAD_BUFFER_SIZE)
+    {
+        SDL_AtomicIncRef(&buf->dropped);
+        Log_RequestFlush();
+        return;
+    }
+
+    header.size = size;
+    header.level = level;
+    header.category = category;
+    header.file = file;
+    header.reserved[0] = header.reserved[1] = header.reserved[2] = 0;
+    Log_RingWrite(buf, head, &header, sizeof(header));
+    Log_RingWrite(buf, head + sizeof(header), text, size);
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&buf->head, (int)(head + sizeof(header) + size));
+
+    if((level >= LOG_LEVEL_ERROR) || (2 * (used + sizeof(header) + size) > LOG_THREAD_BUFFER_SIZE))
+    {
+        Log_RequestFlush();
+    }
+}
+
+/**
+ * Returns 1 if message must be skipped: the same text was already written
+ * LOG_RATE_LIMIT_COUNT times in current window. On window change writes
+ * the count of skipped repeats; if the window just ends, flusher writes it.
+ */
+static int Log_RateLimit(log_buffer_p buf, int file, const char *text, uint32_t size)
+{
+    uint32_t hash = 2166136261u;                                                // FNV-1a
+    uint32_t now = SDL_GetTicks();
+    int slot;
+    int count;
+
+    for(uint32_t i = 0; i < size; ++i)
+    {
+        hash = (hash ^ (uint8_t)text[i]) * 16777619u;
+    }
+    hash |= 1;                                                                  // 0 - empty slot
+    slot = hash & (LOG_RATE_LIMIT_SLOTS - 1);
+
+    if((buf->rate_hash[slot] == hash) && (now - buf->rate_time[slot] < LOG_RATE_LIMIT_WINDOW_MS))
+    {
+        return (SDL_AtomicAdd(buf->rate_count + slot, 1) + 1 > LOG_RATE_LIMIT_COUNT);
+    }
+
+    // count is set first: flusher must not take the old repeats once more
+    count = SDL_AtomicSet(buf->rate_count + slot, 1);
+    if((buf->rate_hash[slot] != 0) && (count > LOG_RATE_LIMIT_COUNT))
+    {
+        char repeats[64];
+        int len = snprintf(repeats, sizeof(repeats), "(previous message repeated %d more times)\n",
+                           count - LOG_RATE_LIMIT_COUNT);
+        Log_Push(buf, buf->rate_file[slot], LOG_LEVEL_INFO, LOG_CAT_SYSTEM, repeats, len);
+    }
+    buf->rate_hash[slot] = hash;
+    buf->rate_time[slot] = now;
+    buf->rate_file[slot] = file;
+
+    return 0;
+}
+
+
+static void Log_WriteSync(const char *file, const char *text, uint32_t size)
+{
+    SDL_RWops *fp;
+
+    SDL_AtomicLock(&log_sync_lock);
+    fp = SDL_RWFromFile(file, "a");
+    if(fp == NULL)
+    {
+        fp = SDL_RWFromFile(file, "w");
+    }
+    if(fp != NULL)
+    {
+        SDL_RWwrite(fp, text, size, 1);
+        SDL_RWclose(fp);
+    }
+    fwrite(text, size, 1, stderr);
+    SDL_AtomicUnlock(&log_sync_lock);
+}
+
+
+void Log_Printf(const char *file, int level, int category, const char *fmt, ...)
+{
+    va_list argptr;
+
+    va_start(argptr, fmt);
+    Log_VPrintf(file, level, category, fmt, argptr);
+    va_end(argptr);
+}
+
+
+void Log_VPrintf(const char *file, int level, int category, const char *fmt, va_list argptr)
+{
+    char text[LOG_MAX_MESSAGE_SIZE];
+    int32_t written;
+
+    if(!Log_IsEnabled(level, category))
+    {
+        return;
+    }
+
+    written = vsnprintf(text, sizeof(text), fmt, argptr);
+    if(written <= 0)
+    {
+        return;
+    }
+    if(written >= (int32_t)sizeof(text))
+    {
+        written = sizeof(text) - 1;
+    }
+
+    // Add newline at end (if possible)
+    if((written + 1) < (int32_t)sizeof(text))
+    {
+        text[written + 0] = '\n';
+        text[written + 1] = 0;
+        written += 1;
+    }
+
+    SDL_AtomicIncRef(&log_writers);
+    if(SDL_AtomicGet(&log_running))
+    {
+        log_buffer_p buf = Log_GetThreadBuffer();
+        if(buf)
+        {
+            int file_index = Log_GetFileIndex(file);
+            if(!Log_RateLimit(buf, file_index, text, written))
+            {
+                Log_Push(buf, file_index, level, category, text, written);
+            }
+            SDL_AtomicAdd(&log_writers, -1);
+            return;
+        }
+    }
+    SDL_AtomicAdd(&log_writers, -1);
+
+    Log_WriteSync(file, text, written);
+}
+
+
+static FILE *Log_GetFile(int index)
+{
+    if(!log_files[index])
+    {
+        log_files[index] = fopen(log_file_names[index], "a");
+    }
+    return log_files[index];
+}
+
+
+static void Log_DrainBuffer(log_buffer_p buf)
+{
+    char text[LOG_MAX_MESSAGE_SIZE];
+    log_record_header_t header;
+    uint32_t head = (uint32_t)SDL_AtomicGet(&buf->head);
+    uint32_t tail = (uint32_t)SDL_AtomicGet(&buf->tail);
+    int dropped;
+
+    SDL_MemoryBarrierAcquire();
+    while(tail != head)
+    {
+        FILE *fp;
+        Log_RingRead(buf, tail, &header, sizeof(header));
+        Log_RingRead(buf, tail + sizeof(header), text, header.size);
+        tail += sizeof(header) + header.size;
+
+        fp = Log_GetFile(header.file);
+        if(fp)
+        {
+            fwrite(text, header.size, 1, fp);
+        }
+        fwrite(text, header.size, 1, stderr);
+    }
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&buf->tail, (int)tail);
+
+    dropped = SDL_AtomicSet(&buf->dropped, 0);
+    if(dropped > 0)
+    {
+        FILE *fp = Log_GetFile(0);
+        if(fp)
+        {
+            fprintf(fp, "log: %d messages dropped, buffer overflow\n", dropped);
+        }
+    }
+}
+
+
+/**
+ * Writes skipped repeats of rate limit windows, which ended without the next
+ * message in slot (all on final drain, when no thread writes).
+ */
+static void Log_DrainRepeats(log_buffer_p buf, int final)
+{
+    uint32_t now = SDL_GetTicks();
+
+    for(int i = 0; i < LOG_RATE_LIMIT_SLOTS; ++i)
+    {
+        int count = SDL_AtomicGet(buf->rate_count + i);
+        if((count > LOG_RATE_LIMIT_COUNT) && (final || (now - buf->rate_time[i] >= LOG_RATE_LIMIT_WINDOW_MS)) &&
+           SDL_AtomicCAS(buf->rate_count + i, count, LOG_RATE_LIMIT_COUNT))
+        {
+            FILE *fp = Log_GetFile(buf->rate_file[i]);
+            if(fp)
+            {
+                fprintf(fp, "(previous message repeated %d more times)\n", count - LOG_RATE_LIMIT_COUNT);
+            }
+            fprintf(stderr, "(previous message repeated %d more times)\n", count - LOG_RATE_LIMIT_COUNT);
+        }
+    }
+}
+
+
+static void Log_DrainAll(int final)
+{
+    for(int i = 0; i < LOG_MAX_THREAD_BUFFERS; ++i)
+    {
+        log_buffer_p buf = log_buffers + i;
+        int state = SDL_AtomicGet(&buf->state);
+        if(state != LOG_BUFFER_FREE)
+        {
+            Log_DrainBuffer(buf);
+            Log_DrainRepeats(buf, final || (state == LOG_BUFFER_ORPHAN));      // orphan slots are not written any more
+            if(state == LOG_BUFFER_ORPHAN)
+            {
+                SDL_AtomicCAS(&buf->state, LOG_BUFFER_ORPHAN, LOG_BUFFER_FREE);
+            }
+        }
+    }
+
+    for(int i = 0; i < LOG_MAX_FILES; ++i)
+    {
+        if(log_files[i])
+        {
+            fflush(log_files[i]);
+        }
+    }
+}
+
+
+static int Log_FlusherThread(void *data)
+{
+    while(SDL_AtomicGet(&log_running))
+    {
+        SDL_SemWaitTimeout(log_sem, LOG_FLUSH_INTERVAL_MS);
+        SDL_AtomicSet(&log_flush_requested, 0);
+        // synchronous writes (no free buffer or log is stopping) must not split drained lines
+        SDL_AtomicLock(&log_sync_lock);
+        Log_DrainAll(0);
+        SDL_AtomicUnlock(&log_sync_lock);
+    }
+    SDL_AtomicLock(&log_sync_lock);
+    Log_DrainAll(0);
+    SDL_AtomicUnlock(&log_sync_lock);
+
+    return 0;
+}
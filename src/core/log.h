@@ -0,0 +1,59 @@
+
+#ifndef LOG_H
+#define LOG_H
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdarg.h>
+
+/*
+ * Buffered logger: every thread formats messages into its own lock-free
+ * ring buffer, background thread drains all buffers into the log files
+ * (and stderr). Until Log_Init() and after Log_Destroy() messages are
+ * written synchronously.
+ */
+#define LOG_LEVEL_DEBUG             (0)
+#define LOG_LEVEL_INFO              (1)
+#define LOG_LEVEL_WARNING           (2)
+#define LOG_LEVEL_ERROR             (3)
+
+#define LOG_CAT_SYSTEM              (0)
+#define LOG_CAT_CONSOLE             (1)
+#define LOG_CAT_GL                  (2)
+#define LOG_CAT_RENDER              (3)
+#define LOG_CAT_AUDIO               (4)
+#define LOG_CAT_WORLD               (5)
+#define LOG_CAT_SCRIPT              (6)
+#define LOG_CAT_AI                  (7)
+#define LOG_CAT_ALL                 (0xFFFFFFFF)
+
+#define LOG_MAX_FILES               (8)
+#define LOG_MAX_THREAD_BUFFERS      (16)
+#define LOG_THREAD_BUFFER_SIZE      (64 * 1024)                                 // must be power of 2
+#define LOG_MAX_MESSAGE_SIZE        (4096)
+#define LOG_FLUSH_INTERVAL_MS       (100)
+
+// same message from one thread is written at most LOG_RATE_LIMIT_COUNT times per window
+#define LOG_RATE_LIMIT_SLOTS        (16)                                        // must be power of 2
+#define LOG_RATE_LIMIT_COUNT        (8)
+#define LOG_RATE_LIMIT_WINDOW_MS    (1000)
+
+void Log_Init();
+void Log_Destroy();
+void Log_Flush();
+
+void Log_SetLevel(int level);
+void Log_SetCategories(uint32_t mask);
+int  Log_IsEnabled(int level, int category);
+
+void Log_Printf(const char *file, int level, int category, const char *fmt, ...);
+void Log_VPrintf(const char *file, int level, int category, const char *fmt, va_list argptr);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,70 @@
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_atomic.h>
+#include <SDL2/SDL_thread.h>
+
+#include "parallel.h"
+
+
+typedef struct parallel_job_s
+{
+    SDL_atomic_t        next;
+    uint32_t            count;
+    parallel_func_t     func;
+    void               *data;
+}parallel_job_t, *parallel_job_p;
+
+
+static int Parallel_Worker(void *data)
+{
+    parallel_job_p job = (parallel_job_p)data;
+    for(uint32_t i = SDL_AtomicAdd(&job->next, 1); i < job->count; i = SDL_AtomicAdd(&job->next, 1))
+    {
+        job->func(job->data, i);
+    }
+    return 0;
+}
+
+
+uint32_t Parallel_GetThreadsCount()
+{
+    int cpus = SDL_GetCPUCount();
+    cpus = (cpus > 1) ? (cpus) : (1);
+    return (cpus < PARALLEL_MAX_THREADS) ? (cpus) : (PARALLEL_MAX_THREADS);
+}
+
+/*
+ * If some worker can not be created, its part is done by the others.
+ */
+void Parallel_For(uint32_t count, parallel_func_t func, void *data)
+{
+    SDL_Thread *threads[PARALLEL_MAX_THREADS];
+    uint32_t workers = Parallel_GetThreadsCount() - 1;
+    parallel_job_t job;
+
+    if(count == 0)
+    {
+        return;
+    }
+
+    workers = (workers < count - 1) ? (workers) : (count - 1);
+    SDL_AtomicSet(&job.next, 0);
+    job.count = count;
+    job.func = func;
+    job.data = data;
+
+    for(uint32_t i = 0; i < workers; i++)
+    {
+        threads[i] = SDL_CreateThread(Parallel_Worker, "parallel_for", &job);
+    }
+
+    Parallel_Worker(&job);
+
+    for(uint32_t i = 0; i < workers; i++)
+    {
+        if(threads[i])
+        {
+            SDL_WaitThread(threads[i], NULL);
+        }
+    }
+}
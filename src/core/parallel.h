@@ -0,0 +1,27 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/*
+ * Parallel for: items [0, count) are taken one by one by a few worker
+ * threads and by the calling thread; returns when all items are done.
+ * Workers live only for the call, so it is meant for big batches of load
+ * time work. func must be thread safe and must not call GL.
+ */
+#define PARALLEL_MAX_THREADS        (8)                                         // including the calling one
+
+typedef void (*parallel_func_t)(void *data, uint32_t index);
+
+void     Parallel_For(uint32_t count, parallel_func_t func, void *data);
+uint32_t Parallel_GetThreadsCount();
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif
@@ -4,6 +4,7 @@
 #include <SDL2/SDL_platform.h>
 #include <SDL2/SDL_opengl.h>
 
+#include "arena.h"
 #include "system.h"
 #include "vmath.h"
 #include "polygon.h"
@@ -30,7 +31,7 @@ void Polygon_Clear(polygon_p p)
     {
         if(p->vertices)
         {
-            free(p->vertices);
+            Arena_Free(p->vertices);
             p->vertices = NULL;
         }
         p->vertex_count = 0;
@@ -0,0 +1,475 @@
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_atomic.h>
+#include <SDL2/SDL_thread.h>
+#include <SDL2/SDL_platform.h>
+#include <SDL2/SDL_opengl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gl_util.h"
+#include "profiler.h"
+
+
+#define PROF_BUFFER_FREE            (0)
+#define PROF_BUFFER_USED            (1)
+
+#define PROF_EVENTS_MASK            (PROF_THREAD_EVENTS - 1)
+#define PROF_MAX_DEPTH              (0xFFFF)
+
+typedef struct prof_event_s
+{
+    const char         *name;
+    uint64_t            start;
+    uint64_t            end;                                                    // 0 - zone is not closed yet
+    uint32_t            ticket;
+    uint16_t            depth;
+    uint16_t            reserved;
+}prof_event_t, *prof_event_p;
+
+/*
+ * Only owner thread writes events and moves head; dump reads
+ * events behind head, zones that are still open are skipped.
+ */
+typedef struct prof_buffer_s
+{
+    SDL_atomic_t        state;
+    SDL_atomic_t        head;
+    SDL_threadID        thread_id;
+    uint32_t            depth;
+    prof_event_t        events[PROF_THREAD_EVENTS];
+}prof_buffer_t, *prof_buffer_p;
+
+typedef struct prof_gpu_query_s
+{
+    const char         *name;
+    uint64_t            start;                                                  // CPU counter at begin, for trace
+    GLuint              query;
+}prof_gpu_query_t, *prof_gpu_query_p;
+
+
+static prof_buffer_t    prof_buffers[PROF_MAX_THREAD_BUFFERS];
+static prof_buffer_t    prof_gpu_buffer;                                        // resolved GPU zones, for trace
+static SDL_TLSID        prof_tls = 0;
+static SDL_atomic_t     prof_enabled = {0};
+static SDL_threadID     prof_main_thread = 0;
+static prof_buffer_p    prof_main_buffer = NULL;
+static uint32_t         prof_frame_head = 0;
+static uint64_t         prof_frame_start = 0;
+static float            prof_frame_ms = 0.0f;
+
+static prof_zone_stats_t prof_frame_zones[PROF_MAX_FRAME_ZONES];
+static uint32_t         prof_frame_zones_count = 0;
+static prof_zone_stats_t prof_gpu_zones[PROF_GPU_ZONES];
+static uint32_t         prof_gpu_zones_count = 0;
+
+static prof_gpu_query_t prof_gpu_queries[PROF_GPU_FRAMES][PROF_GPU_ZONES];
+static uint32_t         prof_gpu_queries_count[PROF_GPU_FRAMES];
+static uint32_t         prof_gpu_frame = 0;
+static int              prof_gpu_active = 0;                                    // query is open
+static int              prof_gpu_inited = 0;
+
+
+void Prof_Init()
+{
+    if(prof_tls)
+    {
+        return;
+    }
+
+    for(int i = 0; i < PROF_MAX_THREAD_BUFFERS; ++i)
+    {
+        SDL_AtomicSet(&prof_buffers[i].state, PROF_BUFFER_FREE);
+        SDL_AtomicSet(&prof_buffers[i].head, 0);
+    }
+    SDL_AtomicSet(&prof_gpu_buffer.state, PROF_BUFFER_USED);
+    SDL_AtomicSet(&prof_gpu_buffer.head, 0);
+
+    prof_tls = SDL_TLSCreate();
+    prof_main_thread = SDL_ThreadID();
+    prof_main_buffer = NULL;
+    prof_frame_start = SDL_GetPerformanceCounter();
+    memset(prof_gpu_queries_count, 0x00, sizeof(prof_gpu_queries_count));
+}
+
+
+void Prof_Destroy()
+{
+    SDL_AtomicSet(&prof_enabled, 0);
+    if(prof_gpu_inited && qglDeleteQueriesARB)
+    {
+        for(int f = 0; f < PROF_GPU_FRAMES; ++f)
+        {
+            for(int i = 0; i < PROF_GPU_ZONES; ++i)
+            {
+                qglDeleteQueriesARB(1, &prof_gpu_queries[f][i].query);
+            }
+        }
+    }
+    prof_gpu_inited = 0;
+}
+
+
+void Prof_SetEnabled(int enabled)
+{
+    if(enabled && !SDL_AtomicGet(&prof_enabled))
+    {
+        prof_frame_zones_count = 0;
+        prof_gpu_zones_count = 0;
+        if(prof_main_buffer)
+        {
+            prof_frame_head = SDL_AtomicGet(&prof_main_buffer->head);
+        }
+    }
+    SDL_AtomicSet(&prof_enabled, (prof_tls && enabled) ? (1) : (0));
+}
+
+
+int Prof_IsEnabled()
+{
+    return SDL_AtomicGet(&prof_enabled);
+}
+
+
+static void Prof_ThreadBufferRelease(void *data)
+{
+    prof_buffer_p buf = (prof_buffer_p)data;
+    SDL_AtomicSet(&buf->state, PROF_BUFFER_FREE);
+}
+
+
+static prof_buffer_p Prof_GetThreadBuffer()
+{
+    prof_buffer_p buf = (prof_buffer_p)SDL_TLSGet(prof_tls);
+
+    if(!buf)
+    {
+        for(int i = 0; i < PROF_MAX_THREAD_BUFFERS; ++i)
+        {
+            if(SDL_AtomicCAS(&prof_buffers[i].state, PROF_BUFFER_FREE, PROF_BUFFER_USED))
+            {
+                buf = prof_buffers + i;
+                buf->thread_id = SDL_ThreadID();
+                buf->depth = 0;
+                SDL_AtomicSet(&buf->head, 0);
+                SDL_TLSSet(prof_tls, buf, Prof_ThreadBufferRelease);
+                if(buf->thread_id == prof_main_thread)
+                {
+                    prof_main_buffer = buf;
+                    prof_frame_head = 0;
+                }
+                break;
+            }
+        }
+    }
+
+    return buf;
+}
+
+
+uint32_t Prof_Begin(const char *name)
+{
+    prof_buffer_p buf;
+
+    if(!SDL_AtomicGet(&prof_enabled) || !(buf = Prof_GetThreadBuffer()))
+    {
+        return PROF_NO_TICKET;
+    }
+
+    uint32_t ticket = (uint32_t)SDL_AtomicGet(&buf->head);
+    prof_event_p ev = buf->events + (ticket & PROF_EVENTS_MASK);
+    ev->name = name;
+    ev->start = SDL_GetPerformanceCounter();
+    ev->end = 0;
+    ev->ticket = ticket;
+    ev->depth = (buf->depth < PROF_MAX_DEPTH) ? (buf->depth) : (PROF_MAX_DEPTH);
+    buf->depth++;
+    SDL_AtomicSet(&buf->head, ticket + 1);
+
+    return ticket;
+}
+
+
+void Prof_End(uint32_t ticket)
+{
+    if(ticket != PROF_NO_TICKET)
+    {
+        prof_buffer_p buf = (prof_buffer_p)SDL_TLSGet(prof_tls);
+        if(buf)
+        {
+            prof_event_p ev = buf->events + (ticket & PROF_EVENTS_MASK);
+            if(ev->ticket == ticket)                                            // else overwritten by newer zones
+            {
+                ev->end = SDL_GetPerformanceCounter();
+            }
+            buf->depth = (buf->depth > 0) ? (buf->depth - 1) : (0);
+        }
+    }
+}
+
+
+void Prof_GPUBegin(const char *name)
+{
+    uint32_t frame = prof_gpu_frame % PROF_GPU_FRAMES;
+
+    if(!SDL_AtomicGet(&prof_enabled) || !qglGenQueriesARB || prof_gpu_active ||
+       (prof_gpu_queries_count[frame] >= PROF_GPU_ZONES))
+    {
+        return;
+    }
+
+    if(!prof_gpu_inited)
+    {
+        for(int f = 0; f < PROF_GPU_FRAMES; ++f)
+        {
+            for(int i = 0; i < PROF_GPU_ZONES; ++i)
+            {
+                qglGenQueriesARB(1, &prof_gpu_queries[f][i].query);
+            }
+            prof_gpu_queries_count[f] = 0;
+        }
+        prof_gpu_inited = 1;
+    }
+
+    prof_gpu_query_p q = prof_gpu_queries[frame] + prof_gpu_queries_count[frame]++;
+    q->name = name;
+    q->start = SDL_GetPerformanceCounter();
+    qglBeginQueryARB(GL_TIME_ELAPSED, q->query);
+    prof_gpu_active = 1;
+}
+
+
+void Prof_GPUEnd()
+{
+    if(prof_gpu_active)
+    {
+        qglEndQueryARB(GL_TIME_ELAPSED);
+        prof_gpu_active = 0;
+    }
+}
+
+
+static prof_zone_stats_p Prof_GetZone(prof_zone_stats_p zones, uint32_t *count, uint32_t max_count, const char *name, uint16_t depth)
+{
+    for(uint32_t i = 0; i < *count; i++)
+    {
+        if((zones[i].name == name) && (zones[i].depth == depth))
+        {
+            return zones + i;
+        }
+    }
+
+    if(*count < max_count)
+    {
+        prof_zone_stats_p z = zones + (*count)++;
+        z->name = name;
+        z->depth = depth;
+        z->calls = 0;
+        z->ms = 0.0f;
+        z->avg_ms = 0.0f;
+        z->max_ms = 0.0f;
+        return z;
+    }
+
+    return NULL;
+}
+
+
+static void Prof_UpdateZonesAverage(prof_zone_stats_p zones, uint32_t count)
+{
+    for(uint32_t i = 0; i < count; i++)
+    {
+        zones[i].avg_ms = 0.9f * zones[i].avg_ms + 0.1f * zones[i].ms;
+        zones[i].max_ms = (zones[i].ms > zones[i].max_ms) ? (zones[i].ms) : (zones[i].max_ms);
+    }
+}
+
+/**
+ * Reads GPU zones of the oldest frame in flight; results that are not
+ * ready yet are dropped, their queries are reused.
+ */
+static void Prof_ResolveGPUFrame(uint32_t frame)
+{
+    const double ms_per_tick = 1000.0 / (double)SDL_GetPerformanceFrequency();
+    prof_gpu_query_p q = prof_gpu_queries[frame];
+
+    for(uint32_t i = 0; i < prof_gpu_zones_count; i++)
+    {
+        prof_gpu_zones[i].ms = 0.0f;
+        prof_gpu_zones[i].calls = 0;
+    }
+
+    for(uint32_t i = 0; i < prof_gpu_queries_count[frame]; i++, q++)
+    {
+        GLint available = 0;
+        GLuint64 ns = 0;
+        qglGetQueryObjectivARB(q->query, GL_QUERY_RESULT_AVAILABLE_ARB, &available);
+        if(available)
+        {
+            qglGetQueryObjectui64v(q->query, GL_QUERY_RESULT_ARB, &ns);
+            prof_zone_stats_p z = Prof_GetZone(prof_gpu_zones, &prof_gpu_zones_count, PROF_GPU_ZONES, q->name, 0);
+            if(z)
+            {
+                z->ms += (float)ns * 1.0e-6f;
+                z->calls++;
+            }
+
+            uint32_t ticket = (uint32_t)SDL_AtomicGet(&prof_gpu_buffer.head);
+            prof_event_p ev = prof_gpu_buffer.events + (ticket & PROF_EVENTS_MASK);
+            ev->name = q->name;
+            ev->start = q->start;
+            ev->end = q->start + (uint64_t)((double)ns * 1.0e-6 / ms_per_tick);
+            ev->ticket = ticket;
+            ev->depth = 0;
+            SDL_AtomicSet(&prof_gpu_buffer.head, ticket + 1);
+        }
+    }
+    prof_gpu_queries_count[frame] = 0;
+
+    Prof_UpdateZonesAverage(prof_gpu_zones, prof_gpu_zones_count);
+}
+
+/**
+ * Collects main thread zones recorded since previous call; must be
+ * called by main thread once per frame, outside of any zone.
+ */
+void Prof_FrameEnd()
+{
+    uint64_t now = SDL_GetPerformanceCounter();
+    const double ms_per_tick = 1000.0 / (double)SDL_GetPerformanceFrequency();
+
+    prof_frame_ms = (float)((double)(now - prof_frame_start) * ms_per_tick);
+    prof_frame_start = now;
+    if(!SDL_AtomicGet(&prof_enabled))
+    {
+        return;
+    }
+
+    for(uint32_t i = 0; i < prof_frame_zones_count; i++)
+    {
+        prof_frame_zones[i].ms = 0.0f;
+        prof_frame_zones[i].calls = 0;
+    }
+
+    if(prof_main_buffer)
+    {
+        uint32_t head = (uint32_t)SDL_AtomicGet(&prof_main_buffer->head);
+        uint32_t first = (head - prof_frame_head > PROF_THREAD_EVENTS) ? (head - PROF_THREAD_EVENTS) : (prof_frame_head);
+        for(uint32_t t = first; t != head; t++)
+        {
+            prof_event_p ev = prof_main_buffer->events + (t & PROF_EVENTS_MASK);
+            if(ev->end != 0)
+            {
+                prof_zone_stats_p z = Prof_GetZone(prof_frame_zones, &prof_frame_zones_count, PROF_MAX_FRAME_ZONES, ev->name, ev->depth);
+                if(z)
+                {
+                    z->ms += (float)((double)(ev->end - ev->start) * ms_per_tick);
+                    z->calls++;
+                }
+            }
+        }
+        prof_frame_head = head;
+    }
+    Prof_UpdateZonesAverage(prof_frame_zones, prof_frame_zones_count);
+
+    Prof_GPUEnd();
+    prof_gpu_frame++;
+    if(prof_gpu_inited)
+    {
+        Prof_ResolveGPUFrame(prof_gpu_frame % PROF_GPU_FRAMES);
+    }
+}
+
+
+uint32_t Prof_GetFrameZones(const prof_zone_stats_t **zones)
+{
+    *zones = prof_frame_zones;
+    return prof_frame_zones_count;
+}
+
+
+uint32_t Prof_GetGPUZones(const prof_zone_stats_t **zones)
+{
+    *zones = prof_gpu_zones;
+    return prof_gpu_zones_count;
+}
+
+
+float Prof_GetFrameTime()
+{
+    return prof_frame_ms;
+}
+
+
+static void Prof_DumpBuffer(FILE *f, prof_buffer_p buf, uint32_t tid, uint64_t base, int *first)
+{
+    const double us_per_tick = 1000000.0 / (double)SDL_GetPerformanceFrequency();
+    uint32_t head = (uint32_t)SDL_AtomicGet(&buf->head);
+    uint32_t t = (head > PROF_THREAD_EVENTS) ? (head - PROF_THREAD_EVENTS) : (0);
+
+    for(; t != head; t++)
+    {
+        prof_event_p ev = buf->events + (t & PROF_EVENTS_MASK);
+        if((ev->ticket == t) && (ev->end >= ev->start) && (ev->end != 0) && (ev->start >= base))
+        {
+            fprintf(f, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                    (*first) ? ("") : (","), ev->name, tid,
+                    (double)(ev->start - base) * us_per_tick, (double)(ev->end - ev->start) * us_per_tick);
+            *first = 0;
+        }
+    }
+}
+
+/**
+ * Writes all buffered zones in Chrome trace event format; recording
+ * is paused while writing. Returns 1 on success.
+ */
+int Prof_DumpTrace(const char *file_name)
+{
+    int was_enabled = SDL_AtomicGet(&prof_enabled);
+    uint64_t base = 0xFFFFFFFFFFFFFFFFULL;
+    int first = 1;
+    FILE *f = fopen(file_name, "w");
+
+    if(!f)
+    {
+        return 0;
+    }
+
+    SDL_AtomicSet(&prof_enabled, 0);
+    for(int i = 0; i < PROF_MAX_THREAD_BUFFERS + 1; ++i)
+    {
+        prof_buffer_p buf = (i < PROF_MAX_THREAD_BUFFERS) ? (prof_buffers + i) : (&prof_gpu_buffer);
+        uint32_t head = (uint32_t)SDL_AtomicGet(&buf->head);
+        uint32_t t = (head > PROF_THREAD_EVENTS) ? (head - PROF_THREAD_EVENTS) : (0);
+        for(; t != head; t++)
+        {
+            prof_event_p ev = buf->events + (t & PROF_EVENTS_MASK);
+            base = ((ev->ticket == t) && (ev->start < base)) ? (ev->start) : (base);
+        }
+    }
+    base = (base == 0xFFFFFFFFFFFFFFFFULL) ? (0) : (base);
+
+    fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    fprintf(f, "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"GPU\"}}");
+    first = 0;
+    for(int i = 0; i < PROF_MAX_THREAD_BUFFERS; ++i)
+    {
+        if(SDL_AtomicGet(&prof_buffers[i].head) > 0)
+        {
+            uint32_t tid = (uint32_t)prof_buffers[i].thread_id;
+            if(prof_buffers[i].thread_id == prof_main_thread)
+            {
+                fprintf(f, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"main\"}}", tid);
+            }
+            Prof_DumpBuffer(f, prof_buffers + i, tid, base, &first);
+        }
+    }
+    Prof_DumpBuffer(f, &prof_gpu_buffer, 0, base, &first);
+    fprintf(f, "\n]}\n");
+    fclose(f);
+
+    SDL_AtomicSet(&prof_enabled, was_enabled);
+    return 1;
+}
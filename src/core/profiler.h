@@ -0,0 +1,70 @@
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/*
+ * Frame profiler: nested CPU zones are written by every thread into its own
+ * ring buffer (no locks, owner thread only), GPU zones are measured with
+ * timer queries when available (main thread, not nested, results are read
+ * PROF_GPU_FRAMES later). Main thread zones of the last frame are collected
+ * for overlay; all buffered zones may be dumped as Chrome trace JSON
+ * (chrome://tracing, Perfetto). Nothing is recorded while disabled.
+ */
+#define PROF_MAX_THREAD_BUFFERS     (8)
+#define PROF_THREAD_EVENTS          (16384)                                     // must be power of 2
+#define PROF_MAX_FRAME_ZONES        (48)
+#define PROF_GPU_ZONES              (8)
+#define PROF_GPU_FRAMES             (4)
+#define PROF_NO_TICKET              (0xFFFFFFFF)
+
+typedef struct prof_zone_stats_s
+{
+    const char             *name;
+    uint16_t                depth;                                              // nesting level, 0 - top
+    uint16_t                calls;                                              // in the last frame
+    float                   ms;                                                 // in the last frame
+    float                   avg_ms;                                             // smoothed
+    float                   max_ms;                                             // worst frame since enabled
+}prof_zone_stats_t, *prof_zone_stats_p;
+
+void Prof_Init();
+void Prof_Destroy();
+void Prof_SetEnabled(int enabled);
+int  Prof_IsEnabled();
+
+uint32_t Prof_Begin(const char *name);                                          // name must be static string
+void Prof_End(uint32_t ticket);
+void Prof_GPUBegin(const char *name);
+void Prof_GPUEnd();
+void Prof_FrameEnd();
+
+uint32_t Prof_GetFrameZones(const prof_zone_stats_t **zones);
+uint32_t Prof_GetGPUZones(const prof_zone_stats_t **zones);
+float    Prof_GetFrameTime();                                                   // ms, between last two Prof_FrameEnd()
+int      Prof_DumpTrace(const char *file_name);
+
+#define PROF_BEGIN(zone)            uint32_t prof_ticket_##zone = Prof_Begin(#zone)
+#define PROF_END(zone)              Prof_End(prof_ticket_##zone)
+
+#ifdef	__cplusplus
+}
+
+struct prof_scope_s
+{
+    uint32_t ticket;
+    prof_scope_s(const char *name) : ticket(Prof_Begin(name)) { }
+   ~prof_scope_s() { Prof_End(ticket); }
+};
+
+#define PROF_SCOPE_CAT2(a, b)       a##b
+#define PROF_SCOPE_CAT(a, b)        PROF_SCOPE_CAT2(a, b)
+#define PROF_SCOPE(name)            prof_scope_s PROF_SCOPE_CAT(prof_scope_, __LINE__)(name)
+#endif
+
+#endif
@@ -6,6 +6,9 @@
 #include <SDL2/SDL_audio.h>
 #include <sys/stat.h>
 #include <sys/time.h>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
 #include <time.h>
 #include <dirent.h>
 #include <stdio.h>
@@ -17,6 +20,8 @@
 #include <lauxlib.h>
 
 #include "system.h"
+#include "log.h"
+#include "profiler.h"
 #include "utf8_32.h"
 #include "console.h"
 #include "gl_util.h"
@@ -39,6 +44,7 @@ extern lua_State       *engine_lua;
 static uint8_t         *engine_mem_buffer             = NULL;
 static size_t           engine_mem_buffer_size        = 0;
 static size_t           engine_mem_buffer_size_left   = 0;
+static SDL_threadID     engine_main_thread_id         = 0;
 
 // =======================================================================
 // General routines
@@ -49,6 +55,10 @@ void Sys_Init()
     engine_mem_buffer               = (uint8_t*)malloc(INIT_TEMP_MEM_SIZE);
     engine_mem_buffer_size          = INIT_TEMP_MEM_SIZE;
     engine_mem_buffer_size_left     = INIT_TEMP_MEM_SIZE;
+    engine_main_thread_id           = SDL_ThreadID();
+
+    Log_Init();
+    Prof_Init();
 }
 
 
@@ -61,6 +71,7 @@ void Sys_InitGlobals()
     screen_info.debug_view_state = 0;
     screen_info.fullscreen = 0;
     screen_info.crosshair = 0;
+    screen_info.show_profiler = 0;
     screen_info.fov = 75.0;
     screen_info.scale_factor = 1.0f;
     screen_info.fps = 0.0f;
@@ -69,6 +80,9 @@ void Sys_InitGlobals()
 
 void Sys_Destroy()
 {
+    Prof_Destroy();
+    Log_Destroy();
+
     if(engine_mem_buffer)
     {
         free(engine_mem_buffer);
@@ -275,6 +289,26 @@ float Sys_FloatTime (void)
 }
 
 
+/**
+ * Peak resident set size of the process in KB, 0 if unknown.
+ */
+size_t Sys_GetPeakRSS()
+{
+#ifndef _WIN32
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) == 0)
+    {
+#ifdef __APPLE__
+        return (size_t)usage.ru_maxrss / 1024;                                  // bytes on macOS
+#else
+        return (size_t)usage.ru_maxrss;
+#endif
+    }
+#endif
+    return 0;
+}
+
+
 void Sys_Strtime(char *buf, size_t buf_size)
 {
     struct tm *tm_;
@@ -300,7 +334,8 @@ void Sys_Error(const char *error, ...)
     vsnprintf (string, 4096, error, argptr);
     va_end (argptr);
 
-    Sys_DebugLog(SYS_LOG_FILENAME, "System error: %s", string);
+    Log_Printf(SYS_LOG_FILENAME, LOG_LEVEL_ERROR, LOG_CAT_SYSTEM, "System error: %s", string);
+    Log_Destroy();
     //Engine_Shutdown(1);
     exit(1);
 }
@@ -314,44 +349,21 @@ void Sys_Warn(const char *warning, ...)
     va_start (argptr, warning);
     vsnprintf (string, 4096, warning, argptr);
     va_end (argptr);
-    Sys_DebugLog(SYS_LOG_FILENAME, "Warning: %s", string);
-    Con_Warning("Warning: %s", string);
+    Log_Printf(SYS_LOG_FILENAME, LOG_LEVEL_WARNING, LOG_CAT_SYSTEM, "Warning: %s", string);
+    if(SDL_ThreadID() == engine_main_thread_id)                                 // console is not thread safe
+    {
+        Con_Warning("Warning: %s", string);
+    }
 }
 
 
 void Sys_DebugLog(const char *file, const char *fmt, ...)
 {
     va_list argptr;
-    static char data[4096];
-    int32_t written;
 
     va_start(argptr, fmt);
-    written = vsnprintf(data, sizeof(data), fmt, argptr);
+    Log_VPrintf(file, LOG_LEVEL_INFO, LOG_CAT_SYSTEM, fmt, argptr);
     va_end(argptr);
-
-    if(written > 0)
-    {
-        SDL_RWops *fp;
-        // Add newline at end (if possible)
-        if((written + 1) < sizeof(data))
-        {
-            data[written + 0] = '\n';
-            data[written + 1] = 0;
-            written += 1;
-        }
-
-        fp = SDL_RWFromFile(file, "a");
-        if(fp == NULL)
-        {
-            fp = SDL_RWFromFile(file, "w");
-        }
-        if(fp != NULL)
-        {
-            SDL_RWwrite(fp, data, written, 1);
-            SDL_RWclose(fp);
-        }
-        fwrite(data, written, 1, stderr);
-    }
 }
 
 
@@ -26,6 +26,7 @@ typedef struct screen_info_s
     uint32_t    debug_view_state : 8;
     uint32_t    fullscreen : 1;
     uint32_t    crosshair : 1;
+    uint32_t    show_profiler : 1;
 } screen_info_t, *screen_info_p;
 
 typedef struct file_info_s
@@ -52,6 +53,7 @@ void Sys_ListDirFree(file_info_p list);
 
 float Sys_FloatTime(void);
 void Sys_Strtime(char *buf, size_t buf_size);
+size_t Sys_GetPeakRSS();
 
 void Sys_Init(void);
 void Sys_Error(const char *error, ...);
@@ -21,6 +21,7 @@ extern "C" {
 #include "core/vmath.h"
 #include "core/polygon.h"
 #include "core/gl_text.h"
+#include "core/profiler.h"
 #include "render/camera.h"
 #include "render/render.h"
 #include "script/script.h"
@@ -41,12 +42,16 @@ extern "C" {
 #include "world.h"
 #include "resource.h"
 #include "engine.h"
+#include "engine_checks.h"
 #include "controls.h"
 #include "trigger.h"
 #include "character_controller.h"
 #include "render/bsp_tree.h"
+#include "render/light_cache.h"
+#include "render/render_queue.h"
 #include "render/shader_manager.h"
 #include "image.h"
+#include "image_writer.h"
 
 
 static SDL_Window             *sdl_window     = NULL;
@@ -60,6 +65,35 @@ static stream_codec_t           engine_video;
 static char                     base_path[1024] = {0};
 static volatile int             engine_done   = 0;
 static int                      engine_set_zero_time = 0;
+static int                      engine_headless = 0;
+static int32_t                  engine_headless_frames = 0;                     // 0 - until replay end / Engine_SetDone()
+static const char              *engine_timing_name = NULL;
+static int                      engine_vis_check = 0;                           // headless: compare reused visibility lists with traversal
+
+/*
+ * Screen capture: pixels are read into one of two pixel pack buffers and are
+ * mapped on the next frame, when GPU is done with them, so frame does not
+ * wait for glReadPixels; encoding and writing are done by image writer.
+ */
+#define SCREEN_CAPTURE_PBO_COUNT    (2)
+
+typedef struct screen_capture_s
+{
+    GLuint                  pbo[SCREEN_CAPTURE_PBO_COUNT];
+    GLsizeiptr              pbo_size[SCREEN_CAPTURE_PBO_COUNT];
+    GLint                   width[SCREEN_CAPTURE_PBO_COUNT];
+    GLint                   height[SCREEN_CAPTURE_PBO_COUNT];
+    int                     format[SCREEN_CAPTURE_PBO_COUNT];
+    int                     pending[SCREEN_CAPTURE_PBO_COUNT];
+    char                    file_name[SCREEN_CAPTURE_PBO_COUNT][IMAGE_WRITER_MAX_FILE_NAME];
+    uint32_t                current;
+    int                     requested;
+    uint32_t                record_every;                                       // record every Nth frame, 0 - off
+    uint32_t                record_frame;
+    uint32_t                record_count;
+}screen_capture_t, *screen_capture_p;
+
+static screen_capture_t         engine_capture = {{0}};
 float time_scale = 1.0f;
 
 engine_container_p      last_cont = NULL;
@@ -84,6 +118,7 @@ enum debug_view_state_e
     room_objects,
     ai_boxes,
     bsp_info,
+    render_info,
     model_view,
     debug_states_count
 };
@@ -101,17 +136,23 @@ void Engine_InitDefaultGlobals();
 
 void Engine_Display(float time);
 void Engine_PollSDLEvents();
+void Engine_HeadlessLoop();
 void Engine_Resize(int nominalW, int nominalH, int pixelsW, int pixelsH);
 
 void TestModelApplyKey(int key);
 void SetTestModel(int index);
 void ShowModelView(float time);
 void ShowDebugInfo();
+void Engine_ShowProfiler();
+void Engine_CaptureFrame();
+void Engine_CaptureDestroy();
 
 void Engine_Start(int argc, char **argv)
 {
     char *config_name = NULL;
     char *autoexec_name = NULL;
+    char *record_name = NULL;
+    char *replay_name = NULL;
 
     Engine_InitDefaultGlobals();
 
@@ -158,12 +199,59 @@ void Engine_Start(int argc, char **argv)
             }
             ++i;
         }
+        else if(0 == strncmp(argv[i], "-headless", 9))
+        {
+            engine_headless = 1;
+            if(i + 1 < argc)
+            {
+                engine_headless_frames = atoi(argv[i + 1]);
+            }
+            ++i;
+        }
+        else if(0 == strncmp(argv[i], "-record", 7))
+        {
+            if(i + 1 < argc)
+            {
+                record_name = argv[i + 1];
+            }
+            ++i;
+        }
+        else if(0 == strncmp(argv[i], "-replay", 7))
+        {
+            if((i + 1 < argc) && (Sys_FileFound(argv[i + 1], 0)))
+            {
+                replay_name = argv[i + 1];
+            }
+            ++i;
+        }
+        else if(Engine_ChecksParseArg(argc, argv, &i))
+        {
+            engine_headless = 1;
+        }
+        else if(0 == strncmp(argv[i], "-vis_check", 10))
+        {
+            engine_vis_check = 1;
+        }
+        else if(0 == strncmp(argv[i], "-timing", 7))
+        {
+            if(i + 1 < argc)
+            {
+                engine_timing_name = argv[i + 1];
+            }
+            ++i;
+        }
         else
         {
             puts("usage:");
             puts("-config \"path_to_config_file\"");
             puts("-autoexec \"path_to_autoexec_file\"");
             puts("-base_path \"path_to_base_folder_location (contains data, resource, save and script folders)\"");
+            puts("-headless frames_count (no window, fixed time step, 0 - run until replay end)");
+            puts("-record \"path_to_controls_record_file\"");
+            puts("-replay \"path_to_controls_record_file\"");
+            puts("-timing \"path_to_frame_timings_csv_file\"");
+            puts("-vis_check (with -headless: build rooms list every frame, compare reused lists with exact portals traversal; -replay gives moving camera)");
+            Engine_ChecksUsage();
             exit(0);
         }
     }
@@ -173,14 +261,27 @@ void Engine_Start(int argc, char **argv)
 
     Engine_LoadConfig(config_name ? config_name : "config.lua");
 
-    // Init generic SDL interfaces.
-    Engine_InitSDLSubsystems();
-    Engine_InitSDLVideo();
-    Audio_CoreInit();
-
-    // Additional OpenGL initialization.
-    Engine_InitGL();
-    renderer.DoShaders();
+    if(engine_headless)
+    {
+        // No window, no GL context and no audio device: all GL calls go to
+        // the null backend, so level loading and renderer setup work as usual.
+        SDL_Init(SDL_INIT_TIMER | SDL_INIT_EVENTS);
+        InitGLNullFuncs();
+        renderer.DoShaders();
+        renderer.renderQueue->SetHeadless(true);
+        renderer.transparencyQueue->SetHeadless(true);
+    }
+    else
+    {
+        // Init generic SDL interfaces.
+        Engine_InitSDLSubsystems();
+        Engine_InitSDLVideo();
+        Audio_CoreInit();
+
+        // Additional OpenGL initialization.
+        Engine_InitGL();
+        renderer.DoShaders();
+    }
 
     // Secondary (deferred) initialization.
     Engine_Init_Post();
@@ -194,10 +295,22 @@ void Engine_Start(int argc, char **argv)
     // Clearing up memory for initial level loading.
     World_Prepare();
 
-    // Setting up mouse.
-    SDL_SetRelativeMouseMode(SDL_TRUE);
-    SDL_WarpMouseInWindow(sdl_window, screen_info.w / 2, screen_info.h / 2);
-    SDL_ShowCursor(0);
+    if(replay_name)
+    {
+        Controls_PlaybackStart(replay_name);
+    }
+    else if(record_name)
+    {
+        Controls_RecordStart(record_name);
+    }
+
+    if(!engine_headless)
+    {
+        // Setting up mouse.
+        SDL_SetRelativeMouseMode(SDL_TRUE);
+        SDL_WarpMouseInWindow(sdl_window, screen_info.w / 2, screen_info.h / 2);
+        SDL_ShowCursor(0);
+    }
 
     luaL_dofile(engine_lua, autoexec_name ? autoexec_name : "autoexec.lua");
 }
@@ -205,6 +318,8 @@ void Engine_Start(int argc, char **argv)
 
 void Engine_Shutdown(int val)
 {
+    Controls_RecordStop();
+    World_PreloadCancel();
     renderer.ResetWorld(NULL, 0, NULL, 0);
     SSBoneFrame_Clear(&test_model);
     World_Clear();
@@ -226,6 +341,8 @@ void Engine_Shutdown(int val)
     Sys_Destroy();
 
     /* no more renderings */
+    Engine_CaptureDestroy();
+    ImageWriter_Destroy();
     SDL_GL_DeleteContext(sdl_gl_context);
     sdl_gl_context = 0;
     SDL_DestroyWindow(sdl_window);
@@ -264,6 +381,12 @@ const char *Engine_GetBasePath()
 }
 
 
+int Engine_IsHeadless()
+{
+    return engine_headless;
+}
+
+
 void Engine_SetDone()
 {
     stream_codec_stop(&engine_video, 0);
@@ -287,6 +410,7 @@ void Engine_Init_Pre()
     stream_codec_init(&engine_video);
 
     Sys_Init();
+    ImageWriter_Init();
     glf_init();
     GLText_Init();
     Con_Init();
@@ -540,7 +664,9 @@ void Engine_Display(float time)
         if(screen_info.debug_view_state != debug_view_state_e::model_view)
         {
             renderer.GenWorldList(&engine_camera);
+            Prof_GPUBegin("DrawList");
             renderer.DrawList();
+            Prof_GPUEnd();
         }
         else
         {
@@ -554,19 +680,32 @@ void Engine_Display(float time)
         qglEnable(GL_ALPHA_TEST);
 
         qglPopClientAttrib();        ///@POP -> GL_VERTEX_ARRAY | GL_COLOR_ARRAY
-        Gui_Render();
+        {
+            PROF_SCOPE("Gui_Render");
+            Prof_GPUBegin("Gui_Render");
+            Gui_Render();
+            Prof_GPUEnd();
+        }
         Gui_SwitchGLMode(0);
 
         renderer.DrawListDebugLines();
 
-        SDL_GL_SwapWindow(sdl_window);
+        Engine_CaptureFrame();
+        {
+            PROF_SCOPE("SwapWindow");
+            SDL_GL_SwapWindow(sdl_window);
+        }
     }
 }
 
 
 void Engine_GLSwapWindow()
 {
-    SDL_GL_SwapWindow(sdl_window);
+    if(sdl_window)
+    {
+        Engine_CaptureFrame();
+        SDL_GL_SwapWindow(sdl_window);
+    }
 }
 
 
@@ -788,6 +927,15 @@ void Engine_MainLoop()
     int cycles = 0;
     char fps_str[32] = "0.0";
 
+    if(engine_headless)
+    {
+        if(!Engine_ChecksRun())
+        {
+            Engine_HeadlessLoop();
+        }
+        return;
+    }
+
     while(!engine_done)
     {
         newtime = Sys_FloatTime();
@@ -805,6 +953,14 @@ void Engine_MainLoop()
             time = 1.0f / 30.0f;
         }
 
+        Sys_ResetTempMem();
+        Engine_PollSDLEvents();
+        if(Controls_IsPlayback() && !Controls_PlaybackFrame(&time))
+        {
+            Con_AddLine("controls replay is over", FONTSTYLE_CONSOLE_EVENT);
+        }
+        Controls_RecordFrame(time);
+
         engine_frame_time = time;
 
         if(cycles < max_cycles)
@@ -820,9 +976,6 @@ void Engine_MainLoop()
             time_cycl = 0.0f;
         }
 
-        Sys_ResetTempMem();
-        Engine_PollSDLEvents();
-
         gl_text_line_p fps = GLText_OutTextXY(10.0f, 10.0f, fps_str);
         if(fps)
         {
@@ -838,15 +991,28 @@ void Engine_MainLoop()
             StreamTrack_Stop(Audio_GetStreamExternal());
         }
 
+        if(screen_info.show_profiler)
+        {
+            Engine_ShowProfiler();
+        }
+
         if(codec_end_state >= 0)
         {
             if(screen_info.debug_view_state != debug_view_state_e::model_view)
             {
+                PROF_BEGIN(Game_Frame);
                 Game_Frame(time);
                 Gameflow_ProcessCommands();
+                PROF_END(Game_Frame);
+            }
+            {
+                PROF_SCOPE("Audio_Update");
+                Audio_Update(time);
+            }
+            {
+                PROF_SCOPE("Engine_Display");
+                Engine_Display(time);
             }
-            Audio_Update(time);
-            Engine_Display(time);
         }
         else
         {
@@ -878,6 +1044,111 @@ void Engine_MainLoop()
                 stream_codec_stop(&engine_video, 0);
             }
         }
+        Prof_FrameEnd();
+    }
+}
+
+
+/*
+ * Headless benchmark loop: game logic only, driven by fixed time step
+ * (or by recorded frame times on replay), nothing is drawn or played.
+ * Per frame timings go to the optional CSV file, averages - to stdout.
+ */
+void Engine_HeadlessLoop()
+{
+    FILE *timing_file = NULL;
+    game_frame_timing_t sum = {0.0f, 0.0f, 0.0f, 0.0f};
+    float sum_logic = 0.0f;
+    float max_total = 0.0f;
+    float start_time = Sys_FloatTime();
+    int32_t frame = 0;
+
+    if(engine_timing_name)
+    {
+        timing_file = fopen(engine_timing_name, "w");
+        if(timing_file)
+        {
+            fprintf(timing_file, "frame;dt;total;logic;physics;animation;scripting\n");
+        }
+        else
+        {
+            Sys_Warn("Can not open frame timings file \"%s\"", engine_timing_name);
+        }
+    }
+
+    renderer.SetVisCacheCheck(engine_vis_check != 0);
+    Game_EnableFrameTiming(1);
+    while(!engine_done && ((engine_headless_frames <= 0) || (frame < engine_headless_frames)))
+    {
+        float time = GAME_LOGIC_REFRESH_INTERVAL;
+        const game_frame_timing_t *t = Game_GetFrameTiming();
+        float logic;
+
+        Sys_ResetTempMem();
+        if(Controls_IsPlayback())
+        {
+            if(!Controls_PlaybackFrame(&time))
+            {
+                break;
+            }
+        }
+        else if(engine_headless_frames <= 0)
+        {
+            break;
+        }
+        Controls_RecordFrame(time);
+
+        engine_frame_time = time;
+        Game_Frame(time);
+        Gameflow_ProcessCommands();
+        if(engine_vis_check)
+        {
+            Cam_Apply(&engine_camera);
+            Cam_RecalcClipPlanes(&engine_camera);
+            renderer.GenWorldList(&engine_camera);
+        }
+
+        logic = t->total - t->physics - t->animation - t->scripting;
+        if(timing_file)
+        {
+            fprintf(timing_file, "%d;%.6f;%.4f;%.4f;%.4f;%.4f;%.4f\n", frame, time,
+                    1000.0f * t->total, 1000.0f * logic, 1000.0f * t->physics,
+                    1000.0f * t->animation, 1000.0f * t->scripting);
+        }
+        sum.total += t->total;
+        sum.physics += t->physics;
+        sum.animation += t->animation;
+        sum.scripting += t->scripting;
+        sum_logic += logic;
+        max_total = (t->total > max_total) ? (t->total) : (max_total);
+        ++frame;
+    }
+    Game_EnableFrameTiming(0);
+
+    if(timing_file)
+    {
+        fclose(timing_file);
+    }
+
+    if(frame > 0)
+    {
+        float k = 1000.0f / (float)frame;
+        printf("headless: %d frames in %.3f s\n", frame, Sys_FloatTime() - start_time);
+        printf("avg ms: total %.4f (max %.4f); logic %.4f; physics %.4f; animation %.4f; scripting %.4f\n",
+               k * sum.total, 1000.0f * max_total, k * sum_logic, k * sum.physics, k * sum.animation, k * sum.scripting);
+    }
+
+    if(engine_vis_check)
+    {
+        render_vis_stats_t vis;
+        renderer.GetVisStats(&vis);
+        renderer.SetVisCacheCheck(false);
+        printf("vis_check: %u frames, %u reused lists (%u turned), %u checked, %u miss rooms (%u rooms missed, %u extra)\n",
+               vis.frames, vis.cached_frames, vis.turned_frames, vis.checked_frames, vis.failed_frames, vis.missed_rooms, vis.extra_rooms);
+        if(vis.failed_frames)
+        {
+            Sys_Warn("vis_check: reused visibility lists miss rooms of exact portals traversal");
+        }
     }
 }
 
@@ -1063,6 +1334,33 @@ void ShowModelView(float time)
 }
 
 
+/**
+ * Profiler overlay: main thread zones of the last frame (nested ones are
+ * indented), smoothed and worst values, then GPU zones if measured.
+ */
+void Engine_ShowProfiler()
+{
+    const prof_zone_stats_t *zones;
+    float x = (float)screen_info.w - 420.0f * screen_info.scale_factor;
+    float y = (float)screen_info.h;
+    const float dy = -18.0f * screen_info.scale_factor;
+    const float dx = 12.0f * screen_info.scale_factor;
+    uint32_t count = Prof_GetFrameZones(&zones);
+
+    GLText_OutTextXY(x, y += dy, "PROFILER: frame %.2f ms (ms: last / avg / max)", Prof_GetFrameTime());
+    for(uint32_t i = 0; i < count; i++, zones++)
+    {
+        GLText_OutTextXY(x + dx * zones->depth, y += dy, "%s x%d: %.2f / %.2f / %.2f", zones->name, (int)zones->calls, zones->ms, zones->avg_ms, zones->max_ms);
+    }
+
+    count = Prof_GetGPUZones(&zones);
+    for(uint32_t i = 0; i < count; i++, zones++)
+    {
+        GLText_OutTextXY(x, y += dy, "GPU %s: %.2f / %.2f / %.2f", zones->name, zones->ms, zones->avg_ms, zones->max_ms);
+    }
+}
+
+
 void ShowDebugInfo()
 {
     float y = (float)screen_info.h;
@@ -1099,7 +1397,7 @@ void ShowDebugInfo()
                             Trigger_TrigTypeToStr(trig_type, 64, rs->trigger->sub_function);
                             Trigger_TrigMaskToStr(trig_mask, rs->trigger->mask);
                             GLText_OutTextXY(30.0f, y += dy, "trig(sub = %s, val = 0x%X, mask = 0b%s, timer = %d)", trig_type, rs->trigger->function_value, trig_mask, rs->trigger->timer);
-                            for(trigger_command_p cmd = rs->trigger->commands; cmd; cmd = cmd->next)
+                            for(trigger_command_p cmd = rs->trigger->commands; cmd < rs->trigger->commands + rs->trigger->commands_count; ++cmd)
                             {
                                 entity_p trig_obj = World_GetEntityByID(cmd->operands);
                                 if(trig_obj)
@@ -1182,7 +1480,7 @@ void ShowDebugInfo()
                             Trigger_TrigTypeToStr(trig_type, 64, rs->trigger->sub_function);
                             Trigger_TrigMaskToStr(trig_mask, rs->trigger->mask);
                             GLText_OutTextXY(30.0f, y += dy, "trig(sub = %s, val = 0x%X, mask = 0b%s, timer = %d)", trig_type, rs->trigger->function_value, trig_mask, rs->trigger->timer);
-                            for(trigger_command_p cmd = rs->trigger->commands; cmd; cmd = cmd->next)
+                            for(trigger_command_p cmd = rs->trigger->commands; cmd < rs->trigger->commands + rs->trigger->commands_count; ++cmd)
                             {
                                 entity_p trig_obj = World_GetEntityByID(cmd->operands);
                                 if(trig_obj)
@@ -1309,6 +1607,33 @@ void ShowDebugInfo()
                 GLText_OutTextXY(30.0f, y += dy, "input polygons = %07d", renderer.dynamicBSP->GetInputPolygonsCount());
                 GLText_OutTextXY(30.0f, y += dy, "added polygons = %07d", renderer.dynamicBSP->GetAddedPolygonsCount());
             }
+            GLText_OutTextXY(30.0f, y += dy, "transparency mode = %s, BSP = %.3f ms, sorted = %.3f ms",
+                             (renderer.settings.transparency_mode == R_TRANSPARENCY_SORTED) ? ("sorted") : ("BSP"),
+                             renderer.GetTransparencyTime(R_TRANSPARENCY_BSP), renderer.GetTransparencyTime(R_TRANSPARENCY_SORTED));
+            if(renderer.transparencyQueue)
+            {
+                const render_queue_stats_t *stats = renderer.transparencyQueue->GetStats();
+                GLText_OutTextXY(30.0f, y += dy, "sorted packets = %05d, draw calls = %05d, blend changes = %04d", stats->packets, stats->draw_calls, stats->blend_changes);
+            }
+            break;
+
+        case debug_view_state_e::render_info:
+            GLText_OutTextXY(30.0f, y += dy, "VIEW: Render queue info");
+            if(renderer.renderQueue)
+            {
+                const render_queue_stats_t *stats = renderer.renderQueue->GetStats();
+                GLText_OutTextXY(30.0f, y += dy, "packets = %05d, objects = %05d, draw calls = %05d", stats->packets, stats->objects, stats->draw_calls);
+                GLText_OutTextXY(30.0f, y += dy, "program binds = %04d, texture binds = %04d", stats->program_binds, stats->texture_binds);
+                GLText_OutTextXY(30.0f, y += dy, "buffer binds = %04d, uniform updates = %04d", stats->buffer_binds, stats->uniform_updates);
+                GLText_OutTextXY(30.0f, y += dy, "instanced draws = %04d, instances = %05d", stats->instanced_draws, stats->instances);
+                GLText_OutTextXY(30.0f, y += dy, "multi draws = %04d, ranges = %05d", stats->multi_draws, stats->multi_draw_ranges);
+                GLText_OutTextXY(30.0f, y += dy, "upload bytes = %07d", stats->upload_bytes);
+            }
+            if(renderer.lightCache)
+            {
+                const light_cache_stats_t *stats = renderer.lightCache->GetStats();
+                GLText_OutTextXY(30.0f, y += dy, "light selections = %04d, reused = %04d", stats->selections, stats->hits);
+            }
             break;
 
         case debug_view_state_e::model_view:
@@ -1324,25 +1649,134 @@ void ShowDebugInfo()
 
 void Engine_TakeScreenShot()
 {
-    GLint ViewPort[4];
-    char fname[128];
-    GLubyte *pixels;
-    uint32_t str_size;
+    engine_capture.requested = 1;
+}
+
+
+void Engine_RecordFrames(uint32_t every)
+{
+    engine_capture.record_every = every;
+    engine_capture.record_frame = 0;
+}
 
-    time_t now = time(0);
-    struct tm tstruct = *localtime(&now);
-    char buf[80];
-    strftime(buf, sizeof(buf), "%Y%m%d_%H%M%S", &tstruct);
 
-    qglGetIntegerv(GL_VIEWPORT, ViewPort);
-    snprintf(fname, sizeof(fname), "screen_%s.png", buf);
+static void Engine_CaptureRead(uint32_t slot)
+{
+    screen_capture_p cap = &engine_capture;
+    uint8_t *pixels = NULL;
+    const void *data;
 
-    str_size = ViewPort[2] * 4;
-    pixels = (GLubyte*)malloc(str_size * ViewPort[3]);
-    qglReadPixels(0, 0, ViewPort[2], ViewPort[3], GL_RGBA, GL_UNSIGNED_BYTE, pixels);
-    Image_Save(fname, IMAGE_FORMAT_PNG, (uint8_t*)pixels, ViewPort[2], ViewPort[3], 32);
+    qglBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, cap->pbo[slot]);
+    data = qglMapBufferARB(GL_PIXEL_PACK_BUFFER_ARB, GL_READ_ONLY_ARB);
+    if(data)
+    {
+        pixels = (uint8_t*)malloc(cap->pbo_size[slot]);
+        memcpy(pixels, data, cap->pbo_size[slot]);
+        qglUnmapBufferARB(GL_PIXEL_PACK_BUFFER_ARB);
+    }
+    qglBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, 0);
+    cap->pending[slot] = 0;
 
-    free(pixels);
+    if(!pixels)
+    {
+        Sys_Warn("screenshot: can not map pixel buffer");
+    }
+    else if(!ImageWriter_Push(cap->file_name[slot], cap->format[slot], pixels, cap->width[slot], cap->height[slot], 32))
+    {
+        Sys_DebugLog(SYS_LOG_FILENAME, "screenshot: writer queue is full, \"%s\" dropped", cap->file_name[slot]);
+    }
+}
+
+/*
+ * Called before swap: maps buffer, read on previous capture, then starts
+ * async read of this frame, if screenshot is requested or frame is recorded.
+ */
+void Engine_CaptureFrame()
+{
+    screen_capture_p cap = &engine_capture;
+    uint32_t slot = cap->current;
+    int record = 0;
+    GLint viewport[4];
+
+    if(cap->pending[slot ^ 1])
+    {
+        Engine_CaptureRead(slot ^ 1);
+    }
+
+    if(cap->record_every > 0)
+    {
+        record = (cap->record_frame % cap->record_every) == 0;
+        cap->record_frame++;
+    }
+
+    if(!cap->requested && !record)
+    {
+        return;
+    }
+
+    if(cap->pending[slot])
+    {
+        Engine_CaptureRead(slot);
+    }
+
+    qglGetIntegerv(GL_VIEWPORT, viewport);
+    cap->width[slot] = viewport[2];
+    cap->height[slot] = viewport[3];
+    if(cap->requested)
+    {
+        time_t now = time(0);
+        struct tm tstruct = *localtime(&now);
+        char buf[80];
+        strftime(buf, sizeof(buf), "%Y%m%d_%H%M%S", &tstruct);
+        snprintf(cap->file_name[slot], IMAGE_WRITER_MAX_FILE_NAME, "screen_%s.png", buf);
+        cap->format[slot] = IMAGE_FORMAT_PNG;
+        cap->requested = 0;
+    }
+    else
+    {
+        // cheap to encode, so writer keeps up with recording
+        snprintf(cap->file_name[slot], IMAGE_WRITER_MAX_FILE_NAME, "record_%.6d.tga", cap->record_count++);
+        cap->format[slot] = IMAGE_FORMAT_TGA;
+    }
+
+    if(!cap->pbo[slot])
+    {
+        qglGenBuffersARB(1, cap->pbo + slot);
+    }
+    qglBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, cap->pbo[slot]);
+    if(cap->pbo_size[slot] != (GLsizeiptr)viewport[2] * viewport[3] * 4)
+    {
+        cap->pbo_size[slot] = (GLsizeiptr)viewport[2] * viewport[3] * 4;
+        qglBufferDataARB(GL_PIXEL_PACK_BUFFER_ARB, cap->pbo_size[slot], NULL, GL_STREAM_READ_ARB);
+    }
+    qglPixelStorei(GL_PACK_ALIGNMENT, 4);
+    qglReadPixels(0, 0, viewport[2], viewport[3], GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    qglBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, 0);
+
+    cap->pending[slot] = 1;
+    cap->current = slot ^ 1;
+}
+
+
+void Engine_CaptureDestroy()
+{
+    screen_capture_p cap = &engine_capture;
+
+    for(uint32_t i = 0; i < SCREEN_CAPTURE_PBO_COUNT; i++)
+    {
+        uint32_t slot = (cap->current + 1 + i) % SCREEN_CAPTURE_PBO_COUNT;     // older one first
+        if(cap->pending[slot])
+        {
+            Engine_CaptureRead(slot);
+        }
+        if(cap->pbo[slot])
+        {
+            qglDeleteBuffersARB(1, cap->pbo + slot);
+            cap->pbo[slot] = 0;
+            cap->pbo_size[slot] = 0;
+        }
+    }
+    cap->record_every = 0;
 }
 
 
@@ -1575,6 +2009,10 @@ extern "C" int Engine_ExecCmd(char *ch)
             Con_AddLine("cvars - lua's table of cvar's, to see them type: show_table(cvars)\0", FONTSTYLE_CONSOLE_NOTIFY);
             Con_AddLine("free_look - switch camera mode\0", FONTSTYLE_CONSOLE_NOTIFY);
             Con_AddLine("r_crosshair - switch crosshair visibility\0", FONTSTYLE_CONSOLE_NOTIFY);
+            Con_AddLine("r_transparency - switch transparency mode: dynamic BSP / sorted batches\0", FONTSTYLE_CONSOLE_NOTIFY);
+            Con_AddLine("r_skinning - switch skeletal models drawing: per bone / bone matrices palette\0", FONTSTYLE_CONSOLE_NOTIFY);
+            Con_AddLine("screenshot - save screen to png, record_frames n - save every n-th frame to tga, 0 - stop\0", FONTSTYLE_CONSOLE_NOTIFY);
+            Con_AddLine("prof - switch frame profiler and its overlay, prof_dump [file] - write profiler trace (chrome://tracing)\0", FONTSTYLE_CONSOLE_NOTIFY);
             Con_AddLine("cam_distance - camera distance to actor\0", FONTSTYLE_CONSOLE_NOTIFY);
             Con_AddLine("r_wireframe, r_portals, r_frustums, r_room_boxes, r_boxes, r_normals, r_skip_room, r_flyby, r_cinematics, r_triggers, r_ai_boxes, r_cameras - render modes, r_path - show character path\0", FONTSTYLE_CONSOLE_NOTIFY);
             Con_AddLine("playsound(id) - play specified sound\0", FONTSTYLE_CONSOLE_NOTIFY);
@@ -1737,6 +2175,53 @@ extern "C" int Engine_ExecCmd(char *ch)
             screen_info.crosshair = !screen_info.crosshair;
             return 1;
         }
+        else if(!strcmp(token, "prof"))
+        {
+            screen_info.show_profiler = !screen_info.show_profiler;
+            Prof_SetEnabled(screen_info.show_profiler);
+            return 1;
+        }
+        else if(!strcmp(token, "prof_dump"))
+        {
+            ch = SC_ParseToken(ch, token, sizeof(token));
+            const char *file_name = (ch) ? (token) : ("profile.json");
+            if(Prof_DumpTrace(file_name))
+            {
+                Con_Notify("profiler trace saved to %s", file_name);
+            }
+            else
+            {
+                Con_Warning("can not write profiler trace to %s", file_name);
+            }
+            return 1;
+        }
+        else if(!strcmp(token, "r_transparency"))
+        {
+            renderer.settings.transparency_mode = (renderer.settings.transparency_mode == R_TRANSPARENCY_SORTED) ? (R_TRANSPARENCY_BSP) : (R_TRANSPARENCY_SORTED);
+            Con_Notify("transparency mode = %s", (renderer.settings.transparency_mode == R_TRANSPARENCY_SORTED) ? ("sorted") : ("BSP"));
+            return 1;
+        }
+        else if(!strcmp(token, "r_skinning"))
+        {
+            renderer.settings.skinning = !renderer.settings.skinning;
+            Con_Notify("skeletal models drawing = %s", (renderer.settings.skinning) ? ("bone matrices palette") : ("per bone"));
+            return 1;
+        }
+        else if(!strcmp(token, "screenshot"))
+        {
+            Engine_TakeScreenShot();
+            return 1;
+        }
+        else if(!strcmp(token, "record_frames"))
+        {
+            image_writer_stats_t stats;
+            int every = SC_ParseInt(&ch);
+            Engine_RecordFrames((every > 0) ? (every) : (0));
+            ImageWriter_GetStats(&stats);
+            Con_Notify("record frames: every = %d, written = %u, dropped = %u, failed = %u",
+                       (every > 0) ? (every) : (0), stats.written, stats.dropped, stats.failed);
+            return 1;
+        }
         else if(!strcmp(token, "room_info"))
         {
             room_p r = engine_camera.current_room;
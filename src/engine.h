@@ -81,6 +81,7 @@ void Engine_JoyRumble(float power, int time);
 
 void Engine_GLSwapWindow();
 void Engine_MainLoop();
+int  Engine_IsHeadless();
 
 // PC-specific level loader routines.
 
@@ -89,6 +90,7 @@ bool Engine_LoadPCLevel(const char *name);
 // General level loading routines.
 
 void Engine_TakeScreenShot();
+void Engine_RecordFrames(uint32_t every);
 void Engine_GetLevelName(char *name, const char *path);
 void Engine_GetLevelScriptNameLocal(const char *level_path, int game_version, char *name, uint32_t buf_size);
 int  Engine_LoadMap(const char *name);
@@ -0,0 +1,1598 @@
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_platform.h>
+#include <SDL2/SDL_opengl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern "C" {
+#include <lua.h>
+#include <lualib.h>
+#include <lauxlib.h>
+}
+
+#include "core/arena.h"
+#include "core/system.h"
+#include "core/gl_util.h"
+#include "core/vmath.h"
+#include "core/obb.h"
+#include "core/parallel.h"
+#include "render/render.h"
+#include "render/bordered_texture_atlas.h"
+#include "script/script.h"
+#include "fmv/tiny_codec.h"
+extern "C" {
+#include "fmv/internal/avcodec.h"
+}
+#include "vt/vt_level.h"
+#include "audio/audio.h"
+#include "audio/audio_cache.h"
+#include "mesh.h"
+#include "skeletal_model.h"
+#include "entity.h"
+#include "room.h"
+#include "world.h"
+#include "engine.h"
+#include "engine_checks.h"
+#include "render/light_cache.h"
+#include "render/render_queue.h"
+#include "image.h"
+#include "image_writer.h"
+
+
+#define ENGINE_BENCH_NONE           (0)
+#define ENGINE_BENCH_LOAD           (1)
+#define ENGINE_BENCH_ATLAS          (2)
+#define ENGINE_BENCH_TASKS          (3)
+#define ENGINE_BENCH_SAMPLES        (4)
+#define ENGINE_BENCH_TEXTILES       (5)
+#define ENGINE_BENCH_SKIN           (6)
+#define ENGINE_BENCH_ADPCM          (7)
+#define ENGINE_BENCH_QUEUE          (8)
+#define ENGINE_BENCH_ATLAS_CHECK    (9)
+#define ENGINE_BENCH_WRITER         (10)
+#define ENGINE_BENCH_AUDIO_CACHE    (11)
+#define ATLAS_BENCH_PAGE_SIZE       (4096)
+static const char              *engine_load_bench_name = NULL;
+static int32_t                  engine_load_bench_count = 0;
+static int                      engine_bench = ENGINE_BENCH_NONE;
+
+
+extern lua_State               *engine_lua;
+extern "C" void adpcm_decode_init(struct tiny_codec_s *avctx);
+
+void Engine_LoadBench();
+void Engine_AtlasBench();
+void Engine_AtlasCheck();
+void Engine_TasksBench();
+void Engine_SamplesBench();
+void Engine_TextileCheck();
+void Engine_SkinCheck();
+void Engine_AdpcmCheck();
+void Engine_QueueCheck();
+void Engine_WriterCheck();
+void Engine_AudioCacheCheck();
+
+
+int Engine_ChecksParseArg(int argc, char **argv, int *i)
+{
+    if(0 == strncmp(argv[*i], "-load_bench", 11))
+    {
+        if(*i + 2 < argc)
+        {
+            engine_bench = ENGINE_BENCH_LOAD;
+            engine_load_bench_name = argv[*i + 1];
+            engine_load_bench_count = atoi(argv[*i + 2]);
+        }
+        *i += 2;
+    }
+    else if(0 == strncmp(argv[*i], "-atlas_check", 12))
+    {
+        if(*i + 1 < argc)
+        {
+            engine_bench = ENGINE_BENCH_ATLAS_CHECK;
+            engine_load_bench_name = argv[*i + 1];
+        }
+        ++*i;
+    }
+    else if(0 == strncmp(argv[*i], "-atlas_bench", 12))
+    {
+        if(*i + 1 < argc)
+        {
+            engine_bench = ENGINE_BENCH_ATLAS;
+            engine_load_bench_name = argv[*i + 1];
+        }
+        ++*i;
+    }
+    else if(0 == strncmp(argv[*i], "-samples_bench", 14))
+    {
+        if(*i + 1 < argc)
+        {
+            engine_bench = ENGINE_BENCH_SAMPLES;
+            engine_load_bench_name = argv[*i + 1];
+        }
+        ++*i;
+    }
+    else if(0 == strncmp(argv[*i], "-textile_check", 14))
+    {
+        if(*i + 1 < argc)
+        {
+            engine_bench = ENGINE_BENCH_TEXTILES;
+            engine_load_bench_name = argv[*i + 1];
+        }
+        ++*i;
+    }
+    else if(0 == strncmp(argv[*i], "-skin_check", 11))
+    {
+        if(*i + 1 < argc)
+        {
+            engine_bench = ENGINE_BENCH_SKIN;
+            engine_load_bench_name = argv[*i + 1];
+        }
+        ++*i;
+    }
+    else if(0 == strncmp(argv[*i], "-adpcm_check", 12))
+    {
+        engine_bench = ENGINE_BENCH_ADPCM;
+    }
+    else if(0 == strncmp(argv[*i], "-writer_check", 13))
+    {
+        if(*i + 1 < argc)
+        {
+            engine_bench = ENGINE_BENCH_WRITER;
+            engine_load_bench_name = argv[*i + 1];
+        }
+        ++*i;
+    }
+    else if(0 == strncmp(argv[*i], "-audio_cache_check", 18))
+    {
+        engine_bench = ENGINE_BENCH_AUDIO_CACHE;
+        if((*i + 1 < argc) && (argv[*i + 1][0] != '-'))
+        {
+            engine_load_bench_name = argv[++*i];
+        }
+    }
+    else if(0 == strncmp(argv[*i], "-queue_check", 12))
+    {
+        engine_bench = ENGINE_BENCH_QUEUE;
+        if((*i + 1 < argc) && (argv[*i + 1][0] != '-'))
+        {
+            engine_load_bench_name = argv[++*i];
+        }
+    }
+    else if(0 == strncmp(argv[*i], "-tasks_bench", 12))
+    {
+        if(*i + 1 < argc)
+        {
+            engine_bench = ENGINE_BENCH_TASKS;
+            engine_load_bench_count = atoi(argv[*i + 1]);
+        }
+        ++*i;
+    }
+    else
+    {
+        return 0;
+    }
+
+    return 1;
+}
+
+
+void Engine_ChecksUsage()
+{
+    puts("-load_bench \"path_to_level_file\" count (headless, load and unload level count times)");
+    puts("-atlas_bench \"path_to_level_file\" (headless, pack level textures with every atlas packer)");
+    puts("-atlas_check \"path_to_level_file\" (headless, check every atlas packer layout: bounds, overlaps, page count against BSP)");
+    puts("-samples_bench \"path_to_level_file\" (headless, decode level samples as before and in parallel, compare ranges and PCM)");
+    puts("-textile_check \"path_to_level_file\" (headless, compare textile conversion and atlas pages with scalar code)");
+    puts("-skin_check \"path_to_level_file\" (headless, compare palette skinning with per bone transforms)");
+    puts("-adpcm_check (headless, decode fixed IMA ADPCM streams, compare with golden vectors)");
+    puts("-queue_check [\"path_to_level_file\"] (headless, submit fixed render queue scenes without GL, compare state changes with expected; with level: count static mesh instanced draws)");
+    puts("-writer_check \"path_to_folder\" (headless, write synthetic frames by image writer, check files and written / dropped / failed counters)");
+    puts("-audio_cache_check [\"path_to_level_file\"] (headless, compare samples cache with reference LRU model; with level: time samples loading with empty and filled cache)");
+    puts("-tasks_bench count (headless, run count timed script tasks with old and native scheduler)");
+}
+
+
+int Engine_ChecksRun()
+{
+    switch(engine_bench)
+    {
+        case ENGINE_BENCH_LOAD:
+            Engine_LoadBench();
+            break;
+
+        case ENGINE_BENCH_ATLAS:
+            Engine_AtlasBench();
+            break;
+
+        case ENGINE_BENCH_ATLAS_CHECK:
+            Engine_AtlasCheck();
+            break;
+
+        case ENGINE_BENCH_TASKS:
+            Engine_TasksBench();
+            break;
+
+        case ENGINE_BENCH_SAMPLES:
+            Engine_SamplesBench();
+            break;
+
+        case ENGINE_BENCH_TEXTILES:
+            Engine_TextileCheck();
+            break;
+
+        case ENGINE_BENCH_SKIN:
+            Engine_SkinCheck();
+            break;
+
+        case ENGINE_BENCH_ADPCM:
+            Engine_AdpcmCheck();
+            break;
+
+        case ENGINE_BENCH_QUEUE:
+            Engine_QueueCheck();
+            break;
+
+        case ENGINE_BENCH_WRITER:
+            Engine_WriterCheck();
+            break;
+
+        case ENGINE_BENCH_AUDIO_CACHE:
+            Engine_AudioCacheCheck();
+            break;
+
+        default:
+            return 0;
+    };
+
+    return 1;
+}
+
+
+/*
+ * Level load benchmark: loads and unloads one level, prints load / unload
+ * wall time, level arena size and peak RSS of the process.
+ */
+void Engine_LoadBench()
+{
+    float sum_load = 0.0f;
+    float sum_unload = 0.0f;
+    int32_t loads = 0;
+    audio_cache_stats_t cache_stats;
+
+    for(; loads < engine_load_bench_count; loads++)
+    {
+        float t0 = Sys_FloatTime();
+        if(!Engine_LoadMap(engine_load_bench_name))
+        {
+            Sys_Warn("load_bench: can not load \"%s\"", engine_load_bench_name);
+            break;
+        }
+        float t1 = Sys_FloatTime();
+        size_t arena_kb = Arena_GetStats()->used_bytes / 1024;
+
+        renderer.ResetWorld(NULL, 0, NULL, 0);
+        World_Clear();
+        float t2 = Sys_FloatTime();
+
+        sum_load += t1 - t0;
+        sum_unload += t2 - t1;
+        printf("load_bench: %d: load %.3f s, unload %.3f s, arena %u KB, peak RSS %u KB\n",
+               loads, t1 - t0, t2 - t1, (uint32_t)arena_kb, (uint32_t)Sys_GetPeakRSS());
+        if(Audio_GetSamplesCacheStats(&cache_stats))
+        {
+            printf("load_bench: %d: samples cache %u entries, %u KB, %u hits, %u misses, %u evictions\n", loads, cache_stats.entries,
+                   (uint32_t)(cache_stats.size / 1024), cache_stats.hits, cache_stats.misses, cache_stats.evictions);
+        }
+    }
+
+    if(loads > 0)
+    {
+        printf("load_bench: %d loads, avg load %.3f s, avg unload %.3f s, peak RSS %u KB\n",
+               loads, sum_load / (float)loads, sum_unload / (float)loads, (uint32_t)Sys_GetPeakRSS());
+    }
+}
+
+/*
+ * Packs level textures with every rect packer on CPU only (fixed page size,
+ * no GL context needed) and prints page count and fill of each page.
+ */
+void Engine_AtlasBench()
+{
+    int trv = VT_Level::get_PC_level_version(engine_load_bench_name);
+    int border = renderer.settings.texture_border;
+    VT_Level *tr;
+
+    if(trv == TR_UNKNOWN)
+    {
+        Sys_Warn("atlas_bench: can not load \"%s\"", engine_load_bench_name);
+        return;
+    }
+
+    tr = new VT_Level();
+    tr->read_level(engine_load_bench_name, trv);
+    tr->prepare_level();
+    border = (border < 0) ? (0) : ((border > 128) ? (128) : (border));
+    printf("atlas_bench: \"%s\": %u textiles, %u object textures, %u sprite textures, border %d\n", engine_load_bench_name,
+           (uint32_t)tr->textile32_count, (uint32_t)tr->object_textures_count, (uint32_t)tr->sprite_textures_count, border);
+
+    for(int packer = 0; packer < RECT_PACKER_TYPES_COUNT; packer++)
+    {
+        float t0 = Sys_FloatTime();
+        bordered_texture_atlas *atlas = new bordered_texture_atlas(border, tr->textile32_count, tr->textile32,
+                                                                   tr->object_textures_count, tr->object_textures,
+                                                                   tr->sprite_textures_count, tr->sprite_textures,
+                                                                   packer, ATLAS_BENCH_PAGE_SIZE);
+        float t1 = Sys_FloatTime();
+        unsigned long pages = atlas->getNumAtlasPages();
+        float used = 0.0f;
+        float total = 0.0f;
+
+        for(unsigned long i = 0; i < pages; i++)
+        {
+            float area = (float)atlas->getPageWidth() * (float)atlas->getPageHeight(i);
+            used += area * atlas->getPageOccupancy(i);
+            total += area;
+        }
+        printf("atlas_bench: %s: %lu pages, %.1f%% filled, layout %.2f ms\n", RectPacker_GetName(packer), pages,
+               (total > 0.0f) ? (100.0f * used / total) : (0.0f), 1000.0f * (t1 - t0));
+        for(unsigned long i = 0; i < pages; i++)
+        {
+            printf("    page %lu: %ux%u, %.1f%% used\n", i, atlas->getPageWidth(), atlas->getPageHeight(i),
+                   100.0f * atlas->getPageOccupancy(i));
+        }
+        delete atlas;
+    }
+
+    delete tr;
+}
+
+/*
+ * Atlas check: every rect packer gets a fixed LCG sequence of rectangles on
+ * one page, placements are checked against page bounds and each other, used
+ * area is summed from them and a failed placement must leave it unchanged.
+ * Then level textures are laid out for a few page sizes and borders, layout
+ * must pass bordered_texture_atlas::checkLayout() and default (maxrects)
+ * packer may not take more pages than BSP one; skyline is only reported,
+ * it loses a page on small pages sometimes.
+ */
+#define ATLAS_CHECK_PAGE_SIZE       (1024)
+#define ATLAS_CHECK_RECTS           (3000)
+
+typedef struct atlas_check_rect_s
+{
+    unsigned    x;
+    unsigned    y;
+    unsigned    width;
+    unsigned    height;
+}atlas_check_rect_t, *atlas_check_rect_p;
+
+static uint32_t Engine_AtlasCheckRand(uint32_t *seed)
+{
+    *seed = *seed * 1664525U + 1013904223U;
+    return *seed >> 16;
+}
+
+static uint32_t Engine_AtlasCheckPacker(int type, atlas_check_rect_p rects, uint32_t *placed_count)
+{
+    rect_packer_p packer = RectPacker_Create(type, ATLAS_CHECK_PAGE_SIZE, ATLAS_CHECK_PAGE_SIZE);
+    unsigned long area = 0;
+    uint32_t seed = 1;
+    uint32_t placed = 0;
+    uint32_t errors = 0;
+
+    for(uint32_t i = 0; i < ATLAS_CHECK_RECTS; i++)
+    {
+        atlas_check_rect_p r = rects + placed;
+        uint32_t big = (Engine_AtlasCheckRand(&seed) % 16 == 0) ? (256) : (48);
+        r->width = 1 + Engine_AtlasCheckRand(&seed) % big;
+        r->height = 1 + Engine_AtlasCheckRand(&seed) % big;
+        if(RectPacker_FindSpaceFor(packer, r->width, r->height, &r->x, &r->y))
+        {
+            area += (unsigned long)r->width * r->height;
+            placed++;
+        }
+        if(RectPacker_GetUsedArea(packer) != area)
+        {
+            errors++;                                                           // wrong area or failed call changed state
+            area = RectPacker_GetUsedArea(packer);
+        }
+    }
+    RectPacker_Destroy(packer);
+
+    for(uint32_t i = 0; i < placed; i++)
+    {
+        atlas_check_rect_p a = rects + i;
+        if((a->x + a->width > ATLAS_CHECK_PAGE_SIZE) || (a->y + a->height > ATLAS_CHECK_PAGE_SIZE))
+        {
+            errors++;
+            continue;
+        }
+        for(uint32_t j = i + 1; j < placed; j++)
+        {
+            atlas_check_rect_p b = rects + j;
+            if((b->x < a->x + a->width) && (a->x < b->x + b->width) && (b->y < a->y + a->height) && (a->y < b->y + b->height))
+            {
+                errors++;
+            }
+        }
+    }
+
+    *placed_count = placed;
+    return errors;
+}
+
+void Engine_AtlasCheck()
+{
+    static const unsigned page_sizes[] = {256, 512, 4096};
+    static const int borders[] = {0, 8};
+    int trv = VT_Level::get_PC_level_version(engine_load_bench_name);
+    atlas_check_rect_p rects = (atlas_check_rect_p)malloc(ATLAS_CHECK_RECTS * sizeof(atlas_check_rect_t));
+    uint32_t failed = 0;
+    VT_Level *tr;
+
+    for(int packer = 0; packer < RECT_PACKER_TYPES_COUNT; packer++)
+    {
+        uint32_t placed = 0;
+        uint32_t errors = Engine_AtlasCheckPacker(packer, rects, &placed);
+        printf("atlas_check: %s: %u of %u rects placed on %dx%d page, %u errors\n", RectPacker_GetName(packer),
+               placed, ATLAS_CHECK_RECTS, ATLAS_CHECK_PAGE_SIZE, ATLAS_CHECK_PAGE_SIZE, errors);
+        failed += errors;
+    }
+    free(rects);
+
+    if(trv == TR_UNKNOWN)
+    {
+        Sys_Warn("atlas_check: can not load \"%s\"", engine_load_bench_name);
+        return;
+    }
+
+    tr = new VT_Level();
+    tr->read_level(engine_load_bench_name, trv);
+    tr->prepare_level();
+    printf("atlas_check: \"%s\": %u textiles, %u object textures, %u sprite textures\n", engine_load_bench_name,
+           (uint32_t)tr->textile32_count, (uint32_t)tr->object_textures_count, (uint32_t)tr->sprite_textures_count);
+
+    for(size_t s = 0; s < sizeof(page_sizes) / sizeof(page_sizes[0]); s++)
+    {
+        for(size_t b = 0; b < sizeof(borders) / sizeof(borders[0]); b++)
+        {
+            unsigned long bsp_pages = 0;
+            for(int packer = 0; packer < RECT_PACKER_TYPES_COUNT; packer++)
+            {
+                bordered_texture_atlas *atlas = new bordered_texture_atlas(borders[b], tr->textile32_count, tr->textile32,
+                                                                           tr->object_textures_count, tr->object_textures,
+                                                                           tr->sprite_textures_count, tr->sprite_textures,
+                                                                           packer, page_sizes[s]);
+                unsigned long pages = atlas->getNumAtlasPages();
+                unsigned long errors = atlas->checkLayout();
+
+                bsp_pages = (packer == RECT_PACKER_BSP) ? (pages) : (bsp_pages);
+                printf("atlas_check: page %u, border %d: %s: %lu pages, %lu layout errors%s\n", page_sizes[s], borders[b],
+                       RectPacker_GetName(packer), pages, errors, (pages > bsp_pages) ? (", more pages than bsp") : (""));
+                failed += errors + (((packer == RECT_PACKER_MAXRECTS) && (pages > bsp_pages)) ? (1) : (0));
+                delete atlas;
+            }
+        }
+    }
+    delete tr;
+
+    if(failed)
+    {
+        Sys_Warn("atlas_check: %u errors in atlas packers layout", failed);
+    }
+}
+
+/*
+ * Compares vectorised textile conversion and parallel atlas page blit with
+ * the original scalar loops: kernels, level textiles and every atlas page
+ * for a few border widths must be bit exact.
+ */
+void Engine_TextileCheck()
+{
+    static const int borders[] = {0, 8, 16};
+    int trv = VT_Level::get_PC_level_version(engine_load_bench_name);
+    size_t page_size = 4 * ATLAS_BENCH_PAGE_SIZE * ATLAS_BENCH_PAGE_SIZE;
+    uint32_t *pixels, *ref_pixels;
+    uint32_t diff, total_diff;
+    VT_Level *tr;
+
+    if(trv == TR_UNKNOWN)
+    {
+        Sys_Warn("textile_check: can not load \"%s\"", engine_load_bench_name);
+        return;
+    }
+
+    tr = new VT_Level();
+    tr->read_level(engine_load_bench_name, trv);
+    tr->prepare_level();
+    total_diff = tr->check_textiles();
+    printf("textile_check: \"%s\": %u textiles, conversion: %u pixels differ\n", engine_load_bench_name,
+           (uint32_t)tr->textile32_count, total_diff);
+
+    pixels = (uint32_t*)malloc(page_size);
+    ref_pixels = (uint32_t*)malloc(page_size);
+    for(size_t b = 0; b < sizeof(borders) / sizeof(borders[0]); b++)
+    {
+        bordered_texture_atlas *atlas = new bordered_texture_atlas(borders[b], tr->textile32_count, tr->textile32,
+                                                                   tr->object_textures_count, tr->object_textures,
+                                                                   tr->sprite_textures_count, tr->sprite_textures,
+                                                                   RECT_PACKER_MAXRECTS, ATLAS_BENCH_PAGE_SIZE);
+        unsigned long pages = atlas->getNumAtlasPages();
+        diff = 0;
+        for(unsigned long i = 0; i < pages; i++)
+        {
+            size_t count = (size_t)atlas->getPageWidth() * atlas->getPageHeight(i);
+            // not covered pixels keep the fill, so missing writes are seen too
+            memset(pixels, 0xA5, page_size);
+            memset(ref_pixels, 0xA5, page_size);
+            atlas->getPagePixels(i, pixels);
+            atlas->getPagePixelsReference(i, ref_pixels);
+            for(size_t j = 0; j < count; j++)
+            {
+                diff += (pixels[j] != ref_pixels[j]) ? (1) : (0);
+            }
+        }
+        printf("textile_check: border %d: %lu pages, %u pixels differ\n", borders[b], pages, diff);
+        total_diff += diff;
+        delete atlas;
+    }
+    free(pixels);
+    free(ref_pixels);
+    delete tr;
+
+    if(total_diff)
+    {
+        Sys_Warn("textile_check: vectorised textile code differs from scalar one");
+    }
+}
+
+/*
+ * Skin check: model space vertices of every bone by the palette (CPU copy of
+ * the skinned shader math) and by the per bone path (bone full transform of
+ * mesh, skin mesh from DrawSkinMesh transform) must match within rounding.
+ */
+typedef struct skin_check_s
+{
+    uint32_t    poses;
+    uint32_t    vertices;
+    uint32_t    failed;
+    float       max_position_error;
+    float       max_normal_error;
+}skin_check_t, *skin_check_p;
+
+static void Engine_SkinCheckPart(skin_check_p check, const mesh_skin_part_t *part, ss_bone_tag_p btag, const float *palette)
+{
+    size_t buf_size = part->mesh->vertex_count * 3 * sizeof(GLfloat);
+    GLfloat *positions = (GLfloat*)Sys_GetTempMem(2 * buf_size);
+    GLfloat *normals = positions + part->mesh->vertex_count * 3;
+    GLfloat *ref_positions = (GLfloat*)Sys_GetTempMem(2 * buf_size);
+    GLfloat *ref_normals = ref_positions + part->mesh->vertex_count * 3;
+
+    BaseMesh_SkinPart(part, palette, positions, normals);
+    if(part->skin_map)
+    {
+        BaseMesh_SkinMeshBoneSpace(part->mesh, part->parent_mesh, part->skin_map, btag->transform, ref_positions, ref_normals);
+    }
+    else
+    {
+        for(uint32_t i = 0; i < part->mesh->vertex_count; i++)
+        {
+            vec3_copy(ref_positions + 3 * i, part->mesh->vertices[i].position);
+            vec3_copy(ref_normals + 3 * i, part->mesh->vertices[i].normal);
+        }
+    }
+
+    for(uint32_t i = 0; i < part->mesh->vertex_count; i++)
+    {
+        float ref_p[3], ref_n[3], dp[3], dn[3], err_p, err_n;
+        Mat4_vec3_mul_macro(ref_p, btag->full_transform, ref_positions + 3 * i);
+        Mat4_vec3_rot_macro(ref_n, btag->full_transform, ref_normals + 3 * i);
+        vec3_sub(dp, positions + 3 * i, ref_p);
+        vec3_sub(dn, normals + 3 * i, ref_n);
+        err_p = vec3_abs(dp);
+        err_n = vec3_abs(dn);
+        check->max_position_error = (err_p > check->max_position_error) ? (err_p) : (check->max_position_error);
+        check->max_normal_error = (err_n > check->max_normal_error) ? (err_n) : (check->max_normal_error);
+        // float rounding only: relative to position, normals are unit ones
+        check->failed += ((err_p > 1.0e-3f + 1.0e-5f * vec3_abs(ref_p)) || (err_n > 1.0e-4f)) ? (1) : (0);
+    }
+    check->vertices += part->mesh->vertex_count;
+
+    Sys_ReturnTempMem(4 * buf_size);
+}
+
+static void Engine_SkinCheckPose(skin_check_p check, ss_bone_frame_p bf)
+{
+    GLfloat palette[MESH_SKIN_MAX_BONES * MESH_SKIN_PALETTE_ROWS * 4];
+    ss_bone_tag_p btag = bf->bone_tags;
+
+    SSBoneFrame_FillBonePalette(bf, palette, MESH_SKIN_MAX_BONES);
+    for(uint16_t i = 0; i < bf->bone_tag_count; i++, btag++)
+    {
+        mesh_skin_part_t part = {(btag->mesh_replace) ? (btag->mesh_replace) : (btag->mesh_base), NULL, NULL, i, 0};
+        if(part.mesh && part.mesh->vertex_count)
+        {
+            Engine_SkinCheckPart(check, &part, btag, palette);
+        }
+        if(btag->mesh_skin && btag->parent && btag->skin_map && btag->mesh_skin->vertex_count)
+        {
+            mesh_skin_part_t skin = {btag->mesh_skin, btag->parent->mesh_base, btag->skin_map, i, btag->parent->index};
+            Engine_SkinCheckPart(check, &skin, btag, palette);
+        }
+    }
+    check->poses++;
+}
+
+static int Engine_SkinCheckEntity(struct entity_s *ent, void *data)
+{
+    if(ent->bf && (ent->bf->bone_tag_count > 1) && (ent->bf->bone_tag_count <= MESH_SKIN_MAX_BONES))
+    {
+        Engine_SkinCheckPose((skin_check_p)data, ent->bf);
+    }
+    return 0;
+}
+
+/*
+ * Checks entities of the level in their current poses (real skins, if level
+ * scripts set them) and every skeletal model in first and middle frames of
+ * its animations; models get synthetic skin meshes: every bone mesh is used
+ * as its skin, every second vertex is mapped to the parent mesh.
+ */
+void Engine_SkinCheck()
+{
+    skin_check_t check;
+    skeletal_model_p models = NULL;
+    uint32_t models_count = 0;
+
+    if(!Engine_LoadMap(engine_load_bench_name))
+    {
+        Sys_Warn("skin_check: can not load \"%s\"", engine_load_bench_name);
+        return;
+    }
+
+    memset(&check, 0, sizeof(check));
+    World_IterateAllEntities(Engine_SkinCheckEntity, &check);
+    printf("skin_check: entities: %u poses, %u vertices, max error position %g normal %g, %u failed\n",
+           check.poses, check.vertices, check.max_position_error, check.max_normal_error, check.failed);
+
+    uint32_t failed = check.failed;
+    memset(&check, 0, sizeof(check));
+    World_GetSkeletalModelsInfo(&models, &models_count);
+    for(uint32_t m = 0; m < models_count; m++)
+    {
+        skeletal_model_p model = models + m;
+        ss_bone_frame_t bf;
+        if((model->mesh_count < 2) || (model->mesh_count > MESH_SKIN_MAX_BONES) || !model->animation_count)
+        {
+            continue;
+        }
+
+        SSBoneFrame_CreateFromModel(&bf, model);
+        for(uint16_t i = 1; i < bf.bone_tag_count; i++)
+        {
+            ss_bone_tag_p btag = bf.bone_tags + i;
+            uint32_t parent_count = (btag->parent->mesh_base) ? (btag->parent->mesh_base->vertex_count) : (0);
+            if(btag->mesh_base && btag->mesh_base->vertex_count && parent_count)
+            {
+                btag->mesh_skin = btag->mesh_base;
+                btag->skin_map = (uint32_t*)malloc(btag->mesh_skin->vertex_count * sizeof(uint32_t));
+                for(uint32_t k = 0; k < btag->mesh_skin->vertex_count; k++)
+                {
+                    btag->skin_map[k] = (k & 1) ? (0xFFFFFFFF) : (k % parent_count);
+                }
+            }
+        }
+
+        for(uint16_t a = 0; a < model->animation_count; a++)
+        {
+            if(!model->animations[a].max_frame)
+            {
+                continue;
+            }
+            uint16_t frames[2] = {0, (uint16_t)(model->animations[a].max_frame / 2)};
+            for(int f = 0; f < 2; f++)
+            {
+                Anim_SetAnimation(&bf.animations, a, frames[f]);
+                SSBoneFrame_Update(&bf, 0.0f);
+                Engine_SkinCheckPose(&check, &bf);
+            }
+        }
+        SSBoneFrame_Clear(&bf);
+    }
+    printf("skin_check: %u models: %u poses, %u vertices, max error position %g normal %g, %u failed\n", models_count,
+           check.poses, check.vertices, check.max_position_error, check.max_normal_error, check.failed);
+    failed += check.failed;
+
+    renderer.ResetWorld(NULL, 0, NULL, 0);
+    World_Clear();
+
+    if(failed)
+    {
+        Sys_Warn("skin_check: palette skinning differs from per bone drawing");
+    }
+}
+
+/*
+ * ADPCM check: golden vectors of IMA decoders used by FMV audio. Packets come
+ * from a fixed LCG (C library independent), decoder state is carried through
+ * all packets of a stream. Expected values were produced by the scalar FFmpeg
+ * decoder with zeroed context (the first SEAD packet used garbage state
+ * before), its planar WAV / QT output interleaved as OpenAL plays it.
+ */
+#define ADPCM_CHECK_PACKETS         (32)
+#define ADPCM_CHECK_HEAD            (8)
+
+typedef struct adpcm_golden_s
+{
+    uint32_t    codec_tag;
+    uint16_t    channels;
+    uint16_t    packet_size;
+    uint32_t    samples;                                                        // per channel, all packets
+    uint32_t    hash;                                                           // FNV-1a of interleaved S16LE output
+    int16_t     head[ADPCM_CHECK_HEAD];                                         // first interleaved samples
+}adpcm_golden_t;
+
+static uint32_t Engine_AdpcmCheckRand(uint32_t *seed)
+{
+    *seed = *seed * 1664525U + 1013904223U;
+    return *seed >> 16;
+}
+
+static void Engine_AdpcmCheckPacket(uint8_t *packet, const adpcm_golden_t *golden, uint32_t *seed)
+{
+    for(uint16_t i = 0; i < golden->packet_size; i++)
+    {
+        packet[i] = Engine_AdpcmCheckRand(seed);
+    }
+    // keep headers valid: step index in [0, 88]
+    for(uint16_t c = 0; c < golden->channels; c++)
+    {
+        if(golden->codec_tag == AV_CODEC_ID_ADPCM_IMA_WAV)
+        {
+            packet[4 * c + 2] = Engine_AdpcmCheckRand(seed) % 89;
+            packet[4 * c + 3] = 0;
+        }
+        else if(golden->codec_tag == AV_CODEC_ID_ADPCM_IMA_QT)
+        {
+            packet[34 * c + 1] = (packet[34 * c + 1] & 0x80) | (Engine_AdpcmCheckRand(seed) % 89);
+        }
+    }
+}
+
+void Engine_AdpcmCheck()
+{
+    static const adpcm_golden_t golden[] =
+    {
+        {AV_CODEC_ID_ADPCM_IMA_EA_SEAD, 1, 1000, 64000, 0xC7BF5524U, {0, 0, 0, 0, 0, 1, 4, 7}},
+        {AV_CODEC_ID_ADPCM_IMA_EA_SEAD, 2, 1000, 32000, 0xE5C1CC21U, {0, 0, 0, 0, 1, -1, -1, -3}},
+        {AV_CODEC_ID_ADPCM_IMA_WAV,     1,  516, 32800, 0xA0514E40U, {-1605, -2963, -2082, -3524, -1002, 4152, 4888, 10915}},
+        {AV_CODEC_ID_ADPCM_IMA_WAV,     2, 1032, 32800, 0x46B07ACEU, {12756, -10551, 12745, -10530, 12718, -10472, 12752, -10464}},
+        {AV_CODEC_ID_ADPCM_IMA_QT,      1,   34,  2048, 0x309684ADU, {-4891, -4856, -4878, -4832, -4751, -4608, -4589, -4429}},
+        {AV_CODEC_ID_ADPCM_IMA_QT,      2,   68,  2048, 0xC573447DU, {11969, 7358, 10664, 7295, 21343, 7402, 5550, 7300}}
+    };
+    static const char *names[] = {"sead", "sead", "ima wav", "ima wav", "ima qt", "ima qt"};
+    uint8_t packet[1032];
+    int failed = 0;
+
+    for(size_t k = 0; k < sizeof(golden) / sizeof(golden[0]); k++)
+    {
+        const adpcm_golden_t *g = golden + k;
+        tiny_codec_t s;
+        uint32_t seed = k + 1;
+        uint32_t hash = 2166136261U;
+        uint32_t samples = 0;
+        int head_diff = 0;
+
+        memset(&s, 0, sizeof(s));
+        s.audio.codec_tag = g->codec_tag;
+        s.audio.channels = g->channels;
+        s.audio.bits_per_coded_sample = 4;
+        adpcm_decode_init(&s);
+        if(!s.audio.decode)
+        {
+            printf("adpcm_check: %s, %d ch: decoder init failed\n", names[k], g->channels);
+            failed++;
+            continue;
+        }
+
+        for(int p = 0; p < ADPCM_CHECK_PACKETS; p++)
+        {
+            AVPacket pkt;
+            const int16_t *out;
+            uint32_t count;
+
+            memset(&pkt, 0, sizeof(pkt));
+            Engine_AdpcmCheckPacket(packet, g, &seed);
+            pkt.data = packet;
+            pkt.size = g->packet_size;
+            s.audio.decode(&s, &pkt);
+            out = (const int16_t*)s.audio.buff;
+            count = s.audio.buff_size / sizeof(int16_t);
+            for(uint32_t i = 0; i < count; i++)
+            {
+                uint16_t v = out[i];
+                uint32_t j = samples * g->channels + i;
+                if((j < ADPCM_CHECK_HEAD) && (out[i] != g->head[j]))
+                {
+                    head_diff++;
+                }
+                hash = (hash ^ (v & 0xFF)) * 16777619U;
+                hash = (hash ^ (v >> 8)) * 16777619U;
+            }
+            samples += count / g->channels;
+        }
+        codec_clear(&s);
+
+        printf("adpcm_check: %s, %d ch: %u samples, hash 0x%08X", names[k], g->channels, samples, hash);
+        if((samples != g->samples) || (hash != g->hash) || head_diff)
+        {
+            printf(", expected %u samples, hash 0x%08X, %d of first %d samples differ\n", g->samples, g->hash, head_diff, ADPCM_CHECK_HEAD);
+            failed++;
+        }
+        else
+        {
+            printf(", ok\n");
+        }
+    }
+
+    if(failed)
+    {
+        Sys_Warn("adpcm_check: %d streams differ from golden vectors", failed);
+    }
+}
+
+/*
+ * Render queue check: fixed scene of fake meshes (no vertex data, only faces
+ * and buffer names) is recorded and submitted by a headless queue, counted
+ * state changes must be equal to ones worked out by hand for the sorted
+ * order. Renderer shaders are used, so only their program names are real.
+ * With level, statics of every room are queued from the room centre, to
+ * measure how many instanced draws the depth ranges in keys cost.
+ */
+#define QUEUE_CHECK_MAX_FACES       (4)
+
+typedef struct queue_check_mesh_s
+{
+    base_mesh_t     mesh;
+    mesh_face_t     faces[QUEUE_CHECK_MAX_FACES];
+    mesh_face_t     animated_faces[QUEUE_CHECK_MAX_FACES];
+}queue_check_mesh_t, *queue_check_mesh_p;
+
+static void Engine_QueueCheckMesh(queue_check_mesh_p m, uint32_t id, const GLuint *textures, uint32_t count, const GLuint *animated_textures, uint32_t animated_count)
+{
+    memset(m, 0, sizeof(*m));
+    m->mesh.id = id;
+    m->mesh.vertex_count = 1;
+    m->mesh.vbo_vertex_array = 1;
+    m->mesh.faces = m->faces;
+    m->mesh.faces_count = count;
+    for(uint32_t i = 0; i < count; i++)
+    {
+        m->faces[i].texture_index = textures[i];
+        m->faces[i].elements_type = GL_UNSIGNED_SHORT;
+        m->faces[i].elements_count = 3;
+    }
+    if(animated_count > 0)
+    {
+        m->mesh.animated_vertex_count = 1;
+        m->mesh.vbo_animated_vertex_array = 2;
+        m->mesh.animated_faces = m->animated_faces;
+        m->mesh.animated_faces_count = animated_count;
+        for(uint32_t i = 0; i < animated_count; i++)
+        {
+            m->animated_faces[i].texture_index = animated_textures[i];
+            m->animated_faces[i].elements_type = GL_UNSIGNED_SHORT;
+            m->animated_faces[i].elements_count = 3;
+        }
+    }
+}
+
+static int Engine_QueueCheckStats(const char *scene, const render_queue_stats_t *stats, const render_queue_stats_t *expected)
+{
+    static const char *names[] = {"packets", "objects", "program binds", "texture binds", "buffer binds", "uniform updates", "draw calls",
+                                  "instanced draws", "instances", "multi draws", "multi draw ranges", "upload bytes", "blend changes"};
+    const uint32_t *got = (const uint32_t*)stats;
+    const uint32_t *exp = (const uint32_t*)expected;
+    int failed = 0;
+
+    printf("queue_check: %s: %u packets, %u draw calls, %u program binds, %u texture binds, %u buffer binds, %u uniform updates\n", scene,
+           stats->packets, stats->draw_calls, stats->program_binds, stats->texture_binds, stats->buffer_binds, stats->uniform_updates);
+    for(size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+    {
+        if(got[i] != exp[i])
+        {
+            printf("queue_check: %s: %s = %u, expected %u\n", scene, names[i], got[i], exp[i]);
+            failed++;
+        }
+    }
+    return failed;
+}
+
+void Engine_QueueCheck()
+{
+    static const GLuint room0_tex[] = {1, 2};
+    static const GLuint room1_tex[] = {2, 3};
+    static const GLuint room1_anim_tex[] = {3};
+    static const GLuint static_tex[] = {2};
+    /*
+     * sorted: R0 t1 | R1 t2, R0 t2 (by depth) | R1 animated t3, R1 t3 | static t2 x2;
+     * buffers: R0, R1, R0, R1 anim, R1, S; objects: R0, R1, R0, R1, S1, S2 (new program resets)
+     */
+    static const render_queue_stats_t expected = {7, 4, 2, 4, 6, 6, 7, 0, 0, 0, 0, 0, 0};
+    static const GLuint instanced_tex[] = {4};
+    static const float instanced_depth[] = {1100.0f, 1500.0f, 1200.0f, 1600.0f, 1300.0f, 100000.0f};
+    /*
+     * A: static + animated face on one page, B: static face; added A, B, A, B, A, A far;
+     * sorted: [1024, 2048) range: B x2 | A x3 | A animated x3, far range: A | A animated
+     */
+    static const render_queue_stats_t instanced_expected = {10, 6, 1, 1, 5, 0, 5, 5, 10, 0, 0, 0, 0};
+    const unlit_tinted_shader_description *room_shader = renderer.shaderManager->getRoomShader(false, false);
+    const unlit_tinted_shader_description *static_shader = renderer.shaderManager->getStaticMeshShader();
+    const instanced_shader_description *instanced_shader = renderer.shaderManager->getStaticMeshInstancedShader();
+    const float tint[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+    float mvp[16];
+    queue_check_mesh_t room0, room1, static_mesh, instanced_a, instanced_b;
+    CRenderQueue queue(16);
+    int failed = 0;
+
+    Mat4_E_macro(mvp);
+    Engine_QueueCheckMesh(&room0, 0, room0_tex, 2, NULL, 0);
+    Engine_QueueCheckMesh(&room1, 1, room1_tex, 2, room1_anim_tex, 1);
+    Engine_QueueCheckMesh(&static_mesh, 10, static_tex, 1, NULL, 0);
+    Engine_QueueCheckMesh(&instanced_a, 7, instanced_tex, 1, instanced_tex, 1);
+    Engine_QueueCheckMesh(&instanced_b, 3, instanced_tex, 1, NULL, 0);
+    queue.SetHeadless(true);
+
+    for(int frame = 0; frame < 2; frame++)
+    {
+        queue.Reset();
+        // animated tex coords are streamed once per mesh per frame
+        if(!queue.MarkAnimatedMesh(&room1.mesh) || queue.MarkAnimatedMesh(&room1.mesh) || queue.MarkAnimatedMesh(&room1.mesh))
+        {
+            printf("queue_check: frame %d: animated mesh is marked not once\n", frame);
+            failed++;
+        }
+        queue.AddMesh(RQ_PASS_ROOM, room_shader, &room0.mesh, queue.AddObject(mvp, tint), 100.0f);
+        queue.AddMesh(RQ_PASS_ROOM, room_shader, &room1.mesh, queue.AddObject(mvp, tint), 50.0f);
+        queue.AddMesh(RQ_PASS_STATIC, static_shader, &static_mesh.mesh, queue.AddObject(mvp, tint), 20.0f);
+        queue.AddMesh(RQ_PASS_STATIC, static_shader, &static_mesh.mesh, queue.AddObject(mvp, tint), 10.0f);
+        queue.Sort();
+        queue.Submit(1.0f, 0.0f);
+        failed += Engine_QueueCheckStats("rooms and statics", queue.GetStats(), &expected);
+    }
+
+    if(instanced_shader)
+    {
+        queue.Reset();
+        for(size_t i = 0; i < sizeof(instanced_depth) / sizeof(instanced_depth[0]); i++)
+        {
+            base_mesh_p mesh = (i % 2 && (i < 4)) ? (&instanced_b.mesh) : (&instanced_a.mesh);
+            queue.AddMeshInstance(RQ_PASS_STATIC, instanced_shader, mesh, queue.AddObject(mvp, tint), instanced_depth[i]);
+        }
+        queue.Sort();
+        queue.Submit(1.0f, 0.0f);
+        failed += Engine_QueueCheckStats("instanced statics", queue.GetStats(), &instanced_expected);
+    }
+    else
+    {
+        printf("queue_check: no instanced shader, instanced statics are not checked\n");
+    }
+
+    if(engine_load_bench_name && instanced_shader)
+    {
+        room_p rooms = NULL;
+        uint32_t rooms_count = 0;
+        uint32_t statics = 0;
+        uint32_t draws[2] = {0, 0};                                             // by mesh only, with depth ranges
+
+        if(!Engine_LoadMap(engine_load_bench_name))
+        {
+            Sys_Warn("queue_check: can not load \"%s\"", engine_load_bench_name);
+            return;
+        }
+
+        World_GetRoomInfo(&rooms, &rooms_count);
+        for(uint32_t i = 0; i < rooms_count; i++)
+        {
+            room_content_p content = rooms[i].content;
+            statics += content->static_mesh_count;
+            for(int pass = 0; (pass < 2) && (content->static_mesh_count > 0); pass++)
+            {
+                queue.Reset();
+                for(uint32_t j = 0; j < content->static_mesh_count; j++)
+                {
+                    static_mesh_p sm = content->static_mesh + j;
+                    float depth = (pass) ? (vec3_dist_sq(sm->obb->centre, rooms[i].obb->centre)) : (0.0f);
+                    queue.AddMeshInstance(RQ_PASS_STATIC, instanced_shader, sm->mesh, queue.AddObject(mvp, tint), depth);
+                }
+                queue.Sort();
+                queue.Submit(1.0f, 0.0f);
+                draws[pass] += queue.GetStats()->instanced_draws;
+            }
+        }
+        printf("queue_check: \"%s\": %u rooms, %u statics, instanced draws from room centres: %u by mesh only, %u with depth ranges\n",
+               engine_load_bench_name, rooms_count, statics, draws[0], draws[1]);
+
+        renderer.ResetWorld(NULL, 0, NULL, 0);
+        World_Clear();
+    }
+
+    if(failed)
+    {
+        Sys_Warn("queue_check: %d render queue counters differ from expected", failed);
+    }
+}
+
+/*
+ * Image writer check: synthetic frames go through the writer queue, written
+ * files are read back (PNG by Image_Load(), TGA as raw bytes) and compared
+ * with the frames; pushes to a bad path and in unsupported format must
+ * count as failed; a burst of big frames must overflow the queue, and
+ * written / dropped counters must agree with ImageWriter_Push() results;
+ * ImageWriter_Destroy() must write all queued frames. Files are removed.
+ */
+#define WRITER_CHECK_FRAMES         (4)                                         // less than queue size, none dropped
+#define WRITER_CHECK_WIDTH          (64)
+#define WRITER_CHECK_HEIGHT         (32)
+#define WRITER_CHECK_BURST          (4 * IMAGE_WRITER_QUEUE_SIZE)
+#define WRITER_CHECK_BURST_SIZE     (512)                                       // encoding takes ms, pushes take us
+
+static uint8_t *Engine_WriterCheckFrame(uint32_t w, uint32_t h, uint32_t bpp, uint32_t k)
+{
+    uint32_t cell = bpp / 8;
+    uint8_t *pixels = (uint8_t*)malloc(w * h * cell);
+    for(uint32_t y = 0; y < h; y++)
+    {
+        for(uint32_t x = 0; x < w; x++)
+        {
+            for(uint32_t c = 0; c < cell; c++)
+            {
+                pixels[(y * w + x) * cell + c] = (x * 7 + y * 13 + c * 31 + k * 17) & 0xFF;
+            }
+        }
+    }
+    return pixels;
+}
+
+/*
+ * Returns number of bytes that differ; frame rows go from bottom to top,
+ * so PNG rows are read back flipped and TGA rows are stored as is.
+ */
+static uint32_t Engine_WriterCheckFile(const char *name, int format, uint32_t bpp, uint32_t k)
+{
+    const uint32_t w = WRITER_CHECK_WIDTH;
+    const uint32_t h = WRITER_CHECK_HEIGHT;
+    const uint32_t cell = bpp / 8;
+    uint8_t *frame = Engine_WriterCheckFrame(w, h, bpp, k);
+    uint8_t *data = NULL;
+    uint32_t diff = w * h * cell;
+
+    if(format == IMAGE_FORMAT_PNG)
+    {
+        uint32_t dw = 0, dh = 0, dbpp = 0;
+        if(Image_Load(name, IMAGE_FORMAT_PNG, &data, &dw, &dh, &dbpp) && (dw == w) && (dh == h) && (dbpp == bpp))
+        {
+            diff = 0;
+            for(uint32_t y = 0; y < h; y++)
+            {
+                const uint8_t *src = frame + (h - 1 - y) * w * cell;
+                const uint8_t *dst = data + y * w * cell;
+                for(uint32_t i = 0; i < w * cell; i++)
+                {
+                    diff += (src[i] != dst[i]) ? (1) : (0);
+                }
+            }
+        }
+    }
+    else
+    {
+        SDL_RWops *f = SDL_RWFromFile(name, "rb");
+        size_t size = 18 + w * h * cell;
+        data = (uint8_t*)malloc(size + 1);
+        if(f && (SDL_RWread(f, data, 1, size + 1) == size) &&
+           (data[2] == 2) && (data[12] + 256 * data[13] == w) && (data[14] + 256 * data[15] == h) && (data[16] == bpp))
+        {
+            const uint8_t *dst = data + 18;
+            diff = 0;
+            for(uint32_t i = 0; i < w * h * cell; i += cell)
+            {
+                diff += (frame[i + 0] != dst[i + 2]) ? (1) : (0);               // BGR(A)
+                diff += (frame[i + 1] != dst[i + 1]) ? (1) : (0);
+                diff += (frame[i + 2] != dst[i + 0]) ? (1) : (0);
+                diff += ((cell == 4) && (frame[i + 3] != dst[i + 3])) ? (1) : (0);
+            }
+        }
+        if(f)
+        {
+            SDL_RWclose(f);
+        }
+    }
+
+    free(data);
+    free(frame);
+    return diff;
+}
+
+static int Engine_WriterCheckStats(const char *step, const image_writer_stats_t *base, uint32_t written, uint32_t failed, uint32_t dropped)
+{
+    image_writer_stats_t stats;
+
+    ImageWriter_GetStats(&stats);
+    printf("writer_check: %s: written %u, failed %u, dropped %u, queued %u\n", step, stats.written - base->written,
+           stats.failed - base->failed, stats.dropped - base->dropped, stats.queued);
+    if((stats.written - base->written != written) || (stats.failed - base->failed != failed) ||
+       (stats.dropped - base->dropped != dropped) || (stats.queued != 0))
+    {
+        printf("writer_check: %s: expected written %u, failed %u, dropped %u, queued 0\n", step, written, failed, dropped);
+        return 1;
+    }
+    return 0;
+}
+
+void Engine_WriterCheck()
+{
+    static const int formats[] = {IMAGE_FORMAT_PNG, IMAGE_FORMAT_TGA};
+    static const char *extensions[] = {"png", "tga"};
+    char names[WRITER_CHECK_FRAMES][1024];
+    char name[1024];
+    uint8_t *burst[WRITER_CHECK_BURST];
+    image_writer_stats_t base;
+    uint32_t accepted = 0;
+    int failed = 0;
+
+    ImageWriter_Init();                                                         // no-op if running already
+
+    // queued frames, RGBA and RGB, both formats
+    ImageWriter_GetStats(&base);
+    for(uint32_t k = 0; k < WRITER_CHECK_FRAMES; k++)
+    {
+        uint32_t bpp = (k < 2) ? (32) : (24);
+        snprintf(names[k], sizeof(names[k]), "%s/writer_check_%u.%s", engine_load_bench_name, k, extensions[k % 2]);
+        if(!ImageWriter_Push(names[k], formats[k % 2], Engine_WriterCheckFrame(WRITER_CHECK_WIDTH, WRITER_CHECK_HEIGHT, bpp, k),
+                             WRITER_CHECK_WIDTH, WRITER_CHECK_HEIGHT, bpp))
+        {
+            printf("writer_check: frame %u dropped with empty queue\n", k);
+            failed++;
+        }
+    }
+    ImageWriter_Flush();
+    failed += Engine_WriterCheckStats("frames", &base, WRITER_CHECK_FRAMES, 0, 0);
+    for(uint32_t k = 0; k < WRITER_CHECK_FRAMES; k++)
+    {
+        uint32_t diff = Engine_WriterCheckFile(names[k], formats[k % 2], (k < 2) ? (32) : (24), k);
+        if(diff)
+        {
+            printf("writer_check: \"%s\": %u bytes differ or file is not read\n", names[k], diff);
+            failed++;
+        }
+    }
+
+    // failures: missing folder, format that can not be saved
+    ImageWriter_GetStats(&base);
+    snprintf(name, sizeof(name), "%s/writer_check_no_such_folder/frame.png", engine_load_bench_name);
+    ImageWriter_Push(name, IMAGE_FORMAT_PNG, Engine_WriterCheckFrame(WRITER_CHECK_WIDTH, WRITER_CHECK_HEIGHT, 32, 0), WRITER_CHECK_WIDTH, WRITER_CHECK_HEIGHT, 32);
+    ImageWriter_Push(names[0], IMAGE_FORMAT_PCX, Engine_WriterCheckFrame(WRITER_CHECK_WIDTH, WRITER_CHECK_HEIGHT, 32, 0), WRITER_CHECK_WIDTH, WRITER_CHECK_HEIGHT, 32);
+    ImageWriter_Flush();
+    failed += Engine_WriterCheckStats("bad path and format", &base, 0, 2, 0);
+
+    // burst: queue takes IMAGE_WRITER_QUEUE_SIZE frames at least, the rest is dropped
+    ImageWriter_GetStats(&base);
+    for(uint32_t k = 0; k < WRITER_CHECK_BURST; k++)
+    {
+        burst[k] = Engine_WriterCheckFrame(WRITER_CHECK_BURST_SIZE, WRITER_CHECK_BURST_SIZE, 32, k);
+    }
+    snprintf(name, sizeof(name), "%s/writer_check_burst.png", engine_load_bench_name);
+    for(uint32_t k = 0; k < WRITER_CHECK_BURST; k++)
+    {
+        accepted += ImageWriter_Push(name, IMAGE_FORMAT_PNG, burst[k], WRITER_CHECK_BURST_SIZE, WRITER_CHECK_BURST_SIZE, 32);
+    }
+    ImageWriter_Flush();
+    failed += Engine_WriterCheckStats("burst", &base, accepted, 0, WRITER_CHECK_BURST - accepted);
+    if((accepted < IMAGE_WRITER_QUEUE_SIZE) || (accepted == WRITER_CHECK_BURST))
+    {
+        printf("writer_check: burst: %u of %u frames accepted, expected %d or more with drops\n", accepted, WRITER_CHECK_BURST, IMAGE_WRITER_QUEUE_SIZE);
+        failed++;
+    }
+
+    // destroy writes queued frames, then frames are written synchronously
+    ImageWriter_GetStats(&base);
+    for(uint32_t k = 0; k < WRITER_CHECK_FRAMES; k++)
+    {
+        uint32_t bpp = (k < 2) ? (32) : (24);
+        ImageWriter_Push(names[k], formats[k % 2], Engine_WriterCheckFrame(WRITER_CHECK_WIDTH, WRITER_CHECK_HEIGHT, bpp, k),
+                         WRITER_CHECK_WIDTH, WRITER_CHECK_HEIGHT, bpp);
+    }
+    ImageWriter_Destroy();
+    ImageWriter_Push(names[1], IMAGE_FORMAT_TGA, Engine_WriterCheckFrame(WRITER_CHECK_WIDTH, WRITER_CHECK_HEIGHT, 32, 1), WRITER_CHECK_WIDTH, WRITER_CHECK_HEIGHT, 32);
+    failed += Engine_WriterCheckStats("destroy and synchronous", &base, WRITER_CHECK_FRAMES + 1, 0, 0);
+    if(Engine_WriterCheckFile(names[1], IMAGE_FORMAT_TGA, 32, 1))
+    {
+        printf("writer_check: \"%s\": synchronous frame differs or file is not read\n", names[1]);
+        failed++;
+    }
+    ImageWriter_Init();
+
+    for(uint32_t k = 0; k < WRITER_CHECK_FRAMES; k++)
+    {
+        remove(names[k]);
+    }
+    remove(name);
+
+    if(failed)
+    {
+        Sys_Warn("writer_check: %d image writer checks failed", failed);
+    }
+}
+
+/*
+ * Samples cache check: random acquire / insert / set size / release / budget
+ * sequence on AudioCache and on a plain reference LRU model (entry with the
+ * oldest release goes first); hits, values, stats and order of evicted values
+ * must match after every call. With level: samples of level are loaded twice
+ * through the cache, the second load must hit every sample; prints samples
+ * loading time without cache, with empty cache and with filled one.
+ */
+#define AUDIO_CACHE_CHECK_KEYS      (96)
+#define AUDIO_CACHE_CHECK_STEPS     (200000)
+#define AUDIO_CACHE_CHECK_EVICTED   (AUDIO_CACHE_CHECK_KEYS)
+
+typedef struct audio_cache_check_model_s
+{
+    uint32_t                value[AUDIO_CACHE_CHECK_KEYS];                      // 0 - not cached
+    uint32_t                refs[AUDIO_CACHE_CHECK_KEYS];
+    size_t                  size[AUDIO_CACHE_CHECK_KEYS];
+    uint32_t                released[AUDIO_CACHE_CHECK_KEYS];                   // LRU stamp
+    uint32_t                stamp;
+    size_t                  budget;
+    audio_cache_stats_t     stats;
+    uint32_t                evicted[AUDIO_CACHE_CHECK_EVICTED];                 // by model
+    uint32_t                evicted_count;
+}audio_cache_check_model_t, *audio_cache_check_model_p;
+
+typedef struct audio_cache_check_log_s
+{
+    uint32_t                evicted[AUDIO_CACHE_CHECK_EVICTED];                 // by cache callback
+    uint32_t                evicted_count;
+}audio_cache_check_log_t, *audio_cache_check_log_p;
+
+static void Engine_AudioCacheCheckEvict(void *data, uint32_t value)
+{
+    audio_cache_check_log_p log = (audio_cache_check_log_p)data;
+    if(log->evicted_count < AUDIO_CACHE_CHECK_EVICTED)
+    {
+        log->evicted[log->evicted_count] = value;
+    }
+    log->evicted_count++;
+}
+
+static uint64_t Engine_AudioCacheCheckKey(uint32_t k)
+{
+    uint8_t bytes[4] = {(uint8_t)k, (uint8_t)(k >> 8), 0xA5, 0x5A};
+    return AudioCache_Hash(bytes, sizeof(bytes), k % 3);
+}
+
+static void Engine_AudioCacheCheckTrim(audio_cache_check_model_p m)
+{
+    while(m->stats.size > m->budget)
+    {
+        int lru = -1;
+        for(int k = 0; k < AUDIO_CACHE_CHECK_KEYS; k++)
+        {
+            if(m->value[k] && !m->refs[k] && ((lru < 0) || (m->released[k] < m->released[lru])))
+            {
+                lru = k;
+            }
+        }
+        if(lru < 0)
+        {
+            break;
+        }
+        if(m->evicted_count < AUDIO_CACHE_CHECK_EVICTED)
+        {
+            m->evicted[m->evicted_count] = m->value[lru];
+        }
+        m->evicted_count++;
+        m->stats.entries--;
+        m->stats.size -= m->size[lru];
+        m->stats.evictions++;
+        m->value[lru] = 0;
+    }
+}
+
+static int Engine_AudioCacheCheckStep(audio_cache_p cache, audio_cache_check_model_p m, audio_cache_check_log_p log, uint32_t step, const char *op)
+{
+    audio_cache_stats_t stats;
+    int failed = 0;
+
+    AudioCache_GetStats(cache, &stats);
+    if(memcmp(&stats, &m->stats, sizeof(stats)))
+    {
+        printf("audio_cache_check: step %u, %s: %u entries, %u referenced, %u bytes, %u / %u / %u hits / misses / evictions, expected %u, %u, %u, %u / %u / %u\n",
+               step, op, stats.entries, stats.referenced, (uint32_t)stats.size, stats.hits, stats.misses, stats.evictions, m->stats.entries,
+               m->stats.referenced, (uint32_t)m->stats.size, m->stats.hits, m->stats.misses, m->stats.evictions);
+        failed++;
+    }
+    if((log->evicted_count != m->evicted_count) ||
+       memcmp(log->evicted, m->evicted, sizeof(uint32_t) * ((m->evicted_count < AUDIO_CACHE_CHECK_EVICTED) ? (m->evicted_count) : (AUDIO_CACHE_CHECK_EVICTED))))
+    {
+        printf("audio_cache_check: step %u, %s: %u entries evicted, expected %u, or in other order\n", step, op, log->evicted_count, m->evicted_count);
+        failed++;
+    }
+    log->evicted_count = 0;
+    m->evicted_count = 0;
+
+    return failed;
+}
+
+static int Engine_AudioCacheCheckModel(uint32_t *steps, uint32_t *evictions)
+{
+    audio_cache_check_log_t log;
+    audio_cache_check_model_t m;
+    audio_cache_p cache;
+    uint32_t seed = 12345;
+    uint32_t next_value = 1;
+    uint32_t step = 0;
+    int failed = 0;
+
+    memset(&log, 0, sizeof(log));
+    memset(&m, 0, sizeof(m));
+    m.budget = 128 * 1024;                                                      // about half of all keys sizes
+    cache = AudioCache_Create(m.budget, Engine_AudioCacheCheckEvict, &log);
+
+    for(; (step < AUDIO_CACHE_CHECK_STEPS) && (failed == 0); step++)
+    {
+        uint32_t r = Engine_AtlasCheckRand(&seed);
+        uint32_t k = (r >> 8) % AUDIO_CACHE_CHECK_KEYS;
+        uint64_t key = Engine_AudioCacheCheckKey(k);
+        const char *op;
+
+        if((r & 0xFF) < 2)
+        {
+            op = "set budget";
+            m.budget = (Engine_AtlasCheckRand(&seed) % 256) * 1024;
+            AudioCache_SetBudget(cache, m.budget);
+            Engine_AudioCacheCheckTrim(&m);
+        }
+        else if((r & 0xFF) < 96)                                               // more releases, so LRU list is long
+        {
+            uint32_t value = 0;
+            op = "acquire";
+            if(AudioCache_Acquire(cache, key, &value) != (m.value[k] != 0))
+            {
+                printf("audio_cache_check: step %u: acquire %s, expected %s\n", step, (m.value[k]) ? ("missed") : ("hit"), (m.value[k]) ? ("hit") : ("miss"));
+                failed++;
+            }
+            else if(m.value[k] && (value != m.value[k]))
+            {
+                printf("audio_cache_check: step %u: acquired value %u, expected %u\n", step, value, m.value[k]);
+                failed++;
+            }
+
+            if(m.value[k])
+            {
+                m.stats.hits++;
+                m.stats.referenced += (m.refs[k]++ == 0) ? (1) : (0);
+            }
+            else
+            {
+                // as in Audio_GenSamples(): inserted on miss with 0 size, size is set after decoding
+                m.stats.misses++;
+                failed += Engine_AudioCacheCheckStep(cache, &m, &log, step, op);
+                op = "insert and set size";
+                m.value[k] = next_value++;
+                m.refs[k] = 1;
+                m.size[k] = 0;
+                m.stats.entries++;
+                m.stats.referenced++;
+                AudioCache_Insert(cache, key, m.value[k], 0);
+                Engine_AudioCacheCheckTrim(&m);
+                m.size[k] = 256 + Engine_AtlasCheckRand(&seed) % 4096;
+                m.stats.size += m.size[k];
+                AudioCache_SetSize(cache, key, m.size[k]);
+                Engine_AudioCacheCheckTrim(&m);
+            }
+        }
+        else
+        {
+            op = "release";
+            AudioCache_Release(cache, key);                                     // not cached or not referenced: no-op
+            if(m.value[k] && m.refs[k] && (--m.refs[k] == 0))
+            {
+                m.released[k] = ++m.stamp;
+                m.stats.referenced--;
+                Engine_AudioCacheCheckTrim(&m);
+            }
+        }
+        failed += Engine_AudioCacheCheckStep(cache, &m, &log, step, op);
+        *evictions = m.stats.evictions;
+    }
+
+    // all entries go at destroy, referenced ones too
+    AudioCache_Destroy(cache);
+    if(log.evicted_count != m.stats.entries)
+    {
+        printf("audio_cache_check: destroy evicted %u entries, expected %u\n", log.evicted_count, m.stats.entries);
+        failed++;
+    }
+    *steps = step;
+
+    return failed;
+}
+
+void Engine_AudioCacheCheck()
+{
+    static const uint8_t bytes[] = {'R', 'I', 'F', 'F', 0, 1, 2, 3};
+    uint32_t steps = 0;
+    uint32_t evictions = 0;
+    int failed = 0;
+
+    if((AudioCache_Hash(bytes, sizeof(bytes), 0) != AudioCache_Hash(bytes, sizeof(bytes), 0)) ||
+       (AudioCache_Hash(bytes, sizeof(bytes), 0) == AudioCache_Hash(bytes, sizeof(bytes), 1)) ||
+       (AudioCache_Hash(bytes, sizeof(bytes), 0) == AudioCache_Hash(bytes, sizeof(bytes) - 1, 0)) ||
+       (AudioCache_Hash(NULL, 0, 0) == 0))
+    {
+        printf("audio_cache_check: sample hash is not stable or does not depend on bytes / seed\n");
+        failed++;
+    }
+
+    failed += Engine_AudioCacheCheckModel(&steps, &evictions);
+    printf("audio_cache_check: LRU model: %u steps, %u keys, %u evictions\n", steps, AUDIO_CACHE_CHECK_KEYS, evictions);
+
+    if(engine_load_bench_name)
+    {
+        int trv = VT_Level::get_PC_level_version(engine_load_bench_name);
+        audio_samples_cache_check_t check;
+        VT_Level *tr;
+
+        if(trv == TR_UNKNOWN)
+        {
+            Sys_Warn("audio_cache_check: can not load \"%s\"", engine_load_bench_name);
+            return;
+        }
+
+        tr = new VT_Level();
+        tr->read_level(engine_load_bench_name, trv);
+        failed += Audio_CheckSamplesCache(tr, &check);
+        printf("audio_cache_check: \"%s\": %u samples, %u cache entries; second load: %u misses, %u key collisions, %u referenced after unload\n",
+               engine_load_bench_name, check.samples_count, check.entries, check.warm_misses, check.key_collisions, check.referenced);
+        printf("audio_cache_check: samples loading: no cache %.2f ms, empty cache %.2f ms, filled cache %.2f ms\n",
+               1000.0f * check.off_time, 1000.0f * check.cold_time, 1000.0f * check.warm_time);
+        delete tr;
+    }
+
+    if(failed)
+    {
+        Sys_Warn("audio_cache_check: %d samples cache checks failed", failed);
+    }
+}
+
+/*
+ * Cuts and decodes level sound samples by the original serial loops and by
+ * Audio_SliceSamples() plus worker threads (no OpenAL); sample ranges and
+ * PCM must match, except of the fixed TR1 tail.
+ */
+void Engine_SamplesBench()
+{
+    int trv = VT_Level::get_PC_level_version(engine_load_bench_name);
+    audio_samples_check_t check;
+    VT_Level *tr;
+    int diff;
+
+    if(trv == TR_UNKNOWN)
+    {
+        Sys_Warn("samples_bench: can not load \"%s\"", engine_load_bench_name);
+        return;
+    }
+
+    tr = new VT_Level();
+    tr->read_level(engine_load_bench_name, trv);
+    diff = Audio_CheckSamplesDecode(tr, &check);
+    printf("samples_bench: \"%s\": %u samples (%u by original loops), %u threads, serial %.2f ms, parallel %.2f ms\n", engine_load_bench_name,
+           check.samples_count, check.reference_count, Parallel_GetThreadsCount(), 1000.0f * check.serial_time, 1000.0f * check.parallel_time);
+    printf("samples_bench: ranges: %u differ (%u of fixed TR1 tail), PCM: %u differ\n",
+           check.slices_differ, check.slices_fixed, check.pcm_differ);
+    delete tr;
+
+    if(diff)
+    {
+        Sys_Warn("samples_bench: samples differ from the original serial loading");
+    }
+}
+
+/*
+ * Script tasks benchmark: engine_load_bench_count periodic timers (0.5 - 5 s)
+ * for TASKS_BENCH_FRAMES frames of 1/60 s. Old Lua scheduler polls every timer
+ * in every frame; native one keeps them as sleeping coroutines.
+ */
+#define TASKS_BENCH_FRAMES      (600)
+
+static const char *tasks_bench_lua =
+    "bench_tasks = {}; bench_fired = 0;\n"
+    "function bench_doTasks()\n"
+    "    local i = 0;\n"
+    "    while(bench_tasks[i] ~= nil) do\n"
+    "        local t = bench_tasks[i]();\n"
+    "        if(t == false or t == nil) then\n"
+    "            local j = i;\n"
+    "            while(bench_tasks[j] ~= nil) do\n"
+    "                bench_tasks[j] = bench_tasks[j + 1];\n"
+    "                j = j + 1;\n"
+    "            end\n"
+    "        end\n"
+    "        i = i + 1;\n"
+    "    end\n"
+    "end\n"
+    "function bench_addTasks(count, native)\n"
+    "    for i = 0, count - 1 do\n"
+    "        local delay = 0.5 + (i % 10) * 0.5;\n"
+    "        if(native) then\n"
+    "            addTask(function() while(true) do coroutine.yield(delay); bench_fired = bench_fired + 1; end end);\n"
+    "        else\n"
+    "            local timer = delay;\n"
+    "            bench_tasks[i] = function()\n"
+    "                timer = timer - frame_time;\n"
+    "                if(timer <= 0.0) then timer = timer + delay; bench_fired = bench_fired + 1; end\n"
+    "                return true;\n"
+    "            end\n"
+    "        end\n"
+    "    end\n"
+    "end\n";
+
+void Engine_TasksBench()
+{
+    const float frame_time = 1.0f / 60.0f;
+    int32_t count = engine_load_bench_count;
+    lua_State *lua = engine_lua;
+    float time[2] = {0.0f, 0.0f};
+    int fired[2] = {0, 0};
+
+    if(!lua || (count <= 0) || luaL_dostring(lua, tasks_bench_lua))
+    {
+        Sys_Warn("tasks_bench: can not start");
+        return;
+    }
+
+    Script_ClearTasks(lua);
+    lua_pushnumber(lua, frame_time);
+    lua_setglobal(lua, "frame_time");
+
+    for(int native = 0; native < 2; native++)
+    {
+        lua_getglobal(lua, "bench_addTasks");
+        lua_pushinteger(lua, count);
+        lua_pushboolean(lua, native);
+        lua_pcall(lua, 2, 0, 0);
+        lua_pushinteger(lua, 0);
+        lua_setglobal(lua, "bench_fired");
+
+        float t0 = Sys_FloatTime();
+        for(int frame = 0; frame < TASKS_BENCH_FRAMES; frame++)
+        {
+            if(native)
+            {
+                Script_RunTasks(lua, frame_time);
+            }
+            else
+            {
+                Script_CallVoidFunc(lua, "bench_doTasks");
+            }
+        }
+        time[native] = Sys_FloatTime() - t0;
+
+        lua_getglobal(lua, "bench_fired");
+        fired[native] = lua_tointeger(lua, -1);
+        lua_pop(lua, 1);
+    }
+
+    unsigned int active = 0;
+    unsigned int sleeping = 0;
+    Script_GetTasksCount(&active, &sleeping);
+    printf("tasks_bench: %d tasks, %d frames, %u active / %u sleeping\n", count, TASKS_BENCH_FRAMES, active, sleeping);
+    printf("tasks_bench: lua polling: %.4f ms per frame, %d timers fired\n", 1000.0f * time[0] / TASKS_BENCH_FRAMES, fired[0]);
+    printf("tasks_bench: native:      %.4f ms per frame, %d timers fired\n", 1000.0f * time[1] / TASKS_BENCH_FRAMES, fired[1]);
+
+    Script_ClearTasks(lua);
+    luaL_dostring(lua, "bench_tasks = nil; bench_doTasks = nil; bench_addTasks = nil;");
+}
@@ -0,0 +1,15 @@
+
+#ifndef ENGINE_CHECKS_H
+#define ENGINE_CHECKS_H
+
+/*
+ * Headless benches and self checks (-load_bench, -atlas_check, ...): selected
+ * one runs after engine initialization instead of the game loop, prints
+ * results with its name prefix and reports failures by Sys_Warn.
+ */
+
+int  Engine_ChecksParseArg(int argc, char **argv, int *i);                     // 1 if argv[*i] is check option; *i skips its parameters
+void Engine_ChecksUsage();
+int  Engine_ChecksRun();                                                        // 0 if no check was selected
+
+#endif
@@ -999,6 +999,33 @@ void Entity_DoFlipEffect(entity_p entity, uint16_t effect_id, int16_t param)
 }
 
 
+static void Entity_UpdateSectorCache(entity_p ent)
+{
+    uint32_t stamp = Room_GetContentSwapsCount();
+    if((ent->sector_cache_src != ent->self->sector) || (ent->sector_cache_stamp != stamp))
+    {
+        ent->sector_cache_src = ent->self->sector;
+        ent->sector_cache_stamp = stamp;
+        ent->lowest_sector = Sector_GetLowest(ent->self->sector);
+        ent->highest_sector = Sector_GetHighest(ent->self->sector);
+    }
+}
+
+
+struct room_sector_s *Entity_GetLowestSector(entity_p ent)
+{
+    Entity_UpdateSectorCache(ent);
+    return ent->lowest_sector;
+}
+
+
+struct room_sector_s *Entity_GetHighestSector(entity_p ent)
+{
+    Entity_UpdateSectorCache(ent);
+    return ent->highest_sector;
+}
+
+
 void Entity_ProcessSector(entity_p ent)
 {
     // Calculate both above and below sectors for further usage.
@@ -1006,10 +1033,12 @@ void Entity_ProcessSector(entity_p ent)
     // as many triggers tend to be called from the lowest room in a row
     // (e.g. first trapdoor in The Great Wall, etc.)
     // Sector above primarily needed for paranoid cases of monkeyswing.
+    // Both are resolved only when entity changes sector or rooms are flipped.
     if(ent->self->sector)
     {
-        room_sector_p highest_sector = Sector_GetHighest(ent->self->sector);
-        room_sector_p lowest_sector  = Sector_GetLowest(ent->self->sector);
+        Entity_UpdateSectorCache(ent);
+        room_sector_p highest_sector = ent->highest_sector;
+        room_sector_p lowest_sector  = ent->lowest_sector;
 
         if(ent->character)
         {
@@ -1124,8 +1153,8 @@ void Entity_MoveToSink(entity_p entity, struct static_camera_sink_s *sink)
         sink_pos[1] = sink->pos[1];
         sink_pos[2] = sink->pos[2] + TR_METERING_STEP; // Prevents digging into the floor.
 
-        room_sector_p ls = Sector_GetLowest(entity->self->sector);
-        room_sector_p hs = Sector_GetHighest(entity->self->sector);
+        room_sector_p ls = Entity_GetLowestSector(entity);
+        room_sector_p hs = Entity_GetHighestSector(entity);
 
         if((sink_pos[2] > hs->ceiling) ||
            (sink_pos[2] < ls->floor) )
@@ -164,6 +164,11 @@ typedef struct entity_s
     struct obb_s                       *obb;                // oriented bounding box
     struct engine_container_s          *self;
 
+    struct room_sector_s               *sector_cache_src;   // self->sector for which lowest / highest sectors were resolved
+    struct room_sector_s               *lowest_sector;
+    struct room_sector_s               *highest_sector;
+    uint32_t                            sector_cache_stamp; // rooms content swaps count at cache update
+
     struct activation_point_s          *activation_point;
     struct inventory_node_s            *inventory;
     struct character_s                 *character;
@@ -178,6 +183,8 @@ void Entity_Disable(entity_p ent);
 void Entity_EnableCollision(entity_p ent);
 void Entity_DisableCollision(entity_p ent);
 void Entity_UpdateRoomPos(entity_p ent);
+struct room_sector_s *Entity_GetLowestSector(entity_p ent);
+struct room_sector_s *Entity_GetHighestSector(entity_p ent);
 void Entity_MoveToRoom(entity_p entity, struct room_s *new_room);
 
 void Entity_Frame(entity_p entity, float time);  // process frame + trying to change state
@@ -39,6 +39,7 @@
 #include "../internal/avcodec.h"
 #include "adpcm.h"
 #include "adpcm_data.h"
+#include "../../core/parallel.h"
 #define BITSTREAM_READER_LE
 #include "../internal/get_bits.h"
 #include "../internal/bytestream.h"
@@ -90,11 +91,41 @@ static const int swf_index_tables[4][16] = {
 
 /* end of tables */
 
+/*
+ * Table driven IMA ADPCM: entry for (step index, nibble) keeps signed
+ * predictor difference in high bits and offset of the next step index row
+ * in low bits, so nibble is expanded by one load, add and clip. Channels
+ * are independent: each one is described by its own job, writing right
+ * into interleaved output; stereo is decoded in one pass, big packets
+ * spread channels over threads.
+ */
+#define ADPCM_IMA_STEPS                 (89)
+#define ADPCM_IMA_ROW_SHIFT             (4)                                     // 16 nibbles per row
+#define ADPCM_IMA_ROW_MASK              (0xFFF)
+#define ADPCM_IMA_DIFF_SHIFT            (12)
+#define ADPCM_IMA_QT_TABLE              (-1)                                    // shift for QuickTime rounding
+#define ADPCM_PARALLEL_MIN_SAMPLES      (131072)                                // per channel, less is faster on one thread
+
+typedef struct ADPCMIMAChannelJob
+{
+    const int32_t      *table;
+    ADPCMChannelStatus *cs;
+    const uint8_t      *src;
+    int16_t            *dst;
+    int                 groups;         /**< runs of channel bytes */
+    int                 group_bytes;
+    int                 src_stride;     /**< between runs starts */
+    int                 dst_stride;     /**< channels count for interleaved output */
+    int                 shift;          /**< of the first nibble in byte: 0 or 4 */
+    int                 nibbles;        /**< of channel per byte: 1 or 2 */
+} ADPCMIMAChannelJob;
+
 typedef struct ADPCMDecodeContext
 {
     ADPCMChannelStatus status[14];
     int vqa_version;                /**< VQA version. Used for ADPCM_IMA_WS */
     int has_status;
+    int32_t ima_table[ADPCM_IMA_STEPS << ADPCM_IMA_ROW_SHIFT];
 } ADPCMDecodeContext;
 
 static inline int16_t adpcm_ima_expand_nibble(ADPCMChannelStatus *c, int8_t nibble, int shift)
@@ -427,6 +458,155 @@ static void adpcm_swf_decode(struct tiny_codec_s *avctx, const uint8_t *buf, int
     }
 }
 
+/*
+ * Same steps, as adpcm_ima_expand_nibble() with given shift or
+ * adpcm_ima_qt_expand_nibble() for ADPCM_IMA_QT_TABLE.
+ */
+static void adpcm_ima_build_table(int32_t *table, int shift)
+{
+    int i, nibble;
+
+    for (i = 0; i < ADPCM_IMA_STEPS; i++)
+    {
+        int step = ff_adpcm_step_table[i];
+        for (nibble = 0; nibble < 16; nibble++)
+        {
+            int step_index = av_clip_c(i + ff_adpcm_index_table[nibble], 0, 88);
+            int diff;
+
+            if (shift == ADPCM_IMA_QT_TABLE)
+            {
+                diff = step >> 3;
+                if (nibble & 4) diff += step;
+                if (nibble & 2) diff += step >> 1;
+                if (nibble & 1) diff += step >> 2;
+            }
+            else
+            {
+                diff = ((2 * (nibble & 7) + 1) * step) >> shift;
+            }
+
+            if (nibble & 8)
+                diff = -diff;
+            table[(i << ADPCM_IMA_ROW_SHIFT) + nibble] = diff * (1 << ADPCM_IMA_DIFF_SHIFT) + (step_index << ADPCM_IMA_ROW_SHIFT);
+        }
+    }
+}
+
+#define ADPCM_IMA_TABLE_STEP(out, row, predictor, nibble)                      \
+    do {                                                                        \
+        int32_t e = table[(row) + (nibble)];                                    \
+        row = e & ADPCM_IMA_ROW_MASK;                                           \
+        predictor = av_clip_int16_c(predictor + (e >> ADPCM_IMA_DIFF_SHIFT));   \
+        out = predictor;                                                        \
+    } while (0)
+
+static void adpcm_ima_decode_channel(void *data, uint32_t index)
+{
+    ADPCMIMAChannelJob *job = (ADPCMIMAChannelJob*)data + index;
+    const int32_t *table = job->table;
+    const int stride = job->dst_stride;
+    const int shift0 = job->shift;
+    const int shift1 = job->shift ^ 4;
+    int row = job->cs->step_index << ADPCM_IMA_ROW_SHIFT;
+    int predictor = job->cs->predictor;
+    int16_t *dst = job->dst;
+    int g;
+
+    for (g = 0; g < job->groups; g++)
+    {
+        const uint8_t *src = job->src + g * job->src_stride;
+        const uint8_t *end = src + job->group_bytes;
+
+        if (job->nibbles == 2)
+        {
+            for (; src < end; src++, dst += 2 * stride)
+            {
+                ADPCM_IMA_TABLE_STEP(dst[0],      row, predictor, (*src >> shift0) & 0x0F);
+                ADPCM_IMA_TABLE_STEP(dst[stride], row, predictor, (*src >> shift1) & 0x0F);
+            }
+        }
+        else
+        {
+            for (; src < end; src++, dst += stride)
+            {
+                ADPCM_IMA_TABLE_STEP(dst[0], row, predictor, (*src >> shift0) & 0x0F);
+            }
+        }
+    }
+
+    job->cs->predictor = predictor;
+    job->cs->step_index = row >> ADPCM_IMA_ROW_SHIFT;
+}
+
+/*
+ * Both channels of stereo in one pass: steps of one channel wait for the
+ * previous table load, so the other channel's steps fill the gap.
+ */
+static void adpcm_ima_decode_pair(ADPCMIMAChannelJob *jobs)
+{
+    const int32_t *table = jobs[0].table;
+    const int stride = jobs[0].dst_stride;
+    const int shift0l = jobs[0].shift, shift1l = jobs[0].shift ^ 4;
+    const int shift0r = jobs[1].shift, shift1r = jobs[1].shift ^ 4;
+    int row_l = jobs[0].cs->step_index << ADPCM_IMA_ROW_SHIFT;
+    int row_r = jobs[1].cs->step_index << ADPCM_IMA_ROW_SHIFT;
+    int predictor_l = jobs[0].cs->predictor;
+    int predictor_r = jobs[1].cs->predictor;
+    int16_t *dst_l = jobs[0].dst;
+    int16_t *dst_r = jobs[1].dst;
+    int g, j;
+
+    for (g = 0; g < jobs[0].groups; g++)
+    {
+        const uint8_t *src_l = jobs[0].src + g * jobs[0].src_stride;
+        const uint8_t *src_r = jobs[1].src + g * jobs[1].src_stride;
+
+        if (jobs[0].nibbles == 2)
+        {
+            for (j = 0; j < jobs[0].group_bytes; j++, dst_l += 2 * stride, dst_r += 2 * stride)
+            {
+                ADPCM_IMA_TABLE_STEP(dst_l[0],      row_l, predictor_l, (src_l[j] >> shift0l) & 0x0F);
+                ADPCM_IMA_TABLE_STEP(dst_r[0],      row_r, predictor_r, (src_r[j] >> shift0r) & 0x0F);
+                ADPCM_IMA_TABLE_STEP(dst_l[stride], row_l, predictor_l, (src_l[j] >> shift1l) & 0x0F);
+                ADPCM_IMA_TABLE_STEP(dst_r[stride], row_r, predictor_r, (src_r[j] >> shift1r) & 0x0F);
+            }
+        }
+        else
+        {
+            for (j = 0; j < jobs[0].group_bytes; j++, dst_l += stride, dst_r += stride)
+            {
+                ADPCM_IMA_TABLE_STEP(dst_l[0], row_l, predictor_l, (src_l[j] >> shift0l) & 0x0F);
+                ADPCM_IMA_TABLE_STEP(dst_r[0], row_r, predictor_r, (src_r[j] >> shift0r) & 0x0F);
+            }
+        }
+    }
+
+    jobs[0].cs->predictor = predictor_l;
+    jobs[0].cs->step_index = row_l >> ADPCM_IMA_ROW_SHIFT;
+    jobs[1].cs->predictor = predictor_r;
+    jobs[1].cs->step_index = row_r >> ADPCM_IMA_ROW_SHIFT;
+}
+
+/*
+ * Jobs of all channels have the same layout, only sources, outputs and
+ * nibbles order differ. Threads are started per call, so they pay off only
+ * for really big packets.
+ */
+static void adpcm_ima_decode_channels(ADPCMIMAChannelJob *jobs, int channels, int nb_samples)
+{
+    if (channels == 2)
+    {
+        if (nb_samples >= ADPCM_PARALLEL_MIN_SAMPLES && Parallel_GetThreadsCount() > 1)
+            Parallel_For(channels, adpcm_ima_decode_channel, jobs);
+        else
+            adpcm_ima_decode_pair(jobs);
+        return;
+    }
+
+    adpcm_ima_decode_channel(jobs, 0);
+}
+
 /**
  * Get the number of samples that will be decoded from the packet.
  * In one case, this is actually the maximum number of samples possible to
@@ -660,6 +840,7 @@ static int32_t adpcm_decode_frame(struct tiny_codec_s *avctx, struct AVPacket *a
     int st; /* stereo */
     int count1, count2;
     int nb_samples, coded_samples, approx_nb_samples, ret;
+    ADPCMIMAChannelJob jobs[2];     /* IMA codecs are limited by 2 channels in init */
     GetByteContext gb;
 
     bytestream2_init(&gb, buf, buf_size);
@@ -685,7 +866,7 @@ static int32_t adpcm_decode_frame(struct tiny_codec_s *avctx, struct AVPacket *a
     {
         case AV_CODEC_ID_ADPCM_IMA_QT:
             /* In QuickTime, IMA is encoded by chunks of 34 bytes (=64 samples).
-               Channel data is interleaved per-chunk. */
+               Channel data is interleaved per-chunk, output is interleaved per-sample. */
             for (channel = 0; channel < avctx->audio.channels; channel++)
             {
                 int predictor;
@@ -720,21 +901,25 @@ static int32_t adpcm_decode_frame(struct tiny_codec_s *avctx, struct AVPacket *a
                     return -1;
                 }
 
-                samples = samples_p[channel];
-
-                for (m = 0; m < 64; m += 2)
-                {
-                    int byte = bytestream2_get_byteu(&gb);
-                    samples[m    ] = adpcm_ima_qt_expand_nibble(cs, byte & 0x0F, 3);
-                    samples[m + 1] = adpcm_ima_qt_expand_nibble(cs, byte >> 4  , 3);
-                }
+                jobs[channel].table = c->ima_table;
+                jobs[channel].cs = cs;
+                jobs[channel].src = gb.buffer;
+                jobs[channel].dst = samples + channel;
+                jobs[channel].groups = 1;
+                jobs[channel].group_bytes = 32;
+                jobs[channel].src_stride = 32;
+                jobs[channel].dst_stride = avctx->audio.channels;
+                jobs[channel].shift = 0;
+                jobs[channel].nibbles = 2;
+                bytestream2_skipu(&gb, 32);
             }
+            adpcm_ima_decode_channels(jobs, avctx->audio.channels, 64);
             break;
         case AV_CODEC_ID_ADPCM_IMA_WAV:
             for(i=0; i<avctx->audio.channels; i++)
             {
                 cs = &(c->status[i]);
-                cs->predictor = samples_p[i][0] = sign_extend(bytestream2_get_le16u(&gb), 16);
+                cs->predictor = samples[i] = sign_extend(bytestream2_get_le16u(&gb), 16);
 
                 cs->step_index = sign_extend(bytestream2_get_le16u(&gb), 16);
                 if (cs->step_index > 88u)
@@ -757,9 +942,9 @@ static int32_t adpcm_decode_frame(struct tiny_codec_s *avctx, struct AVPacket *a
                     for (i = 0; i < avctx->audio.channels; i++)
                     {
                         int j;
+                        int16_t *out = samples + (1 + n * samples_per_block) * avctx->audio.channels + i;
 
                         cs = &c->status[i];
-                        samples = &samples_p[i][1 + n * samples_per_block];
                         for (j = 0; j < block_size; j++)
                         {
                             temp[j] = buf[4 * avctx->audio.channels + block_size * n * avctx->audio.channels +
@@ -770,7 +955,7 @@ static int32_t adpcm_decode_frame(struct tiny_codec_s *avctx, struct AVPacket *a
                             return ret;
                         for (m = 0; m < samples_per_block; m++)
                         {
-                            samples[m] = adpcm_ima_wav_expand_nibble(cs, &g,
+                            out[m * avctx->audio.channels] = adpcm_ima_wav_expand_nibble(cs, &g,
                                               avctx->audio.bits_per_coded_sample);
                         }
                     }
@@ -779,20 +964,22 @@ static int32_t adpcm_decode_frame(struct tiny_codec_s *avctx, struct AVPacket *a
             }
             else
             {
-                for (n = 0; n < (nb_samples - 1) / 8; n++)
+                /* blocks of 4 bytes (8 samples) per channel */
+                for (i = 0; i < avctx->audio.channels; i++)
                 {
-                    for (i = 0; i < avctx->audio.channels; i++)
-                    {
-                        cs = &c->status[i];
-                        samples = &samples_p[i][1 + n * 8];
-                        for (m = 0; m < 8; m += 2)
-                        {
-                            int v = bytestream2_get_byteu(&gb);
-                            samples[m    ] = adpcm_ima_expand_nibble(cs, v & 0x0F, 3);
-                            samples[m + 1] = adpcm_ima_expand_nibble(cs, v >> 4  , 3);
-                        }
-                    }
+                    jobs[i].table = c->ima_table;
+                    jobs[i].cs = &c->status[i];
+                    jobs[i].src = gb.buffer + 4 * i;
+                    jobs[i].dst = samples + avctx->audio.channels + i;
+                    jobs[i].groups = (nb_samples - 1) / 8;
+                    jobs[i].group_bytes = 4;
+                    jobs[i].src_stride = 4 * avctx->audio.channels;
+                    jobs[i].dst_stride = avctx->audio.channels;
+                    jobs[i].shift = 0;
+                    jobs[i].nibbles = 2;
                 }
+                adpcm_ima_decode_channels(jobs, avctx->audio.channels, nb_samples);
+                bytestream2_skipu(&gb, jobs[0].groups * 4 * avctx->audio.channels);
             }
             break;
         case AV_CODEC_ID_ADPCM_4XM:
@@ -1142,12 +1329,23 @@ static int32_t adpcm_decode_frame(struct tiny_codec_s *avctx, struct AVPacket *a
             }
             break;
         case AV_CODEC_ID_ADPCM_IMA_EA_SEAD:
-            for (n = nb_samples >> (1 - st); n > 0; n--)
+            /* high nibble is the first sample, or left channel for stereo */
+            n = nb_samples >> (1 - st);
+            for (i = 0; i <= st; i++)
             {
-                int byte = bytestream2_get_byteu(&gb);
-                *samples++ = adpcm_ima_expand_nibble(&c->status[0],  byte >> 4,   6);
-                *samples++ = adpcm_ima_expand_nibble(&c->status[st], byte & 0x0F, 6);
+                jobs[i].table = c->ima_table;
+                jobs[i].cs = &c->status[i];
+                jobs[i].src = gb.buffer;
+                jobs[i].dst = samples + i;
+                jobs[i].groups = 1;
+                jobs[i].group_bytes = n;
+                jobs[i].src_stride = n;
+                jobs[i].dst_stride = 1 + st;
+                jobs[i].shift = (i) ? 0 : 4;
+                jobs[i].nibbles = 2 - st;
             }
+            adpcm_ima_decode_channels(jobs, 1 + st, nb_samples);
+            bytestream2_skipu(&gb, n);
             break;
         case AV_CODEC_ID_ADPCM_EA:
         {
@@ -1785,7 +1983,7 @@ void adpcm_decode_init(struct tiny_codec_s *avctx)
 {
     if(!avctx->audio.priv_data)
     {
-        ADPCMDecodeContext *c = (ADPCMDecodeContext*)malloc(sizeof(ADPCMDecodeContext));
+        ADPCMDecodeContext *c = (ADPCMDecodeContext*)calloc(1, sizeof(ADPCMDecodeContext));
         unsigned int min_channels = 1;
         unsigned int max_channels = 2;
 
@@ -1842,6 +2040,15 @@ void adpcm_decode_init(struct tiny_codec_s *avctx)
                     avctx->audio.free_data = NULL;
                     return;
                 }
+                adpcm_ima_build_table(c->ima_table, 3);
+                break;
+
+            case AV_CODEC_ID_ADPCM_IMA_QT:
+                adpcm_ima_build_table(c->ima_table, ADPCM_IMA_QT_TABLE);
+                break;
+
+            case AV_CODEC_ID_ADPCM_IMA_EA_SEAD:
+                adpcm_ima_build_table(c->ima_table, 6);
                 break;
 
             case AV_CODEC_ID_ADPCM_IMA_APC:
@@ -1865,8 +2072,6 @@ void adpcm_decode_init(struct tiny_codec_s *avctx)
         {
             case AV_CODEC_ID_ADPCM_AICA:
             case AV_CODEC_ID_ADPCM_IMA_DAT4:
-            case AV_CODEC_ID_ADPCM_IMA_QT:
-            case AV_CODEC_ID_ADPCM_IMA_WAV:
             case AV_CODEC_ID_ADPCM_4XM:
             case AV_CODEC_ID_ADPCM_XA:
             case AV_CODEC_ID_ADPCM_EA_R1:
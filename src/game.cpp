@@ -10,6 +10,7 @@ extern "C" {
 
 #include "core/system.h"
 #include "core/console.h"
+#include "core/profiler.h"
 #include "core/vmath.h"
 #include "core/polygon.h"
 #include "core/obb.h"
@@ -562,20 +563,48 @@ void Game_ApplyControls(struct entity_s *ent)
 }
 
 
+static int                  game_timing_enabled = 0;
+static game_frame_timing_t  game_timing = {0.0f, 0.0f, 0.0f, 0.0f};
+
+#define GAME_TIMING_BEGIN(t)    float t = (game_timing_enabled) ? (Sys_FloatTime()) : (0.0f)
+#define GAME_TIMING_END(t, dst) do { if(game_timing_enabled) { game_timing.dst += Sys_FloatTime() - t; } } while(0)
+
+
+void Game_EnableFrameTiming(int enable)
+{
+    game_timing_enabled = enable;
+}
+
+
+const game_frame_timing_t *Game_GetFrameTiming()
+{
+    return &game_timing;
+}
+
+
 int Game_UpdateEntity(entity_p ent, void *data)
 {
     if(ent && (ent != World_GetPlayer()) && (!ent->self->room || (ent->self->room == ent->self->room->real_room)))
     {
         if(ent->character)
         {
+            // activated by other entity in this frame, after collision LOD update
+            if(ent->self->room && !ent->self->room->is_collision_active)
+            {
+                World_EnableCollisionNear(ent->self->room);
+            }
             Character_Update(ent);
         }
         if(ent->state_flags & ENTITY_STATE_ENABLED)
         {
             Entity_ProcessSector(ent);
+            GAME_TIMING_BEGIN(t_script);
             Script_LoopEntity(engine_lua, ent);
+            GAME_TIMING_END(t_script, scripting);
         }
+        GAME_TIMING_BEGIN(t_anim);
         Entity_Frame(ent, engine_frame_time);
+        GAME_TIMING_END(t_anim, animation);
         Entity_UpdateRigidBody(ent, ent->character != NULL);
         Entity_UpdateRoomPos(ent);
     }
@@ -587,6 +616,8 @@ int Game_UpdateEntity(entity_p ent, void *data)
 void Game_Frame(float time)
 {
     entity_p player = World_GetPlayer();
+    GAME_TIMING_BEGIN(t_frame);
+    memset(&game_timing, 0x00, sizeof(game_timing));
 
     // GUI and controls should be updated at all times!
     if(!Con_IsShown() && control_states.gui_inventory && main_inventory_manager)
@@ -606,11 +637,17 @@ void Game_Frame(float time)
     // If console or inventory is active, only thing to update is audio.
     if(Con_IsShown() || main_inventory_manager->getCurrentState() != gui_InventoryManager::INVENTORY_DISABLED)
     {
+        GAME_TIMING_END(t_frame, total);
         return;
     }
 
     // In game mode
-    Script_DoTasks(engine_lua, time);
+    {
+        PROF_SCOPE("Script_DoTasks");
+        GAME_TIMING_BEGIN(t_script);
+        Script_DoTasks(engine_lua, time);
+        GAME_TIMING_END(t_script, scripting);
+    }
 
     // This must be called EVERY frame to max out smoothness.
     // Includes animations, camera movement, and so on.
@@ -628,7 +665,9 @@ void Game_Frame(float time)
         if(!control_states.noclip)
         {
             Character_Update(player);
+            GAME_TIMING_BEGIN(t_script);
             Script_LoopEntity(engine_lua, player);   ///@TODO: fix that hack (refactoring)
+            GAME_TIMING_END(t_script, scripting);
             if(player->character->target_id == ENTITY_ID_NONE)
             {
                 entity_p target = Character_FindTarget(player);
@@ -646,7 +685,9 @@ void Game_Frame(float time)
                 }
             }
         }
+        GAME_TIMING_BEGIN(t_anim);
         Entity_Frame(player, time);
+        GAME_TIMING_END(t_anim, animation);
         Entity_UpdateRigidBody(player, 1);
         Entity_UpdateRoomPos(player);
     }
@@ -733,12 +774,30 @@ void Game_Frame(float time)
         }
     }
 
-    World_IterateAllEntities(Game_UpdateEntity, NULL);
+    {
+        // after player update: enemies, activated by player triggers, are seeds,
+        // so their height rays hit room collision in this frame
+        PROF_SCOPE("World_UpdateCollisionLOD");
+        GAME_TIMING_BEGIN(t_lod);
+        World_UpdateCollisionLOD();
+        GAME_TIMING_END(t_lod, physics);
+    }
 
-    Physics_StepSimulation(time);
+    {
+        PROF_SCOPE("Game_UpdateEntities");
+        World_IterateAllEntities(Game_UpdateEntity, NULL);
+    }
+
+    {
+        PROF_SCOPE("Physics_StepSimulation");
+        GAME_TIMING_BEGIN(t_phys);
+        Physics_StepSimulation(time);
+        GAME_TIMING_END(t_phys, physics);
+    }
 
     Controls_RefreshStates();
     renderer.UpdateAnimTextures();
+    GAME_TIMING_END(t_frame, total);
 }
 
 
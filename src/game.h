@@ -13,12 +13,24 @@
 struct camera_s;
 struct entity_s;
 
+// Per frame time (in seconds) spent in Game_Frame() subsystems;
+// gathered only while frame timing is enabled (headless benchmarks).
+typedef struct game_frame_timing_s
+{
+    float       total;
+    float       physics;
+    float       animation;
+    float       scripting;
+}game_frame_timing_t, *game_frame_timing_p;
+
 void Game_InitGlobals();
 void Game_RegisterLuaFunctions(struct lua_State *lua);
 int Game_Load(const char* name);
 int Game_Save(const char* name);
 
 void Game_Frame(float time);
+void Game_EnableFrameTiming(int enable);
+const game_frame_timing_t *Game_GetFrameTiming();
 
 void Game_Prepare();
 
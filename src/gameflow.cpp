@@ -54,6 +54,7 @@ typedef struct level_info_s
 bool Gameflow_GetLevelInfo(level_info_p info, int game_id, int level_id);
 bool Gameflow_GetFMVPath(level_info_p info, int fmv_id);
 bool Gameflow_SetGameInternal(int game_id, int level_id);
+void Gameflow_PreloadNextLevel();
 
 
 void Gameflow_Init()
@@ -192,7 +193,12 @@ bool Gameflow_SetMap(const char* filePath, int game_id, int level_id)
     global_gameflow.m_currentGameID = game_id;
     global_gameflow.m_currentLevelID = level_id;
 
-    return Engine_LoadMap(filePath);
+    if(Engine_LoadMap(filePath))
+    {
+        Gameflow_PreloadNextLevel();
+        return true;
+    }
+    return false;
 }
 
 
@@ -332,12 +338,36 @@ bool Gameflow_SetGameInternal(int game_id, int level_id)
         global_gameflow.m_currentLevelID = level_id;
         strncpy(global_gameflow.m_currentLevelName, info.name, LEVEL_NAME_MAX_LEN);
         strncpy(global_gameflow.m_currentLevelPath, info.path, MAX_ENGINE_PATH);
-        return Engine_LoadMap(info.path);
+        if(Engine_LoadMap(info.path))
+        {
+            Gameflow_PreloadNextLevel();
+            return true;
+        }
     }
 
     return false;
 }
 
+/**
+ * Starts background reading of the level which GF_OP_LEVELCOMPLETE will
+ * load, so level change does only world generation.
+ */
+void Gameflow_PreloadNextLevel()
+{
+    level_info_t info;
+    int next_level_id = global_gameflow.m_currentLevelID + 1;
+
+    if(Gameflow_GetLevelInfo(&info, global_gameflow.m_currentGameID, next_level_id) &&
+       (next_level_id <= info.num_levels))
+    {
+        char path[MAX_ENGINE_PATH];
+        strncpy(path, Engine_GetBasePath(), MAX_ENGINE_PATH - 1);
+        path[MAX_ENGINE_PATH - 1] = 0;
+        strncat(path, info.path, MAX_ENGINE_PATH - strlen(path) - 1);
+        World_PreloadStart(path);
+    }
+}
+
 
 const char *Gameflow_GetCurrentLevelPathLocal()
 {
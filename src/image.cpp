@@ -547,6 +547,61 @@ static int Image_SavePNG(const char *file_name, uint8_t *buffer, uint32_t w, uin
 }
 
 
+/*
+ * Uncompressed true color TGA, rows from bottom to top, as buffer is.
+ */
+static int Image_SaveTGA(const char *file_name, uint8_t *buffer, uint32_t w, uint32_t h, uint32_t bpp)
+{
+    uint8_t header[18];
+    uint32_t cell_size = bpp / 8;
+    uint32_t row_size = w * cell_size;
+    uint8_t *row;
+    SDL_RWops *dst;
+
+    if(((bpp != 24) && (bpp != 32)) || (w > 0xFFFF) || (h > 0xFFFF))
+    {
+        return 0;
+    }
+
+    dst = SDL_RWFromFile(file_name, "wb");
+    if(!dst)
+    {
+        return 0;
+    }
+
+    memset(header, 0x00, sizeof(header));
+    header[2] = 2;                                                              // uncompressed true color
+    header[12] = w & 0xFF;
+    header[13] = (w >> 8) & 0xFF;
+    header[14] = h & 0xFF;
+    header[15] = (h >> 8) & 0xFF;
+    header[16] = bpp;
+    header[17] = (bpp == 32) ? (8) : (0);                                       // alpha bits, bottom left origin
+    SDL_RWwrite(dst, header, sizeof(header), 1);
+
+    row = (uint8_t*)malloc(row_size);
+    for(uint32_t y = 0; y < h; y++)
+    {
+        const uint8_t *src = buffer + y * row_size;
+        for(uint32_t x = 0; x < row_size; x += cell_size)
+        {
+            row[x + 0] = src[x + 2];                                            // RGB(A) -> BGR(A)
+            row[x + 1] = src[x + 1];
+            row[x + 2] = src[x + 0];
+            if(cell_size == 4)
+            {
+                row[x + 3] = src[x + 3];
+            }
+        }
+        SDL_RWwrite(dst, row, row_size, 1);
+    }
+    free(row);
+    SDL_RWclose(dst);
+
+    return 1;
+}
+
+
 int Image_Save(const char *file_name, int format, uint8_t *buffer, uint32_t w, uint32_t h, uint32_t bpp)
 {
     switch(format)
@@ -554,6 +609,9 @@ int Image_Save(const char *file_name, int format, uint8_t *buffer, uint32_t w, u
         case IMAGE_FORMAT_PNG:
             return Image_SavePNG(file_name, buffer, w, h, bpp);
 
+        case IMAGE_FORMAT_TGA:
+            return Image_SaveTGA(file_name, buffer, w, h, bpp);
+
         default:
             return 0;
     }
@@ -10,6 +10,7 @@ extern "C" {
 
 #define IMAGE_FORMAT_PCX    (1)
 #define IMAGE_FORMAT_PNG    (2)
+#define IMAGE_FORMAT_TGA    (3)
 
 /**
  * supported formats: PNG, PCX;
@@ -21,8 +22,10 @@ extern "C" {
 int Image_Load(const char *file_name, int format, uint8_t **buffer, uint32_t *w, uint32_t *h, uint32_t *bpp); 
 
 /**
- * supported formats: PNG;
+ * supported formats: PNG, TGA;
  * supported pixel formats: RGB, RGBA, so bpp can be 24 or 32;
+ * buffer rows go from bottom to top (as glReadPixels gives);
+ * thread safe, no GL calls;
  * return 0 on fail and 1 if success;
  */
 int Image_Save(const char *file_name, int format, uint8_t *buffer, uint32_t w, uint32_t h, uint32_t bpp);
@@ -0,0 +1,176 @@
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_atomic.h>
+#include <SDL2/SDL_thread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "image.h"
+#include "image_writer.h"
+
+
+#define IMAGE_WRITER_QUEUE_MASK     (IMAGE_WRITER_QUEUE_SIZE - 1)
+
+typedef struct image_writer_job_s
+{
+    char                file_name[IMAGE_WRITER_MAX_FILE_NAME];
+    int                 format;
+    uint8_t            *pixels;
+    uint32_t            w;
+    uint32_t            h;
+    uint32_t            bpp;
+}image_writer_job_t, *image_writer_job_p;
+
+/*
+ * Only pusher moves head, only writer thread moves tail; job is filled
+ * before head is moved and freed before tail is moved.
+ */
+static image_writer_job_t   writer_jobs[IMAGE_WRITER_QUEUE_SIZE];
+static SDL_atomic_t         writer_head = {0};
+static SDL_atomic_t         writer_tail = {0};
+static SDL_atomic_t         writer_running = {0};
+static SDL_Thread          *writer_thread = NULL;
+static SDL_sem             *writer_sem = NULL;
+
+static SDL_atomic_t         writer_written = {0};
+static SDL_atomic_t         writer_failed = {0};
+static SDL_atomic_t         writer_dropped = {0};
+
+
+static void ImageWriter_Write(image_writer_job_p job)
+{
+    if(Image_Save(job->file_name, job->format, job->pixels, job->w, job->h, job->bpp))
+    {
+        SDL_AtomicAdd(&writer_written, 1);
+    }
+    else
+    {
+        SDL_AtomicAdd(&writer_failed, 1);
+    }
+    free(job->pixels);
+    job->pixels = NULL;
+}
+
+
+static int ImageWriter_Thread(void *data)
+{
+    int running;
+    (void)data;
+
+    do
+    {
+        SDL_SemWait(writer_sem);
+        running = SDL_AtomicGet(&writer_running);
+        for(int tail = SDL_AtomicGet(&writer_tail); tail != SDL_AtomicGet(&writer_head); tail = SDL_AtomicGet(&writer_tail))
+        {
+            SDL_MemoryBarrierAcquire();
+            ImageWriter_Write(writer_jobs + (tail & IMAGE_WRITER_QUEUE_MASK));
+            SDL_MemoryBarrierRelease();
+            SDL_AtomicSet(&writer_tail, tail + 1);
+        }
+    }
+    while(running);
+
+    return 0;
+}
+
+
+void ImageWriter_Init()
+{
+    if(SDL_AtomicGet(&writer_running))
+    {
+        return;
+    }
+
+    SDL_AtomicSet(&writer_head, 0);
+    SDL_AtomicSet(&writer_tail, 0);
+    writer_sem = SDL_CreateSemaphore(0);
+    if(!writer_sem)
+    {
+        return;
+    }
+
+    SDL_AtomicSet(&writer_running, 1);
+    writer_thread = SDL_CreateThread(ImageWriter_Thread, "image_writer", NULL);
+    if(!writer_thread)
+    {
+        SDL_AtomicSet(&writer_running, 0);
+        SDL_DestroySemaphore(writer_sem);
+        writer_sem = NULL;
+    }
+}
+
+
+void ImageWriter_Destroy()
+{
+    if(!SDL_AtomicGet(&writer_running))
+    {
+        return;
+    }
+
+    // writer thread drains the queue and exits, new images go synchronous path
+    SDL_AtomicSet(&writer_running, 0);
+    SDL_SemPost(writer_sem);
+    SDL_WaitThread(writer_thread, NULL);
+    writer_thread = NULL;
+    SDL_DestroySemaphore(writer_sem);
+    writer_sem = NULL;
+}
+
+
+void ImageWriter_Flush()
+{
+    while(SDL_AtomicGet(&writer_running) && (SDL_AtomicGet(&writer_tail) != SDL_AtomicGet(&writer_head)))
+    {
+        SDL_Delay(1);
+    }
+}
+
+
+int ImageWriter_Push(const char *file_name, int format, uint8_t *pixels, uint32_t w, uint32_t h, uint32_t bpp)
+{
+    image_writer_job_t local_job;
+    image_writer_job_p job = &local_job;
+    int head = SDL_AtomicGet(&writer_head);
+    int running = SDL_AtomicGet(&writer_running);
+
+    if(running)
+    {
+        if(head - SDL_AtomicGet(&writer_tail) >= IMAGE_WRITER_QUEUE_SIZE)
+        {
+            SDL_AtomicAdd(&writer_dropped, 1);
+            free(pixels);
+            return 0;
+        }
+        job = writer_jobs + (head & IMAGE_WRITER_QUEUE_MASK);
+    }
+
+    strncpy(job->file_name, file_name, IMAGE_WRITER_MAX_FILE_NAME - 1);
+    job->file_name[IMAGE_WRITER_MAX_FILE_NAME - 1] = 0;
+    job->format = format;
+    job->pixels = pixels;
+    job->w = w;
+    job->h = h;
+    job->bpp = bpp;
+
+    if(running)
+    {
+        SDL_MemoryBarrierRelease();
+        SDL_AtomicSet(&writer_head, head + 1);
+        SDL_SemPost(writer_sem);
+    }
+    else
+    {
+        ImageWriter_Write(job);
+    }
+
+    return 1;
+}
+
+
+void ImageWriter_GetStats(image_writer_stats_p stats)
+{
+    stats->written = SDL_AtomicGet(&writer_written);
+    stats->failed = SDL_AtomicGet(&writer_failed);
+    stats->dropped = SDL_AtomicGet(&writer_dropped);
+    stats->queued = SDL_AtomicGet(&writer_head) - SDL_AtomicGet(&writer_tail);
+}
@@ -0,0 +1,44 @@
+#ifndef ENGINE_IMAGE_WRITER_H
+#define ENGINE_IMAGE_WRITER_H
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/*
+ * Background image writer: main thread pushes ready pixel buffers, worker
+ * thread encodes them by Image_Save() and writes files. No GL calls, so it
+ * can be fed with any synthetic buffers. Single producer (one pushing
+ * thread) / single consumer ring. Until ImageWriter_Init() and after
+ * ImageWriter_Destroy() images are written synchronously.
+ */
+#define IMAGE_WRITER_QUEUE_SIZE     (8)                                         // must be power of 2
+#define IMAGE_WRITER_MAX_FILE_NAME  (128)
+
+typedef struct image_writer_stats_s
+{
+    uint32_t                written;
+    uint32_t                failed;
+    uint32_t                dropped;                                            // queue was full
+    uint32_t                queued;                                             // waiting now
+}image_writer_stats_t, *image_writer_stats_p;
+
+void ImageWriter_Init();
+void ImageWriter_Destroy();                                                     // writes all queued images
+void ImageWriter_Flush();
+
+/**
+ * Takes ownership of malloc'ed pixels (freed by writer, also on fail);
+ * format is IMAGE_FORMAT_*, pixels layout is the same as for Image_Save();
+ * returns 0 if image was dropped.
+ */
+int  ImageWriter_Push(const char *file_name, int format, uint8_t *pixels, uint32_t w, uint32_t h, uint32_t bpp);
+void ImageWriter_GetStats(image_writer_stats_p stats);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif
@@ -1,15 +1,22 @@
 
 #include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
 
+#include "core/arena.h"
 #include "core/gl_util.h"
 #include "core/vmath.h"
 #include "core/polygon.h"
 #include "mesh.h"
 
 
+static mesh_buffers_stats_t mesh_buffers_stats = {0};
+static int                  mesh_pack_vertices = -1;                        // -1 - not checked yet
+
 void BaseMesh_GenVBO(struct base_mesh_s *mesh);
 void BaseMesh_AddPolygonToFaces(base_mesh_p mesh, struct polygon_s *p);
 void BaseMesh_AddAnimatedPolygonToFaces(base_mesh_p mesh, uint32_t *vertex_index, struct polygon_s *p);
+void BaseMesh_AddTransparentPolygonToFaces(base_mesh_p mesh, struct polygon_s *p);
 
 void BaseMesh_Clear(base_mesh_p mesh)
 {
@@ -31,7 +38,14 @@ void BaseMesh_Clear(base_mesh_p mesh)
         mesh->vbo_animated_texcoord_array = 0;
     }
 
+    if(qglIsBufferARB(mesh->vbo_index_array))
+    {
+        qglDeleteBuffersARB(1, &mesh->vbo_index_array);
+        mesh->vbo_index_array = 0;
+    }
+
     mesh->transparency_polygons = NULL;
+    mesh->transparency_animated_polygons = NULL;
     mesh->animated_polygons = NULL;
     
     if(mesh->polygons)
@@ -40,14 +54,14 @@ void BaseMesh_Clear(base_mesh_p mesh)
         {
             Polygon_Clear(mesh->polygons + i);
         }
-        free(mesh->polygons);
+        Arena_Free(mesh->polygons);
         mesh->polygons = NULL;
         mesh->polygons_count = 0;
     }
 
     if(mesh->vertices)
     {
-        free(mesh->vertices);
+        Arena_Free(mesh->vertices);
         mesh->vertices = NULL;
         mesh->vertex_count = 0;
     }
@@ -65,12 +79,12 @@ void BaseMesh_Clear(base_mesh_p mesh)
         {
             if(mesh->faces[i].elements)
             {
-                free(mesh->faces[i].elements);
+                Arena_Free(mesh->faces[i].elements);
                 mesh->faces[i].elements = NULL;
             }
             mesh->faces[i].elements_count = 0;
         }
-        free(mesh->faces);
+        Arena_Free(mesh->faces);
         mesh->faces = NULL;
         mesh->faces_count = 0;
     }
@@ -81,15 +95,31 @@ void BaseMesh_Clear(base_mesh_p mesh)
         {
             if(mesh->animated_faces[i].elements)
             {
-                free(mesh->animated_faces[i].elements);
+                Arena_Free(mesh->animated_faces[i].elements);
                 mesh->animated_faces[i].elements = NULL;
             }
             mesh->animated_faces[i].elements_count = 0;
         }
-        free(mesh->animated_faces);
+        Arena_Free(mesh->animated_faces);
         mesh->animated_faces = NULL;
         mesh->animated_faces_count = 0;
     }
+
+    if(mesh->transparent_faces)
+    {
+        for(uint32_t i = 0; i < mesh->transparent_faces_count; i++)
+        {
+            if(mesh->transparent_faces[i].elements)
+            {
+                Arena_Free(mesh->transparent_faces[i].elements);
+                mesh->transparent_faces[i].elements = NULL;
+            }
+            mesh->transparent_faces[i].elements_count = 0;
+        }
+        Arena_Free(mesh->transparent_faces);
+        mesh->transparent_faces = NULL;
+        mesh->transparent_faces_count = 0;
+    }
     
     mesh->vertex_count = 0;
 }
@@ -144,11 +174,164 @@ void BaseMesh_FindBB(base_mesh_p mesh)
 }
 
 
+void BaseMesh_ResetBuffersStats()
+{
+    mesh_buffers_stats.meshes = 0;
+    mesh_buffers_stats.vertex_bytes_full = 0;
+    mesh_buffers_stats.vertex_bytes = 0;
+    mesh_buffers_stats.index_bytes_full = 0;
+    mesh_buffers_stats.index_bytes = 0;
+}
+
+
+const mesh_buffers_stats_t *BaseMesh_GetBuffersStats()
+{
+    return &mesh_buffers_stats;
+}
+
+
+static GLhalfARB BaseMesh_FloatToHalf(float f)
+{
+    union
+    {
+        float       f;
+        uint32_t    u;
+    } v;
+    uint32_t sign, exp, mant;
+
+    v.f = f;
+    sign = (v.u >> 16) & 0x8000;
+    exp = (v.u >> 23) & 0xFF;
+    mant = v.u & 0x007FFFFF;
+
+    if(exp < 127 - 14)                                                          // too small for normalized half
+    {
+        return (GLhalfARB)sign;
+    }
+    if(exp > 127 + 15)                                                          // overflow, clamp to max half
+    {
+        return (GLhalfARB)(sign | 0x7BFF);
+    }
+
+    mant += 0x00001000;                                                         // round to nearest
+    if(mant & 0x00800000)
+    {
+        mant = 0;
+        exp++;
+        if(exp > 127 + 15)
+        {
+            return (GLhalfARB)(sign | 0x7BFF);
+        }
+    }
+
+    return (GLhalfARB)(sign | ((exp - 127 + 15) << 10) | (mant >> 13));
+}
+
+
+static GLbyte BaseMesh_FloatToSnorm8(float f)
+{
+    f = (f > 1.0f) ? (1.0f) : ((f < -1.0f) ? (-1.0f) : (f));
+    return (GLbyte)((f < 0.0f) ? (f * 127.0f - 0.5f) : (f * 127.0f + 0.5f));
+}
+
+
+static void BaseMesh_UploadVertices(GLuint vbo, vertex_p vertices, uint32_t count, int packed)
+{
+    qglBindBufferARB(GL_ARRAY_BUFFER_ARB, vbo);
+    if(packed)
+    {
+        packed_vertex_p data = (packed_vertex_p)malloc(count * sizeof(packed_vertex_t));
+        packed_vertex_p dst = data;
+        vertex_p src = vertices;
+        for(uint32_t i = 0; i < count; i++, src++, dst++)
+        {
+            vec3_copy(dst->position, src->position);
+            dst->normal[0] = BaseMesh_FloatToSnorm8(src->normal[0]);
+            dst->normal[1] = BaseMesh_FloatToSnorm8(src->normal[1]);
+            dst->normal[2] = BaseMesh_FloatToSnorm8(src->normal[2]);
+            dst->normal[3] = 0;
+            dst->color[0] = BaseMesh_FloatToHalf(src->color[0]);
+            dst->color[1] = BaseMesh_FloatToHalf(src->color[1]);
+            dst->color[2] = BaseMesh_FloatToHalf(src->color[2]);
+            dst->color[3] = BaseMesh_FloatToHalf(src->color[3]);
+            dst->tex_coord[0] = src->tex_coord[0];
+            dst->tex_coord[1] = src->tex_coord[1];
+        }
+        qglBufferDataARB(GL_ARRAY_BUFFER_ARB, count * sizeof(packed_vertex_t), data, GL_STATIC_DRAW_ARB);
+        free(data);
+        mesh_buffers_stats.vertex_bytes += count * sizeof(packed_vertex_t);
+    }
+    else
+    {
+        qglBufferDataARB(GL_ARRAY_BUFFER_ARB, count * sizeof(vertex_t), vertices, GL_STATIC_DRAW_ARB);
+        mesh_buffers_stats.vertex_bytes += count * sizeof(vertex_t);
+    }
+    mesh_buffers_stats.vertex_bytes_full += count * sizeof(vertex_t);
+}
+
+
+static uint32_t BaseMesh_FacesElementsSize(mesh_face_p faces, uint32_t faces_count, uint32_t offset)
+{
+    mesh_face_p face = faces;
+    for(uint32_t i = 0; i < faces_count; i++, face++)
+    {
+        face->elements_offset = offset;
+        offset += face->elements_count * ((face->elements_type == GL_UNSIGNED_SHORT) ? sizeof(GLushort) : sizeof(GLuint));
+        offset = (offset + 3) & ~3U;                                            // keep 32 bit indices aligned
+    }
+    return offset;
+}
+
+
+static void BaseMesh_FacesElementsUpload(mesh_face_p faces, uint32_t faces_count)
+{
+    mesh_face_p face = faces;
+    for(uint32_t i = 0; i < faces_count; i++, face++)
+    {
+        if(face->elements_count > 0)
+        {
+            qglBufferSubDataARB(GL_ELEMENT_ARRAY_BUFFER_ARB, face->elements_offset,
+                face->elements_count * ((face->elements_type == GL_UNSIGNED_SHORT) ? sizeof(GLushort) : sizeof(GLuint)), face->elements);
+        }
+    }
+}
+
+/**
+ * All faces (static, animated and transparent) share one element buffer,
+ * every face addresses its elements by byte offset in it.
+ */
+static void BaseMesh_GenIndexBuffer(struct base_mesh_s *mesh)
+{
+    uint32_t size = BaseMesh_FacesElementsSize(mesh->faces, mesh->faces_count, 0);
+    size = BaseMesh_FacesElementsSize(mesh->animated_faces, mesh->animated_faces_count, size);
+    size = BaseMesh_FacesElementsSize(mesh->transparent_faces, mesh->transparent_faces_count, size);
+
+    mesh->vbo_index_array = 0;
+    if(size > 0)
+    {
+        qglGenBuffersARB(1, &mesh->vbo_index_array);
+        qglBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, mesh->vbo_index_array);
+        qglBufferDataARB(GL_ELEMENT_ARRAY_BUFFER_ARB, size, NULL, GL_STATIC_DRAW_ARB);
+        BaseMesh_FacesElementsUpload(mesh->faces, mesh->faces_count);
+        BaseMesh_FacesElementsUpload(mesh->animated_faces, mesh->animated_faces_count);
+        BaseMesh_FacesElementsUpload(mesh->transparent_faces, mesh->transparent_faces_count);
+    }
+}
+
+
 void BaseMesh_GenVBO(struct base_mesh_s *mesh)
 {
+    if(mesh_pack_vertices < 0)
+    {
+        mesh_pack_vertices = IsGLExtensionSupported("GL_ARB_half_float_vertex");
+    }
+
     mesh->vbo_vertex_array = 0;
+    mesh->vbo_packed = mesh_pack_vertices;
     mesh->vbo_animated_vertex_array = 0;
     mesh->vbo_animated_texcoord_array = 0;
+    mesh->animated_texcoord_static = 0;
+    mesh_buffers_stats.meshes++;
     
     /// now, begin VBO filling!
     qglGenBuffersARB(1, &mesh->vbo_vertex_array);
@@ -157,31 +340,78 @@ void BaseMesh_GenVBO(struct base_mesh_s *mesh)
         abort();
     }
 
-    qglBindBufferARB(GL_ARRAY_BUFFER_ARB, mesh->vbo_vertex_array);
-    qglBufferDataARB(GL_ARRAY_BUFFER_ARB, mesh->vertex_count * sizeof(vertex_t), mesh->vertices, GL_STATIC_DRAW_ARB);
+    BaseMesh_UploadVertices(mesh->vbo_vertex_array, mesh->vertices, mesh->vertex_count, mesh->vbo_packed);
 
     // Now for animated polygons, if any
     if(mesh->animated_polygons)
     {
         // And upload.
         qglGenBuffersARB(1, &mesh->vbo_animated_vertex_array);
-        qglBindBufferARB(GL_ARRAY_BUFFER, mesh->vbo_animated_vertex_array);
-        qglBufferDataARB(GL_ARRAY_BUFFER, mesh->animated_vertex_count * sizeof(vertex_t), mesh->animated_vertices, GL_STATIC_DRAW);
+        BaseMesh_UploadVertices(mesh->vbo_animated_vertex_array, mesh->animated_vertices, mesh->animated_vertex_count, mesh->vbo_packed);
         free(mesh->animated_vertices);
         mesh->animated_vertices = NULL;
         // Prepare empty buffer for tex coords
         qglGenBuffersARB(1, &mesh->vbo_animated_texcoord_array);
         qglBindBufferARB(GL_ARRAY_BUFFER, mesh->vbo_animated_texcoord_array);
-        qglBufferDataARB(GL_ARRAY_BUFFER, mesh->animated_vertex_count * sizeof(GLfloat [2]), 0, GL_STREAM_DRAW);
+        qglBufferDataARB(GL_ARRAY_BUFFER, mesh->animated_vertex_count * sizeof(GLfloat [3]), 0, GL_STREAM_DRAW);
     }
+
+    BaseMesh_GenIndexBuffer(mesh);
     qglBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
     qglBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, 0);
 }
 
+/**
+ * Binds mesh vertex and element buffers and sets vertex, colour and normal
+ * pointers; tex coord pointer is set only for static faces: animated ones
+ * take it from vbo_animated_texcoord_array, bound by caller. Faces are drawn
+ * with MESH_FACE_ELEMENTS(face); caller unbinds element buffer after drawing.
+ */
+void BaseMesh_SetVertexPointers(base_mesh_p mesh, int animated)
+{
+    qglBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, mesh->vbo_index_array);
+    qglBindBufferARB(GL_ARRAY_BUFFER_ARB, (animated) ? (mesh->vbo_animated_vertex_array) : (mesh->vbo_vertex_array));
+    if(mesh->vbo_packed)
+    {
+        qglVertexPointer(3, GL_FLOAT, sizeof(packed_vertex_t), (void*)offsetof(packed_vertex_t, position));
+        qglColorPointer(4, GL_HALF_FLOAT_ARB, sizeof(packed_vertex_t), (void*)offsetof(packed_vertex_t, color));
+        qglNormalPointer(GL_BYTE, sizeof(packed_vertex_t), (void*)offsetof(packed_vertex_t, normal));
+        if(!animated)
+        {
+            qglTexCoordPointer(2, GL_FLOAT, sizeof(packed_vertex_t), (void*)offsetof(packed_vertex_t, tex_coord));
+        }
+    }
+    else
+    {
+        qglVertexPointer(3, GL_FLOAT, sizeof(vertex_t), (void*)offsetof(vertex_t, position));
+        qglColorPointer(4, GL_FLOAT, sizeof(vertex_t), (void*)offsetof(vertex_t, color));
+        qglNormalPointer(GL_FLOAT, sizeof(vertex_t), (void*)offsetof(vertex_t, normal));
+        if(!animated)
+        {
+            qglTexCoordPointer(2, GL_FLOAT, sizeof(vertex_t), (void*)offsetof(vertex_t, tex_coord));
+        }
+    }
+}
+
 
 /*
  * FACES FUNCTIONS
  */
+/**
+ * Capacity of arrays grown while faces are built: the nearest power of 2,
+ * so arrays started from NULL are reallocated only when count crosses it.
+ */
+static uint32_t BaseMesh_GrowCapacity(uint32_t count)
+{
+    uint32_t ret = 1;
+    while(ret < count)
+    {
+        ret <<= 1;
+    }
+    return (count > 0) ? (ret) : (0);
+}
+
+
 uint32_t BaseMesh_AddVertex(base_mesh_p mesh, struct vertex_s *vertex)
 {
     vertex_p v = mesh->vertices;
@@ -199,7 +429,10 @@ uint32_t BaseMesh_AddVertex(base_mesh_p mesh, struct vertex_s *vertex)
 
     vertex_index = mesh->vertex_count;
     mesh->vertex_count++;
-    mesh->vertices = (vertex_p)realloc(mesh->vertices, mesh->vertex_count * sizeof(vertex_t));
+    if(BaseMesh_GrowCapacity(vertex_index) < mesh->vertex_count)
+    {
+        mesh->vertices = (vertex_p)realloc(mesh->vertices, BaseMesh_GrowCapacity(mesh->vertex_count) * sizeof(vertex_t));
+    }
 
     v = mesh->vertices + vertex_index;
     vec3_copy(v->position, vertex->position);
@@ -227,38 +460,48 @@ uint32_t BaseMesh_FindVertexIndex(base_mesh_p mesh, float v[3])
 }
 
 
-void BaseMesh_AddPolygonToFaces(base_mesh_p mesh, struct polygon_s *p)
+/**
+ * Returns face of given texture page and blending mode, appends new one if needed.
+ */
+static mesh_face_p BaseMesh_GetFace(mesh_face_p *faces, uint32_t *faces_count, GLuint texture_index, uint32_t transparency)
+{
+    for(uint32_t i = 0; i < *faces_count; i++)
+    {
+        if(((*faces)[i].texture_index == texture_index) && ((*faces)[i].transparency == transparency))
+        {
+            return *faces + i;
+        }
+    }
+
+    *faces = (mesh_face_p)realloc(*faces, (*faces_count + 1) * sizeof(mesh_face_t));
+    mesh_face_p face = *faces + *faces_count;
+    (*faces_count)++;
+    face->elements = NULL;
+    face->elements_type = GL_UNSIGNED_INT;
+    face->elements_offset = 0;
+    face->elements_count = 0;
+    face->texture_index = texture_index;
+    face->transparency = transparency;
+
+    return face;
+}
+
+
+static void BaseMesh_AddPolygonElements(base_mesh_p mesh, mesh_face_p current_face, struct polygon_s *p)
 {
-    mesh_face_p current_face = NULL;
     uint32_t add_elements_count = (p->vertex_count - 2) * 3;
     GLuint *current_index;
-    
+
     if (p->double_side)
     {
         add_elements_count *= 2;
     }
-    
-    for(uint32_t i = 0; i < mesh->faces_count; i++)
-    {
-        if(mesh->faces[i].texture_index == p->texture_index)
-        {
-            current_face = mesh->faces + i;
-            break;
-        }
-    }
-    
-    if(current_face == NULL)
+
+    if(BaseMesh_GrowCapacity(current_face->elements_count) < current_face->elements_count + add_elements_count)
     {
-        mesh->faces = (mesh_face_p)realloc(mesh->faces, (mesh->faces_count + 1) * sizeof(mesh_face_t));
-        current_face = mesh->faces + mesh->faces_count;
-        mesh->faces_count++;
-        current_face->elements = NULL;
-        current_face->elements_count = 0;
-        current_face->texture_index = p->texture_index;
+        current_face->elements = realloc(current_face->elements, BaseMesh_GrowCapacity(current_face->elements_count + add_elements_count) * sizeof(GLuint));
     }
-    
-    current_face->elements = (GLuint *)realloc(current_face->elements, (current_face->elements_count + add_elements_count) * sizeof(GLuint));
-    current_index = current_face->elements + current_face->elements_count;
+    current_index = (GLuint*)current_face->elements + current_face->elements_count;
     current_face->elements_count += add_elements_count;
 
     // Render the face as a triangle array
@@ -285,6 +528,24 @@ void BaseMesh_AddPolygonToFaces(base_mesh_p mesh, struct polygon_s *p)
 }
 
 
+void BaseMesh_AddPolygonToFaces(base_mesh_p mesh, struct polygon_s *p)
+{
+    mesh_face_p current_face = BaseMesh_GetFace(&mesh->faces, &mesh->faces_count, p->texture_index, 0);
+    BaseMesh_AddPolygonElements(mesh, current_face, p);
+}
+
+/**
+ * Transparent polygons with static texture share mesh vertex buffer with
+ * opaque ones; faces are split by blending mode too, so sorted transparency
+ * path draws them without CPU side processing.
+ */
+void BaseMesh_AddTransparentPolygonToFaces(base_mesh_p mesh, struct polygon_s *p)
+{
+    mesh_face_p current_face = BaseMesh_GetFace(&mesh->transparent_faces, &mesh->transparent_faces_count, p->texture_index, p->transparency);
+    BaseMesh_AddPolygonElements(mesh, current_face, p);
+}
+
+
 void BaseMesh_AddAnimatedPolygonToFaces(base_mesh_p mesh, uint32_t *vertex_index, struct polygon_s *p)
 {
     mesh_face_p current_face = NULL;
@@ -296,27 +557,13 @@ void BaseMesh_AddAnimatedPolygonToFaces(base_mesh_p mesh, uint32_t *vertex_index
         add_elements_count *= 2;
     }
     
-    for(uint32_t i = 0; i < mesh->animated_faces_count; i++)
-    {
-        if(mesh->animated_faces[i].texture_index == p->texture_index)
-        {
-            current_face = mesh->animated_faces + i;
-            break;
-        }
-    }
-    
-    if(current_face == NULL)
+    current_face = BaseMesh_GetFace(&mesh->animated_faces, &mesh->animated_faces_count, p->texture_index, 0);
+
+    if(BaseMesh_GrowCapacity(current_face->elements_count) < current_face->elements_count + add_elements_count)
     {
-        mesh->animated_faces = (mesh_face_p)realloc(mesh->animated_faces, (mesh->animated_faces_count + 1) * sizeof(mesh_face_t));
-        current_face = mesh->animated_faces + mesh->animated_faces_count;
-        mesh->animated_faces_count++;
-        current_face->elements = NULL;
-        current_face->elements_count = 0;
-        current_face->texture_index = p->texture_index;
+        current_face->elements = realloc(current_face->elements, BaseMesh_GrowCapacity(current_face->elements_count + add_elements_count) * sizeof(GLuint));
     }
-    
-    current_face->elements = (GLuint *)realloc(current_face->elements, (current_face->elements_count + add_elements_count) * sizeof(GLuint));
-    current_index = current_face->elements + current_face->elements_count;
+    current_index = (GLuint*)current_face->elements + current_face->elements_count;
     current_face->elements_count += add_elements_count;
 
     // Render the face as a triangle array
@@ -350,20 +597,88 @@ void BaseMesh_AddAnimatedPolygonToFaces(base_mesh_p mesh, uint32_t *vertex_index
 }
 
 
+/**
+ * Converts face indices to 16 bit, if all mesh vertices are addressable.
+ */
+static void BaseMesh_PackFacesElements(mesh_face_p faces, uint32_t faces_count, uint32_t vertex_count)
+{
+    mesh_face_p face = faces;
+    for(uint32_t i = 0; i < faces_count; i++, face++)
+    {
+        mesh_buffers_stats.index_bytes_full += face->elements_count * sizeof(GLuint);
+        if((vertex_count <= MESH_MAX_SHORT_INDEX + 1) && (face->elements_type == GL_UNSIGNED_INT))
+        {
+            GLuint *src = (GLuint*)face->elements;
+            GLushort *dst = (GLushort*)face->elements;
+            for(uint32_t j = 0; j < face->elements_count; j++)
+            {
+                dst[j] = (GLushort)src[j];                                      // dst never overtakes src
+            }
+            face->elements = realloc(face->elements, face->elements_count * sizeof(GLushort));
+            face->elements_type = GL_UNSIGNED_SHORT;
+        }
+        mesh_buffers_stats.index_bytes += face->elements_count * ((face->elements_type == GL_UNSIGNED_SHORT) ? sizeof(GLushort) : sizeof(GLuint));
+    }
+}
+
+
+/**
+ * Faces are built in heap arrays grown by BaseMesh_GrowCapacity(); final
+ * arrays of level meshes are copied to level arena with exact size. If arena
+ * is out of memory heap array is kept: Arena_Free() releases it on clear.
+ */
+static void *BaseMesh_MoveToArena(void *data, size_t size)
+{
+    void *ret = NULL;
+    if(data && (size > 0))
+    {
+        ret = Arena_Alloc(ARENA_TAG_MESHES, size);
+        if(!ret)
+        {
+            return data;
+        }
+        memcpy(ret, data, size);
+    }
+    free(data);
+    return ret;
+}
+
+
+static mesh_face_p BaseMesh_MoveFacesToArena(mesh_face_p faces, uint32_t faces_count)
+{
+    for(uint32_t i = 0; i < faces_count; i++)
+    {
+        size_t elem_size = (faces[i].elements_type == GL_UNSIGNED_SHORT) ? sizeof(GLushort) : sizeof(GLuint);
+        faces[i].elements = BaseMesh_MoveToArena(faces[i].elements, faces[i].elements_count * elem_size);
+    }
+    return (mesh_face_p)BaseMesh_MoveToArena(faces, faces_count * sizeof(mesh_face_t));
+}
+
+
+/**
+ * Transparent polygons are listed in mesh->transparency_polygons for dynamic
+ * BSP; ones with static texture go first and are also added to transparent
+ * faces, so list tail (mesh->transparency_animated_polygons) holds only
+ * polygons that sorted transparency path still passes to BSP.
+ */
 void BaseMesh_GenFaces(base_mesh_p mesh)
 {
     polygon_p p = mesh->polygons;
+    polygon_p transparency_tail = NULL;
     
     mesh->faces_count = 0;
     mesh->faces = NULL;
     mesh->animated_faces_count = 0;
     mesh->animated_faces = NULL;
+    mesh->transparent_faces_count = 0;
+    mesh->transparent_faces = NULL;
 
     mesh->animated_vertices = NULL;
     mesh->animated_vertex_count = 0;
     
     mesh->animated_polygons = NULL;
     mesh->transparency_polygons = NULL;
+    mesh->transparency_animated_polygons = NULL;
     
     for(uint32_t i = 0; i < mesh->polygons_count; i++, p++)
     {
@@ -371,10 +686,17 @@ void BaseMesh_GenFaces(base_mesh_p mesh)
         {
             BaseMesh_AddPolygonToFaces(mesh, p);
         }
-        else if(p->transparency >= 2)
+        else if((p->transparency >= 2) && (p->anim_id == 0) && !Polygon_IsBroken(p))
         {
+            BaseMesh_AddTransparentPolygonToFaces(mesh, p);
             p->next = mesh->transparency_polygons;
-            mesh->transparency_polygons = p;            
+            mesh->transparency_polygons = p;
+            transparency_tail = (transparency_tail) ? (transparency_tail) : (p);
+        }
+        else if(p->transparency >= 2)
+        {
+            p->next = mesh->transparency_animated_polygons;
+            mesh->transparency_animated_polygons = p;
         }
         else if(p->anim_id > 0)
         {
@@ -382,6 +704,15 @@ void BaseMesh_GenFaces(base_mesh_p mesh)
             mesh->animated_polygons = p;
         }
     }
+
+    if(transparency_tail)
+    {
+        transparency_tail->next = mesh->transparency_animated_polygons;
+    }
+    else
+    {
+        mesh->transparency_polygons = mesh->transparency_animated_polygons;
+    }
     
     if(mesh->animated_polygons)
     {
@@ -397,6 +728,274 @@ void BaseMesh_GenFaces(base_mesh_p mesh)
             BaseMesh_AddAnimatedPolygonToFaces(mesh, &vertex_index, p);
         }
     }
-    
+
+    BaseMesh_PackFacesElements(mesh->faces, mesh->faces_count, mesh->vertex_count);
+    BaseMesh_PackFacesElements(mesh->animated_faces, mesh->animated_faces_count, mesh->animated_vertex_count);
+    BaseMesh_PackFacesElements(mesh->transparent_faces, mesh->transparent_faces_count, mesh->vertex_count);
+
+    mesh->vertices = (vertex_p)BaseMesh_MoveToArena(mesh->vertices, mesh->vertex_count * sizeof(vertex_t));
+    mesh->faces = BaseMesh_MoveFacesToArena(mesh->faces, mesh->faces_count);
+    mesh->animated_faces = BaseMesh_MoveFacesToArena(mesh->animated_faces, mesh->animated_faces_count);
+    mesh->transparent_faces = BaseMesh_MoveFacesToArena(mesh->transparent_faces, mesh->transparent_faces_count);
     BaseMesh_GenVBO(mesh);
 }
+
+/*
+ * MESH BATCH FUNCTIONS
+ */
+/**
+ * Source of skinned part vertex: own position and bone, or, for skin joint,
+ * position of mapped parent mesh vertex and parent bone; normal is always
+ * own (it is copied from parent vertex by SSBoneFrame_FillSkinnedMeshMap).
+ */
+static inline const GLfloat *BaseMesh_SkinPartVertex(const mesh_skin_part_t *part, uint32_t index, uint16_t *bone)
+{
+    if(part->skin_map && (part->skin_map[index] != 0xFFFFFFFF))
+    {
+        *bone = part->parent_bone;
+        return part->parent_mesh->vertices[part->skin_map[index]].position;
+    }
+    *bone = part->bone;
+    return part->mesh->vertices[index].position;
+}
+
+/**
+ * Skinned parts are not transformed, every vertex gets bone index instead;
+ * skin_parts are kept in batch, so owner can check if meshes were swapped.
+ */
+static mesh_batch_p BaseMesh_CreateBatchParts(base_mesh_p *parts, float **transforms, const mesh_skin_part_t *skin_parts, uint32_t parts_count)
+{
+    mesh_batch_p batch = (mesh_batch_p)calloc(1, sizeof(mesh_batch_t));
+    base_mesh_p mesh = &batch->mesh;
+    uint32_t *vertex_base = (uint32_t*)malloc(parts_count * sizeof(uint32_t));
+    GLfloat *bones = NULL;
+
+    batch->parts_count = parts_count;
+
+    // one face per texture page, vertices of all parts in one array
+    for(uint32_t i = 0; i < parts_count; i++)
+    {
+        base_mesh_p part = parts[i];
+        vertex_base[i] = mesh->vertex_count;
+        if(part && part->vertices)
+        {
+            mesh->vertex_count += part->vertex_count;
+            for(uint32_t j = 0; j < part->faces_count; j++)
+            {
+                uint32_t k = 0;
+                for(; (k < mesh->faces_count) && (mesh->faces[k].texture_index != part->faces[j].texture_index); k++);
+                if(k == mesh->faces_count)
+                {
+                    mesh->faces = (mesh_face_p)realloc(mesh->faces, (mesh->faces_count + 1) * sizeof(mesh_face_t));
+                    mesh->faces[k].texture_index = part->faces[j].texture_index;
+                    mesh->faces[k].elements_type = GL_UNSIGNED_INT;
+                    mesh->faces[k].elements_count = 0;
+                    mesh->faces[k].elements_offset = 0;
+                    mesh->faces[k].elements = NULL;
+                    mesh->faces[k].transparency = 0;
+                    mesh->faces_count++;
+                }
+                mesh->faces[k].elements_count += part->faces[j].elements_count;
+            }
+        }
+    }
+
+    if(skin_parts)
+    {
+        batch->skin_parts = (mesh_skin_part_p)malloc(parts_count * sizeof(mesh_skin_part_t));
+        memcpy(batch->skin_parts, skin_parts, parts_count * sizeof(mesh_skin_part_t));
+    }
+
+    if(mesh->faces_count == 0)
+    {
+        free(vertex_base);
+        if(!skin_parts)
+        {
+            free(batch);
+            return NULL;
+        }
+        mesh->vertex_count = 0;                                                 // empty skinned batch, is kept to not rebuild it
+        return batch;
+    }
+
+    mesh->vertices = (vertex_p)malloc(mesh->vertex_count * sizeof(vertex_t));
+    if(skin_parts)
+    {
+        bones = (GLfloat*)malloc(mesh->vertex_count * sizeof(GLfloat));
+    }
+    batch->ranges = (mesh_batch_range_p)calloc(parts_count * mesh->faces_count, sizeof(mesh_batch_range_t));
+    for(uint32_t k = 0; k < mesh->faces_count; k++)
+    {
+        mesh->faces[k].elements = malloc(mesh->faces[k].elements_count * sizeof(GLuint));
+        mesh->faces[k].elements_count = 0;
+    }
+
+    for(uint32_t i = 0; i < parts_count; i++)
+    {
+        base_mesh_p part = parts[i];
+        if(part && part->vertices)
+        {
+            vertex_p dst = mesh->vertices + vertex_base[i];
+            vertex_p src = part->vertices;
+            if(skin_parts)
+            {
+                GLfloat *dst_bone = bones + vertex_base[i];
+                for(uint32_t j = 0; j < part->vertex_count; j++, src++, dst++, dst_bone++)
+                {
+                    uint16_t bone;
+                    *dst = *src;
+                    vec3_copy(dst->position, BaseMesh_SkinPartVertex(skin_parts + i, j, &bone));
+                    *dst_bone = bone;
+                }
+            }
+            else
+            {
+                for(uint32_t j = 0; j < part->vertex_count; j++, src++, dst++)
+                {
+                    *dst = *src;
+                    Mat4_vec3_mul_macro(dst->position, transforms[i], src->position);
+                    Mat4_vec3_rot_macro(dst->normal, transforms[i], src->normal);
+                }
+            }
+
+            // part ranges are in elements here, converted to bytes after upload
+            for(uint32_t k = 0; k < mesh->faces_count; k++)
+            {
+                mesh_face_p face = mesh->faces + k;
+                for(uint32_t j = 0; j < part->faces_count; j++)
+                {
+                    mesh_face_p part_face = part->faces + j;
+                    if(part_face->texture_index == face->texture_index)
+                    {
+                        mesh_batch_range_p range = batch->ranges + i * mesh->faces_count + k;
+                        GLuint *elements = (GLuint*)face->elements + face->elements_count;
+                        range->elements_offset = face->elements_count;
+                        range->elements_count = part_face->elements_count;
+                        for(uint32_t e = 0; e < part_face->elements_count; e++)
+                        {
+                            elements[e] = vertex_base[i] + ((part_face->elements_type == GL_UNSIGNED_SHORT) ?
+                                          (((GLushort*)part_face->elements)[e]) : (((GLuint*)part_face->elements)[e]));
+                        }
+                        face->elements_count += part_face->elements_count;
+                    }
+                }
+            }
+        }
+    }
+    free(vertex_base);
+
+    BaseMesh_PackFacesElements(mesh->faces, mesh->faces_count, mesh->vertex_count);
+    BaseMesh_GenVBO(mesh);
+    if(bones)
+    {
+        qglGenBuffersARB(1, &batch->vbo_bone_array);
+        qglBindBufferARB(GL_ARRAY_BUFFER_ARB, batch->vbo_bone_array);
+        qglBufferDataARB(GL_ARRAY_BUFFER_ARB, mesh->vertex_count * sizeof(GLfloat), bones, GL_STATIC_DRAW_ARB);
+        qglBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+        free(bones);
+    }
+
+    for(uint32_t k = 0; k < mesh->faces_count; k++)
+    {
+        mesh_face_p face = mesh->faces + k;
+        GLuint elem_size = (face->elements_type == GL_UNSIGNED_SHORT) ? sizeof(GLushort) : sizeof(GLuint);
+        for(uint32_t i = 0; i < parts_count; i++)
+        {
+            mesh_batch_range_p range = batch->ranges + i * mesh->faces_count + k;
+            range->elements_offset = face->elements_offset + range->elements_offset * elem_size;
+        }
+        free(face->elements);                                                   // batch is drawn only from buffers
+        face->elements = NULL;
+    }
+    free(mesh->vertices);
+    mesh->vertices = NULL;
+
+    return batch;
+}
+
+
+mesh_batch_p BaseMesh_CreateBatch(base_mesh_p *parts, float **transforms, uint32_t parts_count)
+{
+    return BaseMesh_CreateBatchParts(parts, transforms, NULL, parts_count);
+}
+
+
+mesh_batch_p BaseMesh_CreateSkinnedBatch(const mesh_skin_part_t *parts, uint32_t parts_count)
+{
+    mesh_batch_p batch;
+    base_mesh_p *meshes = (base_mesh_p*)malloc(parts_count * sizeof(base_mesh_p));
+
+    for(uint32_t i = 0; i < parts_count; i++)
+    {
+        meshes[i] = parts[i].mesh;
+    }
+    batch = BaseMesh_CreateBatchParts(meshes, NULL, parts, parts_count);
+    free(meshes);
+
+    return batch;
+}
+
+
+void BaseMesh_DeleteBatch(mesh_batch_p batch)
+{
+    if(batch)
+    {
+        if(qglIsBufferARB(batch->vbo_bone_array))
+        {
+            qglDeleteBuffersARB(1, &batch->vbo_bone_array);
+            batch->vbo_bone_array = 0;
+        }
+        BaseMesh_Clear(&batch->mesh);
+        free(batch->ranges);
+        batch->ranges = NULL;
+        free(batch->skin_parts);
+        batch->skin_parts = NULL;
+        batch->parts_count = 0;
+        free(batch);
+    }
+}
+
+/**
+ * Skin mesh for per bone drawing (in space of its bone): joint vertices take
+ * parent mesh vertex moved by inverse bone transform (relative to parent).
+ */
+void BaseMesh_SkinMeshBoneSpace(base_mesh_p mesh, base_mesh_p parent_mesh, const uint32_t *map, float transform[16], GLfloat *positions, GLfloat *normals)
+{
+    vertex_p v = mesh->vertices;
+    for(uint32_t i = 0; i < mesh->vertex_count; i++, v++, map++, positions += 3, normals += 3)
+    {
+        GLfloat *src_n = v->normal;
+        if(*map == 0xFFFFFFFF)
+        {
+            vec3_copy(positions, v->position);
+            vec3_copy(normals, src_n);
+        }
+        else
+        {
+            Mat4_vec3_mul_inv(positions, transform, parent_mesh->vertices[*map].position);
+            normals[0] = transform[0] * src_n[0] + transform[1] * src_n[1] + transform[2]  * src_n[2];              // (M^-1 * src).x
+            normals[1] = transform[4] * src_n[0] + transform[5] * src_n[1] + transform[6]  * src_n[2];              // (M^-1 * src).y
+            normals[2] = transform[8] * src_n[0] + transform[9] * src_n[1] + transform[10] * src_n[2];              // (M^-1 * src).z
+        }
+    }
+}
+
+/**
+ * CPU reference of palette skinning, the same math as entity skinned vertex
+ * shader: positions and normals of part vertices in model space.
+ */
+void BaseMesh_SkinPart(const mesh_skin_part_t *part, const GLfloat *palette, GLfloat *positions, GLfloat *normals)
+{
+    vertex_p v = part->mesh->vertices;
+    for(uint32_t i = 0; i < part->mesh->vertex_count; i++, v++, positions += 3, normals += 3)
+    {
+        uint16_t bone;
+        const GLfloat *p = BaseMesh_SkinPartVertex(part, i, &bone);
+        const GLfloat *row = palette + bone * MESH_SKIN_PALETTE_ROWS * 4;
+        for(int r = 0; r < 3; r++, row += 4)
+        {
+            positions[r] = row[0] * p[0] + row[1] * p[1] + row[2] * p[2] + row[3];
+            normals[r] = row[0] * v->normal[0] + row[1] * v->normal[1] + row[2] * v->normal[2];
+        }
+    }
+}
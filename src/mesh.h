@@ -16,13 +16,49 @@ extern "C" {
 struct polygon_s;
 struct vertex_s;
 
+#define MESH_MAX_SHORT_INDEX  0xFFFF                                           // faces of smaller meshes use 16 bit indices
+
+// Bone matrices palette for skinned batches: 3 rows (x, y, z) of affine
+// bone matrix per bone, rows are vec4 uniforms of entity skinned shader.
+#define MESH_SKIN_MAX_BONES     (32)
+#define MESH_SKIN_PALETTE_ROWS  (3)
+
+/*
+ * GPU side vertex: 32 bytes instead of 56 of vertex_t. Normals are signed
+ * normalized bytes, colours are half floats (TR vertex colours go up to 2.0),
+ * both are accepted by fixed attribute pointers, so shaders stay the same.
+ * Used only if GL_ARB_half_float_vertex is present.
+ */
+typedef struct packed_vertex_s
+{
+    GLfloat                 position[3];
+    GLbyte                  normal[4];                                          // w is unused
+    GLhalfARB               color[4];
+    GLfloat                 tex_coord[2];
+}packed_vertex_t, *packed_vertex_p;
+
 typedef struct mesh_face_s
 {
     GLuint                  texture_index;
+    GLenum                  elements_type;                                      // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
     GLuint                  elements_count;
-    GLuint                 *elements;    
+    GLuint                  elements_offset;                                    // in bytes, in mesh->vbo_index_array
+    GLvoid                 *elements;                                           // client side copy
+    uint32_t                transparency;                                       // blending mode, only for transparent faces
 }mesh_face_t, *mesh_face_p;
 
+#define MESH_FACE_ELEMENTS(face) ((const GLvoid*)(uintptr_t)(face)->elements_offset)
+
+// level geometry buffers sizes, in bytes: unpacked (vertex_t + 32 bit indices) and real
+typedef struct mesh_buffers_stats_s
+{
+    uint32_t                meshes;
+    uint32_t                vertex_bytes_full;
+    uint32_t                vertex_bytes;
+    uint32_t                index_bytes_full;
+    uint32_t                index_bytes;
+}mesh_buffers_stats_t, *mesh_buffers_stats_p;
+
 /*
  * base mesh, uses everywhere
  */
@@ -33,6 +69,7 @@ typedef struct base_mesh_s
     struct polygon_s       *polygons;                                           // polygons data
 
     struct polygon_s       *transparency_polygons;                              // transparency mesh's polygons list
+    struct polygon_s       *transparency_animated_polygons;                     // its tail with animated and broken polygons
     struct polygon_s       *animated_polygons;                                  // opaque animated mesh's polygons list
 
     uint32_t                faces_count;                                        // faces with static texture
@@ -40,6 +77,9 @@ typedef struct base_mesh_s
 
     uint32_t                animated_faces_count;                               // faces with animated texture
     struct mesh_face_s     *animated_faces;
+
+    uint32_t                transparent_faces_count;                            // blended faces with static texture, by page and mode
+    struct mesh_face_s     *transparent_faces;
     
     uint32_t                vertex_count;                                       // number of mesh's vertices
     uint32_t                animated_vertex_count;
@@ -52,10 +92,50 @@ typedef struct base_mesh_s
     float                   radius;                                             // radius of the bounding sphere
 
     GLuint                  vbo_vertex_array;
+    GLuint                  vbo_packed;                                         // vertex arrays are packed_vertex_t
     GLuint                  vbo_animated_vertex_array;
-    GLuint                  vbo_animated_texcoord_array;
+    GLuint                  vbo_animated_texcoord_array;                        // u, v, animated texture frame slot
+    GLuint                  animated_texcoord_static;                           // tex coords are filled once, frames are applied by shader
+    GLuint                  vbo_index_array;                                    // elements of faces and animated faces
+    uint32_t                queue_frame;                                        // render queue frame stamp of last animated tex coords update
 }base_mesh_t, *base_mesh_p;
 
+/*
+ * Static faces of several meshes (parts) merged into one mesh with
+ * one face per texture page. Part vertices are pre transformed, so
+ * any set of parts is drawn with one transform, and every page of it
+ * with one glMultiDrawElements call.
+ */
+typedef struct mesh_batch_range_s
+{
+    GLuint                  elements_offset;                                    // in bytes, in batch->mesh.vbo_index_array
+    GLuint                  elements_count;                                     // 0 - part has no faces on that page
+}mesh_batch_range_t, *mesh_batch_range_p;
+
+typedef struct mesh_batch_s
+{
+    struct base_mesh_s      mesh;
+    uint32_t                parts_count;
+    struct mesh_batch_range_s *ranges;                                          // [part * mesh.faces_count + face]
+    struct mesh_skin_part_s *skin_parts;                                        // skinned batch only: parts sources
+    GLuint                  vbo_bone_array;                                     // skinned batch only: bone of every vertex, float
+}mesh_batch_t, *mesh_batch_p;
+
+/*
+ * Part of skinned batch: mesh vertices are kept in bone space and go with
+ * bone matrix. Vertices of skin mesh, mapped by skin_map to the parent
+ * mesh, take parent vertex position and go with parent bone matrix: skin
+ * joints follow parent bone, as in CPU skinning of TR4+ models.
+ */
+typedef struct mesh_skin_part_s
+{
+    struct base_mesh_s     *mesh;                                               // NULL - empty part
+    struct base_mesh_s     *parent_mesh;
+    const uint32_t         *skin_map;                                           // NULL - rigid part
+    uint16_t                bone;
+    uint16_t                parent_bone;
+}mesh_skin_part_t, *mesh_skin_part_p;
+
 
 /*
  * base sprite structure
@@ -111,6 +191,16 @@ void BaseMesh_FindBB(base_mesh_p mesh);
 uint32_t BaseMesh_AddVertex(base_mesh_p mesh, struct vertex_s *vertex);
 uint32_t BaseMesh_FindVertexIndex(base_mesh_p mesh, float v[3]);
 void     BaseMesh_GenFaces(base_mesh_p mesh);
+void     BaseMesh_SetVertexPointers(base_mesh_p mesh, int animated);
+
+mesh_batch_p BaseMesh_CreateBatch(base_mesh_p *parts, float **transforms, uint32_t parts_count);
+mesh_batch_p BaseMesh_CreateSkinnedBatch(const mesh_skin_part_t *parts, uint32_t parts_count);
+void         BaseMesh_DeleteBatch(mesh_batch_p batch);
+void         BaseMesh_SkinMeshBoneSpace(base_mesh_p mesh, base_mesh_p parent_mesh, const uint32_t *map, float transform[16], GLfloat *positions, GLfloat *normals);
+void         BaseMesh_SkinPart(const mesh_skin_part_t *part, const GLfloat *palette, GLfloat *positions, GLfloat *normals);
+
+void     BaseMesh_ResetBuffersStats();
+const mesh_buffers_stats_t *BaseMesh_GetBuffersStats();
 
 
 #ifdef	__cplusplus
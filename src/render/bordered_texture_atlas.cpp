@@ -16,23 +16,46 @@
 #include <string.h>
 
 #include "../core/gl_util.h"
+#include "../core/parallel.h"
 #include "../core/polygon.h"
-#include "bsp_tree_2d.h"
+#include "rect_packer.h"
 #include "../vt/vt_level.h"
 
-#ifndef __APPLE__
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define ATLAS_NEON 1
+#endif
+
 /*!
- * Fills an area of memory with a four-byte pattern pointed to.
- * This is a standard library function on Mac OS X, but sadly not anywhere else, so I'm redefining it here. Because I know where it will be called, I can add additional requirements: len must be a multiple of four, and pattern and b both must be four-byte aligned.
+ * Fills count pixels with one pixel value, four pixels per store where SSE2 or NEON is available.
  */
-static void memset_pattern4(void *b, const void *pattern, const size_t len)
+static inline void fill_pixels(uint32_t *dst, uint32_t value, size_t count)
 {
-    uint32_t *intb = (uint32_t *) b;
-    uint32_t patternValue = *((uint32_t *) pattern);
-    for (size_t i = 0; i < len/4; i++)
-        intb[i] = patternValue;
-}
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i v = _mm_set1_epi32((int) value);
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_si128((__m128i *) (dst + i), v);
+#elif defined(ATLAS_NEON)
+    const uint32x4_t v = vdupq_n_u32(value);
+    for (; i + 4 <= count; i += 4)
+        vst1q_u32(dst + i, v);
 #endif
+    for (; i < count; i++)
+        dst[i] = value;
+}
+
+/*!
+ * Work for one page in createTextures: the canonical textures of the page, as indices.
+ */
+struct blit_job
+{
+    const bordered_texture_atlas *atlas;
+    uint32_t *data;
+    const unsigned long *textures;
+};
 
 static __inline GLuint NextPowerOf2(GLuint in)
 {
@@ -86,7 +109,9 @@ int bordered_texture_atlas::compareCanonicalTextureSizes(const void *parameter1,
 
 /*!
  * Lays out the texture data and switches the atlas to laid out mode. This makes
- * use of a bsp_tree_2d to handle all the really annoying stuff.
+ * use of a rect_packer to handle all the really annoying stuff. Textures are
+ * placed highest first (then biggest area), each into the first page that
+ * has space for it, so a new page is opened only when all others are full.
  */
 void bordered_texture_atlas::layOutTextures()
 {
@@ -102,7 +127,8 @@ void bordered_texture_atlas::layOutTextures()
     // Find positions for the canonical textures
     number_result_pages = 0;
     result_page_height = NULL;
-    bsp_tree_2d_p *result_pages = NULL;
+    result_page_used_area = NULL;
+    rect_packer_p *result_pages = NULL;
 
     for (unsigned long texture = 0; texture < number_canonical_object_textures; texture++)
     {
@@ -112,7 +138,7 @@ void bordered_texture_atlas::layOutTextures()
         bool found_place = 0;
         for (unsigned long page = 0; page < number_result_pages; page++)
         {
-            found_place = BSPTree2D_FindSpaceFor(result_pages[page],
+            found_place = RectPacker_FindSpaceFor(result_pages[page],
                                                  canonical.width + 2*border_width,
                                                  canonical.height + 2*border_width,
                                                  &(canonical.new_x_with_border),
@@ -133,11 +159,11 @@ void bordered_texture_atlas::layOutTextures()
         if (!found_place)
         {
             number_result_pages += 1;
-            result_pages = (bsp_tree_2d_p *) realloc(result_pages, sizeof(bsp_tree_2d_p) * number_result_pages);
-            result_pages[number_result_pages - 1] = BSPTree2D_Create(result_page_width, result_page_width);
+            result_pages = (rect_packer_p *) realloc(result_pages, sizeof(rect_packer_p) * number_result_pages);
+            result_pages[number_result_pages - 1] = RectPacker_Create(packer_type, result_page_width, result_page_width);
             result_page_height = (unsigned *) realloc(result_page_height, sizeof(unsigned) * number_result_pages);
 
-            BSPTree2D_FindSpaceFor(result_pages[number_result_pages - 1],
+            RectPacker_FindSpaceFor(result_pages[number_result_pages - 1],
                                    canonical.width + 2*border_width,
                                    canonical.height + 2*border_width,
                                    &(canonical.new_x_with_border),
@@ -150,15 +176,17 @@ void bordered_texture_atlas::layOutTextures()
     }
 
     // Fix up heights if necessary
+    result_page_used_area = (unsigned long *) malloc(sizeof(unsigned long) * (number_result_pages + 1));
     for (unsigned page = 0; page < number_result_pages; page++)
     {
         result_page_height[page] = NextPowerOf2(result_page_height[page]);
+        result_page_used_area[page] = RectPacker_GetUsedArea(result_pages[page]);
     }
 
     // Cleanup
     delete [] sorted_indices;
     for (unsigned long i = 0; i < number_result_pages; i++)
-        BSPTree2D_Destroy(result_pages[i]);
+        RectPacker_Destroy(result_pages[i]);
     free(result_pages);
 }
 
@@ -168,11 +196,15 @@ bordered_texture_atlas::bordered_texture_atlas(int border,
                                                size_t object_texture_count,
                                                const tr4_object_texture_t *object_textures,
                                                size_t sprite_texture_count,
-                                               const tr_sprite_texture_t *sprite_textures)
+                                               const tr_sprite_texture_t *sprite_textures,
+                                               int packer,
+                                               unsigned max_page_size)
 : border_width(border),
+packer_type(packer),
 number_result_pages(0),
 result_page_width(0),
 result_page_height(NULL),
+result_page_used_area(NULL),
 number_original_pages(page_count),
 original_pages(pages),
 number_file_object_textures(0),
@@ -183,8 +215,9 @@ number_canonical_object_textures(0),
 canonical_object_textures(NULL),
 textures_indexes(NULL)
 {
-    GLint max_texture_edge_length = 0;
-    qglGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_texture_edge_length);
+    GLint max_texture_edge_length = max_page_size;
+    if (max_texture_edge_length <= 0)
+        qglGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_texture_edge_length);
     if (max_texture_edge_length > 4096)
         max_texture_edge_length = 4096; // That is already 64 MB and covers up to 256 pages.
     result_page_width = max_texture_edge_length;
@@ -222,6 +255,7 @@ bordered_texture_atlas::~bordered_texture_atlas()
     delete [] canonical_object_textures;
     original_pages = NULL;
     free(result_page_height);
+    free(result_page_used_area);
 }
 
 void bordered_texture_atlas::addObjectTexture(const tr4_object_texture_t &texture)
@@ -493,146 +527,286 @@ unsigned long bordered_texture_atlas::getNumAtlasPages() const
     return number_result_pages;
 }
 
-void bordered_texture_atlas::createTextures(GLuint *textureNames)
+unsigned bordered_texture_atlas::getPageWidth() const
 {
-    GLubyte *data = (GLubyte *) malloc(4 * result_page_width * result_page_width);
+    return result_page_width;
+}
 
-    qglGenTextures((GLsizei) number_result_pages, textureNames);
+unsigned bordered_texture_atlas::getPageHeight(unsigned long page) const
+{
+    return (page < number_result_pages) ? result_page_height[page] : 0;
+}
 
-    textures_indexes = textureNames;
+float bordered_texture_atlas::getPageOccupancy(unsigned long page) const
+{
+    if (page >= number_result_pages || result_page_height[page] == 0)
+        return 0.0f;
+    return (float) result_page_used_area[page] / ((float) result_page_width * (float) result_page_height[page]);
+}
 
-    for (unsigned long page = 0; page < number_result_pages; page++)
+unsigned long bordered_texture_atlas::checkLayout() const
+{
+    unsigned long errors = 0;
+
+    for (unsigned long i = 0; i < number_canonical_object_textures; i++)
     {
-        for (unsigned long texture = 0; texture < number_canonical_object_textures; texture++)
+        const canonical_object_texture &a = canonical_object_textures[i];
+        const unsigned a_width = a.width + 2 * border_width;
+        const unsigned a_height = a.height + 2 * border_width;
+
+        if (a.new_page >= number_result_pages ||
+            a.new_x_with_border + a_width > result_page_width ||
+            a.new_y_with_border + a_height > result_page_height[a.new_page])
         {
-            const canonical_object_texture &canonical = canonical_object_textures[texture];
-            if (canonical.new_page != page)
-                continue;
+            errors++;
+            continue;
+        }
 
-            if(canonical.original_page == WHITE_TEXTURE_INDEX)
+        for (unsigned long j = i + 1; j < number_canonical_object_textures; j++)
+        {
+            const canonical_object_texture &b = canonical_object_textures[j];
+            if (b.new_page == a.new_page &&
+                b.new_x_with_border < a.new_x_with_border + a_width &&
+                a.new_x_with_border < b.new_x_with_border + b.width + 2 * border_width &&
+                b.new_y_with_border < a.new_y_with_border + a_height &&
+                a.new_y_with_border < b.new_y_with_border + b.height + 2 * border_width)
             {
-                uint32_t white_pixels[1] = {0xFFFFFFFFU};
-                // Add top border
-                for (int border = 0; border < border_width; border++)
-                {
-                    unsigned x = canonical.new_x_with_border;
-                    unsigned y = canonical.new_y_with_border + border;
-
-                    // expand top-left pixel
-                    memset_pattern4(&data[(y*result_page_width + x) * 4],
-                           white_pixels, 4 * border_width);
-                    // copy top line
-                    memset_pattern4(&data[(y*result_page_width + x + border_width) * 4],
-                           white_pixels, canonical.width * 4);
-                    // expand top-right pixel
-                    memset_pattern4(&data[(y*result_page_width + x + border_width + canonical.width) * 4],
-                           white_pixels, 4 * border_width);
-                }
+                errors++;
+            }
+        }
+    }
 
-                // Copy main content
-                for (int line = 0; line < canonical.height; line++)
-                {
-                    unsigned x = canonical.new_x_with_border;
-                    unsigned y = canonical.new_y_with_border + border_width + line;
-
-                    // expand left pixel
-                    memset_pattern4(&data[(y*result_page_width + x) * 4],
-                           white_pixels, 4 * border_width);
-                    // copy line
-                    memset_pattern4(&data[(y*result_page_width + x + border_width) * 4],
-                           white_pixels, canonical.width * 4);
-                    // expand right pixel
-                    memset_pattern4(&data[(y*result_page_width + x + border_width + canonical.width) * 4],
-                           white_pixels, 4 * border_width);
-                }
+    return errors;
+}
 
-                // Add bottom border
-                for (int border = 0; border < border_width; border++)
-                {
-                    unsigned x = canonical.new_x_with_border;
-                    unsigned y = canonical.new_y_with_border + canonical.height + border_width + border;
-
-                    // expand bottom-left pixel
-                    memset_pattern4(&data[(y*result_page_width + x) * 4],
-                           white_pixels, 4 * border_width);
-                    // copy bottom line
-                    memset_pattern4(&data[(y*result_page_width + x + border_width) * 4],
-                           white_pixels, canonical.width * 4);
-                    // expand bottom-right pixel
-                    memset_pattern4(&data[(y*result_page_width + x + border_width + canonical.width) * 4],
-                           white_pixels, 4 * border_width);
-                }
+/*!
+ * Copies one canonical texture with its borders into the page. Source line of every destination row is clamped to the texture, so the top border repeats the first line and the bottom border repeats the line just below the texture (as it always did); border rows are copies of the row above. Left and right borders repeat the first pixel and the pixel just right of the line.
+ */
+void bordered_texture_atlas::blitCanonicalTexture(uint32_t *data, const canonical_object_texture &canonical) const
+{
+    const unsigned rows = canonical.height + 2 * border_width;
+    const unsigned row_pixels = canonical.width + 2 * border_width;
+    const uint32_t *original = NULL;
+    uint32_t *dst = data + canonical.new_y_with_border * result_page_width + canonical.new_x_with_border;
+
+    if (canonical.original_page != WHITE_TEXTURE_INDEX)
+        original = &original_pages[canonical.original_page].pixels[canonical.original_y][canonical.original_x];
+
+    for (unsigned row = 0; row < rows; row++, dst += result_page_width)
+    {
+        if ((row > 0 && row < (unsigned) border_width) || (row > (unsigned) border_width + canonical.height))
+        {
+            memcpy(dst, dst - result_page_width, row_pixels * 4);
+        }
+        else if (original)
+        {
+            const uint32_t *line = original + ((row > (unsigned) border_width) ? (row - border_width) : 0) * 256;
+            fill_pixels(dst, line[0], border_width);
+            memcpy(dst + border_width, line, canonical.width * 4);
+            fill_pixels(dst + border_width + canonical.width, line[canonical.width], border_width);
+        }
+        else
+        {
+            fill_pixels(dst, 0xFFFFFFFFU, row_pixels);
+        }
+    }
+}
+
+void bordered_texture_atlas::blitJob(void *data, uint32_t index)
+{
+    struct blit_job *job = (struct blit_job *) data;
+    job->atlas->blitCanonicalTexture(job->data, job->atlas->canonical_object_textures[job->textures[index]]);
+}
+
+void bordered_texture_atlas::getPagePixels(unsigned long page, uint32_t *data) const
+{
+    unsigned long *page_textures = (unsigned long *) malloc((number_canonical_object_textures + 1) * sizeof(unsigned long));
+    unsigned long count = 0;
+    for (unsigned long texture = 0; texture < number_canonical_object_textures; texture++)
+        if (canonical_object_textures[texture].new_page == page)
+            page_textures[count++] = texture;
+
+    struct blit_job job = { this, data, page_textures };
+    Parallel_For((uint32_t) count, blitJob, &job);
+    free(page_textures);
+}
+
+/*!
+ * Fills an area of memory with a four-byte pattern pointed to. len must be a multiple of four.
+ */
+static void memset_pattern4_reference(void *b, const void *pattern, const size_t len)
+{
+    uint32_t *intb = (uint32_t *) b;
+    uint32_t patternValue = *((const uint32_t *) pattern);
+    for (size_t i = 0; i < len/4; i++)
+        intb[i] = patternValue;
+}
+
+/*!
+ * The original scalar page copy loop, kept as reference for the blit check.
+ */
+void bordered_texture_atlas::getPagePixelsReference(unsigned long page, uint32_t *pixels) const
+{
+    GLubyte *data = (GLubyte *) pixels;
+
+    for (unsigned long texture = 0; texture < number_canonical_object_textures; texture++)
+    {
+        const canonical_object_texture &canonical = canonical_object_textures[texture];
+        if (canonical.new_page != page)
+            continue;
+
+        if(canonical.original_page == WHITE_TEXTURE_INDEX)
+        {
+            uint32_t white_pixels[1] = {0xFFFFFFFFU};
+            // Add top border
+            for (int border = 0; border < border_width; border++)
+            {
+                unsigned x = canonical.new_x_with_border;
+                unsigned y = canonical.new_y_with_border + border;
+
+                // expand top-left pixel
+                memset_pattern4_reference(&data[(y*result_page_width + x) * 4],
+                       white_pixels, 4 * border_width);
+                // copy top line
+                memset_pattern4_reference(&data[(y*result_page_width + x + border_width) * 4],
+                       white_pixels, canonical.width * 4);
+                // expand top-right pixel
+                memset_pattern4_reference(&data[(y*result_page_width + x + border_width + canonical.width) * 4],
+                       white_pixels, 4 * border_width);
             }
-            else
+
+            // Copy main content
+            for (int line = 0; line < canonical.height; line++)
             {
-                const char *original = (char *) original_pages[canonical.original_page].pixels;
-                // Add top border
-                for (int border = 0; border < border_width; border++)
-                {
-                    unsigned x = canonical.new_x_with_border;
-                    unsigned y = canonical.new_y_with_border + border;
-                    unsigned old_x = canonical.original_x;
-                    unsigned old_y = canonical.original_y;
-
-                    // expand top-left pixel
-                    memset_pattern4(&data[(y*result_page_width + x) * 4],
-                           &(original[(old_y * 256 + old_x) * 4]),
-                           4 * border_width);
-                    // copy top line
-                    memcpy(&data[(y*result_page_width + x + border_width) * 4],
-                           &original[(old_y * 256 + old_x) * 4],
-                           canonical.width * 4);
-                    // expand top-right pixel
-                    memset_pattern4(&data[(y*result_page_width + x + border_width + canonical.width) * 4],
-                           &(original[(old_y * 256 + old_x + canonical.width) * 4]),
-                           4 * border_width);
-                }
+                unsigned x = canonical.new_x_with_border;
+                unsigned y = canonical.new_y_with_border + border_width + line;
+
+                // expand left pixel
+                memset_pattern4_reference(&data[(y*result_page_width + x) * 4],
+                       white_pixels, 4 * border_width);
+                // copy line
+                memset_pattern4_reference(&data[(y*result_page_width + x + border_width) * 4],
+                       white_pixels, canonical.width * 4);
+                // expand right pixel
+                memset_pattern4_reference(&data[(y*result_page_width + x + border_width + canonical.width) * 4],
+                       white_pixels, 4 * border_width);
+            }
 
-                // Copy main content
-                for (int line = 0; line < canonical.height; line++)
-                {
-                    unsigned x = canonical.new_x_with_border;
-                    unsigned y = canonical.new_y_with_border + border_width + line;
-                    unsigned old_x = canonical.original_x;
-                    unsigned old_y = canonical.original_y + line;
-
-                    // expand left pixel
-                    memset_pattern4(&data[(y*result_page_width + x) * 4],
-                           &(original[(old_y * 256 + old_x) * 4]),
-                           4 * border_width);
-                    // copy line
-                    memcpy(&data[(y*result_page_width + x + border_width) * 4],
-                           &original[(old_y * 256 + old_x) * 4],
-                           canonical.width * 4);
-                    // expand right pixel
-                    memset_pattern4(&data[(y*result_page_width + x + border_width + canonical.width) * 4],
-                           &(original[(old_y * 256 + old_x + canonical.width) * 4]),
-                           4 * border_width);
-                }
+            // Add bottom border
+            for (int border = 0; border < border_width; border++)
+            {
+                unsigned x = canonical.new_x_with_border;
+                unsigned y = canonical.new_y_with_border + canonical.height + border_width + border;
+
+                // expand bottom-left pixel
+                memset_pattern4_reference(&data[(y*result_page_width + x) * 4],
+                       white_pixels, 4 * border_width);
+                // copy bottom line
+                memset_pattern4_reference(&data[(y*result_page_width + x + border_width) * 4],
+                       white_pixels, canonical.width * 4);
+                // expand bottom-right pixel
+                memset_pattern4_reference(&data[(y*result_page_width + x + border_width + canonical.width) * 4],
+                       white_pixels, 4 * border_width);
+            }
+        }
+        else
+        {
+            const char *original = (const char *) original_pages[canonical.original_page].pixels;
+            // Add top border
+            for (int border = 0; border < border_width; border++)
+            {
+                unsigned x = canonical.new_x_with_border;
+                unsigned y = canonical.new_y_with_border + border;
+                unsigned old_x = canonical.original_x;
+                unsigned old_y = canonical.original_y;
+
+                // expand top-left pixel
+                memset_pattern4_reference(&data[(y*result_page_width + x) * 4],
+                       &(original[(old_y * 256 + old_x) * 4]),
+                       4 * border_width);
+                // copy top line
+                memcpy(&data[(y*result_page_width + x + border_width) * 4],
+                       &original[(old_y * 256 + old_x) * 4],
+                       canonical.width * 4);
+                // expand top-right pixel
+                memset_pattern4_reference(&data[(y*result_page_width + x + border_width + canonical.width) * 4],
+                       &(original[(old_y * 256 + old_x + canonical.width) * 4]),
+                       4 * border_width);
+            }
 
-                // Add bottom border
-                for (int border = 0; border < border_width; border++)
-                {
-                    unsigned x = canonical.new_x_with_border;
-                    unsigned y = canonical.new_y_with_border + canonical.height + border_width + border;
-                    unsigned old_x = canonical.original_x;
-                    unsigned old_y = canonical.original_y + canonical.height;
-
-                    // expand bottom-left pixel
-                    memset_pattern4(&data[(y*result_page_width + x) * 4],
-                           &(original[(old_y * 256 + old_x) * 4]),
-                           4 * border_width);
-                    // copy bottom line
-                    memcpy(&data[(y*result_page_width + x + border_width) * 4],
-                           &original[(old_y * 256 + old_x) * 4],
-                           canonical.width * 4);
-                    // expand bottom-right pixel
-                    memset_pattern4(&data[(y*result_page_width + x + border_width + canonical.width) * 4],
-                           &(original[(old_y * 256 + old_x + canonical.width) * 4]),
-                           4 * border_width);
-                }
+            // Copy main content
+            for (int line = 0; line < canonical.height; line++)
+            {
+                unsigned x = canonical.new_x_with_border;
+                unsigned y = canonical.new_y_with_border + border_width + line;
+                unsigned old_x = canonical.original_x;
+                unsigned old_y = canonical.original_y + line;
+
+                // expand left pixel
+                memset_pattern4_reference(&data[(y*result_page_width + x) * 4],
+                       &(original[(old_y * 256 + old_x) * 4]),
+                       4 * border_width);
+                // copy line
+                memcpy(&data[(y*result_page_width + x + border_width) * 4],
+                       &original[(old_y * 256 + old_x) * 4],
+                       canonical.width * 4);
+                // expand right pixel
+                memset_pattern4_reference(&data[(y*result_page_width + x + border_width + canonical.width) * 4],
+                       &(original[(old_y * 256 + old_x + canonical.width) * 4]),
+                       4 * border_width);
+            }
+
+            // Add bottom border
+            for (int border = 0; border < border_width; border++)
+            {
+                unsigned x = canonical.new_x_with_border;
+                unsigned y = canonical.new_y_with_border + canonical.height + border_width + border;
+                unsigned old_x = canonical.original_x;
+                unsigned old_y = canonical.original_y + canonical.height;
+
+                // expand bottom-left pixel
+                memset_pattern4_reference(&data[(y*result_page_width + x) * 4],
+                       &(original[(old_y * 256 + old_x) * 4]),
+                       4 * border_width);
+                // copy bottom line
+                memcpy(&data[(y*result_page_width + x + border_width) * 4],
+                       &original[(old_y * 256 + old_x) * 4],
+                       canonical.width * 4);
+                // expand bottom-right pixel
+                memset_pattern4_reference(&data[(y*result_page_width + x + border_width + canonical.width) * 4],
+                       &(original[(old_y * 256 + old_x + canonical.width) * 4]),
+                       4 * border_width);
             }
         }
+    }
+}
+
+void bordered_texture_atlas::createTextures(GLuint *textureNames)
+{
+    GLubyte *data = (GLubyte *) malloc(4 * result_page_width * result_page_width);
+
+    qglGenTextures((GLsizei) number_result_pages, textureNames);
+
+    textures_indexes = textureNames;
+
+    // Group canonical textures by page
+    unsigned long *page_first = (unsigned long *) calloc(number_result_pages + 1, sizeof(unsigned long));
+    unsigned long *page_textures = (unsigned long *) malloc((number_canonical_object_textures + 1) * sizeof(unsigned long));
+    for (unsigned long texture = 0; texture < number_canonical_object_textures; texture++)
+        page_first[canonical_object_textures[texture].new_page + 1]++;
+    for (unsigned long page = 0; page < number_result_pages; page++)
+        page_first[page + 1] += page_first[page];
+    for (unsigned long texture = 0; texture < number_canonical_object_textures; texture++)
+        page_textures[page_first[canonical_object_textures[texture].new_page]++] = texture;
+    for (unsigned long page = number_result_pages; page > 0; page--)
+        page_first[page] = page_first[page - 1];
+    page_first[0] = 0;
+
+    for (unsigned long page = 0; page < number_result_pages; page++)
+    {
+        // Tiles with borders never overlap, so they are copied in parallel.
+        struct blit_job job = { this, (uint32_t *) data, page_textures + page_first[page] };
+        Parallel_For((uint32_t) (page_first[page + 1] - page_first[page]), blitJob, &job);
 
         qglBindTexture(GL_TEXTURE_2D, textureNames[page]);
         qglTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, (GLsizei)result_page_width, (GLsizei) result_page_height[page], 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
@@ -690,5 +864,7 @@ void bordered_texture_atlas::createTextures(GLuint *textureNames)
         qglTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     }
 
+    free(page_first);
+    free(page_textures);
     free(data);
 }
@@ -31,6 +31,7 @@
 #include <SDL2/SDL_opengl.h>
 #include "../core/polygon.h"
 #include "../vt/tr_types.h"
+#include "rect_packer.h"
 
 class bordered_texture_atlas
 {
@@ -78,11 +79,15 @@ class bordered_texture_atlas
     // How much border to add.
     int border_width;
     
+    // Which rect packer lays out the pages (RECT_PACKER_*).
+    int packer_type;
+    
     // Result pages
     // Note: No capacity here, this is handled internally by the layout method. Also, all result pages have the same width, which will always be less than or equal to the height.
     unsigned long number_result_pages;
     unsigned result_page_width;
     unsigned *result_page_height;
+    unsigned long *result_page_used_area; // Pixels taken by tiles with borders, for occupancy reports.
     
     // Original data
     unsigned long number_original_pages;
@@ -103,12 +108,18 @@ class bordered_texture_atlas
     
     GLuint *textures_indexes;
     
-    /*! Lays out the texture data and switches the atlas to laid out mode. */
+    /*! Lays out the texture data with the selected packer and switches the atlas to laid out mode. No GL calls. */
     void layOutTextures();
     
     /*! For sorting: Compares two different textures and sorts them by size. */
     static int compareCanonicalTextureSizes(const void *parameter1, const void *parameter2);
     
+    /*! Copies a canonical texture with its borders into the page data (result_page_width pixels per row). */
+    void blitCanonicalTexture(uint32_t *data, const canonical_object_texture &canonical) const;
+    
+    /*! Parallel_For job of createTextures: blits one texture of a page. */
+    static void blitJob(void *data, uint32_t index);
+    
     /*! Adds an object texture to the list. */
     void addObjectTexture(const tr4_object_texture_t &texture);
     
@@ -119,6 +130,8 @@ public:
     /*!
      * Create a new Bordered texture atlas with the specified border width and textures. This lays out all the data for the textures, but does not upload anything to OpenGL yet.
      * @param border The border width around each texture.
+     * @param packer The rect packer for the layout, one of RECT_PACKER_*.
+     * @param max_page_size The page edge length; 0 queries GL_MAX_TEXTURE_SIZE (capped at 4096). Pass it to use the atlas without GL context.
      */
     bordered_texture_atlas(int border,
                            size_t page_count,
@@ -126,7 +139,9 @@ public:
                            size_t object_texture_count,
                            const tr4_object_texture_t *object_textures,
                            size_t sprite_texture_count,
-                           const tr_sprite_texture_t *sprite_textures);
+                           const tr_sprite_texture_t *sprite_textures,
+                           int packer = RECT_PACKER_MAXRECTS,
+                           unsigned max_page_size = 0);
     
     /*!
      * Destroy all contents of a bordered texture atlas. Using the atlas afterwards
@@ -167,6 +182,13 @@ public:
      */
     unsigned long getNumAtlasPages() const;
     
+    /*!
+     * Returns the size of the specified result page and the part of it taken by tiles (with borders), from 0 to 1.
+     */
+    unsigned getPageWidth() const;
+    unsigned getPageHeight(unsigned long page) const;
+    float getPageOccupancy(unsigned long page) const;
+    
     /*!
      * Returns height of specified file object texture.
      */
@@ -181,6 +203,19 @@ public:
      * @param additionalTextureNames How many texture names to create in addition to the needed ones.
      */
     void createTextures(GLuint *textureNames);
+    
+    /*!
+     * Writes page pixels (getPageWidth() pixels per row) as createTextures does, without GL calls; pixels not covered by tiles are not changed.
+     * The reference version is the original scalar loop, used for checking the blit.
+     */
+    void getPagePixels(unsigned long page, uint32_t *data) const;
+    void getPagePixelsReference(unsigned long page, uint32_t *data) const;
+    
+    /*!
+     * Checks the layout without GL calls: every texture with its borders must lie inside its page and must not overlap other textures of that page.
+     * Returns the number of textures out of bounds plus the number of overlapping pairs.
+     */
+    unsigned long checkLayout() const;
 
 };
 
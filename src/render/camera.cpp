@@ -395,6 +395,38 @@ void Cam_RecalcClipPlanes(camera_p cam)
     vec3_add(cam->frustum->vertex, cam->transform.M4x4 + 12, cam->transform.M4x4 + 8);
 }
 
+/**
+ * Tilts side clipplanes outward, so frustum contains every view of the camera
+ * turned up to angle from current position. Direction closer than angle to the
+ * frustum has n * dir >= -sin(angle) for every side plane and axis * dir >=
+ * cos(corner + angle), so n + axis * sin(angle) / cos(corner + angle) plane
+ * keeps it. Returns 0 if turned corner reaches 90 degrees.
+ */
+int Cam_WidenClipPlanes(camera_p cam, GLfloat angle)
+{
+    GLfloat corner = atanf(sqrtf(cam->w * cam->w + cam->h * cam->h) / (2.0f * cam->dist_near));
+    GLfloat *axis = cam->transform.M4x4 + 8;
+    GLfloat *n = cam->clip_planes;
+    GLfloat k, t;
+
+    if(corner + angle >= 0.5f * M_PI - 0.01f)
+    {
+        return 0;
+    }
+
+    k = sinf(angle) / cosf(corner + angle);
+    for(int i = 0; i < 4; i++, n += 4)
+    {
+        n[0] += k * axis[0];
+        n[1] += k * axis[1];
+        n[2] += k * axis[2];
+        vec3_norm(n, t);
+        n[3] = -vec3_dot(n, cam->transform.M4x4 + 12);
+    }
+
+    return 1;
+}
+
 /*
  * SCENES CAMERAS
  */
@@ -147,6 +147,7 @@ void Cam_SetRoll(camera_p cam, GLfloat roll);                      // set roll o
 void Cam_MoveTo(camera_p cam, GLfloat to[3], GLfloat max_dist);
 void Cam_LookTo(camera_p cam, GLfloat to[3]);
 void Cam_RecalcClipPlanes(camera_p cam);                           // recalculation of camera frustum clipplanes
+int  Cam_WidenClipPlanes(camera_p cam, GLfloat angle);             // clipplanes cover camera turned up to angle
 void Cam_SetFrame(camera_p cam, camera_frame_p a, camera_frame_p b, float offset[3], float lerp);
 
 flyby_camera_sequence_p FlyBySequence_Create(camera_frame_p start, uint32_t count);
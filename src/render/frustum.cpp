@@ -3,6 +3,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "../core/arena.h"
 #include "../core/system.h"
 #include "../core/vmath.h"
 #include "../core/polygon.h"
@@ -23,6 +24,7 @@ CFrustumManager::CFrustumManager(uint32_t buffer_size)
     m_buffer = (uint8_t*)malloc(buffer_size * sizeof(uint8_t));
     memset(m_buffer, 0, (buffer_size * sizeof(uint8_t)));
     m_need_realloc = false;
+    m_turn_margin = 0.0f;
 }
 
 CFrustumManager::~CFrustumManager()
@@ -240,19 +242,22 @@ frustum_p CFrustumManager::PortalFrustumIntersect(struct portal_s *portal, frust
         int in_dist = 0, in_face = 0;
         float *n = cam->frustum->norm;
         float *v = portal->vertex;
+        float *cam_pos = cam->transform.M4x4 + 12;
 
-        if((dest_room == cam->current_room) || vec3_plane_dist(portal->norm, cam->transform.M4x4 + 12) < -SPLIT_EPSILON)            // non face or degenerate to the line portal
+        if((dest_room == cam->current_room) || vec3_plane_dist(portal->norm, cam_pos) < -SPLIT_EPSILON)            // non face or degenerate to the line portal
         {
             return NULL;
         }
 
         for(uint16_t i = 0; i < portal->vertex_count; i++, v += 3)
         {
-            if((in_dist == 0) && (vec3_plane_dist(n, v) < cam->dist_far))
+            // view direction turned by margin changes vertex depth up to margin * dist
+            float turn = (m_turn_margin > 0.0f) ? (m_turn_margin * vec3_dist(v, cam_pos)) : (0.0f);
+            if((in_dist == 0) && (vec3_plane_dist(n, v) - turn < cam->dist_far))
             {
                 in_dist = 1;
             }
-            if((in_face == 0) && (vec3_plane_dist(emitter->norm, v) > 0.0))
+            if((in_face == 0) && (vec3_plane_dist(emitter->norm, v) + ((emitter == cam->frustum) ? (turn) : (0.0f)) > 0.0))
             {
                 in_face = 1;
             }
@@ -706,7 +711,7 @@ void Portal_Clear(portal_p p)
     {
         if(p->vertex)
         {
-            free(p->vertex);
+            Arena_Free(p->vertex);
             p->vertex = NULL;
         }
         p->vertex_count = 0;
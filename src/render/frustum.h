@@ -42,7 +42,23 @@ public:
    ~CFrustumManager();
     
     void Reset();
+    bool NeedRealloc() const
+    {
+        return m_need_realloc;
+    }
     frustum_p PortalFrustumIntersect(struct portal_s *portal, frustum_p emitter, struct camera_s *cam);
+    void SetTurnMargin(float margin)                                            // 2 * sin(angle / 2): camera may turn up to angle
+    {
+        m_turn_margin = margin;
+    }
+    uint32_t GetAllocated() const
+    {
+        return m_allocated;
+    }
+    void Rollback(uint32_t allocated)                                           // drop frustums allocated after GetAllocated()
+    {
+        m_allocated = allocated;
+    }
 
 private:
     float *Alloc(uint32_t size);
@@ -52,6 +68,7 @@ private:
     int  SplitByPlane(frustum_p p, float n[4], float *buf);
     
     bool m_need_realloc;
+    float m_turn_margin;
     uint32_t m_buffer_size;
     uint32_t m_allocated;
     uint8_t *m_buffer;
@@ -0,0 +1,234 @@
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL2/SDL_platform.h>
+#include <SDL2/SDL_opengl.h>
+
+#include "../core/vmath.h"
+#include "../mesh.h"
+#include "../room.h"
+#include "../entity.h"
+#include "light_cache.h"
+
+
+CLightCache::CLightCache():
+m_rooms(NULL),
+m_rooms_count(0),
+m_room_candidates(NULL),
+m_selections_size(0),
+m_selections(NULL)
+{
+    memset(&m_temp_selection, 0x00, sizeof(m_temp_selection));
+    memset(&m_stats, 0x00, sizeof(m_stats));
+}
+
+
+CLightCache::~CLightCache()
+{
+    this->Reset(NULL, 0);
+}
+
+
+void CLightCache::Reset(struct room_s *rooms, uint32_t rooms_count)
+{
+    if(m_room_candidates)
+    {
+        for(uint32_t i = 0; i < m_rooms_count; i++)
+        {
+            free(m_room_candidates[i].candidates);
+        }
+        free(m_room_candidates);
+        m_room_candidates = NULL;
+    }
+    free(m_selections);
+    m_selections = NULL;
+    m_selections_size = 0;
+
+    m_rooms = rooms;
+    m_rooms_count = (rooms) ? (rooms_count) : (0);
+    if(m_rooms_count > 0)
+    {
+        m_room_candidates = (struct room_candidates_s*)calloc(m_rooms_count, sizeof(struct room_candidates_s));
+        for(uint32_t i = 0; i < m_rooms_count; i++)
+        {
+            this->BuildRoomCandidates(i);
+        }
+    }
+}
+
+
+static void LightCache_AddCandidate(light_candidate_p c, struct light_s *light, bool own)
+{
+    c->light = light;
+    for(int i = 0; i < 4; i++)
+    {
+        c->colour[i] = (light->colour[i] > 0.0f) ? ((light->colour[i] < 1.0f) ? (light->colour[i]) : (1.0f)) : (0.0f);
+    }
+    c->luminance = 0.299f * c->colour[0] + 0.587f * c->colour[1] + 0.114f * c->colour[2];
+    c->own = (own) ? (0x01) : (0x00);
+}
+
+/**
+ * Own lights of any type, then point and shadow lights of near rooms
+ * that can reach room box.
+ */
+void CLightCache::BuildRoomCandidates(uint32_t room_index)
+{
+    room_p room = m_rooms + room_index;
+    struct room_candidates_s *rc = m_room_candidates + room_index;
+    uint32_t count = room->content->lights_count;
+
+    for(uint16_t i = 0; i < room->content->near_room_list_size; i++)
+    {
+        count += room->content->near_room_list[i]->content->lights_count;
+    }
+
+    rc->stamp = Room_GetContentSwapsCount();
+    rc->count = 0;
+    rc->candidates = (light_candidate_p)realloc(rc->candidates, ((count > 0) ? (count) : (1)) * sizeof(light_candidate_t));
+
+    for(uint32_t i = 0; i < room->content->lights_count; i++)
+    {
+        LightCache_AddCandidate(rc->candidates + rc->count++, room->content->lights + i, true);
+    }
+
+    for(uint16_t i = 0; i < room->content->near_room_list_size; i++)
+    {
+        room_p near_room = room->content->near_room_list[i];
+        for(uint32_t j = 0; j < near_room->content->lights_count; j++)
+        {
+            light_p light = near_room->content->lights + j;
+            if((light->light_type == LT_POINT) || (light->light_type == LT_SHADOW))
+            {
+                float reach = fabsf(light->outer) + LIGHT_CACHE_REACH_MARGIN;
+                float d2 = 0.0f;
+                for(int k = 0; k < 3; k++)
+                {
+                    float d = (light->pos[k] < room->bb_min[k]) ? (room->bb_min[k] - light->pos[k]) :
+                              ((light->pos[k] > room->bb_max[k]) ? (light->pos[k] - room->bb_max[k]) : (0.0f));
+                    d2 += d * d;
+                }
+                if(d2 <= reach * reach)
+                {
+                    LightCache_AddCandidate(rc->candidates + rc->count++, light, false);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Ranks room candidates by contribution at pos: suns first, point and shadow
+ * lights by luminance with linear falloff from inner radius to the reach
+ * distance; keeps MAX_NUM_LIGHTS best ones.
+ */
+void CLightCache::SelectLights(struct light_selection_s *sel, struct room_s *room, const float pos[3])
+{
+    uint32_t room_index = room - m_rooms;
+    struct room_candidates_s *rc = m_room_candidates + room_index;
+    GLfloat scores[MAX_NUM_LIGHTS];
+
+    if(rc->stamp != Room_GetContentSwapsCount())
+    {
+        this->BuildRoomCandidates(room_index);
+    }
+
+    m_stats.selections++;
+    sel->room = room;
+    sel->stamp = rc->stamp;
+    vec3_copy(sel->pos, pos);
+    sel->lights_count = 0;
+
+    light_candidate_p c = rc->candidates;
+    for(uint32_t i = 0; i < rc->count; i++, c++)
+    {
+        GLfloat score;
+        if(c->light->light_type == LT_SUN)
+        {
+            if(!c->own)
+            {
+                continue;
+            }
+            score = 2.0f + c->luminance;
+        }
+        else if((c->light->light_type == LT_POINT) || (c->light->light_type == LT_SHADOW))
+        {
+            float inner = fabsf(c->light->inner);
+            float reach = fabsf(c->light->outer) + LIGHT_CACHE_REACH_MARGIN;
+            float d2 = vec3_dist_sq(pos, c->light->pos);
+            if(d2 > reach * reach)
+            {
+                continue;
+            }
+            float d = sqrtf(d2);
+            score = (d <= inner) ? (c->luminance) : (c->luminance * (reach - d) / (reach - inner));
+            score += 1.0e-6f;                                                   // black lights are still better than none
+        }
+        else
+        {
+            continue;
+        }
+
+        // insertion into sorted best list
+        uint32_t j = sel->lights_count;
+        if(j == MAX_NUM_LIGHTS)
+        {
+            if(score <= scores[j - 1])
+            {
+                continue;
+            }
+            j--;
+        }
+        else
+        {
+            sel->lights_count++;
+        }
+        for(; (j > 0) && (scores[j - 1] < score); j--)
+        {
+            scores[j] = scores[j - 1];
+            sel->lights[j] = sel->lights[j - 1];
+        }
+        scores[j] = score;
+        sel->lights[j] = c;
+    }
+}
+
+
+const struct light_selection_s *CLightCache::GetEntityLights(struct entity_s *entity)
+{
+    room_p room = entity->self->room;
+    const float *pos = entity->transform.M4x4 + 12;
+    light_selection_p sel = &m_temp_selection;
+
+    if(!room || (room < m_rooms) || (room >= m_rooms + m_rooms_count))
+    {
+        return NULL;
+    }
+
+    if(entity->id <= LIGHT_CACHE_MAX_ENTITY_ID)
+    {
+        if(entity->id >= m_selections_size)
+        {
+            uint32_t new_size = (m_selections_size > 0) ? (m_selections_size) : (64);
+            while(new_size <= entity->id)
+            {
+                new_size *= 2;
+            }
+            m_selections = (light_selection_p)realloc(m_selections, new_size * sizeof(light_selection_t));
+            memset(m_selections + m_selections_size, 0x00, (new_size - m_selections_size) * sizeof(light_selection_t));
+            m_selections_size = new_size;
+        }
+
+        sel = m_selections + entity->id;
+        if((sel->room == room) && (sel->stamp == Room_GetContentSwapsCount()) &&
+           (vec3_dist_sq(sel->pos, pos) < LIGHT_CACHE_MOVE_THRESHOLD * LIGHT_CACHE_MOVE_THRESHOLD))
+        {
+            m_stats.hits++;
+            return sel;
+        }
+    }
+
+    this->SelectLights(sel, room, pos);
+    return sel;
+}
@@ -0,0 +1,90 @@
+
+#ifndef LIGHT_CACHE_H
+#define LIGHT_CACHE_H
+
+#include <stdint.h>
+#include <SDL2/SDL_platform.h>
+#include <SDL2/SDL_opengl.h>
+
+#include "shader_manager.h"
+
+struct room_s;
+struct light_s;
+struct entity_s;
+
+/*
+ * Every room has list of light candidates: own lights and point / shadow
+ * lights of near rooms that reach room box. Entity gets up to MAX_NUM_LIGHTS
+ * candidates with the biggest contribution at its position; selection is
+ * reused while entity stays in the same room inside small region around
+ * position it was made for. Rooms content swaps rebuild candidates lazily.
+ */
+#define LIGHT_CACHE_REACH_MARGIN    (1024.0f)                                   // light affects up to outer radius + margin
+#define LIGHT_CACHE_MOVE_THRESHOLD  (128.0f)
+#define LIGHT_CACHE_MAX_ENTITY_ID   (0xFFFF)                                    // entities with bigger id select lights every frame
+
+typedef struct light_candidate_s
+{
+    struct light_s         *light;
+    GLfloat                 colour[4];                                          // clamped to [0, 1]
+    GLfloat                 luminance;
+    uint32_t                own : 1;                                            // from candidates owner room: gets water tint
+}light_candidate_t, *light_candidate_p;
+
+typedef struct light_selection_s
+{
+    struct room_s          *room;
+    uint32_t                stamp;                                              // rooms content swaps count at selection
+    GLfloat                 pos[3];
+    uint32_t                lights_count;
+    const struct light_candidate_s *lights[MAX_NUM_LIGHTS];
+}light_selection_t, *light_selection_p;
+
+typedef struct light_cache_stats_s
+{
+    uint32_t                selections;                                         // lights ranked this frame
+    uint32_t                hits;                                               // previous selection reused
+}light_cache_stats_t, *light_cache_stats_p;
+
+
+class CLightCache
+{
+public:
+    CLightCache();
+   ~CLightCache();
+
+    void Reset(struct room_s *rooms, uint32_t rooms_count);
+    const struct light_selection_s *GetEntityLights(struct entity_s *entity);
+    void ResetStats()
+    {
+        m_stats.selections = 0;
+        m_stats.hits = 0;
+    }
+    const light_cache_stats_t *GetStats() const
+    {
+        return &m_stats;
+    }
+
+private:
+    struct room_candidates_s
+    {
+        uint32_t            stamp;
+        uint32_t            count;
+        struct light_candidate_s *candidates;
+    };
+
+    void BuildRoomCandidates(uint32_t room_index);
+    void SelectLights(struct light_selection_s *sel, struct room_s *room, const float pos[3]);
+
+    struct room_s          *m_rooms;
+    uint32_t                m_rooms_count;
+    struct room_candidates_s *m_room_candidates;
+
+    uint32_t                m_selections_size;
+    struct light_selection_s *m_selections;                                     // by entity id
+    struct light_selection_s  m_temp_selection;
+
+    light_cache_stats_t     m_stats;
+};
+
+#endif
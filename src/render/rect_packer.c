@@ -0,0 +1,384 @@
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bsp_tree_2d.h"
+#include "rect_packer.h"
+
+
+#define RECT_PACKER_CAPACITY_STEP   (64)
+
+typedef struct skyline_node_s
+{
+    unsigned                x;
+    unsigned                y;                                                  // top edge of filled area
+    unsigned                width;
+}skyline_node_t, *skyline_node_p;
+
+typedef struct packer_rect_s
+{
+    unsigned                x;
+    unsigned                y;
+    unsigned                width;
+    unsigned                height;
+}packer_rect_t, *packer_rect_p;
+
+struct rect_packer_s
+{
+    int                     type;
+    unsigned                width;
+    unsigned                height;
+    unsigned long           used_area;
+
+    bsp_tree_2d_p           bsp;
+    unsigned                count;                                              // skyline nodes or free rects
+    unsigned                capacity;
+    skyline_node_p          skyline;
+    packer_rect_p           free_rects;
+};
+
+static const char *rect_packer_names[RECT_PACKER_TYPES_COUNT] =
+{
+    "bsp",
+    "skyline",
+    "maxrects"
+};
+
+
+static void *RectPacker_Reserve(rect_packer_p packer, void *items, size_t item_size, unsigned count)
+{
+    if(count > packer->capacity)
+    {
+        packer->capacity = count + RECT_PACKER_CAPACITY_STEP;
+        items = realloc(items, packer->capacity * item_size);
+    }
+    return items;
+}
+
+
+rect_packer_p RectPacker_Create(int type, unsigned width, unsigned height)
+{
+    rect_packer_p packer = (rect_packer_p)calloc(1, sizeof(struct rect_packer_s));
+    packer->type = ((type >= 0) && (type < RECT_PACKER_TYPES_COUNT)) ? (type) : (RECT_PACKER_BSP);
+    packer->width = width;
+    packer->height = height;
+
+    switch(packer->type)
+    {
+        case RECT_PACKER_SKYLINE:
+            packer->skyline = (skyline_node_p)RectPacker_Reserve(packer, NULL, sizeof(skyline_node_t), 1);
+            packer->skyline[0].x = 0;
+            packer->skyline[0].y = 0;
+            packer->skyline[0].width = width;
+            packer->count = 1;
+            break;
+
+        case RECT_PACKER_MAXRECTS:
+            packer->free_rects = (packer_rect_p)RectPacker_Reserve(packer, NULL, sizeof(packer_rect_t), 1);
+            packer->free_rects[0].x = 0;
+            packer->free_rects[0].y = 0;
+            packer->free_rects[0].width = width;
+            packer->free_rects[0].height = height;
+            packer->count = 1;
+            break;
+
+        default:
+            packer->bsp = BSPTree2D_Create(width, height);
+            break;
+    };
+
+    return packer;
+}
+
+
+void RectPacker_Destroy(rect_packer_p packer)
+{
+    if(packer)
+    {
+        if(packer->bsp)
+        {
+            BSPTree2D_Destroy(packer->bsp);
+        }
+        free(packer->skyline);
+        free(packer->free_rects);
+        free(packer);
+    }
+}
+
+/*
+ * Skyline: top edge of filled area is kept as list of horizontal segments,
+ * sorted by x, covering all width. Rectangle is put on the segment, where
+ * its top is the lowest.
+ */
+static int Skyline_Fit(rect_packer_p packer, unsigned index, unsigned width, unsigned height, unsigned *y)
+{
+    unsigned space = width;
+    unsigned top = 0;
+
+    if(packer->skyline[index].x + width > packer->width)
+    {
+        return 0;
+    }
+
+    for(unsigned i = index; (space > 0) && (i < packer->count); i++)
+    {
+        top = (packer->skyline[i].y > top) ? (packer->skyline[i].y) : (top);
+        if(top + height > packer->height)
+        {
+            return 0;
+        }
+        space = (packer->skyline[i].width < space) ? (space - packer->skyline[i].width) : (0);
+    }
+
+    *y = top;
+    return 1;
+}
+
+
+static int Skyline_FindSpaceFor(rect_packer_p packer, unsigned width, unsigned height, unsigned *x, unsigned *y)
+{
+    unsigned best_top = UINT_MAX;
+    unsigned best_width = UINT_MAX;
+    unsigned best_index = 0;
+    unsigned best_y = 0;
+    skyline_node_p node;
+
+    for(unsigned i = 0; i < packer->count; i++)
+    {
+        unsigned fit_y;
+        if(Skyline_Fit(packer, i, width, height, &fit_y) &&
+           ((fit_y + height < best_top) || ((fit_y + height == best_top) && (packer->skyline[i].width < best_width))))
+        {
+            best_top = fit_y + height;
+            best_width = packer->skyline[i].width;
+            best_index = i;
+            best_y = fit_y;
+        }
+    }
+
+    if(best_top == UINT_MAX)
+    {
+        return 0;
+    }
+
+    *x = packer->skyline[best_index].x;
+    *y = best_y;
+
+    // new segment over the rectangle
+    packer->skyline = (skyline_node_p)RectPacker_Reserve(packer, packer->skyline, sizeof(skyline_node_t), packer->count + 1);
+    memmove(packer->skyline + best_index + 1, packer->skyline + best_index, (packer->count - best_index) * sizeof(skyline_node_t));
+    packer->count++;
+    node = packer->skyline + best_index;
+    node->x = *x;
+    node->y = best_y + height;
+    node->width = width;
+
+    // cut segments, covered by the new one
+    for(unsigned i = best_index + 1; i < packer->count;)
+    {
+        skyline_node_p prev = packer->skyline + i - 1;
+        node = packer->skyline + i;
+        if(node->x >= prev->x + prev->width)
+        {
+            break;
+        }
+        unsigned shrink = prev->x + prev->width - node->x;
+        if(node->width > shrink)
+        {
+            node->x += shrink;
+            node->width -= shrink;
+            break;
+        }
+        packer->count--;
+        memmove(node, node + 1, (packer->count - i) * sizeof(skyline_node_t));
+    }
+
+    // merge segments of the same level
+    for(unsigned i = 0; i + 1 < packer->count;)
+    {
+        node = packer->skyline + i;
+        if(node->y == node[1].y)
+        {
+            node->width += node[1].width;
+            packer->count--;
+            memmove(node + 1, node + 2, (packer->count - i - 1) * sizeof(skyline_node_t));
+        }
+        else
+        {
+            i++;
+        }
+    }
+
+    return 1;
+}
+
+/*
+ * MaxRects: all maximal free rectangles are kept (they may overlap). Placed
+ * rectangle splits every free one it intersects; contained ones are pruned.
+ */
+static inline int MaxRects_Contains(const packer_rect_t *outer, const packer_rect_t *inner)
+{
+    return (inner->x >= outer->x) && (inner->y >= outer->y) &&
+           (inner->x + inner->width <= outer->x + outer->width) &&
+           (inner->y + inner->height <= outer->y + outer->height);
+}
+
+
+static void MaxRects_AddFree(rect_packer_p packer, unsigned x, unsigned y, unsigned width, unsigned height)
+{
+    packer_rect_p r;
+    packer->free_rects = (packer_rect_p)RectPacker_Reserve(packer, packer->free_rects, sizeof(packer_rect_t), packer->count + 1);
+    r = packer->free_rects + packer->count++;
+    r->x = x;
+    r->y = y;
+    r->width = width;
+    r->height = height;
+}
+
+
+static void MaxRects_Place(rect_packer_p packer, const packer_rect_t *used)
+{
+    unsigned count = packer->count;
+
+    for(unsigned i = 0; i < count; i++)
+    {
+        packer_rect_t f = packer->free_rects[i];
+        if((used->x >= f.x + f.width) || (used->x + used->width <= f.x) ||
+           (used->y >= f.y + f.height) || (used->y + used->height <= f.y))
+        {
+            continue;
+        }
+
+        if(used->x > f.x)
+        {
+            MaxRects_AddFree(packer, f.x, f.y, used->x - f.x, f.height);
+        }
+        if(used->x + used->width < f.x + f.width)
+        {
+            MaxRects_AddFree(packer, used->x + used->width, f.y, f.x + f.width - used->x - used->width, f.height);
+        }
+        if(used->y > f.y)
+        {
+            MaxRects_AddFree(packer, f.x, f.y, f.width, used->y - f.y);
+        }
+        if(used->y + used->height < f.y + f.height)
+        {
+            MaxRects_AddFree(packer, f.x, used->y + used->height, f.width, f.y + f.height - used->y - used->height);
+        }
+        packer->free_rects[i].width = 0;                                        // mark to remove
+    }
+
+    /*
+     * remove split and contained rectangles; old ones do not contain each
+     * other and can not be inside new parts of split ones, so only new ones
+     * are tested.
+     */
+    for(unsigned i = count; i < packer->count; i++)
+    {
+        packer_rect_p a = packer->free_rects + i;
+        for(unsigned j = 0; (a->width > 0) && (j < packer->count); j++)
+        {
+            packer_rect_p b = packer->free_rects + j;
+            if((j != i) && (b->width > 0) && MaxRects_Contains(b, a))
+            {
+                a->width = 0;
+            }
+        }
+    }
+
+    count = 0;
+    for(unsigned i = 0; i < packer->count; i++)
+    {
+        if(packer->free_rects[i].width > 0)
+        {
+            packer->free_rects[count++] = packer->free_rects[i];
+        }
+    }
+    packer->count = count;
+}
+
+
+static int MaxRects_FindSpaceFor(rect_packer_p packer, unsigned width, unsigned height, unsigned *x, unsigned *y)
+{
+    unsigned best_short = UINT_MAX;
+    unsigned best_long = UINT_MAX;
+    packer_rect_t used = {0, 0, 0, 0};
+    packer_rect_p r = packer->free_rects;
+
+    for(unsigned i = 0; i < packer->count; i++, r++)
+    {
+        if((r->width >= width) && (r->height >= height))
+        {
+            unsigned dw = r->width - width;
+            unsigned dh = r->height - height;
+            unsigned short_side = (dw < dh) ? (dw) : (dh);
+            unsigned long_side = (dw < dh) ? (dh) : (dw);
+            if((short_side < best_short) || ((short_side == best_short) && (long_side < best_long)))
+            {
+                best_short = short_side;
+                best_long = long_side;
+                used.x = r->x;
+                used.y = r->y;
+            }
+        }
+    }
+
+    if(best_short == UINT_MAX)
+    {
+        return 0;
+    }
+
+    used.width = width;
+    used.height = height;
+    MaxRects_Place(packer, &used);
+    *x = used.x;
+    *y = used.y;
+
+    return 1;
+}
+
+
+int RectPacker_FindSpaceFor(rect_packer_p packer, unsigned width, unsigned height, unsigned *x, unsigned *y)
+{
+    int ret;
+
+    if((width == 0) || (height == 0) || (width > packer->width) || (height > packer->height))
+    {
+        return 0;
+    }
+
+    switch(packer->type)
+    {
+        case RECT_PACKER_SKYLINE:
+            ret = Skyline_FindSpaceFor(packer, width, height, x, y);
+            break;
+
+        case RECT_PACKER_MAXRECTS:
+            ret = MaxRects_FindSpaceFor(packer, width, height, x, y);
+            break;
+
+        default:
+            ret = BSPTree2D_FindSpaceFor(packer->bsp, width, height, x, y);
+            break;
+    };
+
+    if(ret)
+    {
+        packer->used_area += (unsigned long)width * height;
+    }
+
+    return ret;
+}
+
+
+unsigned long RectPacker_GetUsedArea(rect_packer_p packer)
+{
+    return packer->used_area;
+}
+
+
+const char *RectPacker_GetName(int type)
+{
+    return ((type >= 0) && (type < RECT_PACKER_TYPES_COUNT)) ? (rect_packer_names[type]) : ("unknown");
+}
@@ -0,0 +1,35 @@
+#ifndef RECT_PACKER_H
+#define RECT_PACKER_H
+
+/*
+ * Rectangle packers for texture atlas pages. All packers share the contract
+ * of BSPTree2D_FindSpaceFor: returned areas never overlap, on failure state
+ * is untouched. No rotation - atlas tiles keep their orientation.
+ *   BSP      - old 2D BSP tree (bsp_tree_2d.c);
+ *   SKYLINE  - skyline bottom-left: lowest top edge, then narrowest segment;
+ *   MAXRECTS - maximal free rectangles, best short side fit.
+ * Pure CPU code, no GL calls.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RECT_PACKER_BSP             (0)
+#define RECT_PACKER_SKYLINE         (1)
+#define RECT_PACKER_MAXRECTS        (2)
+#define RECT_PACKER_TYPES_COUNT     (3)
+
+typedef struct rect_packer_s *rect_packer_p;
+
+rect_packer_p RectPacker_Create(int type, unsigned width, unsigned height);
+void RectPacker_Destroy(rect_packer_p packer);
+int  RectPacker_FindSpaceFor(rect_packer_p packer, unsigned width, unsigned height, unsigned *x, unsigned *y);
+unsigned long RectPacker_GetUsedArea(rect_packer_p packer);
+const char *RectPacker_GetName(int type);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RECT_PACKER_H */
@@ -8,6 +8,7 @@
 #include "../core/gl_text.h"
 #include "../core/system.h"
 #include "../core/console.h"
+#include "../core/profiler.h"
 #include "../core/vmath.h"
 #include "../core/polygon.h"
 #include "../core/obb.h"
@@ -18,6 +19,9 @@
 #include "render.h"
 #include "bsp_tree.h"
 #include "frustum.h"
+#include "light_cache.h"
+#include "rect_packer.h"
+#include "render_queue.h"
 #include "shader_description.h"
 #include "shader_manager.h"
 #include "../room.h"
@@ -44,8 +48,24 @@ m_rooms(NULL),
 m_rooms_count(0),
 m_anim_sequences(NULL),
 m_anim_sequences_count(0),
+m_anim_tex_slot_base(NULL),
+m_anim_tex_slots(0),
+m_anim_tex_frames(NULL),
+m_sprites_vbo(0),
+m_sprites_pages_count(0),
+m_sprites_pages(NULL),
+m_sprites_first(NULL),
+m_sprites_count(NULL),
+m_sprites_draw_first(NULL),
+m_sprites_draw_count(NULL),
+m_room_batch(NULL),
+m_room_batch_object(0),
 m_active_transparency(0),
 m_active_texture(0),
+m_vis_cache_turn(0.0f),
+m_vis_cache_room(NULL),
+m_vis_cache_swaps(0),
+m_vis_cache_check(false),
 r_list_size(0),
 r_list_active_count(0),
 r_list(NULL),
@@ -53,18 +73,33 @@ frustumManager(NULL),
 shaderManager(NULL),
 debugDrawer(NULL),
 dynamicBSP(NULL),
+renderQueue(NULL),
+transparencyQueue(NULL),
+lightCache(NULL),
 r_flags(0x00)
 {
     this->InitSettings();
     frustumManager = new CFrustumManager(32768);
     debugDrawer    = new CRenderDebugDrawer();
     dynamicBSP     = new CDynamicBSP(512 * 1024);
+    renderQueue    = new CRenderQueue(4096);
+    transparencyQueue = new CRenderQueue(1024);
+    lightCache     = new CLightCache();
+    m_transparency_time[0] = 0.0f;
+    m_transparency_time[1] = 0.0f;
+    memset(&m_vis_stats, 0, sizeof(m_vis_stats));
 }
 
 CRender::~CRender()
 {
     m_camera = NULL;
 
+    free(m_anim_tex_slot_base);
+    m_anim_tex_slot_base = NULL;
+    free(m_anim_tex_frames);
+    m_anim_tex_frames = NULL;
+    m_anim_tex_slots = 0;
+
     if(r_list)
     {
         r_list_active_count = 0;
@@ -91,6 +126,24 @@ CRender::~CRender()
         dynamicBSP = NULL;
     }
 
+    if(renderQueue)
+    {
+        delete renderQueue;
+        renderQueue = NULL;
+    }
+
+    if(transparencyQueue)
+    {
+        delete transparencyQueue;
+        transparencyQueue = NULL;
+    }
+
+    if(lightCache)
+    {
+        delete lightCache;
+        lightCache = NULL;
+    }
+
     if(shaderManager)
     {
         delete shaderManager;
@@ -114,6 +167,9 @@ void CRender::InitSettings()
     settings.fog_color[2] = 0.0f;
     settings.fog_start_depth = 10000.0f;
     settings.fog_end_depth = 16000.0f;
+    settings.transparency_mode = R_TRANSPARENCY_BSP;
+    settings.atlas_packer = RECT_PACKER_MAXRECTS;
+    settings.skinning = 1;
 }
 
 void CRender::DoShaders()
@@ -128,12 +184,50 @@ void CRender::ResetWorld(struct room_s *rooms, uint32_t rooms_count, struct anim
 {
     this->CleanList();
     r_flags = 0x00;
+    m_vis_cache_room = NULL;
 
     m_rooms = rooms;
     m_rooms_count = rooms_count;
     m_anim_sequences = anim_sequences;
     m_anim_sequences_count = anim_sequences_count;
 
+    BaseMesh_DeleteBatch(m_room_batch);
+    m_room_batch = NULL;
+    this->ClearSpritesBuffer();
+    lightCache->Reset(m_rooms, m_rooms_count);
+
+    /*
+     * every (sequence, frame offset) pair gets slot in frames table; if all
+     * of them fit shader uniforms, animated tex coords become static
+     */
+    free(m_anim_tex_slot_base);
+    m_anim_tex_slot_base = NULL;
+    free(m_anim_tex_frames);
+    m_anim_tex_frames = NULL;
+    m_anim_tex_slots = 0;
+    if(m_anim_sequences && shaderManager)
+    {
+        uint32_t slots = 1;
+        m_anim_tex_slot_base = (uint32_t*)malloc(m_anim_sequences_count * sizeof(uint32_t));
+        for(uint32_t i = 0; i < m_anim_sequences_count; i++)
+        {
+            m_anim_tex_slot_base[i] = slots;
+            slots += m_anim_sequences[i].frames_count;
+        }
+
+        if(slots <= (uint32_t)shaderManager->getAnimTexSlots())
+        {
+            m_anim_tex_slots = slots;
+            m_anim_tex_frames = (GLfloat*)calloc(8 * slots, sizeof(GLfloat));
+            m_anim_tex_frames[0] = 1.0f;
+            m_anim_tex_frames[3] = 1.0f;
+        }
+        else
+        {
+            Sys_DebugLog(SYS_LOG_FILENAME, "animated textures: %d frames do not fit %d shader slots, CPU path is used", slots, shaderManager->getAnimTexSlots());
+        }
+    }
+
     if(m_rooms)
     {
         uint32_t list_size = rooms_count + 128;                                 // magick 128 was added for debug and testing
@@ -156,7 +250,109 @@ void CRender::ResetWorld(struct room_s *rooms, uint32_t rooms_count, struct anim
         {
             m_rooms[i].is_in_r_list = 0;
         }
+
+        // merge static faces of all rooms (flipped contents too) into world space batch
+        base_mesh_p *parts = (base_mesh_p*)malloc(m_rooms_count * sizeof(base_mesh_p));
+        float **transforms = (float**)malloc(m_rooms_count * sizeof(float*));
+        for(uint32_t i = 0; i < m_rooms_count; i++)
+        {
+            parts[i] = m_rooms[i].original_content->mesh;
+            transforms[i] = m_rooms[i].transform;
+        }
+        m_room_batch = BaseMesh_CreateBatch(parts, transforms, m_rooms_count);
+        free(transforms);
+        free(parts);
+
+        this->GenSpritesBuffer();
+    }
+}
+
+/**
+ * Uploads static sprite quads of all rooms contents into one buffer: pages
+ * go one after another, inside page - rooms in id order, so sprites of
+ * neighbour rooms on one page are drawn as one range.
+ */
+void CRender::GenSpritesBuffer()
+{
+    uint32_t quads = 0;
+
+    for(uint32_t i = 0; i < m_rooms_count; i++)
+    {
+        room_content_p content = m_rooms[i].original_content;
+        for(uint32_t j = 0; j < content->sprites_count; j++)
+        {
+            sprite_p sprite = content->sprites[j].sprite;
+            uint32_t page = 0;
+            if(!sprite || !content->sprites_vertices)
+            {
+                continue;
+            }
+            for(; (page < m_sprites_pages_count) && (m_sprites_pages[page] != sprite->texture_index); page++);
+            if(page == m_sprites_pages_count)
+            {
+                m_sprites_pages = (GLuint*)realloc(m_sprites_pages, (m_sprites_pages_count + 1) * sizeof(GLuint));
+                m_sprites_pages[m_sprites_pages_count++] = sprite->texture_index;
+            }
+            quads++;
+        }
+    }
+
+    if(quads == 0)
+    {
+        return;
+    }
+
+    vertex_p vertices = (vertex_p)malloc(4 * quads * sizeof(vertex_t));
+    vertex_p v = vertices;
+    m_sprites_first = (GLint*)calloc(m_rooms_count * m_sprites_pages_count, sizeof(GLint));
+    m_sprites_count = (GLsizei*)calloc(m_rooms_count * m_sprites_pages_count, sizeof(GLsizei));
+    m_sprites_draw_first = (GLint*)malloc(r_list_size * sizeof(GLint));
+    m_sprites_draw_count = (GLsizei*)malloc(r_list_size * sizeof(GLsizei));
+    for(uint32_t page = 0; page < m_sprites_pages_count; page++)
+    {
+        for(uint32_t i = 0; i < m_rooms_count; i++)
+        {
+            room_content_p content = m_rooms[i].original_content;
+            uint32_t range = i * m_sprites_pages_count + page;
+            m_sprites_first[range] = v - vertices;
+            for(uint32_t j = 0; j < content->sprites_count; j++)
+            {
+                sprite_p sprite = content->sprites[j].sprite;
+                if(sprite && content->sprites_vertices && (sprite->texture_index == m_sprites_pages[page]))
+                {
+                    memcpy(v, content->sprites_vertices + 4 * j, 4 * sizeof(vertex_t));
+                    v += 4;
+                    m_sprites_count[range] += 4;
+                }
+            }
+        }
     }
+
+    qglGenBuffersARB(1, &m_sprites_vbo);
+    qglBindBufferARB(GL_ARRAY_BUFFER_ARB, m_sprites_vbo);
+    qglBufferDataARB(GL_ARRAY_BUFFER_ARB, 4 * quads * sizeof(vertex_t), vertices, GL_STATIC_DRAW_ARB);
+    qglBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+    free(vertices);
+}
+
+void CRender::ClearSpritesBuffer()
+{
+    if(m_sprites_vbo != 0)
+    {
+        qglDeleteBuffersARB(1, &m_sprites_vbo);
+        m_sprites_vbo = 0;
+    }
+    free(m_sprites_pages);
+    m_sprites_pages = NULL;
+    m_sprites_pages_count = 0;
+    free(m_sprites_first);
+    m_sprites_first = NULL;
+    free(m_sprites_count);
+    m_sprites_count = NULL;
+    free(m_sprites_draw_first);
+    m_sprites_draw_first = NULL;
+    free(m_sprites_draw_count);
+    m_sprites_draw_count = NULL;
 }
 
 // This function is used for updating global animated texture frame
@@ -222,6 +418,23 @@ void CRender::UpdateAnimTextures()
                 };
             }
         }
+
+        if(m_anim_tex_slots > 0)
+        {
+            GLfloat *v = m_anim_tex_frames + 8;
+            seq = m_anim_sequences;
+            for(uint16_t i = 0; i < m_anim_sequences_count; i++, seq++)
+            {
+                for(uint16_t j = 0; j < seq->frames_count; j++, v += 8)
+                {
+                    tex_frame_p tf = seq->frames + (seq->current_frame + j) % seq->frames_count;
+                    vec4_copy(v, tf->mat);
+                    v[4] = tf->move[0];
+                    v[5] = tf->move[1] - tf->current_uvrotate;
+                }
+            }
+            shaderManager->setAnimTexFrames(m_anim_tex_frames, m_anim_tex_slots);
+        }
     }
 }
 
@@ -230,20 +443,74 @@ void CRender::UpdateAnimTextures()
  */
 void CRender::GenWorldList(struct camera_s *cam)
 {
-    this->CleanList();
+    PROF_SCOPE("GenWorldList");
     this->dynamicBSP->Reset(m_anim_sequences);
-    this->frustumManager->Reset();
     cam->frustum->next = NULL;
     m_camera = cam;
 
     if(m_rooms == NULL)
     {
+        this->CleanList();
+        this->frustumManager->Reset();
         return;
     }
 
     room_p curr_room = World_FindRoomByPosCogerrence(cam->transform.M4x4 + 12, cam->current_room);     // find room that contains camera
-    GLfloat *cam_pos = cam->transform.M4x4 + 12;
     cam->current_room = curr_room;                                              // set camera's cuttent room pointer
+
+    m_vis_stats.frames++;
+    if(this->IsVisCacheValid(cam, curr_room))
+    {
+        // Reuse previous portals traversal: the same camera position gives
+        // the same distances, turned view stays inside widened frustums.
+        m_vis_stats.cached_frames++;
+        if(memcmp(m_vis_cache_transform, cam->transform.M4x4, sizeof(m_vis_cache_transform)) != 0)
+        {
+            m_vis_stats.turned_frames++;
+        }
+        if(m_vis_cache_check)
+        {
+            this->CheckVisCache(cam, curr_room);
+        }
+        return;
+    }
+
+    GLfloat planes[16];
+    float turn = 0.0f;
+    memcpy(planes, cam->clip_planes, sizeof(planes));
+    if(this->IsVisCacheSpot(cam, curr_room) && Cam_WidenClipPlanes(cam, RENDER_VIS_CACHE_TURN))
+    {
+        turn = RENDER_VIS_CACHE_TURN;                                           // camera turns in place
+    }
+    this->CleanList();
+    this->frustumManager->Reset();
+    this->UpdateVisCache(cam, curr_room, turn);
+    if(turn > 0.0f)
+    {
+        this->frustumManager->SetTurnMargin(2.0f * sinf(0.5f * turn));
+        this->TraversePortals(cam, curr_room);
+        this->frustumManager->SetTurnMargin(0.0f);
+        memcpy(cam->clip_planes, planes, sizeof(planes));
+    }
+    else
+    {
+        this->TraversePortals(cam, curr_room);
+    }
+
+    if(this->frustumManager->NeedRealloc())
+    {
+        m_vis_cache_room = NULL;                                                // incomplete traversal must not be reused
+    }
+}
+
+
+/**
+ * Full portals traversal from the camera room into the cleaned rooms list.
+ */
+void CRender::TraversePortals(struct camera_s *cam, struct room_s *curr_room)
+{
+    GLfloat *cam_pos = cam->transform.M4x4 + 12;
+
     if(curr_room != NULL)                                                       // camera located in some room
     {
         const float eps = 10.0f;
@@ -295,6 +562,7 @@ void CRender::GenWorldList(struct camera_s *cam)
             }
         }
     }
+
 }
 
 /**
@@ -302,6 +570,7 @@ void CRender::GenWorldList(struct camera_s *cam)
  */
 void CRender::DrawList()
 {
+    PROF_SCOPE("DrawList");
     if(m_camera)
     {
         if(r_flags & R_DRAW_WIRE)
@@ -340,89 +609,35 @@ void CRender::DrawList()
         m_cam_right[2] = 0.0f;
         
         /*
-         * room rendering
+         * room rendering: room and static meshes go through sorted render queue,
+         * entities and stencil clipped rooms are drawn immediately
          */
-        for(uint32_t i = 0; i < r_list_active_count; i++)
+        renderQueue->Reset();
+        lightCache->ResetStats();
+        if(m_room_batch)
         {
-            this->DrawRoom(r_list[i].room, m_camera->gl_view_mat, m_camera->gl_view_proj_mat);
+            GLfloat tint[4];
+            CalculateWaterTint(tint, 1);
+            m_room_batch_object = renderQueue->AddObject(m_camera->gl_view_proj_mat, tint);
         }
-
-        qglDisable(GL_CULL_FACE);
         for(uint32_t i = 0; i < r_list_active_count; i++)
         {
-            this->DrawRoomSprites(r_list[i].room);
+            this->QueueRoom(r_list[i].room, m_camera->gl_view_proj_mat);
         }
+        renderQueue->Sort();
+        renderQueue->Submit(m_camera->dist_far, (GLfloat)SDL_GetTicks());
+        m_active_texture = renderQueue->GetActiveTexture();
 
-        /*
-         * NOW render transparency polygons
-         */
-        /*First generate BSP from base room mesh - it has good for start splitter polygons*/
         for(uint32_t i = 0; i < r_list_active_count; i++)
         {
-            room_p r = r_list[i].room;
-            if((r->content->mesh != NULL) && (r->content->mesh->transparency_polygons != NULL))
-            {
-                dynamicBSP->AddNewPolygonList(r->content->mesh->transparency_polygons, r->transform, m_camera->frustum);
-            }
+            this->DrawRoom(r_list[i].room, m_camera->gl_view_mat, m_camera->gl_view_proj_mat);
         }
 
-        for(uint32_t i = 0; i < r_list_active_count; i++)
-        {
-            room_p r = r_list[i].room;
-            // Add transparency polygons from static meshes (if they exists)
-            for(uint16_t j = 0; j < r->content->static_mesh_count; j++)
-            {
-                if((r->content->static_mesh[j].mesh->transparency_polygons != NULL) && Frustum_IsOBBVisibleInFrustumList(r->content->static_mesh[j].obb, (r->frustum) ? (r->frustum) : (m_camera->frustum)))
-                {
-                    dynamicBSP->AddNewPolygonList(r->content->static_mesh[j].mesh->transparency_polygons, r->content->static_mesh[j].transform, m_camera->frustum);
-                }
-            }
+        qglDisable(GL_CULL_FACE);
+        this->DrawRoomsSprites();
 
-            // Add transparency polygons from all entities (if they exists) // yes, entities may be animated and intersects with each others;
-            for(engine_container_p cont = r->containers; cont; cont = cont->next)
-            {
-                if(cont->object_type == OBJECT_ENTITY)
-                {
-                    entity_p ent = (entity_p)cont->object;
-                    if((ent->state_flags & ENTITY_STATE_VISIBLE) && ent->bf->animations.model && (ent->bf->animations.model->transparency_flags == MESH_HAS_TRANSPARENCY) && Frustum_IsOBBVisibleInFrustumList(ent->obb, (r->frustum) ? (r->frustum) : (m_camera->frustum)))
-                    {
-                        float tr[16];
-                        for(uint16_t j = 0; j < ent->bf->bone_tag_count; j++)
-                        {
-                            if(ent->bf->bone_tags[j].mesh_base->transparency_polygons != NULL)
-                            {
-                                Mat4_Mat4_mul(tr, ent->transform.M4x4, ent->bf->bone_tags[j].full_transform);
-                                dynamicBSP->AddNewPolygonList(ent->bf->bone_tags[j].mesh_base->transparency_polygons, tr, m_camera->frustum);
-                            }
-                        }
-                    }
-                }
-            }
-        }
+        this->DrawTransparency();
 
-        if(dynamicBSP->m_root->polygons_front && (dynamicBSP->m_vbo != 0))
-        {
-            const unlit_tinted_shader_description *shader = shaderManager->getRoomShader(false, false);
-            qglUseProgramObjectARB(shader->program);
-            qglUniform1iARB(shader->sampler, 0);
-            qglUniformMatrix4fvARB(shader->model_view_projection, 1, false, m_camera->gl_view_proj_mat);
-            qglUniform1fARB(shader->dist_fog, m_camera->dist_far);
-            qglDepthMask(GL_FALSE);
-            qglDisable(GL_ALPHA_TEST);
-            qglEnable(GL_BLEND);
-            m_active_transparency = 0;
-            qglBindBufferARB(GL_ARRAY_BUFFER_ARB, dynamicBSP->m_vbo);
-            qglBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, 0);
-            qglBufferDataARB(GL_ARRAY_BUFFER_ARB, dynamicBSP->GetActiveVertexCount() * sizeof(vertex_t), dynamicBSP->GetVertexArray(), GL_DYNAMIC_DRAW);
-            qglVertexPointer(3, GL_FLOAT, sizeof(vertex_t), (void*)offsetof(vertex_t, position));
-            qglColorPointer(4, GL_FLOAT, sizeof(vertex_t), (void*)offsetof(vertex_t, color));
-            qglNormalPointer(GL_FLOAT, sizeof(vertex_t), (void*)offsetof(vertex_t, normal));
-            qglTexCoordPointer(2, GL_FLOAT, sizeof(vertex_t), (void*)offsetof(vertex_t, tex_coord));
-            this->DrawBSPBackToFront(dynamicBSP->m_root);
-            qglBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
-            qglDepthMask(GL_TRUE);
-            qglDisable(GL_BLEND);
-        }
         //Reset polygon draw mode
         qglPolygonMode(GL_FRONT, GL_FILL);
         m_active_texture = 0;
@@ -549,6 +764,108 @@ void CRender::DrawListDebugLines()
     debugDrawer->Reset();
 }
 
+/**
+ * Camera stays at the cached traversal spot: the same room, rooms content,
+ * projection and position; only view direction may differ.
+ */
+bool CRender::IsVisCacheSpot(struct camera_s *cam, struct room_s *curr_room)
+{
+    return (curr_room != NULL) && (curr_room == m_vis_cache_room) &&
+           (m_vis_cache_swaps == Room_GetContentSwapsCount()) &&
+           (memcmp(m_vis_cache_proj, cam->gl_proj_mat, sizeof(m_vis_cache_proj)) == 0) &&
+           (memcmp(m_vis_cache_transform + 12, cam->transform.M4x4 + 12, 3 * sizeof(GLfloat)) == 0);
+}
+
+/**
+ * Previous frame portals traversal may be reused at the same spot if camera
+ * turned less than widening angle of it (exact traversal needs the same view).
+ */
+bool CRender::IsVisCacheValid(struct camera_s *cam, struct room_s *curr_room)
+{
+    if(!this->IsVisCacheSpot(cam, curr_room))
+    {
+        return false;
+    }
+
+    if(m_vis_cache_turn > 0.0f)
+    {
+        GLfloat *m0 = m_vis_cache_transform;
+        GLfloat *m = cam->transform.M4x4;
+        // cos of rotation angle from cached to current camera orientation
+        GLfloat c = 0.5f * (vec3_dot(m0, m) + vec3_dot(m0 + 4, m + 4) + vec3_dot(m0 + 8, m + 8) - 1.0f);
+        return c >= cosf(m_vis_cache_turn);
+    }
+
+    return memcmp(m_vis_cache_transform, cam->transform.M4x4, sizeof(m_vis_cache_transform)) == 0;
+}
+
+
+void CRender::UpdateVisCache(struct camera_s *cam, struct room_s *curr_room, float turn)
+{
+    m_vis_cache_turn = turn;
+    m_vis_cache_room = curr_room;
+    m_vis_cache_swaps = Room_GetContentSwapsCount();
+    memcpy(m_vis_cache_transform, cam->transform.M4x4, sizeof(m_vis_cache_transform));
+    memcpy(m_vis_cache_proj, cam->gl_proj_mat, sizeof(m_vis_cache_proj));
+}
+
+/**
+ * Check mode: compares reused rooms list with the exact traversal for the
+ * current camera, then puts reused list and its frustums back. Widened list
+ * may have extra rooms, but must not miss visible ones.
+ */
+void CRender::CheckVisCache(struct camera_s *cam, struct room_s *curr_room)
+{
+    uint32_t cached_count = r_list_active_count;
+    size_t buf_size = (cached_count + 1) * (sizeof(room_p) + sizeof(frustum_p));
+    room_p *cached = (room_p*)Sys_GetTempMem(buf_size);
+    frustum_p *cached_frustums = (frustum_p*)(cached + cached_count + 1);
+    room_p cache_room = m_vis_cache_room;
+    uint32_t allocated = this->frustumManager->GetAllocated();
+    uint32_t common = 0;
+
+    for(uint32_t i = 0; i < cached_count; i++)
+    {
+        cached[i] = r_list[i].room;
+        cached_frustums[i] = cached[i]->frustum;
+    }
+
+    this->CleanList();
+    this->TraversePortals(cam, curr_room);                                      // after reused frustums in the same buffer
+    if(!this->frustumManager->NeedRealloc())
+    {
+        for(uint32_t i = 0; i < cached_count; i++)
+        {
+            if(cached[i]->is_in_r_list)
+            {
+                common++;
+            }
+            else
+            {
+                m_vis_stats.extra_rooms++;
+            }
+        }
+        m_vis_stats.missed_rooms += r_list_active_count - common;
+        m_vis_stats.failed_frames += (common != r_list_active_count) ? (1) : (0);
+        m_vis_stats.checked_frames++;
+    }
+    else
+    {
+        cache_room = NULL;                                                      // rebuild with bigger buffer, check next frames
+    }
+
+    this->CleanList();
+    for(uint32_t i = 0; i < cached_count; i++)
+    {
+        cached[i]->frustum = cached_frustums[i];
+        this->AddRoom(cached[i]);
+    }
+    this->frustumManager->Rollback(allocated);
+    m_vis_cache_room = cache_room;
+    Sys_ReturnTempMem(buf_size);
+}
+
+
 void CRender::CleanList()
 {
     for(uint32_t i = 0; i < r_list_active_count; i++)
@@ -569,6 +886,7 @@ void CRender::CleanList()
 
     r_flags &= ~R_DRAW_SKYBOX;
     r_list_active_count = 0;
+    m_vis_cache_room = NULL;
 }
 
 /*
@@ -576,38 +894,10 @@ void CRender::CleanList()
  */
 void CRender::DrawBSPPolygon(struct bsp_polygon_s *p)
 {
-    // Blending mode switcher.
-    // Note that modes above 2 aren't explicitly used in TR textures, only for
-    // internal particle processing. Theoretically it's still possible to use
-    // them if you will force type via TRTextur utility.
     if(m_active_transparency != p->transparency)
     {
         m_active_transparency = p->transparency;
-        switch(m_active_transparency)
-        {
-            case BM_MULTIPLY:                                    // Classic PC alpha
-                qglBlendFunc(GL_ONE, GL_ONE);
-                break;
-
-            case BM_INVERT_SRC:                                  // Inversion by src (PS darkness) - SAME AS IN TR3-TR5
-                qglBlendFunc(GL_ZERO, GL_ONE_MINUS_SRC_COLOR);
-                break;
-
-            case BM_INVERT_DEST:                                 // Inversion by dest
-                qglBlendFunc(GL_ONE_MINUS_SRC_COLOR, GL_ONE_MINUS_SRC_COLOR);
-                break;
-
-            case BM_SCREEN:                                      // Screen (smoke, etc.)
-                qglBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_COLOR);
-                break;
-
-            case BM_ANIMATED_TEX:
-                qglBlendFunc(GL_ONE, GL_ZERO);
-                break;
-
-            default:                                             // opaque animated textures case
-                break;
-        };
+        CRenderQueue::SetBlendMode(m_active_transparency);
     }
 
     if(m_active_texture != p->texture_index)
@@ -714,47 +1004,82 @@ void CRender::DrawBSPBackToFront(struct bsp_node_s *root)
     }
 }
 
-void CRender::DrawMesh(struct base_mesh_s *mesh, const float *overrideVertices, const float *overrideNormals)
+/**
+ * Fills animated tex coords buffer: with frames table it is done once (u, v
+ * and slot of polygon sequence and frame offset, shader applies the frame),
+ * else current frames are applied here every call. Returns uploaded bytes.
+ */
+uint32_t CRender::UpdateAnimatedTexCoords(struct base_mesh_s *mesh)
 {
-    if(mesh->animated_vertex_count)
+    if(mesh->animated_texcoord_static)
     {
-        // Respecify the tex coord buffer
-        qglBindBufferARB(GL_ARRAY_BUFFER, mesh->vbo_animated_texcoord_array);
-        // Tell OpenGL to discard the old values
-        qglBufferDataARB(GL_ARRAY_BUFFER, mesh->animated_vertex_count * sizeof(GLfloat [2]), 0, GL_STREAM_DRAW);
-        // Get writable data (to avoid copy)
-        GLfloat *data = (GLfloat *) qglMapBufferARB(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
+        return 0;
+    }
+
+    // Respecify the tex coord buffer
+    qglBindBufferARB(GL_ARRAY_BUFFER, mesh->vbo_animated_texcoord_array);
+    // Tell OpenGL to discard the old values
+    qglBufferDataARB(GL_ARRAY_BUFFER, mesh->animated_vertex_count * sizeof(GLfloat [3]), 0, (m_anim_tex_slots > 0) ? (GL_STATIC_DRAW) : (GL_STREAM_DRAW));
+    // Get writable data (to avoid copy)
+    GLfloat *data = (GLfloat *) qglMapBufferARB(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
 
-        for(polygon_p p = mesh->animated_polygons; p; p = p->next)
+    for(polygon_p p = mesh->animated_polygons; p; p = p->next)
+    {
+        anim_seq_p seq = m_anim_sequences + p->anim_id - 1;
+        if(m_anim_tex_slots > 0)
+        {
+            GLfloat slot = (GLfloat)(m_anim_tex_slot_base[p->anim_id - 1] + p->frame_offset % seq->frames_count);
+            for(uint16_t i = 0; i < p->vertex_count; i++, data += 3)
+            {
+                data[0] = p->vertices[i].tex_coord[0];
+                data[1] = p->vertices[i].tex_coord[1];
+                data[2] = slot;
+            }
+        }
+        else
         {
-            anim_seq_p seq = m_anim_sequences + p->anim_id - 1;
             uint16_t frame = (seq->current_frame + p->frame_offset) % seq->frames_count;
             tex_frame_p tf = seq->frames + frame;
-            for(uint16_t i = 0; i < p->vertex_count; i++, data += 2)
+            for(uint16_t i = 0; i < p->vertex_count; i++, data += 3)
             {
                 ApplyAnimTextureTransformation(data, p->vertices[i].tex_coord, tf);
+                data[2] = 0.0f;
             }
         }
-        qglUnmapBufferARB(GL_ARRAY_BUFFER);
+    }
+    qglUnmapBufferARB(GL_ARRAY_BUFFER);
+    mesh->animated_texcoord_static = (m_anim_tex_slots > 0);
 
-        // Setup altered buffer
-        qglTexCoordPointer(2, GL_FLOAT, sizeof(GLfloat [2]), 0);
-        // Setup static data
-        qglBindBufferARB(GL_ARRAY_BUFFER, mesh->vbo_animated_vertex_array);
-        qglVertexPointer(3, GL_FLOAT, sizeof(vertex_t), (void*)offsetof(vertex_t, position));
-        qglColorPointer(4, GL_FLOAT, sizeof(vertex_t), (void*)offsetof(vertex_t, color));
-        qglNormalPointer(GL_FLOAT, sizeof(vertex_t), (void*)offsetof(vertex_t, normal));
+    return mesh->animated_vertex_count * sizeof(GLfloat [3]);
+}
+
+void CRender::DrawMeshAnimatedFaces(struct base_mesh_s *mesh)
+{
+    this->UpdateAnimatedTexCoords(mesh);
+
+    // Setup altered buffer
+    qglTexCoordPointer(3, GL_FLOAT, sizeof(GLfloat [3]), 0);
+    // Setup static data
+    BaseMesh_SetVertexPointers(mesh, 1);
 
-        mesh_face_p face = mesh->animated_faces;
-        for(uint32_t face_index = 0; face_index < mesh->animated_faces_count; face_index++, face++)
+    mesh_face_p face = mesh->animated_faces;
+    for(uint32_t face_index = 0; face_index < mesh->animated_faces_count; face_index++, face++)
+    {
+        if(m_active_texture != face->texture_index)
         {
-            if(m_active_texture != face->texture_index)
-            {
-                m_active_texture = face->texture_index;
-                qglBindTexture(GL_TEXTURE_2D, m_active_texture);
-            }
-            qglDrawElements(GL_TRIANGLES, face->elements_count, GL_UNSIGNED_INT, face->elements);
+            m_active_texture = face->texture_index;
+            qglBindTexture(GL_TEXTURE_2D, m_active_texture);
         }
+        qglDrawElements(GL_TRIANGLES, face->elements_count, face->elements_type, MESH_FACE_ELEMENTS(face));
+    }
+    qglBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, 0);
+}
+
+void CRender::DrawMesh(struct base_mesh_s *mesh, const float *overrideVertices, const float *overrideNormals)
+{
+    if(mesh->animated_vertex_count)
+    {
+        this->DrawMeshAnimatedFaces(mesh);
     }
 
     if(mesh->vertex_count == 0)
@@ -764,11 +1089,7 @@ void CRender::DrawMesh(struct base_mesh_s *mesh, const float *overrideVertices,
 
     if(mesh->vbo_vertex_array)
     {
-        qglBindBufferARB(GL_ARRAY_BUFFER_ARB, mesh->vbo_vertex_array);
-        qglVertexPointer(3, GL_FLOAT, sizeof(vertex_t), (void*)offsetof(vertex_t, position));
-        qglColorPointer(4, GL_FLOAT, sizeof(vertex_t), (void*)offsetof(vertex_t, color));
-        qglNormalPointer(GL_FLOAT, sizeof(vertex_t), (void*)offsetof(vertex_t, normal));
-        qglTexCoordPointer(2, GL_FLOAT, sizeof(vertex_t), (void*)offsetof(vertex_t, tex_coord));
+        BaseMesh_SetVertexPointers(mesh, 0);
     }
 
     // Bind overriden vertices if they exist
@@ -789,42 +1110,20 @@ void CRender::DrawMesh(struct base_mesh_s *mesh, const float *overrideVertices,
             m_active_texture = face->texture_index;
             qglBindTexture(GL_TEXTURE_2D, m_active_texture);
         }
-        qglDrawElements(GL_TRIANGLES, face->elements_count, GL_UNSIGNED_INT, face->elements);
+        qglDrawElements(GL_TRIANGLES, face->elements_count, face->elements_type, MESH_FACE_ELEMENTS(face));
     }
+    qglBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, 0);
 }
 
 void CRender::DrawSkinMesh(struct base_mesh_s *mesh, struct base_mesh_s *parent_mesh, uint32_t *map, float transform[16])
 {
-    uint32_t i;
-    vertex_p v;
-    float *p_vertex, *src_v, *dst_v;
-    GLfloat *p_normale, *src_n, *dst_n;
+    float *p_vertex;
+    GLfloat *p_normale;
     size_t buf_size = mesh->vertex_count * 3 * sizeof(GLfloat);
 
     p_vertex  = (GLfloat*)Sys_GetTempMem(buf_size);
     p_normale = (GLfloat*)Sys_GetTempMem(buf_size);
-    dst_v = p_vertex;
-    dst_n = p_normale;
-    v = mesh->vertices;
-    for(i = 0; i < mesh->vertex_count; i++, v++, map++)
-    {
-        src_v = v->position;
-        src_n = v->normal;
-        if(*map == 0xFFFFFFFF)
-        {
-            vec3_copy(dst_v, src_v);
-            vec3_copy(dst_n, src_n);
-        }
-        else
-        {
-            Mat4_vec3_mul_inv(dst_v, transform, parent_mesh->vertices[*map].position);
-            dst_n[0]  = transform[0] * src_n[0] + transform[1] * src_n[1] + transform[2]  * src_n[2];             // (M^-1 * src).x
-            dst_n[1]  = transform[4] * src_n[0] + transform[5] * src_n[1] + transform[6]  * src_n[2];             // (M^-1 * src).y
-            dst_n[2]  = transform[8] * src_n[0] + transform[9] * src_n[1] + transform[10] * src_n[2];             // (M^-1 * src).z
-        }
-        dst_v += 3;
-        dst_n += 3;
-    }
+    BaseMesh_SkinMeshBoneSpace(mesh, parent_mesh, map, transform, p_vertex, p_normale);
 
     this->DrawMesh(mesh, p_vertex, p_normale);
     Sys_ReturnTempMem(2 * buf_size);
@@ -893,27 +1192,160 @@ void CRender::DrawSkeletalModel(const lit_shader_description *shader, struct ss_
     }
 }
 
-void CRender::DrawEntity(struct entity_s *entity, const float modelViewMatrix[16], const float modelViewProjectionMatrix[16])
+/**
+ * Skinned batch of bone frame is made on the first draw and remade when bone
+ * meshes are swapped (weapons, meshes replaced by script). Parts of bone i
+ * are 3 * i + 0 - base or replace mesh, + 1 - slot mesh, + 2 - skin mesh.
+ */
+struct mesh_batch_s *CRender::GetSkinBatch(struct ss_bone_frame_s *bframe)
 {
-    if(!(entity->state_flags & ENTITY_STATE_VISIBLE) || (entity->bf->animations.model->hide && !(r_flags & R_DRAW_NULLMESHES)))
-    {
-        return;
-    }
-
-    // Calculate lighting
-    const lit_shader_description *shader = this->SetupEntityLight(entity, modelViewMatrix);
+    mesh_skin_part_t parts[3 * MESH_SKIN_MAX_BONES];
+    uint32_t parts_count = 3 * bframe->bone_tag_count;
+    ss_bone_tag_p btag = bframe->bone_tags;
 
-    if(entity->bf->animations.model && entity->bf->animations.model->animations)
+    memset(parts, 0x00, parts_count * sizeof(mesh_skin_part_t));                 // padding too, parts are compared with memcmp
+    for(uint16_t i = 0; i < bframe->bone_tag_count; i++, btag++)
     {
-        float subModelView[16];
-        float subModelViewProjection[16];
-        if(entity->bf->bone_tag_count == 1)
+        mesh_skin_part_p part = parts + 3 * i;
+        part[0].mesh = (btag->mesh_replace) ? (btag->mesh_replace) : (btag->mesh_base);
+        part[0].bone = i;
+        part[1].mesh = btag->mesh_slot;
+        part[1].bone = i;
+        if(btag->mesh_skin && btag->parent)
         {
-            float scaledTransform[16];
-            memcpy(scaledTransform, entity->transform.M4x4, sizeof(scaledTransform));
-            Mat4_Scale(scaledTransform, entity->transform.scaling[0], entity->transform.scaling[1], entity->transform.scaling[2]);
-            Mat4_Mat4_mul(subModelView, modelViewMatrix, scaledTransform);
-            Mat4_Mat4_mul(subModelViewProjection, modelViewProjectionMatrix, scaledTransform);
+            part[2].mesh = btag->mesh_skin;
+            part[2].parent_mesh = btag->parent->mesh_base;
+            part[2].skin_map = btag->skin_map;
+            part[2].bone = i;
+            part[2].parent_bone = btag->parent->index;
+        }
+    }
+
+    if(bframe->skin_batch && ((bframe->skin_batch->parts_count != parts_count) ||
+       memcmp(bframe->skin_batch->skin_parts, parts, parts_count * sizeof(mesh_skin_part_t))))
+    {
+        BaseMesh_DeleteBatch(bframe->skin_batch);
+        bframe->skin_batch = NULL;
+    }
+    if(!bframe->skin_batch)
+    {
+        bframe->skin_batch = BaseMesh_CreateSkinnedBatch(parts, parts_count);
+    }
+
+    return bframe->skin_batch;
+}
+
+/**
+ * Matrix palette skinning: bone matrices are uploaded once per model and
+ * static faces of all bones are drawn from one buffer, one (multi) draw per
+ * texture page; ranges of hidden bones are skipped. Faces with animated
+ * textures are not in the batch, they go per mesh with constant bone index.
+ */
+void CRender::DrawSkinnedModel(const skinned_shader_description *shader, struct ss_bone_frame_s *bframe, const float mvMatrix[16], const float mvpMatrix[16])
+{
+    GLfloat palette[MESH_SKIN_MAX_BONES * MESH_SKIN_PALETTE_ROWS * 4];
+    GLsizei counts[3 * MESH_SKIN_MAX_BONES];
+    const GLvoid *offsets[3 * MESH_SKIN_MAX_BONES];
+    mesh_batch_p batch = this->GetSkinBatch(bframe);
+    base_mesh_p mesh = &batch->mesh;
+    uint16_t bones = SSBoneFrame_FillBonePalette(bframe, palette, MESH_SKIN_MAX_BONES);
+
+    qglUniformMatrix4fvARB(shader->model_view, 1, false, mvMatrix);
+    qglUniformMatrix4fvARB(shader->model_view_projection, 1, false, mvpMatrix);
+    qglUniform4fvARB(shader->bone_palette, MESH_SKIN_PALETTE_ROWS * bones, palette);
+
+    if(mesh->faces_count > 0)
+    {
+        BaseMesh_SetVertexPointers(mesh, 0);
+        qglBindBufferARB(GL_ARRAY_BUFFER_ARB, batch->vbo_bone_array);
+        qglEnableVertexAttribArrayARB(shader->bone_index);
+        qglVertexAttribPointerARB(shader->bone_index, 1, GL_FLOAT, GL_FALSE, 0, 0);
+
+        mesh_face_p face = mesh->faces;
+        for(uint32_t k = 0; k < mesh->faces_count; k++, face++)
+        {
+            GLuint elem_size = (face->elements_type == GL_UNSIGNED_SHORT) ? sizeof(GLushort) : sizeof(GLuint);
+            GLuint end = 0xFFFFFFFF;
+            GLsizei ranges = 0;
+            for(uint32_t i = 0; i < batch->parts_count; i++)
+            {
+                mesh_batch_range_p range = batch->ranges + i * mesh->faces_count + k;
+                if((range->elements_count == 0) || bframe->bone_tags[i / 3].is_hidden)
+                {
+                    continue;
+                }
+                if(range->elements_offset == end)
+                {
+                    counts[ranges - 1] += range->elements_count;
+                }
+                else
+                {
+                    counts[ranges] = range->elements_count;
+                    offsets[ranges] = (const GLvoid*)(uintptr_t)range->elements_offset;
+                    ranges++;
+                }
+                end = range->elements_offset + range->elements_count * elem_size;
+            }
+
+            if(ranges > 0)
+            {
+                if(m_active_texture != face->texture_index)
+                {
+                    m_active_texture = face->texture_index;
+                    qglBindTexture(GL_TEXTURE_2D, m_active_texture);
+                }
+                if(qglMultiDrawElements)
+                {
+                    qglMultiDrawElements(GL_TRIANGLES, counts, face->elements_type, offsets, ranges);
+                }
+                else
+                {
+                    for(GLsizei i = 0; i < ranges; i++)
+                    {
+                        qglDrawElements(GL_TRIANGLES, counts[i], face->elements_type, offsets[i]);
+                    }
+                }
+            }
+        }
+        qglDisableVertexAttribArrayARB(shader->bone_index);
+        qglBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, 0);
+    }
+
+    for(uint32_t i = 0; i < batch->parts_count; i++)
+    {
+        mesh_skin_part_p part = batch->skin_parts + i;
+        if(part->mesh && part->mesh->animated_vertex_count && !bframe->bone_tags[i / 3].is_hidden)
+        {
+            qglVertexAttrib1fARB(shader->bone_index, part->bone);
+            this->DrawMeshAnimatedFaces(part->mesh);
+        }
+    }
+}
+
+void CRender::DrawEntity(struct entity_s *entity, const float modelViewMatrix[16], const float modelViewProjectionMatrix[16])
+{
+    if(!(entity->state_flags & ENTITY_STATE_VISIBLE) || (entity->bf->animations.model->hide && !(r_flags & R_DRAW_NULLMESHES)))
+    {
+        return;
+    }
+
+    bool skinned = settings.skinning && (entity->bf->bone_tag_count > 1) && (entity->bf->bone_tag_count <= MESH_SKIN_MAX_BONES) &&
+                   shaderManager->getEntitySkinnedShader(0);
+
+    // Calculate lighting
+    const lit_shader_description *shader = this->SetupEntityLight(entity, modelViewMatrix, skinned);
+
+    if(entity->bf->animations.model && entity->bf->animations.model->animations)
+    {
+        float subModelView[16];
+        float subModelViewProjection[16];
+        if(entity->bf->bone_tag_count == 1)
+        {
+            float scaledTransform[16];
+            memcpy(scaledTransform, entity->transform.M4x4, sizeof(scaledTransform));
+            Mat4_Scale(scaledTransform, entity->transform.scaling[0], entity->transform.scaling[1], entity->transform.scaling[2]);
+            Mat4_Mat4_mul(subModelView, modelViewMatrix, scaledTransform);
+            Mat4_Mat4_mul(subModelViewProjection, modelViewProjectionMatrix, scaledTransform);
         }
         else
         {
@@ -921,12 +1353,23 @@ void CRender::DrawEntity(struct entity_s *entity, const float modelViewMatrix[16
             Mat4_Mat4_mul(subModelViewProjection, modelViewProjectionMatrix, entity->transform.M4x4);
         }
 
-        this->DrawSkeletalModel(shader, entity->bf, subModelView, subModelViewProjection);
+        if(skinned)
+        {
+            this->DrawSkinnedModel(static_cast<const skinned_shader_description*>(shader), entity->bf, subModelView, subModelViewProjection);
+        }
+        else
+        {
+            this->DrawSkeletalModel(shader, entity->bf, subModelView, subModelViewProjection);
+        }
 
         if(entity->character && entity->character->hair_count)
         {
             base_mesh_p mesh;
             float transform[16];
+            if(skinned)
+            {
+                shader = this->SetupEntityLight(entity, modelViewMatrix, false);  // hair elements have own transforms
+            }
             for(int h = 0; h < entity->character->hair_count; h++)
             {
                 int num_elements = Hair_GetElementsCount(entity->character->hairs[h]);
@@ -966,72 +1409,325 @@ void CRender::DrawEntity(struct entity_s *entity, const float modelViewMatrix[16
     }
 }
 
-void CRender::DrawRoom(struct room_s *room, const float modelViewMatrix[16], const float modelViewProjectionMatrix[16])
+bool CRender::IsRoomNeedStencil(struct room_s *room)
 {
-    float transform[16];
-    engine_container_p cont;
-    entity_p ent;
-
-    const shader_description *lastShader = 0;
-
 #if STENCIL_FRUSTUM
-    ////start test stencil test code
-    bool need_stencil = false;
     if(room->frustum != NULL)
     {
         for(uint16_t i = 0; i < room->content->overlapped_room_list_size; i++)
         {
             if(room->content->overlapped_room_list[i]->real_room->is_in_r_list)
             {
-                need_stencil = true;
-                break;
+                return true;
             }
         }
+    }
+#endif
+    return false;
+}
+
+/**
+ * Room static faces come from the batch part of room content owner, if
+ * room has the same transform as owner (flipped room in other place is not).
+ */
+int CRender::GetRoomBatchPart(struct room_s *room)
+{
+    uint32_t part = room->content->original_room_id;
+    if(m_room_batch && (part < m_room_batch->parts_count) &&
+       (memcmp(room->transform, m_rooms[part].transform, sizeof(room->transform)) == 0))
+    {
+        return part;
+    }
+    return -1;
+}
+
+void CRender::QueueMesh(uint32_t pass, const struct unlit_tinted_shader_description *shader, struct base_mesh_s *mesh, const float mvp[16], const float tint[4], const float centre[3])
+{
+    if(mesh->animated_vertex_count && renderQueue->MarkAnimatedMesh(mesh) && !renderQueue->IsHeadless())
+    {
+        renderQueue->CountUpload(this->UpdateAnimatedTexCoords(mesh));
+    }
+    uint32_t object = renderQueue->AddObject(mvp, tint);
+    renderQueue->AddMesh(pass, shader, mesh, object, vec3_dist_sq(centre, m_camera->transform.M4x4 + 12));
+}
+
+void CRender::QueueStaticMesh(struct static_mesh_s *static_mesh, const float mvp[16], const float tint[4])
+{
+    const instanced_shader_description *shader = shaderManager->getStaticMeshInstancedShader();
+    if(shader)
+    {
+        base_mesh_p mesh = static_mesh->mesh;
+        if(mesh->animated_vertex_count && renderQueue->MarkAnimatedMesh(mesh) && !renderQueue->IsHeadless())
+        {
+            renderQueue->CountUpload(this->UpdateAnimatedTexCoords(mesh));
+        }
+        renderQueue->AddMeshInstance(RQ_PASS_STATIC, shader, mesh, renderQueue->AddObject(mvp, tint),
+                                     vec3_dist_sq(static_mesh->obb->centre, m_camera->transform.M4x4 + 12));
+    }
+    else
+    {
+        this->QueueMesh(RQ_PASS_STATIC, shaderManager->getStaticMeshShader(), static_mesh->mesh, mvp, tint, static_mesh->obb->centre);
+    }
+}
+
+/**
+ * Records room mesh and static meshes (own and overlapping from near rooms) into render queue
+ */
+void CRender::QueueRoom(struct room_s *room, const float modelViewProjectionMatrix[16])
+{
+    float transform[16];
+    GLfloat tint[4];
+    frustum_p frus = (room->frustum) ? (room->frustum) : (m_camera->frustum);
 
-        if(need_stencil)
+    if(!(r_flags & R_SKIP_ROOM) && room->content->mesh && !this->IsRoomNeedStencil(room))
+    {
+        const unlit_tinted_shader_description *shader = shaderManager->getRoomShader(room->content->light_mode == 1, room->content->room_flags & 1);
+        int part = this->GetRoomBatchPart(room);
+        if(part >= 0)
         {
-            const int elem_size = (3 + 3 + 4 + 2) * sizeof(GLfloat);
-            const unlit_tinted_shader_description *shader = shaderManager->getRoomShader(false, false);
-            size_t buf_size;
+            base_mesh_p mesh = room->content->mesh;
+            renderQueue->AddBatchPart(RQ_PASS_ROOM_BATCH, shader, m_room_batch, part, m_room_batch_object);
+            if(mesh->animated_vertex_count)
+            {
+                if(renderQueue->MarkAnimatedMesh(mesh) && !renderQueue->IsHeadless())
+                {
+                    renderQueue->CountUpload(this->UpdateAnimatedTexCoords(mesh));
+                }
+                Mat4_Mat4_mul(transform, modelViewProjectionMatrix, room->transform);
+                CalculateWaterTint(tint, 1);
+                renderQueue->AddAnimatedFaces(RQ_PASS_ROOM, shader, mesh, renderQueue->AddObject(transform, tint),
+                                              vec3_dist_sq(room->obb->centre, m_camera->transform.M4x4 + 12));
+            }
+        }
+        else
+        {
+            Mat4_Mat4_mul(transform, modelViewProjectionMatrix, room->transform);
+            CalculateWaterTint(tint, 1);
+            this->QueueMesh(RQ_PASS_ROOM, shader, room->content->mesh, transform, tint, room->obb->centre);
+        }
+    }
 
-            qglUseProgramObjectARB(shader->program);
-            qglUniform1iARB(shader->sampler, 0);
-            qglUniformMatrix4fvARB(shader->model_view_projection, 1, false, engine_camera.gl_view_proj_mat);
-            qglUniform1fARB(shader->dist_fog, m_camera->dist_far);
-            qglEnable(GL_STENCIL_TEST);
-            qglClear(GL_STENCIL_BUFFER_BIT);
-            qglStencilFunc(GL_NEVER, 1, 0x00);
-            qglStencilOp(GL_REPLACE, GL_KEEP, GL_KEEP);
-            for(frustum_p f = room->frustum; f; f = f->next)
+    if(room->content->static_mesh_count > 0)
+    {
+        for(uint32_t i = 0; i < room->content->static_mesh_count; i++)
+        {
+            static_mesh_p sm = room->content->static_mesh + i;
+            if((!sm->hide || (r_flags & R_DRAW_DUMMY_STATICS)) && Frustum_IsOBBVisibleInFrustumList(sm->obb, frus))
+            {
+                Mat4_Mat4_mul(transform, modelViewProjectionMatrix, sm->transform);
+                vec4_copy(tint, sm->tint);
+                //If this static mesh is in a water room
+                if(room->content->room_flags & TR_ROOM_FLAG_WATER)
+                {
+                    CalculateWaterTint(tint, 0);
+                }
+                this->QueueStaticMesh(sm, transform, tint);
+            }
+        }
+    }
+
+    for(uint16_t ni = 0; ni < room->content->near_room_list_size; ni++)
+    {
+        room_p near_room = room->content->near_room_list[ni]->real_room;
+        if(!room->content->near_room_list[ni]->is_in_r_list && (near_room->content->static_mesh_count > 0))
+        {
+            for(uint32_t si = 0; si < near_room->content->static_mesh_count; si++)
+            {
+                static_mesh_p sm = near_room->content->static_mesh + si;
+                if(OBB_OBB_Test(sm->obb, room->obb, 0.0f) && Frustum_IsOBBVisibleInFrustumList(sm->obb, frus) &&
+                   (!sm->hide || (r_flags & R_DRAW_DUMMY_STATICS)))
+                {
+                    Mat4_Mat4_mul(transform, modelViewProjectionMatrix, sm->transform);
+                    vec4_copy(tint, sm->tint);
+                    //If this static mesh is in a water near_room
+                    if(near_room->content->room_flags & TR_ROOM_FLAG_WATER)
+                    {
+                        CalculateWaterTint(tint, 0);
+                    }
+                    this->QueueStaticMesh(sm, transform, tint);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Sorted mode queues static transparent faces of the mesh, the rest (animated
+ * and broken polygons) goes to dynamic BSP, as all polygons do in BSP mode.
+ */
+void CRender::QueueTransparentMesh(struct base_mesh_s *mesh, float transform[16], bool sorted)
+{
+    if(!sorted)
+    {
+        if(mesh->transparency_polygons)
+        {
+            dynamicBSP->AddNewPolygonList(mesh->transparency_polygons, transform, m_camera->frustum);
+        }
+        return;
+    }
+
+    if(mesh->transparent_faces_count > 0)
+    {
+        const GLfloat tint[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+        float mvp[16], centre[3];
+        Mat4_Mat4_mul(mvp, m_camera->gl_view_proj_mat, transform);
+        Mat4_vec3_mul_macro(centre, transform, mesh->centre);
+        transparencyQueue->AddTransparentFaces(shaderManager->getRoomShader(false, false), mesh,
+                                               transparencyQueue->AddObject(mvp, tint), vec3_dist_sq(centre, m_camera->transform.M4x4 + 12));
+    }
+
+    if(mesh->transparency_animated_polygons)
+    {
+        dynamicBSP->AddNewPolygonList(mesh->transparency_animated_polygons, transform, m_camera->frustum);
+    }
+}
+
+/**
+ * Collects transparent geometry of visible rooms, static meshes and entities
+ * and draws it back to front; time spent here is kept per transparency mode.
+ */
+void CRender::DrawTransparency()
+{
+    PROF_SCOPE("DrawTransparency");
+    uint64_t start = SDL_GetPerformanceCounter();
+    bool sorted = (settings.transparency_mode == R_TRANSPARENCY_SORTED);
+
+    transparencyQueue->Reset();
+    /*First generate BSP from base room mesh - it has good for start splitter polygons*/
+    for(uint32_t i = 0; i < r_list_active_count; i++)
+    {
+        room_p r = r_list[i].room;
+        if(r->content->mesh != NULL)
+        {
+            this->QueueTransparentMesh(r->content->mesh, r->transform, sorted);
+        }
+    }
+
+    for(uint32_t i = 0; i < r_list_active_count; i++)
+    {
+        room_p r = r_list[i].room;
+        // Add transparency polygons from static meshes (if they exists)
+        for(uint16_t j = 0; j < r->content->static_mesh_count; j++)
+        {
+            if((r->content->static_mesh[j].mesh->transparency_polygons != NULL) && Frustum_IsOBBVisibleInFrustumList(r->content->static_mesh[j].obb, (r->frustum) ? (r->frustum) : (m_camera->frustum)))
+            {
+                this->QueueTransparentMesh(r->content->static_mesh[j].mesh, r->content->static_mesh[j].transform, sorted);
+            }
+        }
+
+        // Add transparency polygons from all entities (if they exists) // yes, entities may be animated and intersects with each others;
+        for(engine_container_p cont = r->containers; cont; cont = cont->next)
+        {
+            if(cont->object_type == OBJECT_ENTITY)
             {
-                buf_size = f->vertex_count * elem_size;
-                GLfloat *v, *buf = (GLfloat*)Sys_GetTempMem(buf_size);
-                v=buf;
-                for(int16_t i = f->vertex_count - 1; i >= 0; i--)
+                entity_p ent = (entity_p)cont->object;
+                if((ent->state_flags & ENTITY_STATE_VISIBLE) && ent->bf->animations.model && (ent->bf->animations.model->transparency_flags == MESH_HAS_TRANSPARENCY) && Frustum_IsOBBVisibleInFrustumList(ent->obb, (r->frustum) ? (r->frustum) : (m_camera->frustum)))
                 {
-                    vec3_copy(v, f->vertex + 3 * i);                    v+=3;
-                    vec3_copy_inv(v, engine_camera.transform.M4x4 + 8);   v+=3;
-                    vec4_set_one(v);                                    v+=4;
-                    v[0] = v[1] = 0.0;                                  v+=2;
+                    float tr[16];
+                    for(uint16_t j = 0; j < ent->bf->bone_tag_count; j++)
+                    {
+                        if(ent->bf->bone_tags[j].mesh_base->transparency_polygons != NULL)
+                        {
+                            Mat4_Mat4_mul(tr, ent->transform.M4x4, ent->bf->bone_tags[j].full_transform);
+                            this->QueueTransparentMesh(ent->bf->bone_tags[j].mesh_base, tr, sorted);
+                        }
+                    }
                 }
+            }
+        }
+    }
 
-                m_active_texture = 0;
-                BindWhiteTexture();
-                qglBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
-                qglVertexPointer(3, GL_FLOAT, elem_size, buf+0);
-                qglNormalPointer(GL_FLOAT, elem_size, buf+3);
-                qglColorPointer(4, GL_FLOAT, elem_size, buf+3+3);
-                qglTexCoordPointer(2, GL_FLOAT, elem_size, buf+3+3+4);
-                qglDrawArrays(GL_TRIANGLE_FAN, 0, f->vertex_count);
+    qglDepthMask(GL_FALSE);
+    qglDisable(GL_ALPHA_TEST);
+    qglEnable(GL_BLEND);
+    if(sorted)
+    {
+        transparencyQueue->Sort();
+        transparencyQueue->Submit(m_camera->dist_far, (GLfloat)SDL_GetTicks());
+        m_active_texture = transparencyQueue->GetActiveTexture();
+    }
 
-                Sys_ReturnTempMem(buf_size);
+    if(dynamicBSP->m_root->polygons_front && (dynamicBSP->m_vbo != 0))
+    {
+        const unlit_tinted_shader_description *shader = shaderManager->getRoomShader(false, false);
+        qglUseProgramObjectARB(shader->program);
+        qglUniform1iARB(shader->sampler, 0);
+        qglUniformMatrix4fvARB(shader->model_view_projection, 1, false, m_camera->gl_view_proj_mat);
+        qglUniform1fARB(shader->dist_fog, m_camera->dist_far);
+        m_active_transparency = 0;
+        qglBindBufferARB(GL_ARRAY_BUFFER_ARB, dynamicBSP->m_vbo);
+        qglBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, 0);
+        qglBufferDataARB(GL_ARRAY_BUFFER_ARB, dynamicBSP->GetActiveVertexCount() * sizeof(vertex_t), dynamicBSP->GetVertexArray(), GL_DYNAMIC_DRAW);
+        qglVertexPointer(3, GL_FLOAT, sizeof(vertex_t), (void*)offsetof(vertex_t, position));
+        qglColorPointer(4, GL_FLOAT, sizeof(vertex_t), (void*)offsetof(vertex_t, color));
+        qglNormalPointer(GL_FLOAT, sizeof(vertex_t), (void*)offsetof(vertex_t, normal));
+        qglTexCoordPointer(2, GL_FLOAT, sizeof(vertex_t), (void*)offsetof(vertex_t, tex_coord));
+        this->DrawBSPBackToFront(dynamicBSP->m_root);
+        qglBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+    }
+    qglDepthMask(GL_TRUE);
+    qglDisable(GL_BLEND);
+
+    float ms = 1000.0f * (float)(SDL_GetPerformanceCounter() - start) / (float)SDL_GetPerformanceFrequency();
+    float *time = m_transparency_time + ((sorted) ? 1 : 0);
+    *time = (*time > 0.0f) ? (0.9f * *time + 0.1f * ms) : (ms);
+}
+
+void CRender::DrawRoom(struct room_s *room, const float modelViewMatrix[16], const float modelViewProjectionMatrix[16])
+{
+    engine_container_p cont;
+    entity_p ent;
+
+    const shader_description *lastShader = 0;
+
+    // rooms clipped by stencil are drawn here, other room meshes are drawn by render queue
+    bool need_stencil = !(r_flags & R_SKIP_ROOM) && room->content->mesh && this->IsRoomNeedStencil(room);
+
+#if STENCIL_FRUSTUM
+    ////start test stencil test code
+    if(need_stencil)
+    {
+        const int elem_size = (3 + 3 + 4 + 2) * sizeof(GLfloat);
+        const unlit_tinted_shader_description *shader = shaderManager->getRoomShader(false, false);
+        size_t buf_size;
+
+        qglUseProgramObjectARB(shader->program);
+        qglUniform1iARB(shader->sampler, 0);
+        qglUniformMatrix4fvARB(shader->model_view_projection, 1, false, engine_camera.gl_view_proj_mat);
+        qglUniform1fARB(shader->dist_fog, m_camera->dist_far);
+        qglEnable(GL_STENCIL_TEST);
+        qglClear(GL_STENCIL_BUFFER_BIT);
+        qglStencilFunc(GL_NEVER, 1, 0x00);
+        qglStencilOp(GL_REPLACE, GL_KEEP, GL_KEEP);
+        for(frustum_p f = room->frustum; f; f = f->next)
+        {
+            buf_size = f->vertex_count * elem_size;
+            GLfloat *v, *buf = (GLfloat*)Sys_GetTempMem(buf_size);
+            v=buf;
+            for(int16_t i = f->vertex_count - 1; i >= 0; i--)
+            {
+                vec3_copy(v, f->vertex + 3 * i);                    v+=3;
+                vec3_copy_inv(v, engine_camera.transform.M4x4 + 8);   v+=3;
+                vec4_set_one(v);                                    v+=4;
+                v[0] = v[1] = 0.0;                                  v+=2;
             }
-            qglStencilFunc(GL_EQUAL, 1, 0xFF);
+
+            m_active_texture = 0;
+            BindWhiteTexture();
+            qglBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+            qglVertexPointer(3, GL_FLOAT, elem_size, buf+0);
+            qglNormalPointer(GL_FLOAT, elem_size, buf+3);
+            qglColorPointer(4, GL_FLOAT, elem_size, buf+3+3);
+            qglTexCoordPointer(2, GL_FLOAT, elem_size, buf+3+3+4);
+            qglDrawArrays(GL_TRIANGLE_FAN, 0, f->vertex_count);
+
+            Sys_ReturnTempMem(buf_size);
         }
+        qglStencilFunc(GL_EQUAL, 1, 0xFF);
     }
 #endif
 
-    if(!(r_flags & R_SKIP_ROOM) && room->content->mesh)
+    if(need_stencil)
     {
         float modelViewProjectionTransform[16];
         Mat4_Mat4_mul(modelViewProjectionTransform, modelViewProjectionMatrix, room->transform);
@@ -1061,34 +1757,6 @@ void CRender::DrawRoom(struct room_s *room, const float modelViewMatrix[16], con
     }
 #endif
 
-    if (room->content->static_mesh_count > 0)
-    {
-        const unlit_tinted_shader_description *shader = shaderManager->getStaticMeshShader();
-        qglUseProgramObjectARB(shader->program);
-        for(uint32_t i = 0; i < room->content->static_mesh_count; i++)
-        {
-            if((!room->content->static_mesh[i].hide || (r_flags & R_DRAW_DUMMY_STATICS)) &&
-               Frustum_IsOBBVisibleInFrustumList(room->content->static_mesh[i].obb, (room->frustum) ? (room->frustum) : (m_camera->frustum)))
-            {
-                Mat4_Mat4_mul(transform, modelViewProjectionMatrix, room->content->static_mesh[i].transform);
-                qglUniformMatrix4fvARB(shader->model_view_projection, 1, false, transform);
-                qglUniform1fARB(shader->dist_fog, m_camera->dist_far);
-                base_mesh_s *mesh = room->content->static_mesh[i].mesh;
-                GLfloat tint[4];
-
-                vec4_copy(tint, room->content->static_mesh[i].tint);
-
-                //If this static mesh is in a water room
-                if(room->content->room_flags & TR_ROOM_FLAG_WATER)
-                {
-                    CalculateWaterTint(tint, 0);
-                }
-                qglUniform4fvARB(shader->tint_mult, 1, tint);
-                this->DrawMesh(mesh, NULL, NULL);
-            }
-        }
-    }
-
     for(cont = room->containers; cont; cont = cont->next)
     {
         switch(cont->object_type)
@@ -1108,35 +1776,6 @@ void CRender::DrawRoom(struct room_s *room, const float modelViewMatrix[16], con
         room_p near_room = room->content->near_room_list[ni]->real_room;
         if(!room->content->near_room_list[ni]->is_in_r_list)
         {
-            if (near_room->content->static_mesh_count > 0)
-            {
-                const unlit_tinted_shader_description *shader = shaderManager->getStaticMeshShader();
-                for(uint32_t si = 0; si < near_room->content->static_mesh_count; si++)
-                {
-                    if(OBB_OBB_Test(near_room->content->static_mesh[si].obb, room->obb, 0.0f) &&
-                       Frustum_IsOBBVisibleInFrustumList(near_room->content->static_mesh[si].obb, (room->frustum) ? (room->frustum) : (m_camera->frustum)) &&
-                       (!near_room->content->static_mesh[si].hide || (r_flags & R_DRAW_DUMMY_STATICS)))
-                    {
-                        qglUseProgramObjectARB(shader->program);
-                        Mat4_Mat4_mul(transform, modelViewProjectionMatrix, near_room->content->static_mesh[si].transform);
-                        qglUniformMatrix4fvARB(shader->model_view_projection, 1, false, transform);
-                        qglUniform1fARB(shader->dist_fog, m_camera->dist_far);
-                        base_mesh_s *mesh = near_room->content->static_mesh[si].mesh;
-                        GLfloat tint[4];
-
-                        vec4_copy(tint, near_room->content->static_mesh[si].tint);
-
-                        //If this static mesh is in a water near_room
-                        if(near_room->content->room_flags & TR_ROOM_FLAG_WATER)
-                        {
-                            CalculateWaterTint(tint, 0);
-                        }
-                        qglUniform4fvARB(shader->tint_mult, 1, tint);
-                        this->DrawMesh(mesh, NULL, NULL);
-                    }
-                }
-            }
-
             for(cont = near_room->containers; cont; cont=cont->next)
             {
                 switch(cont->object_type)
@@ -1156,52 +1795,69 @@ void CRender::DrawRoom(struct room_s *room, const float modelViewMatrix[16], con
 }
 
 
-void CRender::DrawRoomSprites(struct room_s *room)
+/**
+ * Draws sprites of all visible rooms from static buffer: one texture bind and
+ * one multi draw per atlas page, billboards are built by sprite shader.
+ */
+void CRender::DrawRoomsSprites()
 {
-    if (room->content->sprites_count > 0)
+    if(m_sprites_vbo == 0)
     {
-        const unlit_tinted_shader_description *shader = shaderManager->getRoomShader(false, false);
-        GLfloat *view = m_camera->transform.M4x4 + 8;
-
-        qglBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
-        qglUseProgramObjectARB(shader->program);
-        qglUniform1iARB(shader->sampler, 0);
-        qglUniformMatrix4fvARB(shader->model_view_projection, 1, false, m_camera->gl_view_proj_mat);
-        qglUniform1fARB(shader->dist_fog, m_camera->dist_far);
-    
-        for(uint32_t i = 0; i < room->content->sprites_count; i++)
-        {
-            room_sprite_p s = room->content->sprites + i;
-            vertex_p v = room->content->sprites_vertices + i * 4;
-            vec3_copy_inv(v[0].normal, view);
-            vec3_copy_inv(v[1].normal, view);
-            vec3_copy_inv(v[2].normal, view);
-            vec3_copy_inv(v[3].normal, view);
-
-            v[0].position[0] = s->pos[0] + s->sprite->right * m_cam_right[0];
-            v[0].position[1] = s->pos[1] + s->sprite->right * m_cam_right[1];
-            v[0].position[2] = s->pos[2] + s->sprite->right * m_cam_right[2] + s->sprite->top;
+        return;
+    }
 
-            v[1].position[0] = s->pos[0] + s->sprite->left * m_cam_right[0];
-            v[1].position[1] = s->pos[1] + s->sprite->left * m_cam_right[1];
-            v[1].position[2] = s->pos[2] + s->sprite->left * m_cam_right[2] + s->sprite->top;
+    const sprite_shader_description *shader = shaderManager->getSpriteShader();
+    qglUseProgramObjectARB(shader->program);
+    qglUniform1iARB(shader->sampler, 0);
+    qglUniformMatrix4fvARB(shader->model_view_projection, 1, false, m_camera->gl_view_proj_mat);
+    qglUniform1fARB(shader->dist_fog, m_camera->dist_far);
+    qglUniform3fvARB(shader->cam_right, 1, m_cam_right);
 
-            v[2].position[0] = s->pos[0] + s->sprite->left * m_cam_right[0];
-            v[2].position[1] = s->pos[1] + s->sprite->left * m_cam_right[1];
-            v[2].position[2] = s->pos[2] + s->sprite->left * m_cam_right[2] + s->sprite->bottom;
+    qglBindBufferARB(GL_ARRAY_BUFFER_ARB, m_sprites_vbo);
+    qglVertexPointer(3, GL_FLOAT, sizeof(vertex_t), (void*)offsetof(vertex_t, position));
+    qglColorPointer(4, GL_FLOAT, sizeof(vertex_t), (void*)offsetof(vertex_t, color));
+    qglNormalPointer(GL_FLOAT, sizeof(vertex_t), (void*)offsetof(vertex_t, normal));
+    qglTexCoordPointer(2, GL_FLOAT, sizeof(vertex_t), (void*)offsetof(vertex_t, tex_coord));
 
-            v[3].position[0] = s->pos[0] + s->sprite->right * m_cam_right[0];
-            v[3].position[1] = s->pos[1] + s->sprite->right * m_cam_right[1];
-            v[3].position[2] = s->pos[2] + s->sprite->right * m_cam_right[2] + s->sprite->bottom;
+    for(uint32_t page = 0; page < m_sprites_pages_count; page++)
+    {
+        GLsizei ranges = 0;
+        for(uint32_t i = 0; i < r_list_active_count; i++)
+        {
+            uint32_t range = r_list[i].room->content->original_room_id * m_sprites_pages_count + page;
+            if(m_sprites_count[range] > 0)
+            {
+                if((ranges > 0) && (m_sprites_draw_first[ranges - 1] + m_sprites_draw_count[ranges - 1] == m_sprites_first[range]))
+                {
+                    m_sprites_draw_count[ranges - 1] += m_sprites_count[range];
+                }
+                else
+                {
+                    m_sprites_draw_first[ranges] = m_sprites_first[range];
+                    m_sprites_draw_count[ranges] = m_sprites_count[range];
+                    ranges++;
+                }
+            }
         }
 
-        qglBindTexture(GL_TEXTURE_2D, room->content->sprites->sprite->texture_index);
-        qglVertexPointer(3, GL_FLOAT, sizeof(vertex_t), room->content->sprites_vertices->position);
-        qglColorPointer(4, GL_FLOAT, sizeof(vertex_t), room->content->sprites_vertices->color);
-        qglNormalPointer(GL_FLOAT, sizeof(vertex_t), room->content->sprites_vertices->normal);
-        qglTexCoordPointer(2, GL_FLOAT, sizeof(vertex_t), room->content->sprites_vertices->tex_coord);
-        qglDrawArrays(GL_QUADS, 0, 4 * room->content->sprites_count);
+        if(ranges > 0)
+        {
+            m_active_texture = m_sprites_pages[page];
+            qglBindTexture(GL_TEXTURE_2D, m_active_texture);
+            if(qglMultiDrawArrays)
+            {
+                qglMultiDrawArrays(GL_QUADS, m_sprites_draw_first, m_sprites_draw_count, ranges);
+            }
+            else
+            {
+                for(GLsizei i = 0; i < ranges; i++)
+                {
+                    qglDrawArrays(GL_QUADS, m_sprites_draw_first[i], m_sprites_draw_count[i]);
+                }
+            }
+        }
     }
+    qglBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
 }
 
 
@@ -1298,7 +1954,7 @@ int CRender::ProcessRoom(struct portal_s *portal, struct frustum_s *frus)
  * Sets up the light calculations for the given entity based on its current
  * room. Returns the used shader, which will have been made current already.
  */
-const lit_shader_description *CRender::SetupEntityLight(struct entity_s *entity, const float modelViewMatrix[16])
+const lit_shader_description *CRender::SetupEntityLight(struct entity_s *entity, const float modelViewMatrix[16], bool skinned)
 {
     // Calculate lighting
     const lit_shader_description *shader;
@@ -1319,91 +1975,39 @@ const lit_shader_description *CRender::SetupEntityLight(struct entity_s *entity,
         }
 
         GLenum current_light_number = 0;
-        light_s *current_light = NULL;
-
         GLfloat positions[3*MAX_NUM_LIGHTS];
         GLfloat colors[4*MAX_NUM_LIGHTS];
         GLfloat innerRadiuses[1*MAX_NUM_LIGHTS];
         GLfloat outerRadiuses[1*MAX_NUM_LIGHTS];
-        memset(positions, 0, sizeof(positions));
-        memset(colors, 0, sizeof(colors));
-        memset(innerRadiuses, 0, sizeof(innerRadiuses));
-        memset(outerRadiuses, 0, sizeof(outerRadiuses));
-
-        float *entity_pos = entity->transform.M4x4 + 12;
-
-        for(uint32_t i = 0; (i < room->content->lights_count) && (current_light_number < MAX_NUM_LIGHTS); i++)
-        {
-            current_light = &room->content->lights[i];
-
-            float x = entity_pos[0] - current_light->pos[0];
-            float y = entity_pos[1] - current_light->pos[1];
-            float z = entity_pos[2] - current_light->pos[2];
-
-            float distance = sqrtf(x * x + y * y + z * z);
-
-            // Find color
-            colors[current_light_number*4 + 0] = std::fmin(std::fmax(current_light->colour[0], 0.0), 1.0);
-            colors[current_light_number*4 + 1] = std::fmin(std::fmax(current_light->colour[1], 0.0), 1.0);
-            colors[current_light_number*4 + 2] = std::fmin(std::fmax(current_light->colour[2], 0.0), 1.0);
-            colors[current_light_number*4 + 3] = std::fmin(std::fmax(current_light->colour[3], 0.0), 1.0);
-
-            if(room->content->room_flags & TR_ROOM_FLAG_WATER)
-            {
-                CalculateWaterTint(colors + current_light_number * 4, 0);
-            }
-
-            // Find position
-            Mat4_vec3_mul(&positions[3*current_light_number], modelViewMatrix, current_light->pos);
-
-            // Find fall-off
-            if(current_light->light_type == LT_SUN)
-            {
-                innerRadiuses[current_light_number] = 1e20f;
-                outerRadiuses[current_light_number] = 1e21f;
-                current_light_number++;
-            }
-            else if(distance <= current_light->outer + 1024.0f && (current_light->light_type == LT_POINT || current_light->light_type == LT_SHADOW))
-            {
-                innerRadiuses[current_light_number] = std::fabs(current_light->inner);
-                outerRadiuses[current_light_number] = std::fabs(current_light->outer);
-                current_light_number++;
-            }
-        }
 
-        for(uint32_t room_index = 0; (current_light_number < MAX_NUM_LIGHTS) && (room_index < room->content->near_room_list_size); room_index++)
+        const light_selection_s *sel = lightCache->GetEntityLights(entity);
+        if(sel != NULL)
         {
-            room_p near_room = room->content->near_room_list[room_index];
-            for(uint32_t i = 0; (i < near_room->content->lights_count) && (current_light_number < MAX_NUM_LIGHTS); i++)
+            current_light_number = sel->lights_count;
+            for(uint32_t i = 0; i < sel->lights_count; i++)
             {
-                current_light = &near_room->content->lights[i];
-
-                float x = entity_pos[0] - current_light->pos[0];
-                float y = entity_pos[1] - current_light->pos[1];
-                float z = entity_pos[2] - current_light->pos[2];
-
-                float distance = sqrtf(x * x + y * y + z * z);
-
-                // Find color
-                colors[current_light_number*4 + 0] = std::fmin(std::fmax(current_light->colour[0], 0.0), 1.0);
-                colors[current_light_number*4 + 1] = std::fmin(std::fmax(current_light->colour[1], 0.0), 1.0);
-                colors[current_light_number*4 + 2] = std::fmin(std::fmax(current_light->colour[2], 0.0), 1.0);
-                colors[current_light_number*4 + 3] = std::fmin(std::fmax(current_light->colour[3], 0.0), 1.0);
-
-                // Find position
-                Mat4_vec3_mul(&positions[3*current_light_number], modelViewMatrix, current_light->pos);
+                const light_candidate_s *c = sel->lights[i];
+                vec4_copy(colors + i * 4, c->colour);
+                if(c->own && (room->content->room_flags & TR_ROOM_FLAG_WATER))
+                {
+                    CalculateWaterTint(colors + i * 4, 0);
+                }
 
-                // Find fall-off
-                if(distance <= current_light->outer + 1024.0f && (current_light->light_type == LT_POINT || current_light->light_type == LT_SHADOW))
+                Mat4_vec3_mul(positions + i * 3, modelViewMatrix, c->light->pos);
+                if(c->light->light_type == LT_SUN)
+                {
+                    innerRadiuses[i] = 1e20f;
+                    outerRadiuses[i] = 1e21f;
+                }
+                else
                 {
-                    innerRadiuses[current_light_number] = std::fabs(current_light->inner);
-                    outerRadiuses[current_light_number] = std::fabs(current_light->outer);
-                    current_light_number++;
+                    innerRadiuses[i] = std::fabs(c->light->inner);
+                    outerRadiuses[i] = std::fabs(c->light->outer);
                 }
             }
         }
 
-        shader = shaderManager->getEntityShader(current_light_number);
+        shader = (skinned) ? (shaderManager->getEntitySkinnedShader(current_light_number)) : (shaderManager->getEntityShader(current_light_number));
         qglUseProgramObjectARB(shader->program);
         qglUniform1fARB(shader->dist_fog, m_camera->dist_far);
         qglUniform4fvARB(shader->light_ambient, 1, ambient_component);
@@ -1414,7 +2018,7 @@ const lit_shader_description *CRender::SetupEntityLight(struct entity_s *entity,
     }
     else
     {
-        shader = shaderManager->getEntityShader(0);
+        shader = (skinned) ? (shaderManager->getEntitySkinnedShader(0)) : (shaderManager->getEntityShader(0));
         qglUseProgramObjectARB(shader->program);
         qglUniform1fARB(shader->dist_fog, m_camera->dist_far);
     }
@@ -1775,6 +2379,27 @@ void CRenderDebugDrawer::DrawSkeletalModelDebugLines(struct ss_bone_frame_s *bfr
             Mat4_Mat4_mul(tr, transform, btag->full_transform);
             this->DrawMeshDebugLines(btag->mesh_base, tr, NULL, NULL);
         }
+
+        // skin meshes by CPU reference of palette skinning, result is in model space
+        if(bframe->bone_tag_count <= MESH_SKIN_MAX_BONES)
+        {
+            GLfloat palette[MESH_SKIN_MAX_BONES * MESH_SKIN_PALETTE_ROWS * 4];
+            SSBoneFrame_FillBonePalette(bframe, palette, MESH_SKIN_MAX_BONES);
+            btag = bframe->bone_tags;
+            for(uint16_t i = 0; i < bframe->bone_tag_count; i++, btag++)
+            {
+                if(btag->mesh_skin && btag->parent && btag->skin_map)
+                {
+                    mesh_skin_part_t part = {btag->mesh_skin, btag->parent->mesh_base, btag->skin_map, i, btag->parent->index};
+                    size_t buf_size = btag->mesh_skin->vertex_count * 3 * sizeof(GLfloat);
+                    GLfloat *positions = (GLfloat*)Sys_GetTempMem(buf_size);
+                    GLfloat *normals = (GLfloat*)Sys_GetTempMem(buf_size);
+                    BaseMesh_SkinPart(&part, palette, positions, normals);
+                    this->DrawMeshDebugLines(btag->mesh_skin, transform, positions, normals);
+                    Sys_ReturnTempMem(2 * buf_size);
+                }
+            }
+        }
     }
 }
 
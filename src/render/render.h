@@ -33,6 +33,31 @@
 
 #define STENCIL_FRUSTUM 1
 
+// Transparency modes: dynamic BSP splits and sorts every transparent polygon
+// on CPU; sorted mode draws static transparent faces from mesh buffers,
+// objects sorted back to front by render queue.
+#define R_TRANSPARENCY_BSP          (0)
+#define R_TRANSPARENCY_SORTED       (1)
+
+// Visibility cache: rooms list and portal frustums of previous frame are reused
+// while camera room, position and projection are the same and camera turned
+// less than RENDER_VIS_CACHE_TURN (fixed cameras, free look, paused game).
+// Turning from the same position rebuilds list with camera frustum widened by
+// that angle, so the list covers every view of the turn range; portal frustums
+// have camera position as apex, so any move rebuilds exact list.
+#define RENDER_VIS_CACHE_TURN   (5.0f * M_PI / 180.0f)
+
+typedef struct render_vis_stats_s
+{
+    uint32_t    frames;                                                         // GenWorldList() calls with rooms
+    uint32_t    cached_frames;                                                  // of them reused previous traversal
+    uint32_t    turned_frames;                                                  // reused ones with turned camera
+    uint32_t    checked_frames;                                                 // cached ones compared with full traversal
+    uint32_t    failed_frames;                                                  // cached list misses visible rooms
+    uint32_t    missed_rooms;                                                   // visible rooms out of cached lists
+    uint32_t    extra_rooms;                                                    // cached rooms not visible (turn margin)
+}render_vis_stats_t, *render_vis_stats_p;
+
 struct portal_s;
 struct frustum_s;
 struct world_s;
@@ -41,8 +66,12 @@ struct camera_s;
 struct entity_s;
 struct sprite_s;
 struct base_mesh_s;
+struct mesh_batch_s;
+struct static_mesh_s;
 struct obb_s;
 struct lit_shader_description;
+struct skinned_shader_description;
+struct unlit_tinted_shader_description;
 
 // Native TR blending modes.
 
@@ -83,6 +112,9 @@ typedef struct render_settings_s
     GLfloat   fog_color[4];
     float     fog_start_depth;
     float     fog_end_depth;
+    int8_t    transparency_mode;
+    int8_t    atlas_packer;                                                     // RECT_PACKER_* (render/rect_packer.h)
+    int8_t    skinning;                                                         // skeletal models: 0 - draw per bone, 1 - bone matrices palette
 }render_settings_t, *render_settings_p;
 
 
@@ -145,23 +177,39 @@ class CRender
         void UpdateAnimTextures();
 
         void GenWorldList(struct camera_s *cam);
+        void SetVisCacheCheck(bool check)                                       // compare every reused list with full traversal
+        {
+            m_vis_cache_check = check;
+        }
+        void GetVisStats(struct render_vis_stats_s *stats)
+        {
+            *stats = m_vis_stats;
+        }
         void DrawList();
         void DrawListDebugLines();
         void CleanList();
 
+        float GetTransparencyTime(int mode)                                     // ms per frame, CPU side
+        {
+            return m_transparency_time[(mode == R_TRANSPARENCY_SORTED) ? 1 : 0];
+        }
+
         void DrawBSPPolygon(struct bsp_polygon_s *p);
         void DrawBSPFrontToBack(struct bsp_node_s *root);
         void DrawBSPBackToFront(struct bsp_node_s *root);
 
+        uint32_t UpdateAnimatedTexCoords(struct base_mesh_s *mesh);
         void DrawMesh(struct base_mesh_s *mesh, const float *overrideVertices, const float *overrideNormals);
         void DrawSkinMesh(struct base_mesh_s *mesh, struct base_mesh_s *parent_mesh, uint32_t *map, float transform[16]);
         void DrawSkyBox(const float matrix[16]);
 
         void DrawSkeletalModel(const struct lit_shader_description *shader, struct ss_bone_frame_s *bframe, const float mvMatrix[16], const float mvpMatrix[16]);
+        void DrawSkinnedModel(const struct skinned_shader_description *shader, struct ss_bone_frame_s *bframe, const float mvMatrix[16], const float mvpMatrix[16]);
         void DrawEntity(struct entity_s *entity, const float modelViewMatrix[16], const float modelViewProjectionMatrix[16]);
 
+        void QueueRoom(struct room_s *room, const float modelViewProjectionMatrix[16]);
         void DrawRoom(struct room_s *room, const float matrix[16], const float modelViewProjectionMatrix[16]);
-        void DrawRoomSprites(struct room_s *room);
+        void DrawRoomsSprites();
 
         struct gl_text_line_s *OutTextXYZ(GLfloat x, GLfloat y, GLfloat z, const char *fmt, ...);
 
@@ -176,7 +224,22 @@ class CRender
         void InitSettings();
         int  AddRoom(struct room_s *room);
         int  ProcessRoom(struct portal_s *portal, struct frustum_s *frus);
-        const lit_shader_description *SetupEntityLight(struct entity_s *entity, const float modelViewMatrix[16]);
+        void TraversePortals(struct camera_s *cam, struct room_s *curr_room);
+        bool IsVisCacheSpot(struct camera_s *cam, struct room_s *curr_room);
+        bool IsVisCacheValid(struct camera_s *cam, struct room_s *curr_room);
+        void UpdateVisCache(struct camera_s *cam, struct room_s *curr_room, float turn);
+        void CheckVisCache(struct camera_s *cam, struct room_s *curr_room);
+        bool IsRoomNeedStencil(struct room_s *room);
+        void GenSpritesBuffer();
+        void ClearSpritesBuffer();
+        int  GetRoomBatchPart(struct room_s *room);
+        void QueueMesh(uint32_t pass, const struct unlit_tinted_shader_description *shader, struct base_mesh_s *mesh, const float mvp[16], const float tint[4], const float centre[3]);
+        void QueueStaticMesh(struct static_mesh_s *static_mesh, const float mvp[16], const float tint[4]);
+        void QueueTransparentMesh(struct base_mesh_s *mesh, float transform[16], bool sorted);
+        void DrawMeshAnimatedFaces(struct base_mesh_s *mesh);
+        struct mesh_batch_s *GetSkinBatch(struct ss_bone_frame_s *bframe);
+        void DrawTransparency();
+        const lit_shader_description *SetupEntityLight(struct entity_s *entity, const float modelViewMatrix[16], bool skinned);
 
         struct camera_s            *m_camera;
 
@@ -184,11 +247,31 @@ class CRender
         uint32_t                    m_rooms_count;
         struct anim_seq_s          *m_anim_sequences;
         uint32_t                    m_anim_sequences_count;
+        uint32_t                   *m_anim_tex_slot_base;                       // first frames table slot of every sequence
+        uint32_t                    m_anim_tex_slots;                           // 0 - frames are applied on CPU
+        GLfloat                    *m_anim_tex_frames;                          // 8 floats per slot, slot 0 is identity
+        GLuint                      m_sprites_vbo;                              // room sprites of all rooms, grouped by page, then by room
+        uint32_t                    m_sprites_pages_count;
+        GLuint                     *m_sprites_pages;                            // texture of every page
+        GLint                      *m_sprites_first;                            // [room * pages_count + page], in vertices
+        GLsizei                    *m_sprites_count;
+        GLint                      *m_sprites_draw_first;                       // ranges of one page for visible rooms
+        GLsizei                    *m_sprites_draw_count;
+        struct mesh_batch_s        *m_room_batch;                               // static faces of all rooms, part per room
+        uint32_t                    m_room_batch_object;
 
         uint16_t                    m_active_transparency;
+        float                       m_transparency_time[2];                     // BSP and sorted, smoothed
         GLuint                      m_active_texture;
 
         GLfloat                     m_cam_right[3];
+        GLfloat                     m_vis_cache_transform[16];
+        GLfloat                     m_vis_cache_proj[16];
+        float                       m_vis_cache_turn;                           // widening angle of cached traversal
+        struct room_s              *m_vis_cache_room;
+        uint32_t                    m_vis_cache_swaps;
+        bool                        m_vis_cache_check;
+        struct render_vis_stats_s   m_vis_stats;
         uint32_t                    r_list_size;
         uint32_t                    r_list_active_count;
         struct render_list_s       *r_list;
@@ -199,6 +282,9 @@ class CRender
         class shader_manager       *shaderManager;
         class CRenderDebugDrawer   *debugDrawer;
         class CDynamicBSP          *dynamicBSP;
+        class CRenderQueue         *renderQueue;
+        class CRenderQueue         *transparencyQueue;
+        class CLightCache          *lightCache;
         uint32_t                    r_flags;
 };
 
@@ -0,0 +1,658 @@
+
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <SDL2/SDL_platform.h>
+#include <SDL2/SDL_opengl.h>
+
+#include "../core/gl_util.h"
+#include "../core/polygon.h"
+#include "../mesh.h"
+#include "shader_description.h"
+#include "render.h"
+#include "render_queue.h"
+
+
+static uint32_t rq_frame_stamp = 0;                                             // shared, so queues never mark meshes with the same stamp
+
+static uint32_t RenderQueue_NewFrameStamp()
+{
+    if(++rq_frame_stamp == 0)
+    {
+        ++rq_frame_stamp;                                                       // zero is stamp of never marked mesh
+    }
+    return rq_frame_stamp;
+}
+
+
+CRenderQueue::CRenderQueue(uint32_t packets_count):
+m_headless(false),
+m_active_texture(0),
+m_packets_size(packets_count),
+m_packets_count(0),
+m_objects_size(packets_count / 4),
+m_objects_count(0),
+m_instance_vbo(0),
+m_instance_data_size(0),
+m_instance_data(NULL),
+m_frame(RenderQueue_NewFrameStamp()),
+m_upload_bytes(0)
+{
+    m_packets = (render_packet_p)malloc(m_packets_size * sizeof(render_packet_t));
+    m_keys = (uint64_t*)malloc(m_packets_size * sizeof(uint64_t));
+    m_order = (uint32_t*)malloc(m_packets_size * sizeof(uint32_t));
+    m_keys_tmp = (uint64_t*)malloc(m_packets_size * sizeof(uint64_t));
+    m_order_tmp = (uint32_t*)malloc(m_packets_size * sizeof(uint32_t));
+    m_multi_counts = (GLsizei*)malloc(m_packets_size * sizeof(GLsizei));
+    m_multi_offsets = (const GLvoid**)malloc(m_packets_size * sizeof(GLvoid*));
+    m_objects = (render_object_p)malloc(m_objects_size * sizeof(render_object_t));
+    memset(&m_stats, 0x00, sizeof(m_stats));
+}
+
+
+CRenderQueue::~CRenderQueue()
+{
+    free(m_packets);
+    m_packets = NULL;
+    free(m_keys);
+    m_keys = NULL;
+    free(m_order);
+    m_order = NULL;
+    free(m_keys_tmp);
+    m_keys_tmp = NULL;
+    free(m_order_tmp);
+    m_order_tmp = NULL;
+    free(m_multi_counts);
+    m_multi_counts = NULL;
+    free(m_multi_offsets);
+    m_multi_offsets = NULL;
+    free(m_objects);
+    m_objects = NULL;
+    free(m_instance_data);
+    m_instance_data = NULL;
+    if(m_instance_vbo != 0)
+    {
+        qglDeleteBuffersARB(1, &m_instance_vbo);
+        m_instance_vbo = 0;
+    }
+
+    m_packets_size = 0;
+    m_packets_count = 0;
+    m_objects_size = 0;
+    m_objects_count = 0;
+    m_instance_data_size = 0;
+}
+
+
+void CRenderQueue::Reset()
+{
+    m_packets_count = 0;
+    m_objects_count = 0;
+    m_frame = RenderQueue_NewFrameStamp();
+    m_upload_bytes = 0;
+}
+
+
+uint32_t CRenderQueue::AddObject(const float mvp[16], const float tint[4])
+{
+    if(m_objects_count >= m_objects_size)
+    {
+        m_objects_size *= 2;
+        m_objects = (render_object_p)realloc(m_objects, m_objects_size * sizeof(render_object_t));
+    }
+
+    render_object_p obj = m_objects + m_objects_count;
+    memcpy(obj->mvp, mvp, sizeof(obj->mvp));
+    memcpy(obj->tint, tint, sizeof(obj->tint));
+
+    return m_objects_count++;
+}
+
+
+void CRenderQueue::AddPacket(uint64_t key, const struct unlit_tinted_shader_description *shader, struct base_mesh_s *mesh, struct mesh_face_s *face, uint32_t object, uint32_t flags)
+{
+    if(m_packets_count >= m_packets_size)
+    {
+        m_packets_size *= 2;
+        m_packets = (render_packet_p)realloc(m_packets, m_packets_size * sizeof(render_packet_t));
+        m_keys = (uint64_t*)realloc(m_keys, m_packets_size * sizeof(uint64_t));
+        m_order = (uint32_t*)realloc(m_order, m_packets_size * sizeof(uint32_t));
+        m_keys_tmp = (uint64_t*)realloc(m_keys_tmp, m_packets_size * sizeof(uint64_t));
+        m_order_tmp = (uint32_t*)realloc(m_order_tmp, m_packets_size * sizeof(uint32_t));
+        m_multi_counts = (GLsizei*)realloc(m_multi_counts, m_packets_size * sizeof(GLsizei));
+        m_multi_offsets = (const GLvoid**)realloc(m_multi_offsets, m_packets_size * sizeof(GLvoid*));
+    }
+
+    render_packet_p p = m_packets + m_packets_count;
+    p->shader = shader;
+    p->mesh = mesh;
+    p->face = face;
+    p->range = NULL;
+    p->object = object;
+    p->flags = flags;
+    m_keys[m_packets_count] = key;
+    m_order[m_packets_count] = m_packets_count;
+    m_packets_count++;
+}
+
+
+void CRenderQueue::AddFaces(uint64_t base_key, const struct unlit_tinted_shader_description *shader, struct base_mesh_s *mesh, uint32_t object, uint32_t flags)
+{
+    if(mesh->animated_vertex_count && mesh->vbo_animated_vertex_array)
+    {
+        mesh_face_p face = mesh->animated_faces;
+        for(uint32_t i = 0; i < mesh->animated_faces_count; i++, face++)
+        {
+            uint64_t key = base_key | ((uint64_t)(face->texture_index & RQ_KEY_TEXTURE_MASK) << RQ_KEY_TEXTURE_SHIFT);
+            this->AddPacket(key, shader, mesh, face, object, flags | RQ_PACKET_ANIMATED);
+        }
+    }
+
+    if(mesh->vertex_count && mesh->vbo_vertex_array)
+    {
+        mesh_face_p face = mesh->faces;
+        for(uint32_t i = 0; i < mesh->faces_count; i++, face++)
+        {
+            uint64_t key = base_key | ((uint64_t)(face->texture_index & RQ_KEY_TEXTURE_MASK) << RQ_KEY_TEXTURE_SHIFT);
+            this->AddPacket(key, shader, mesh, face, object, flags);
+        }
+    }
+}
+
+
+uint64_t CRenderQueue::MakeKey(uint32_t pass, const struct unlit_tinted_shader_description *shader, float depth)
+{
+    uint32_t depth_bits;
+
+    // non negative IEEE floats keep their order when compared as integers
+    depth = (depth > 0.0f) ? (depth) : (0.0f);
+    memcpy(&depth_bits, &depth, sizeof(depth_bits));
+    return ((uint64_t)pass << RQ_KEY_PASS_SHIFT) |
+           ((uint64_t)(shader->program & RQ_KEY_SHADER_MASK) << RQ_KEY_SHADER_SHIFT) |
+           (uint64_t)depth_bits;
+}
+
+
+void CRenderQueue::AddMesh(uint32_t pass, const struct unlit_tinted_shader_description *shader, struct base_mesh_s *mesh, uint32_t object, float depth)
+{
+    this->AddFaces(this->MakeKey(pass, shader, depth), shader, mesh, object, 0x00);
+}
+
+/**
+ * Adds only animated faces: static ones of that mesh are drawn from a batch.
+ */
+void CRenderQueue::AddAnimatedFaces(uint32_t pass, const struct unlit_tinted_shader_description *shader, struct base_mesh_s *mesh, uint32_t object, float depth)
+{
+    uint64_t base_key = this->MakeKey(pass, shader, depth);
+
+    if(mesh->animated_vertex_count && mesh->vbo_animated_vertex_array)
+    {
+        mesh_face_p face = mesh->animated_faces;
+        for(uint32_t i = 0; i < mesh->animated_faces_count; i++, face++)
+        {
+            uint64_t key = base_key | ((uint64_t)(face->texture_index & RQ_KEY_TEXTURE_MASK) << RQ_KEY_TEXTURE_SHIFT);
+            this->AddPacket(key, shader, mesh, face, object, RQ_PACKET_ANIMATED);
+        }
+    }
+}
+
+/**
+ * Adds non empty ranges of one batch part; object must hold batch transform.
+ */
+void CRenderQueue::AddBatchPart(uint32_t pass, const struct unlit_tinted_shader_description *shader, struct mesh_batch_s *batch, uint32_t part, uint32_t object)
+{
+    uint64_t base_key = this->MakeKey(pass, shader, 0.0f);
+    base_mesh_p mesh = &batch->mesh;
+    mesh_batch_range_p range = batch->ranges + part * mesh->faces_count;
+    mesh_face_p face = mesh->faces;
+
+    for(uint32_t i = 0; i < mesh->faces_count; i++, face++, range++)
+    {
+        if(range->elements_count > 0)
+        {
+            uint64_t key = base_key | ((uint64_t)(face->texture_index & RQ_KEY_TEXTURE_MASK) << RQ_KEY_TEXTURE_SHIFT);
+            this->AddPacket(key, shader, mesh, face, object, RQ_PACKET_BATCH);
+            m_packets[m_packets_count - 1].range = range;
+        }
+    }
+}
+
+/**
+ * Adds transparent faces of mesh; depth is squared distance to object centre,
+ * so objects are drawn back to front, faces of one object - by blending mode
+ * and texture. Intersecting objects are not split, as dynamic BSP does.
+ */
+void CRenderQueue::AddTransparentFaces(const struct unlit_tinted_shader_description *shader, struct base_mesh_s *mesh, uint32_t object, float depth)
+{
+    uint32_t depth_bits;
+
+    depth = (depth > 0.0f) ? (depth) : (0.0f);
+    memcpy(&depth_bits, &depth, sizeof(depth_bits));
+    uint64_t base_key = ((uint64_t)RQ_PASS_TRANSPARENT << RQ_KEY_PASS_SHIFT) |
+                        ((uint64_t)(~depth_bits) << RQ_KEY_BLEND_DEPTH_SHIFT);
+
+    if(mesh->vbo_vertex_array)
+    {
+        mesh_face_p face = mesh->transparent_faces;
+        for(uint32_t i = 0; i < mesh->transparent_faces_count; i++, face++)
+        {
+            uint64_t key = base_key | ((uint64_t)(face->transparency & RQ_KEY_BLEND_MODE_MASK) << RQ_KEY_BLEND_MODE_SHIFT) |
+                           ((uint64_t)(face->texture_index & RQ_KEY_TEXTURE_MASK) << RQ_KEY_BLEND_TEXTURE_SHIFT);
+            this->AddPacket(key, shader, mesh, face, object, RQ_PACKET_BLEND);
+        }
+    }
+}
+
+/**
+ * Instances are keyed by coarse depth (exponent of squared distance) and
+ * mesh id, so visible copies of one face in one distance range end up next
+ * to each other and are drawn in one call. Animated faces get own key, else
+ * they interleave with static faces of the same page and break the runs.
+ */
+void CRenderQueue::AddMeshInstance(uint32_t pass, const struct instanced_shader_description *shader, struct base_mesh_s *mesh, uint32_t object, float depth)
+{
+    uint32_t depth_bits;
+
+    depth = (depth > 0.0f) ? (depth) : (0.0f);
+    memcpy(&depth_bits, &depth, sizeof(depth_bits));
+    uint64_t base_key = ((uint64_t)pass << RQ_KEY_PASS_SHIFT) |
+                        ((uint64_t)(shader->program & RQ_KEY_SHADER_MASK) << RQ_KEY_SHADER_SHIFT) |
+                        ((uint64_t)(depth_bits >> 23) << RQ_KEY_INSTANCE_DEPTH_SHIFT) |
+                        (uint64_t)(mesh->id & RQ_KEY_INSTANCE_MESH_MASK);
+
+    if(mesh->animated_vertex_count && mesh->vbo_animated_vertex_array)
+    {
+        mesh_face_p face = mesh->animated_faces;
+        for(uint32_t i = 0; i < mesh->animated_faces_count; i++, face++)
+        {
+            uint64_t key = base_key | RQ_KEY_INSTANCE_ANIMATED | ((uint64_t)(face->texture_index & RQ_KEY_TEXTURE_MASK) << RQ_KEY_TEXTURE_SHIFT);
+            this->AddPacket(key, shader, mesh, face, object, RQ_PACKET_INSTANCED | RQ_PACKET_ANIMATED);
+        }
+    }
+
+    if(mesh->vertex_count && mesh->vbo_vertex_array)
+    {
+        mesh_face_p face = mesh->faces;
+        for(uint32_t i = 0; i < mesh->faces_count; i++, face++)
+        {
+            uint64_t key = base_key | ((uint64_t)(face->texture_index & RQ_KEY_TEXTURE_MASK) << RQ_KEY_TEXTURE_SHIFT);
+            this->AddPacket(key, shader, mesh, face, object, RQ_PACKET_INSTANCED);
+        }
+    }
+}
+
+/**
+ * Returns true only for the first call with that mesh since last Reset(),
+ * so animated texture coordinates are streamed once per mesh per frame.
+ */
+bool CRenderQueue::MarkAnimatedMesh(struct base_mesh_s *mesh)
+{
+    if(mesh->queue_frame == m_frame)
+    {
+        return false;
+    }
+    mesh->queue_frame = m_frame;
+    return true;
+}
+
+/**
+ * Blending mode switcher.
+ * Note that modes above 2 aren't explicitly used in TR textures, only for
+ * internal particle processing. Theoretically it's still possible to use
+ * them if you will force type via TRTextur utility.
+ */
+void CRenderQueue::SetBlendMode(uint32_t transparency)
+{
+    switch(transparency)
+    {
+        case BM_MULTIPLY:                                    // Classic PC alpha
+            qglBlendFunc(GL_ONE, GL_ONE);
+            break;
+
+        case BM_INVERT_SRC:                                  // Inversion by src (PS darkness) - SAME AS IN TR3-TR5
+            qglBlendFunc(GL_ZERO, GL_ONE_MINUS_SRC_COLOR);
+            break;
+
+        case BM_INVERT_DEST:                                 // Inversion by dest
+            qglBlendFunc(GL_ONE_MINUS_SRC_COLOR, GL_ONE_MINUS_SRC_COLOR);
+            break;
+
+        case BM_SCREEN:                                      // Screen (smoke, etc.)
+            qglBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_COLOR);
+            break;
+
+        case BM_ANIMATED_TEX:
+            qglBlendFunc(GL_ONE, GL_ZERO);
+            break;
+
+        default:                                             // opaque animated textures case
+            break;
+    };
+}
+
+/**
+ * LSD radix sort by 8 bit digits; stable, so packets with equal keys
+ * keep the order they were added in. Digits that are equal for all keys
+ * (unused passes, single shader, etc.) are skipped.
+ */
+void CRenderQueue::Sort()
+{
+    uint32_t count[256];
+
+    if(m_packets_count < 2)
+    {
+        return;
+    }
+
+    for(uint32_t shift = 0; shift < 64; shift += 8)
+    {
+        uint8_t first = (uint8_t)(m_keys[0] >> shift);
+        bool trivial = true;
+
+        memset(count, 0x00, sizeof(count));
+        for(uint32_t i = 0; i < m_packets_count; i++)
+        {
+            uint8_t digit = (uint8_t)(m_keys[i] >> shift);
+            trivial = trivial && (digit == first);
+            count[digit]++;
+        }
+
+        if(trivial)
+        {
+            continue;
+        }
+
+        for(uint32_t i = 0, sum = 0; i < 256; i++)
+        {
+            uint32_t c = count[i];
+            count[i] = sum;
+            sum += c;
+        }
+
+        for(uint32_t i = 0; i < m_packets_count; i++)
+        {
+            uint32_t dst = count[(uint8_t)(m_keys[i] >> shift)]++;
+            m_keys_tmp[dst] = m_keys[i];
+            m_order_tmp[dst] = m_order[i];
+        }
+
+        uint64_t *keys = m_keys;
+        uint32_t *order = m_order;
+        m_keys = m_keys_tmp;
+        m_order = m_order_tmp;
+        m_keys_tmp = keys;
+        m_order_tmp = order;
+    }
+}
+
+
+/**
+ * Instance data is written in the same order Submit() walks sorted packets,
+ * so every run of instanced packets finds its data at a running offset.
+ */
+uint32_t CRenderQueue::UploadInstances()
+{
+    uint32_t instances = 0;
+
+    for(uint32_t i = 0; i < m_packets_count; i++)
+    {
+        if(m_packets[m_order[i]].flags & RQ_PACKET_INSTANCED)
+        {
+            instances++;
+        }
+    }
+
+    if(instances > 0)
+    {
+        if(instances > m_instance_data_size)
+        {
+            m_instance_data_size = instances;
+            m_instance_data = (GLfloat*)realloc(m_instance_data, m_instance_data_size * RQ_INSTANCE_FLOATS * sizeof(GLfloat));
+        }
+
+        GLfloat *data = m_instance_data;
+        for(uint32_t i = 0; i < m_packets_count; i++)
+        {
+            render_packet_p p = m_packets + m_order[i];
+            if(p->flags & RQ_PACKET_INSTANCED)
+            {
+                render_object_p obj = m_objects + p->object;
+                memcpy(data, obj->mvp, sizeof(obj->mvp));
+                memcpy(data + 16, obj->tint, sizeof(obj->tint));
+                data += RQ_INSTANCE_FLOATS;
+            }
+        }
+
+        if(m_instance_vbo == 0)
+        {
+            qglGenBuffersARB(1, &m_instance_vbo);
+        }
+        qglBindBufferARB(GL_ARRAY_BUFFER_ARB, m_instance_vbo);
+        qglBufferDataARB(GL_ARRAY_BUFFER_ARB, instances * RQ_INSTANCE_FLOATS * sizeof(GLfloat), m_instance_data, GL_STREAM_DRAW);
+        m_upload_bytes += instances * RQ_INSTANCE_FLOATS * sizeof(GLfloat);
+    }
+
+    return instances;
+}
+
+
+void CRenderQueue::SetInstanceAttribs(const struct instanced_shader_description *shader, bool enable)
+{
+    GLint attribs[5] = {shader->instance_mvp[0], shader->instance_mvp[1], shader->instance_mvp[2], shader->instance_mvp[3], shader->instance_tint};
+
+    for(int i = 0; i < 5; i++)
+    {
+        if(attribs[i] >= 0)
+        {
+            if(enable)
+            {
+                qglEnableVertexAttribArrayARB(attribs[i]);
+                qglVertexAttribDivisorARB(attribs[i], 1);
+            }
+            else
+            {
+                qglVertexAttribDivisorARB(attribs[i], 0);
+                qglDisableVertexAttribArrayARB(attribs[i]);
+            }
+        }
+    }
+}
+
+
+/**
+ * Draws run of batch packets with the same face, shader and object, starting
+ * from sorted position first; ranges of parts adjacent in the element buffer
+ * are merged. Returns number of packets drawn.
+ */
+uint32_t CRenderQueue::SubmitBatch(uint32_t first)
+{
+    render_packet_p p = m_packets + m_order[first];
+    GLuint elem_size = (p->face->elements_type == GL_UNSIGNED_SHORT) ? sizeof(GLushort) : sizeof(GLuint);
+    uint32_t run = 0;
+    uint32_t ranges = 0;
+    GLuint end = 0xFFFFFFFF;
+
+    for(; first + run < m_packets_count; run++)
+    {
+        render_packet_p next = m_packets + m_order[first + run];
+        if(!(next->flags & RQ_PACKET_BATCH) || (next->face != p->face) || (next->shader != p->shader) || (next->object != p->object))
+        {
+            break;
+        }
+        if(next->range->elements_offset == end)
+        {
+            m_multi_counts[ranges - 1] += next->range->elements_count;
+        }
+        else
+        {
+            m_multi_counts[ranges] = next->range->elements_count;
+            m_multi_offsets[ranges] = (const GLvoid*)(uintptr_t)next->range->elements_offset;
+            ranges++;
+        }
+        end = next->range->elements_offset + next->range->elements_count * elem_size;
+    }
+
+    m_stats.multi_draw_ranges += ranges;
+    if(qglMultiDrawElements)
+    {
+        m_stats.multi_draws++;
+        if(!m_headless)
+        {
+            qglMultiDrawElements(GL_TRIANGLES, m_multi_counts, p->face->elements_type, m_multi_offsets, ranges);
+        }
+    }
+    else
+    {
+        m_stats.draw_calls += ranges - 1;
+        for(uint32_t i = 0; (i < ranges) && !m_headless; i++)
+        {
+            qglDrawElements(GL_TRIANGLES, m_multi_counts[i], p->face->elements_type, m_multi_offsets[i]);
+        }
+    }
+
+    return run;
+}
+
+
+void CRenderQueue::Submit(GLfloat dist_fog, GLfloat current_tick)
+{
+    const unlit_tinted_shader_description *shader = NULL;
+    const instanced_shader_description *instanced_shader = NULL;
+    struct base_mesh_s *mesh = NULL;
+    uint32_t object = 0xFFFFFFFF;
+    uint32_t flags = 0x00;
+    uint32_t instance = 0;
+    uint32_t transparency = 0xFFFFFFFF;
+
+    memset(&m_stats, 0x00, sizeof(m_stats));
+    m_stats.packets = m_packets_count;
+    m_stats.objects = m_objects_count;
+    m_active_texture = 0xFFFFFFFF;                                              // first packet always binds its texture
+
+    if(!m_headless)
+    {
+        this->UploadInstances();
+    }
+
+    for(uint32_t i = 0; i < m_packets_count; i++)
+    {
+        render_packet_p p = m_packets + m_order[i];
+
+        if(shader != p->shader)
+        {
+            if(instanced_shader && !m_headless)
+            {
+                this->SetInstanceAttribs(instanced_shader, false);
+            }
+            shader = p->shader;
+            instanced_shader = (p->flags & RQ_PACKET_INSTANCED) ? ((const instanced_shader_description*)shader) : (NULL);
+            object = 0xFFFFFFFF;                                                // uniforms are per program
+            m_stats.program_binds++;
+            if(!m_headless)
+            {
+                qglUseProgramObjectARB(shader->program);
+                qglUniform1iARB(shader->sampler, 0);
+                qglUniform1fARB(shader->dist_fog, dist_fog);
+                qglUniform1fARB(shader->current_tick, current_tick);
+                if(instanced_shader)
+                {
+                    this->SetInstanceAttribs(instanced_shader, true);
+                }
+            }
+        }
+
+        if(!instanced_shader && (object != p->object))
+        {
+            object = p->object;
+            m_stats.uniform_updates++;
+            if(!m_headless)
+            {
+                render_object_p obj = m_objects + object;
+                qglUniformMatrix4fvARB(shader->model_view_projection, 1, false, obj->mvp);
+                qglUniform4fvARB(shader->tint_mult, 1, obj->tint);
+            }
+        }
+
+        if((mesh != p->mesh) || ((flags & RQ_PACKET_ANIMATED) != (p->flags & RQ_PACKET_ANIMATED)))
+        {
+            mesh = p->mesh;
+            flags = p->flags;
+            m_stats.buffer_binds++;
+            if(!m_headless)
+            {
+                if(flags & RQ_PACKET_ANIMATED)
+                {
+                    qglBindBufferARB(GL_ARRAY_BUFFER_ARB, mesh->vbo_animated_texcoord_array);
+                    qglTexCoordPointer(3, GL_FLOAT, sizeof(GLfloat [3]), 0);
+                }
+                BaseMesh_SetVertexPointers(mesh, flags & RQ_PACKET_ANIMATED);
+            }
+        }
+
+        if(m_active_texture != p->face->texture_index)
+        {
+            m_active_texture = p->face->texture_index;
+            m_stats.texture_binds++;
+            if(!m_headless)
+            {
+                qglBindTexture(GL_TEXTURE_2D, m_active_texture);
+            }
+        }
+
+        if((p->flags & RQ_PACKET_BLEND) && (transparency != p->face->transparency))
+        {
+            transparency = p->face->transparency;
+            m_stats.blend_changes++;
+            if(!m_headless)
+            {
+                CRenderQueue::SetBlendMode(transparency);
+            }
+        }
+
+        m_stats.draw_calls++;
+        if(p->flags & RQ_PACKET_BATCH)
+        {
+            i += this->SubmitBatch(i) - 1;
+        }
+        else if(instanced_shader)
+        {
+            uint32_t run = 1;
+            while((i + run < m_packets_count) && (m_packets[m_order[i + run]].face == p->face) &&
+                  (m_packets[m_order[i + run]].shader == shader))
+            {
+                run++;
+            }
+
+            m_stats.instanced_draws++;
+            m_stats.instances += run;
+            if(!m_headless)
+            {
+                const GLsizei stride = RQ_INSTANCE_FLOATS * sizeof(GLfloat);
+                uint8_t *offset = (uint8_t*)0 + instance * stride;
+                qglBindBufferARB(GL_ARRAY_BUFFER_ARB, m_instance_vbo);
+                for(int c = 0; c < 4; c++)
+                {
+                    qglVertexAttribPointerARB(instanced_shader->instance_mvp[c], 4, GL_FLOAT, GL_FALSE, stride, offset + c * 4 * sizeof(GLfloat));
+                }
+                qglVertexAttribPointerARB(instanced_shader->instance_tint, 4, GL_FLOAT, GL_FALSE, stride, offset + 16 * sizeof(GLfloat));
+                qglDrawElementsInstancedARB(GL_TRIANGLES, p->face->elements_count, p->face->elements_type, MESH_FACE_ELEMENTS(p->face), run);
+            }
+            instance += run;
+            i += run - 1;
+        }
+        else if(!m_headless)
+        {
+            qglDrawElements(GL_TRIANGLES, p->face->elements_count, p->face->elements_type, MESH_FACE_ELEMENTS(p->face));
+        }
+    }
+
+    if(instanced_shader && !m_headless)
+    {
+        this->SetInstanceAttribs(instanced_shader, false);
+    }
+    if(!m_headless)
+    {
+        qglBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, 0);                       // other draw paths use client side indices
+    }
+    m_stats.upload_bytes = m_upload_bytes;
+}
@@ -0,0 +1,164 @@
+
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <stdint.h>
+#include <SDL2/SDL_platform.h>
+#include <SDL2/SDL_opengl.h>
+
+struct base_mesh_s;
+struct mesh_face_s;
+struct mesh_batch_s;
+struct mesh_batch_range_s;
+struct unlit_tinted_shader_description;
+struct instanced_shader_description;
+
+/*
+ * Render queue packets are sorted by 64-bit key, most significant first:
+ * | pass : 4 | shader : 12 | texture : 16 | depth : 32 |
+ * so all packets of one pass are submitted with minimal program and texture
+ * switches, front to back inside one texture page. Instanced packets replace
+ * depth with | depth exponent : 8 | animated : 1 | mesh id : 23 |, so copies
+ * of one face in the same distance range (x2 of squared distance) follow
+ * each other and are drawn in one call, and ranges still go front to back. Batch
+ * packets have zero depth, so all visible parts of one batch page follow
+ * each other (in order they were added) and are drawn with one multi draw.
+ * Transparent pass keys put inverted depth first, to draw back to front:
+ * | pass : 4 | far to near depth : 32 | blend mode : 8 | texture : 16 | 0 : 4 |
+ */
+#define RQ_PASS_ROOM_BATCH          (0)
+#define RQ_PASS_ROOM                (1)
+#define RQ_PASS_STATIC              (2)
+#define RQ_PASS_TRANSPARENT         (3)
+
+#define RQ_KEY_PASS_SHIFT           (60)
+#define RQ_KEY_SHADER_SHIFT         (48)
+#define RQ_KEY_TEXTURE_SHIFT        (32)
+#define RQ_KEY_SHADER_MASK          (0x0FFF)
+#define RQ_KEY_TEXTURE_MASK         (0xFFFF)
+#define RQ_KEY_BLEND_DEPTH_SHIFT    (28)
+#define RQ_KEY_BLEND_MODE_SHIFT     (20)
+#define RQ_KEY_BLEND_TEXTURE_SHIFT  (4)
+#define RQ_KEY_BLEND_MODE_MASK      (0xFF)
+#define RQ_KEY_INSTANCE_DEPTH_SHIFT (24)
+#define RQ_KEY_INSTANCE_ANIMATED    (0x00800000)
+#define RQ_KEY_INSTANCE_MESH_MASK   (0x007FFFFF)
+
+#define RQ_PACKET_ANIMATED          (0x01)                                      // face from mesh->animated_faces
+#define RQ_PACKET_INSTANCED         (0x02)                                      // drawn in one call with neighbours of the same face
+#define RQ_PACKET_BATCH             (0x04)                                      // range of merged batch face
+#define RQ_PACKET_BLEND             (0x08)                                      // transparent face, sets blending mode
+
+#define RQ_INSTANCE_FLOATS          (16 + 4)                                    // mvp columns + tint
+
+typedef struct render_object_s
+{
+    GLfloat                 mvp[16];
+    GLfloat                 tint[4];
+}render_object_t, *render_object_p;
+
+typedef struct render_packet_s
+{
+    const struct unlit_tinted_shader_description *shader;
+    struct base_mesh_s     *mesh;
+    struct mesh_face_s     *face;
+    const struct mesh_batch_range_s *range;                                     // only for RQ_PACKET_BATCH
+    uint32_t                object;                                             // index in objects array
+    uint32_t                flags;
+}render_packet_t, *render_packet_p;
+
+typedef struct render_queue_stats_s
+{
+    uint32_t                packets;
+    uint32_t                objects;
+    uint32_t                program_binds;
+    uint32_t                texture_binds;
+    uint32_t                buffer_binds;
+    uint32_t                uniform_updates;
+    uint32_t                draw_calls;
+    uint32_t                instanced_draws;
+    uint32_t                instances;
+    uint32_t                multi_draws;                                        // glMultiDrawElements calls
+    uint32_t                multi_draw_ranges;                                  // element ranges drawn by them
+    uint32_t                upload_bytes;                                       // streamed per frame: instances, animated tex coords
+    uint32_t                blend_changes;
+}render_queue_stats_t, *render_queue_stats_p;
+
+
+class CRenderQueue
+{
+public:
+    CRenderQueue(uint32_t packets_count);
+   ~CRenderQueue();
+
+    void Reset();
+    uint32_t AddObject(const float mvp[16], const float tint[4]);
+    void AddMesh(uint32_t pass, const struct unlit_tinted_shader_description *shader, struct base_mesh_s *mesh, uint32_t object, float depth);
+    void AddAnimatedFaces(uint32_t pass, const struct unlit_tinted_shader_description *shader, struct base_mesh_s *mesh, uint32_t object, float depth);
+    void AddMeshInstance(uint32_t pass, const struct instanced_shader_description *shader, struct base_mesh_s *mesh, uint32_t object, float depth);
+    void AddBatchPart(uint32_t pass, const struct unlit_tinted_shader_description *shader, struct mesh_batch_s *batch, uint32_t part, uint32_t object);
+    void AddTransparentFaces(const struct unlit_tinted_shader_description *shader, struct base_mesh_s *mesh, uint32_t object, float depth);
+    bool MarkAnimatedMesh(struct base_mesh_s *mesh);
+    void Sort();
+    void Submit(GLfloat dist_fog, GLfloat current_tick);
+
+    static void SetBlendMode(uint32_t transparency);
+
+    // headless mode walks sorted packets and counts state changes without GL calls
+    void SetHeadless(bool headless)
+    {
+        m_headless = headless;
+    }
+    bool IsHeadless() const
+    {
+        return m_headless;
+    }
+    void CountUpload(uint32_t bytes)
+    {
+        m_upload_bytes += bytes;
+    }
+    GLuint GetActiveTexture() const
+    {
+        return m_active_texture;
+    }
+    const render_queue_stats_t *GetStats() const
+    {
+        return &m_stats;
+    }
+
+private:
+    uint64_t MakeKey(uint32_t pass, const struct unlit_tinted_shader_description *shader, float depth);
+    void AddPacket(uint64_t key, const struct unlit_tinted_shader_description *shader, struct base_mesh_s *mesh, struct mesh_face_s *face, uint32_t object, uint32_t flags);
+    void AddFaces(uint64_t base_key, const struct unlit_tinted_shader_description *shader, struct base_mesh_s *mesh, uint32_t object, uint32_t flags);
+    uint32_t UploadInstances();
+    void SetInstanceAttribs(const struct instanced_shader_description *shader, bool enable);
+    uint32_t SubmitBatch(uint32_t first);
+
+    bool                    m_headless;
+    GLuint                  m_active_texture;
+
+    uint32_t                m_packets_size;
+    uint32_t                m_packets_count;
+    render_packet_p         m_packets;
+    uint64_t               *m_keys;
+    uint32_t               *m_order;
+    uint64_t               *m_keys_tmp;
+    uint32_t               *m_order_tmp;
+    GLsizei                *m_multi_counts;
+    const GLvoid          **m_multi_offsets;
+
+    uint32_t                m_objects_size;
+    uint32_t                m_objects_count;
+    render_object_p         m_objects;
+
+    GLuint                  m_instance_vbo;
+    uint32_t                m_instance_data_size;
+    GLfloat                *m_instance_data;
+
+    uint32_t                m_frame;                                            // stamp for MarkAnimatedMesh(), new on every Reset()
+
+    uint32_t                m_upload_bytes;
+    render_queue_stats_t    m_stats;
+};
+
+#endif
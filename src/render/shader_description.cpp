@@ -56,6 +56,7 @@ unlit_shader_description::unlit_shader_description(const shader_stage &vertex, c
 {
     model_view_projection = qglGetUniformLocationARB(program, "modelViewProjection");
     dist_fog = qglGetUniformLocationARB(program, "distFog");
+    anim_tex_frames = qglGetUniformLocationARB(program, "animTexFrames");
 }
 
 lit_shader_description::lit_shader_description(const shader_stage &vertex, const shader_stage &fragment)
@@ -70,9 +71,32 @@ lit_shader_description::lit_shader_description(const shader_stage &vertex, const
     light_ambient = qglGetUniformLocationARB(program, "light_ambient");
 }
 
+skinned_shader_description::skinned_shader_description(const shader_stage &vertex, const shader_stage &fragment)
+: lit_shader_description(vertex, fragment)
+{
+    bone_palette = qglGetUniformLocationARB(program, "bonePalette");
+    bone_index = qglGetAttribLocationARB(program, "boneIndex");
+}
+
 unlit_tinted_shader_description::unlit_tinted_shader_description(const shader_stage &vertex, const shader_stage &fragment)
 : unlit_shader_description(vertex, fragment)
 {
     current_tick = qglGetUniformLocationARB(program, "fCurrentTick");
     tint_mult = qglGetUniformLocationARB(program, "tintMult");
 }
+
+sprite_shader_description::sprite_shader_description(const shader_stage &vertex, const shader_stage &fragment)
+: unlit_shader_description(vertex, fragment)
+{
+    cam_right = qglGetUniformLocationARB(program, "camRight");
+}
+
+instanced_shader_description::instanced_shader_description(const shader_stage &vertex, const shader_stage &fragment)
+: unlit_tinted_shader_description(vertex, fragment)
+{
+    instance_mvp[0] = qglGetAttribLocationARB(program, "instanceMVP0");
+    instance_mvp[1] = qglGetAttribLocationARB(program, "instanceMVP1");
+    instance_mvp[2] = qglGetAttribLocationARB(program, "instanceMVP2");
+    instance_mvp[3] = qglGetAttribLocationARB(program, "instanceMVP3");
+    instance_tint = qglGetAttribLocationARB(program, "instanceTint");
+}
@@ -47,6 +47,7 @@ struct unlit_shader_description : public shader_description
 {
     GLint model_view_projection;
     GLint dist_fog;
+    GLint anim_tex_frames;
 
     unlit_shader_description(const shader_stage &vertex, const shader_stage &fragment);
 };
@@ -69,6 +70,18 @@ struct lit_shader_description : public unlit_shader_description
     lit_shader_description(const shader_stage &vertex, const shader_stage &fragment);
 };
 
+/*!
+ * Lit shader with matrix palette skinning: bone matrices come in a
+ * uniform array, bone of vertex in a vertex attribute.
+ */
+struct skinned_shader_description : public lit_shader_description
+{
+    GLint bone_palette;
+    GLint bone_index;
+
+    skinned_shader_description(const shader_stage &vertex, const shader_stage &fragment);
+};
+
 struct unlit_tinted_shader_description : public unlit_shader_description
 {
     GLint current_tick;
@@ -77,4 +90,26 @@ struct unlit_tinted_shader_description : public unlit_shader_description
     unlit_tinted_shader_description(const shader_stage &vertex, const shader_stage &fragment);
 };
 
+/*!
+ * Room sprites shader: billboard corners are expanded along camera right vector.
+ */
+struct sprite_shader_description : public unlit_shader_description
+{
+    GLint cam_right;
+
+    sprite_shader_description(const shader_stage &vertex, const shader_stage &fragment);
+};
+
+/*!
+ * Instanced variant of the tinted shader: transform and tint come from
+ * per instance vertex attributes instead of uniforms.
+ */
+struct instanced_shader_description : public unlit_tinted_shader_description
+{
+    GLint instance_mvp[4];
+    GLint instance_tint;
+
+    instanced_shader_description(const shader_stage &vertex, const shader_stage &fragment);
+};
+
 #endif /* defined(__OpenTomb__shader_description__) */
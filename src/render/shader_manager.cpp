@@ -2,11 +2,26 @@
 #include <sstream>
 
 #include "shader_manager.h"
+#include "../mesh.h"
 
 shader_manager::shader_manager()
 {
+    GLint max_vertex_uniforms = 0;
+    qglGetIntegerv(GL_MAX_VERTEX_UNIFORM_COMPONENTS_ARB, &max_vertex_uniforms);
+    anim_tex_slots = (max_vertex_uniforms / 4 - ANIM_TEX_RESERVED_VECTORS) / 2;
+    anim_tex_slots = (anim_tex_slots > ANIM_TEX_MAX_SLOTS) ? (ANIM_TEX_MAX_SLOTS) : ((anim_tex_slots < 1) ? (1) : (anim_tex_slots));
+
+    std::ostringstream anim_tex_define;
+    anim_tex_define << "#define ANIM_TEX_SLOTS " << anim_tex_slots << std::endl;
+
     //Color mult prog
-    static_mesh_shader = new unlit_tinted_shader_description(shader_stage(GL_VERTEX_SHADER_ARB, "shaders/static_mesh.vsh"), shader_stage(GL_FRAGMENT_SHADER_ARB, "shaders/static_mesh.fsh"));
+    shader_stage staticMeshFragmentShader(GL_FRAGMENT_SHADER_ARB, "shaders/static_mesh.fsh");
+    static_mesh_shader = new unlit_tinted_shader_description(shader_stage(GL_VERTEX_SHADER_ARB, "shaders/static_mesh.vsh", (anim_tex_define.str() + "#define IS_INSTANCED 0\n").c_str()), staticMeshFragmentShader);
+    static_mesh_instanced_shader = NULL;
+    if(qglVertexAttribDivisorARB && qglDrawElementsInstancedARB)
+    {
+        static_mesh_instanced_shader = new instanced_shader_description(shader_stage(GL_VERTEX_SHADER_ARB, "shaders/static_mesh.vsh", (anim_tex_define.str() + "#define IS_INSTANCED 1\n").c_str()), staticMeshFragmentShader);
+    }
 
     //Room prog
     shader_stage roomFragmentShader(GL_FRAGMENT_SHADER_ARB, "shaders/room.fsh");
@@ -15,6 +30,7 @@ shader_manager::shader_manager()
         for (int isFlicker = 0; isFlicker < 2; isFlicker++)
         {
             std::ostringstream stream;
+            stream << anim_tex_define.str();
             stream << "#define IS_WATER " << isWater << std::endl;
             stream << "#define IS_FLICKER " << isFlicker << std::endl;
 
@@ -22,16 +38,75 @@ shader_manager::shader_manager()
         }
     }
 
-    // Entity prog
-    shader_stage entityVertexShader(GL_VERTEX_SHADER_ARB, "shaders/entity.vsh");
+    // Room sprites prog
+    sprite_shader = new sprite_shader_description(shader_stage(GL_VERTEX_SHADER_ARB, "shaders/sprite.vsh"), roomFragmentShader);
+
+    // Entity prog; skinned variant needs room for bone palette besides animated texture frames
+    bool skinning = (max_vertex_uniforms / 4 >= 2 * anim_tex_slots + ANIM_TEX_RESERVED_VECTORS + MESH_SKIN_PALETTE_ROWS * MESH_SKIN_MAX_BONES);
+    std::ostringstream skin_define;
+    skin_define << anim_tex_define.str();
+    skin_define << "#define IS_SKINNED 1" << std::endl;
+    skin_define << "#define SKIN_MAX_BONES " << MESH_SKIN_MAX_BONES << std::endl;
+    shader_stage entityVertexShader(GL_VERTEX_SHADER_ARB, "shaders/entity.vsh", (anim_tex_define.str() + "#define IS_SKINNED 0\n").c_str());
+    shader_stage *entitySkinnedVertexShader = (skinning) ? (new shader_stage(GL_VERTEX_SHADER_ARB, "shaders/entity.vsh", skin_define.str().c_str())) : (NULL);
     for (int i = 0; i <= MAX_NUM_LIGHTS; i++) {
         std::ostringstream stream;
         stream << "#define NUMBER_OF_LIGHTS " << i << std::endl;
 
-        entity_shader[i] = new lit_shader_description(entityVertexShader, shader_stage(GL_FRAGMENT_SHADER_ARB, "shaders/entity.fsh", stream.str().c_str()));
+        shader_stage entityFragmentShader(GL_FRAGMENT_SHADER_ARB, "shaders/entity.fsh", stream.str().c_str());
+        entity_shader[i] = new lit_shader_description(entityVertexShader, entityFragmentShader);
+        entity_skinned_shader[i] = NULL;
+        if(entitySkinnedVertexShader)
+        {
+            entity_skinned_shader[i] = new skinned_shader_description(*entitySkinnedVertexShader, entityFragmentShader);
+        }
     }
+    delete entitySkinnedVertexShader;
 
     text = new text_shader_description(shader_stage(GL_VERTEX_SHADER_ARB, "shaders/text.vsh"), shader_stage(GL_FRAGMENT_SHADER_ARB, "shaders/text.fsh"));
+
+    // slot 0 (not animated texture) must be identity before the first frame
+    const GLfloat identity[8] = {1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    this->setAnimTexFrames(identity, 1);
+}
+
+/**
+ * Uploads animated texture frames table to all mesh programs;
+ * uniforms are per program state, so it is done once per frame.
+ */
+void shader_manager::setAnimTexFrames(const GLfloat *frames, int slots)
+{
+    const unlit_shader_description *shaders[4 + 2 + 2 * (MAX_NUM_LIGHTS + 1)];
+    int count = 0;
+
+    shaders[count++] = room_shaders[0][0];
+    shaders[count++] = room_shaders[0][1];
+    shaders[count++] = room_shaders[1][0];
+    shaders[count++] = room_shaders[1][1];
+    shaders[count++] = static_mesh_shader;
+    if(static_mesh_instanced_shader)
+    {
+        shaders[count++] = static_mesh_instanced_shader;
+    }
+    for(int i = 0; i <= MAX_NUM_LIGHTS; i++)
+    {
+        shaders[count++] = entity_shader[i];
+        if(entity_skinned_shader[i])
+        {
+            shaders[count++] = entity_skinned_shader[i];
+        }
+    }
+
+    slots = (slots > anim_tex_slots) ? (anim_tex_slots) : (slots);
+    for(int i = 0; i < count; i++)
+    {
+        if(shaders[i]->anim_tex_frames >= 0)
+        {
+            qglUseProgramObjectARB(shaders[i]->program);
+            qglUniform4fvARB(shaders[i]->anim_tex_frames, 2 * slots, frames);
+        }
+    }
+    qglUseProgramObjectARB(0);
 }
 
 shader_manager::~shader_manager()
@@ -45,6 +120,12 @@ const lit_shader_description *shader_manager::getEntityShader(unsigned numberOfL
     return entity_shader[numberOfLights];
 }
 
+const skinned_shader_description *shader_manager::getEntitySkinnedShader(unsigned numberOfLights) const {
+    assert(numberOfLights <= MAX_NUM_LIGHTS);
+
+    return entity_skinned_shader[numberOfLights];
+}
+
 const unlit_tinted_shader_description *shader_manager::getRoomShader(bool isFlickering, bool isWater) const
 {
     return room_shaders[isWater ? 1 : 0][isFlickering ? 1 : 0];
@@ -6,23 +6,43 @@
 // Highest number of lights that will show up in the entity shader.
 #define MAX_NUM_LIGHTS 8
 
+// Animated texture frame slots in mesh vertex shaders (2 vec4 uniforms each);
+// real count is limited by vertex uniforms, ANIM_TEX_RESERVED_VECTORS are left for other uniforms.
+#define ANIM_TEX_MAX_SLOTS 256
+#define ANIM_TEX_RESERVED_VECTORS 64
+
 class shader_manager {
     unlit_tinted_shader_description *room_shaders[2][2];
     unlit_tinted_shader_description *static_mesh_shader;
+    instanced_shader_description *static_mesh_instanced_shader;
+    sprite_shader_description *sprite_shader;
     lit_shader_description *entity_shader[MAX_NUM_LIGHTS+1];
+    skinned_shader_description *entity_skinned_shader[MAX_NUM_LIGHTS+1];
     text_shader_description *text;
+    int anim_tex_slots;
 
 public:
     shader_manager();
     ~shader_manager();
     
     const lit_shader_description *getEntityShader(unsigned numberOfLights) const;
+
+    // NULL if bone palette does not fit vertex uniforms
+    const skinned_shader_description *getEntitySkinnedShader(unsigned numberOfLights) const;
     
     const unlit_tinted_shader_description *getStaticMeshShader() const { return static_mesh_shader; }
+
+    // NULL if instancing is not supported by driver
+    const instanced_shader_description *getStaticMeshInstancedShader() const { return static_mesh_instanced_shader; }
     
     const unlit_tinted_shader_description *getRoomShader(bool isFlickering, bool isWater) const;
+
+    const sprite_shader_description *getSpriteShader() const { return sprite_shader; }
     
     const text_shader_description *getTextShader() const { return text; }
+
+    int getAnimTexSlots() const { return anim_tex_slots; }
+    void setAnimTexFrames(const GLfloat *frames, int slots);
 };
 
 #endif /* defined(__OpenTomb__shader_manager__) */
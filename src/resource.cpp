@@ -12,6 +12,7 @@ extern "C" {
 #include <lauxlib.h>
 }
 
+#include "core/arena.h"
 #include "core/system.h"
 #include "core/vmath.h"
 #include "core/gl_util.h"
@@ -783,45 +784,22 @@ int Res_Sector_TranslateFloorData(struct room_s *rooms, uint32_t rooms_count, st
                 {
                     fd_trigger_head_t fd_trigger_head = *((fd_trigger_head_p)entry);
 
-                    if(sector->trigger == NULL)
-                    {
-                        sector->trigger = (trigger_header_p)malloc(sizeof(trigger_header_t));
-                    }
-                    else
+                    if(sector->trigger != NULL)
                     {
                         Con_AddLine("SECTOR HAS TWO OR MORE TRIGGERS!!!", FONTSTYLE_CONSOLE_WARNING);
+                        Trigger_Delete(sector->trigger);
                     }
-                    sector->trigger->commands = NULL;
-                    sector->trigger->function_value = fd_command.function_value;
-                    sector->trigger->sub_function = fd_command.sub_function;
-                    sector->trigger->mask = fd_trigger_head.mask;
-                    sector->trigger->timer = fd_trigger_head.timer;
-                    sector->trigger->once = fd_trigger_head.once;
-
-                    // Now parse operand chain for trigger function!
+                    sector->trigger = Trigger_Create(fd_command.function_value, fd_command.sub_function,
+                                                     fd_trigger_head.mask, fd_trigger_head.once, fd_trigger_head.timer);
+
+                    // Now parse operand chain for trigger function into flat commands array!
                     fd_trigger_function_t fd_trigger_function;
                     do
                     {
-                        trigger_command_p command = (trigger_command_p)malloc(sizeof(trigger_command_t));
-                        trigger_command_p *last_command_ptr = &sector->trigger->commands;
-                        command->next = NULL;
-                        while(*last_command_ptr)
-                        {
-                            last_command_ptr = &((*last_command_ptr)->next);
-                        }
-                        *last_command_ptr = command;
-
                         entry++;
                         current_offset++;
                         fd_trigger_function = *((fd_trigger_function_p)entry);
-                        command->function = fd_trigger_function.function;
-                        command->operands = fd_trigger_function.operands;
-                        command->unused = 0;
-                        command->once = 0;
-                        command->camera.index = 0;
-                        command->camera.timer = 0;
-                        command->camera.move = 0;
-                        command->camera.unused = 0;
+                        trigger_command_p command = Trigger_AddCommand(sector->trigger, fd_trigger_function.function, fd_trigger_function.operands);
 
                         switch(command->function)
                         {
@@ -1076,10 +1054,30 @@ static void TR_CopyNormals(const polygon_p polygon, base_mesh_p mesh, const uint
 }
 
 
-void TR_AccumulateNormals(tr4_mesh_t *tr_mesh, base_mesh_p mesh, int numCorners, const uint16_t *vertex_indices, polygon_p p)
+/**
+ * Level mesh polygons (triangles first) and all their vertices are two
+ * arena blocks; polygons are never resized later.
+ */
+static polygon_p TR_CreatePolygons(uint32_t triangles_count, uint32_t rectangles_count)
 {
-    Polygon_Resize(p, numCorners);
+    uint32_t polygons_count = triangles_count + rectangles_count;
+    polygon_p ret = (polygon_p)Arena_Calloc(ARENA_TAG_MESHES, polygons_count, sizeof(polygon_t));
+    vertex_p v = (vertex_p)Arena_Calloc(ARENA_TAG_MESHES, 3 * triangles_count + 4 * rectangles_count, sizeof(vertex_t));
+    polygon_p p = ret;
+
+    for(uint32_t i = 0; i < polygons_count; i++, p++)
+    {
+        p->vertex_count = (i < triangles_count) ? (3) : (4);
+        p->vertices = v;
+        v += p->vertex_count;
+    }
+
+    return ret;
+}
+
 
+void TR_AccumulateNormals(tr4_mesh_t *tr_mesh, base_mesh_p mesh, int numCorners, const uint16_t *vertex_indices, polygon_p p)
+{
     for(int i = 0; i < numCorners; i++)
     {
         TR_vertex_to_arr(p->vertices[i].position, &tr_mesh->vertices[vertex_indices[i]]);
@@ -1170,7 +1168,8 @@ void TR_GenMesh(struct base_mesh_s *mesh, size_t mesh_index, struct anim_seq_s *
     BaseMesh_FindBB(mesh);
 
     mesh->polygons_count = tr_mesh->num_textured_triangles + tr_mesh->num_coloured_triangles + tr_mesh->num_textured_rectangles + tr_mesh->num_coloured_rectangles;
-    p = mesh->polygons = Polygon_CreateArray(mesh->polygons_count);
+    p = mesh->polygons = TR_CreatePolygons(tr_mesh->num_textured_triangles + tr_mesh->num_coloured_triangles,
+                                           tr_mesh->num_textured_rectangles + tr_mesh->num_coloured_rectangles);
 
     /*
      * textured triangles
@@ -1249,7 +1248,6 @@ void TR_GenMesh(struct base_mesh_s *mesh, size_t mesh_index, struct anim_seq_s *
     {
         face4 = &tr_mesh->coloured_rectangles[i];
         col = face4->texture & 0xff;
-        Polygon_Resize(p, 4);
         p->texture_index = 0;
         p->transparency = 0;
         p->anim_id = 0;
@@ -1347,7 +1345,7 @@ void TR_GenRoomMesh(struct room_s *room, size_t room_index, struct anim_seq_s *a
         return;
     }
 
-    mesh = room->content->mesh = (base_mesh_p)calloc(1, sizeof(base_mesh_t));
+    mesh = room->content->mesh = (base_mesh_p)Arena_Calloc(ARENA_TAG_MESHES, 1, sizeof(base_mesh_t));
     mesh->id = room_index;
 
     mesh->vertex_count = tr_room->num_vertices;
@@ -1361,7 +1359,7 @@ void TR_GenRoomMesh(struct room_s *room, size_t room_index, struct anim_seq_s *a
     BaseMesh_FindBB(mesh);
 
     mesh->polygons_count = tr_room->num_triangles + tr_room->num_rectangles;
-    p = mesh->polygons = Polygon_CreateArray(mesh->polygons_count);
+    p = mesh->polygons = TR_CreatePolygons(tr_room->num_triangles, tr_room->num_rectangles);
 
     /*
      * triangles
@@ -1369,7 +1367,6 @@ void TR_GenRoomMesh(struct room_s *room, size_t room_index, struct anim_seq_s *a
     for(uint32_t i = 0; i < tr_room->num_triangles; i++, p++)
     {
         uint32_t masked_texture = tr_room->triangles[i].texture & tex_mask;
-        Polygon_Resize(p, 3);
         TR_SetupRoomPolygonVertices(p, mesh, tr_room, tr_room->triangles[i].vertices);
         p->double_side = (tr_room->triangles[i].texture & 0x8000) ? (0x01) : (0x00);
         p->transparency = tr->object_textures[masked_texture].transparency_flags;
@@ -1383,7 +1380,6 @@ void TR_GenRoomMesh(struct room_s *room, size_t room_index, struct anim_seq_s *a
     for(uint32_t i = 0; i < tr_room->num_rectangles; i++, p++)
     {
         uint32_t masked_texture = tr_room->rectangles[i].texture & tex_mask;
-        Polygon_Resize(p, 4);
         TR_SetupRoomPolygonVertices(p, mesh, tr_room, tr_room->rectangles[i].vertices);
         p->double_side = (tr_room->rectangles[i].texture & 0x8000) ? (0x01) : (0x00);
         p->transparency = tr->object_textures[masked_texture].transparency_flags;
@@ -1450,12 +1446,13 @@ void TR_SkeletalModelInterpolateFrames(skeletal_model_p model, tr_animation_t *t
         if(anim->frames_count > 1 && tr_anim->frame_rate > 1)                   // we can't interpolate one frame or rate < 2!
         {
             new_frames_count = (uint16_t)tr_anim->frame_rate * (anim->frames_count - 1) + 1;
-            bf = new_bone_frames = (bone_frame_p)malloc(new_frames_count * sizeof(bone_frame_t));
+            bf = new_bone_frames = (bone_frame_p)Arena_Alloc(ARENA_TAG_ANIMATIONS, new_frames_count * sizeof(bone_frame_t));
+            bone_tag_p new_bone_tags = (bone_tag_p)Arena_Alloc(ARENA_TAG_ANIMATIONS, new_frames_count * model->mesh_count * sizeof(bone_tag_t));
 
             /*
              * the first frame does not changes
              */
-            bf->bone_tags = (bone_tag_p)malloc(model->mesh_count * sizeof(bone_tag_t));
+            bf->bone_tags = new_bone_tags;
             bf->bone_tag_count = model->mesh_count;
             vec3_set_zero(bf->pos);
             vec3_copy(bf->centre, anim->frames[0].centre);
@@ -1477,7 +1474,7 @@ void TR_SkeletalModelInterpolateFrames(skeletal_model_p model, tr_animation_t *t
                     lerp = ((float)lerp_index) / (float)tr_anim->frame_rate;
                     t = 1.0f - lerp;
 
-                    bf->bone_tags = (bone_tag_p)malloc(model->mesh_count * sizeof(bone_tag_t));
+                    bf->bone_tags = new_bone_tags + (bf - new_bone_frames) * model->mesh_count;
                     bf->bone_tag_count = model->mesh_count;
 
                     bf->centre[0] = t * anim->frames[j-1].centre[0] + lerp * anim->frames[j].centre[0];
@@ -1510,18 +1507,18 @@ void TR_SkeletalModelInterpolateFrames(skeletal_model_p model, tr_animation_t *t
 
             /*
              * swap old and new animation bone frames
-             * free old bone frames;
+             * free old bone frames (arena ones stay until level unload);
              */
             for(uint16_t j = 0; j < anim->frames_count; j++)
             {
                 if(anim->frames[j].bone_tag_count)
                 {
                     anim->frames[j].bone_tag_count = 0;
-                    free(anim->frames[j].bone_tags);
+                    Arena_Free(anim->frames[j].bone_tags);
                     anim->frames[j].bone_tags = NULL;
                 }
             }
-            free(anim->frames);
+            Arena_Free(anim->frames);
             anim->frames = new_bone_frames;
             anim->frames_count = new_frames_count;
         }
@@ -1544,8 +1541,8 @@ void TR_GenSkeletalModel(struct skeletal_model_s *model, size_t model_id, struct
     mesh_tree_tag_p tree_tag;
     animation_frame_p anim;
 
-    model->collision_map = (uint16_t*)malloc(model->mesh_count * sizeof(uint16_t));
-    model->mesh_tree = (mesh_tree_tag_p)calloc(model->mesh_count, sizeof(mesh_tree_tag_t));
+    model->collision_map = (uint16_t*)Arena_Alloc(ARENA_TAG_ANIMATIONS, model->mesh_count * sizeof(uint16_t));
+    model->mesh_tree = (mesh_tree_tag_p)Arena_Calloc(ARENA_TAG_ANIMATIONS, model->mesh_count, sizeof(mesh_tree_tag_t));
     tree_tag = model->mesh_tree;
 
     uint32_t *mesh_index = tr->mesh_indices + tr_moveable->starting_mesh;
@@ -1577,10 +1574,10 @@ void TR_GenSkeletalModel(struct skeletal_model_s *model, size_t model_id, struct
          * model has no start offset and any animation
          */
         model->animation_count = 1;
-        model->animations = (animation_frame_p)malloc(sizeof(animation_frame_t));
+        model->animations = (animation_frame_p)Arena_Alloc(ARENA_TAG_ANIMATIONS, sizeof(animation_frame_t));
         model->animations->frames_count = 1;
         model->animations->max_frame = 1;
-        model->animations->frames = (bone_frame_p)calloc(model->animations->frames_count , sizeof(bone_frame_t));
+        model->animations->frames = (bone_frame_p)Arena_Calloc(ARENA_TAG_ANIMATIONS, model->animations->frames_count, sizeof(bone_frame_t));
         bone_frame = model->animations->frames;
 
         model->animations->id = 0;
@@ -1591,7 +1588,7 @@ void TR_GenSkeletalModel(struct skeletal_model_s *model, size_t model_id, struct
         model->animations->commands = NULL;
         model->animations->effects = NULL;
         bone_frame->bone_tag_count = model->mesh_count;
-        bone_frame->bone_tags = (bone_tag_p)malloc(bone_frame->bone_tag_count * sizeof(bone_tag_t));
+        bone_frame->bone_tags = (bone_tag_p)Arena_Alloc(ARENA_TAG_ANIMATIONS, bone_frame->bone_tag_count * sizeof(bone_tag_t));
         vec3_set_zero(bone_frame->pos);
 
         rot[0] = 0.0f;
@@ -1616,7 +1613,7 @@ void TR_GenSkeletalModel(struct skeletal_model_s *model, size_t model_id, struct
         model->animation_count = 1;
     }
 
-    model->animations = (animation_frame_p)calloc(model->animation_count, sizeof(animation_frame_t));
+    model->animations = (animation_frame_p)Arena_Calloc(ARENA_TAG_ANIMATIONS, model->animation_count, sizeof(animation_frame_t));
     anim = model->animations;
     for(uint16_t i = 0; i < model->animation_count; i++, anim++)
     {
@@ -1691,7 +1688,8 @@ void TR_GenSkeletalModel(struct skeletal_model_s *model, size_t model_id, struct
              */
             anim->frames_count = 1;
         }
-        anim->frames = (bone_frame_p)calloc(anim->frames_count, sizeof(bone_frame_t));
+        anim->frames = (bone_frame_p)Arena_Calloc(ARENA_TAG_ANIMATIONS, anim->frames_count, sizeof(bone_frame_t));
+        bone_tag_p frames_bone_tags = (bone_tag_p)Arena_Alloc(ARENA_TAG_ANIMATIONS, anim->frames_count * model->mesh_count * sizeof(bone_tag_t));
 
         /*
          * let us begin to load animations
@@ -1701,7 +1699,7 @@ void TR_GenSkeletalModel(struct skeletal_model_s *model, size_t model_id, struct
         for(uint16_t frame_index = 0; frame_index < anim->frames_count; frame_index++, bone_frame++)
         {
             bone_frame->bone_tag_count = model->mesh_count;
-            bone_frame->bone_tags = (bone_tag_p)malloc(model->mesh_count * sizeof(bone_tag_t));
+            bone_frame->bone_tags = frames_bone_tags + frame_index * model->mesh_count;
             tr->get_anim_frame_data(min_max_pos, rotations, bone_frame->bone_tag_count, tr_animation, frame_index);
 
             bone_frame->bb_min[0] = min_max_pos[0].x;
@@ -1781,7 +1779,7 @@ void TR_GenSkeletalModel(struct skeletal_model_s *model, size_t model_id, struct
             Sys_DebugLog(LOG_FILENAME, "ANIM[%d], next_anim = %d, next_frame = %d", i, (anim->next_anim) ? (anim->next_anim->id) : (-1), anim->next_frame);
 #endif
             anim->state_change_count = tr_animation->num_state_changes;
-            sch_p = anim->state_change = (state_change_p)malloc(tr_animation->num_state_changes * sizeof(state_change_t));
+            sch_p = anim->state_change = (state_change_p)Arena_Alloc(ARENA_TAG_ANIMATIONS, tr_animation->num_state_changes * sizeof(state_change_t));
 
             for(uint16_t j = 0;j < tr_animation->num_state_changes; j++, sch_p++)
             {
@@ -1797,10 +1795,14 @@ void TR_GenSkeletalModel(struct skeletal_model_s *model, size_t model_id, struct
                     uint16_t next_anim_ind = next_anim - (tr_moveable->animation_index & 0x7fff);
                     if(next_anim_ind < model->animation_count)
                     {
-                        sch_p->anim_dispatch_count++;
-                        sch_p->anim_dispatch = (anim_dispatch_p)realloc(sch_p->anim_dispatch, sch_p->anim_dispatch_count * sizeof(anim_dispatch_t));
-
-                        anim_dispatch_p adsp = sch_p->anim_dispatch + sch_p->anim_dispatch_count - 1;
+                        anim_dispatch_p adsp = (anim_dispatch_p)Arena_Realloc(ARENA_TAG_ANIMATIONS, sch_p->anim_dispatch, sch_p->anim_dispatch_count * sizeof(anim_dispatch_t),
+                                                                             (sch_p->anim_dispatch_count + 1) * sizeof(anim_dispatch_t));
+                        if(!adsp)
+                        {
+                            continue;
+                        }
+                        sch_p->anim_dispatch = adsp;
+                        adsp += sch_p->anim_dispatch_count++;
                         uint16_t next_max_frame = model->animations[next_anim - tr_moveable->animation_index].max_frame;
                         uint16_t next_frame = tr_adisp->next_frame - tr->animations[next_anim].frame_start;
 
@@ -3,6 +3,7 @@
 #include <stdlib.h>
 #include <SDL2/SDL.h>
 
+#include "core/arena.h"
 #include "core/gl_util.h"
 #include "core/console.h"
 #include "core/vmath.h"
@@ -21,6 +22,8 @@
 
 #define ROOM_LIST_SIZE_ALIGN    (8)
 
+static uint32_t room_content_swaps_count = 0;   // used for invalidation of cached sectors links
+
 
 void Room_Clear(struct room_s *room)
 {
@@ -43,7 +46,7 @@ void Room_Clear(struct room_s *room)
             {
                 Portal_Clear(p);
             }
-            free(content->portals);
+            Arena_Free(content->portals);
             content->portals = NULL;
             content->portals_count = 0;
         }
@@ -51,7 +54,7 @@ void Room_Clear(struct room_s *room)
         if(content->mesh)
         {
             BaseMesh_Clear(content->mesh);
-            free(content->mesh);
+            Arena_Free(content->mesh);
             content->mesh = NULL;
         }
 
@@ -71,7 +74,7 @@ void Room_Clear(struct room_s *room)
                     content->static_mesh[i].self = NULL;
                 }
             }
-            free(content->static_mesh);
+            Arena_Free(content->static_mesh);
             content->static_mesh = NULL;
             content->static_mesh_count = 0;
         }
@@ -83,20 +86,20 @@ void Room_Clear(struct room_s *room)
 
         if(content->sprites_count)
         {
-            free(content->sprites);
+            Arena_Free(content->sprites);
             content->sprites = NULL;
             content->sprites_count = 0;
         }
 
         if(content->sprites_vertices)
         {
-            free(content->sprites_vertices);
+            Arena_Free(content->sprites_vertices);
             content->sprites_vertices = NULL;
         }
 
         if(content->lights_count)
         {
-            free(content->lights);
+            Arena_Free(content->lights);
             content->lights = NULL;
             content->lights_count = 0;
         }
@@ -108,18 +111,11 @@ void Room_Clear(struct room_s *room)
             {
                 if(s->trigger)
                 {
-                    for(trigger_command_p current_command = s->trigger->commands; current_command; )
-                    {
-                        trigger_command_p next_command = current_command->next;
-                        current_command->next = NULL;
-                        free(current_command);
-                        current_command = next_command;
-                    }
-                    free(s->trigger);
+                    Trigger_Delete(s->trigger);
                     s->trigger = NULL;
                 }
             }
-            free(content->sectors);
+            Arena_Free(content->sectors);
             content->sectors = NULL;
             room->sectors_count = 0;
             room->sectors_x = 0;
@@ -140,7 +136,7 @@ void Room_Clear(struct room_s *room)
             content->near_room_list = NULL;
         }
 
-        free(content);
+        Arena_Free(content);
     }
     room->original_content = NULL;
 
@@ -161,24 +157,7 @@ void Room_Clear(struct room_s *room)
 
 void Room_Enable(struct room_s *room)
 {
-    if(room->content->physics_body != NULL)
-    {
-        Physics_EnableObject(room->content->physics_body);
-    }
-
-    if(room->content->physics_alt_tween)
-    {
-        Physics_DisableObject(room->content->physics_alt_tween);
-    }
-
-    for(uint32_t i = 0; i < room->content->static_mesh_count; i++)
-    {
-        if(room->content->static_mesh[i].physics_body != NULL)
-        {
-            Physics_EnableObject(room->content->static_mesh[i].physics_body);
-        }
-    }
-
+    Room_EnableStaticCollision(room);
     for(engine_container_p cont = room->containers; cont; cont = cont->next)
     {
         if(cont->collision_group == COLLISION_NONE)
@@ -200,34 +179,69 @@ void Room_Enable(struct room_s *room)
 
 void Room_Disable(struct room_s *room)
 {
+    Room_DisableStaticCollision(room);
+    for(engine_container_p cont = room->containers; cont; cont = cont->next)
+    {
+        switch(cont->object_type)
+        {
+            case OBJECT_ENTITY:
+                if(((entity_p)cont->object)->state_flags & ENTITY_STATE_ENABLED)
+                {
+                    Physics_DisableCollision(((entity_p)cont->object)->physics);
+                }
+                break;
+        }
+    }
+}
+
+
+/*
+ * Static collision switching: unlike Room_Enable / Room_Disable it touches only
+ * room geometry and static meshes bodies, entities in room are not affected.
+ * Dynamic tween follows the room (as after World_UpdateFlipCollisions()); a
+ * stale one of swapped content is replaced there.
+ */
+void Room_EnableStaticCollision(struct room_s *room)
+{
+    room->is_collision_active = 0x01;
     if(room->content->physics_body)
     {
-        Physics_DisableObject(room->content->physics_body);
+        Physics_EnableObject(room->content->physics_body);
     }
 
     if(room->content->physics_alt_tween)
     {
-        Physics_DisableObject(room->content->physics_alt_tween);
+        Physics_EnableObject(room->content->physics_alt_tween);
     }
 
     for(uint32_t i = 0; i < room->content->static_mesh_count; i++)
     {
         if(room->content->static_mesh[i].physics_body)
         {
-            Physics_DisableObject(room->content->static_mesh[i].physics_body);
+            Physics_EnableObject(room->content->static_mesh[i].physics_body);
         }
     }
+}
 
-    for(engine_container_p cont = room->containers; cont; cont = cont->next)
+
+void Room_DisableStaticCollision(struct room_s *room)
+{
+    room->is_collision_active = 0x00;
+    if(room->content->physics_body)
     {
-        switch(cont->object_type)
+        Physics_DisableObject(room->content->physics_body);
+    }
+
+    if(room->content->physics_alt_tween)
+    {
+        Physics_DisableObject(room->content->physics_alt_tween);
+    }
+
+    for(uint32_t i = 0; i < room->content->static_mesh_count; i++)
+    {
+        if(room->content->static_mesh[i].physics_body)
         {
-            case OBJECT_ENTITY:
-                if(((entity_p)cont->object)->state_flags & ENTITY_STATE_ENABLED)
-                {
-                    Physics_DisableCollision(((entity_p)cont->object)->physics);
-                }
-                break;
+            Physics_DisableObject(room->content->static_mesh[i].physics_body);
         }
     }
 }
@@ -292,6 +306,7 @@ void Room_SetActiveContent(struct room_s *room, struct room_s *room_with_content
     engine_container_p cont = room->containers;
     room->containers = NULL;
     room->content = room_with_content_from->original_content;
+    room_content_swaps_count++;
     Physics_SetOwnerObject(room->content->physics_body, room->self);
     Physics_SetOwnerObject(room->content->physics_alt_tween, room->self);
 
@@ -330,6 +345,7 @@ void Room_DoFlip(struct room_s *room1, struct room_s *room2)
             room_content_p t = room1->content;
             room1->content = room2->content;
             room2->content = t;
+            room_content_swaps_count++;
 
             // fix physics
             Physics_SetOwnerObject(room1->content->physics_body, room1->self);
@@ -612,31 +628,38 @@ void Room_MoveActiveItems(struct room_s *room_to, struct room_s *room_from)
 }
 
 
+/**
+ * Sprite quads are static: position is sprite centre, normal xy is corner
+ * offset along camera right vector and world z, shader builds billboard.
+ */
 void Room_GenSpritesBuffer(struct room_s *room)
 {
     room->content->sprites_vertices = NULL;
 
     if(room->content->sprites_count > 0)
     {
-        room->content->sprites_vertices = (vertex_p)malloc(room->content->sprites_count * 4 * sizeof(vertex_t));
+        room->content->sprites_vertices = (vertex_p)Arena_Calloc(ARENA_TAG_ROOMS, room->content->sprites_count * 4, sizeof(vertex_t));
         for(uint32_t i = 0; i < room->content->sprites_count; i++)
         {
             room_sprite_p s = room->content->sprites + i;
             if(s->sprite)
             {
                 vertex_p v = room->content->sprites_vertices + i * 4;
-                vec4_set_one(v[0].color);
-                vec4_set_one(v[1].color);
-                vec4_set_one(v[2].color);
-                vec4_set_one(v[3].color);
-                v[0].tex_coord[0] = s->sprite->tex_coord[0];
-                v[0].tex_coord[1] = s->sprite->tex_coord[1];
-                v[1].tex_coord[0] = s->sprite->tex_coord[2];
-                v[1].tex_coord[1] = s->sprite->tex_coord[3];
-                v[2].tex_coord[0] = s->sprite->tex_coord[4];
-                v[2].tex_coord[1] = s->sprite->tex_coord[5];
-                v[3].tex_coord[0] = s->sprite->tex_coord[6];
-                v[3].tex_coord[1] = s->sprite->tex_coord[7];
+                for(int j = 0; j < 4; j++)
+                {
+                    vec3_copy(v[j].position, s->pos);
+                    vec4_set_one(v[j].color);
+                    v[j].tex_coord[0] = s->sprite->tex_coord[2 * j + 0];
+                    v[j].tex_coord[1] = s->sprite->tex_coord[2 * j + 1];
+                }
+                v[0].normal[0] = s->sprite->right;
+                v[0].normal[1] = s->sprite->top;
+                v[1].normal[0] = s->sprite->left;
+                v[1].normal[1] = s->sprite->top;
+                v[2].normal[0] = s->sprite->left;
+                v[2].normal[1] = s->sprite->bottom;
+                v[3].normal[0] = s->sprite->right;
+                v[3].normal[1] = s->sprite->bottom;
             }
         }
     }
@@ -684,6 +707,12 @@ struct room_sector_s *Sector_GetPortalSectorTargetRaw(struct room_sector_s *rs)
 }
 
 
+uint32_t Room_GetContentSwapsCount()
+{
+    return room_content_swaps_count;
+}
+
+
 struct room_sector_s *Sector_GetLowest(struct room_sector_s *sector)
 {
     for(; sector && sector->room_below; sector = Room_GetSectorRaw(sector->room_below->real_room, sector->pos));
@@ -10,6 +10,12 @@
 
 #define TR_MESH_ROOM_COLLISION 0
 
+// Collision LOD: rooms static collision (room geometry and static meshes) is
+// kept in physics world only within this number of near rooms hops from any
+// active entity (or camera). Negative value keeps all rooms collision enabled.
+
+#define ROOM_COLLISION_LOD_DEPTH    (2)
+
 // Metering step and sector size are basic Tomb Raider world metrics.
 // Use these defines at all times, when you're referencing classic TR
 // dimensions and terrain manipulations.
@@ -270,6 +276,7 @@ typedef struct room_s
     uint32_t                    id;                                             // room's ID
     uint32_t                    is_in_r_list : 1;                               // is room in render list
     uint32_t                    is_swapped : 1;
+    uint32_t                    is_collision_active : 1;                        // is room static collision in physics world
     struct room_s              *alternate_room_next;                            // alternative room pointer
     struct room_s              *alternate_room_prev;                            // alternative room pointer
     struct room_s              *real_room;                                      // real room, using in game
@@ -293,11 +300,14 @@ typedef struct room_s
 void Room_Clear(struct room_s *room);
 void Room_Enable(struct room_s *room);
 void Room_Disable(struct room_s *room);
+void Room_EnableStaticCollision(struct room_s *room);
+void Room_DisableStaticCollision(struct room_s *room);
 int  Room_AddObject(struct room_s *room, struct engine_container_s *cont);
 int  Room_RemoveObject(struct room_s *room, struct engine_container_s *cont);
 
 void Room_SetActiveContent(struct room_s *room, struct room_s *room_with_content_from);
 void Room_DoFlip(struct room_s *room1, struct room_s *room2);
+uint32_t Room_GetContentSwapsCount();
 
 struct room_sector_s *Room_GetSectorRaw(struct room_s *room, float pos[3]);
 struct room_sector_s *Room_GetSectorXYZ(struct room_s *room, float pos[3]);
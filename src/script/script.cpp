@@ -16,6 +16,7 @@ extern "C" {
 #include "../core/vmath.h"
 #include "../render/camera.h"
 #include "../render/render.h"
+#include "../render/rect_packer.h"
 #include "../state_control/state_control.h"
 #include "../vt/tr_versions.h"
 #include "../skeletal_model.h"
@@ -206,36 +207,6 @@ int Script_UseItem(lua_State *lua, int item_id, int activator_id)
 }
 
 
-int Script_DoTasks(lua_State *lua, float time)
-{
-    lua_pushnumber(lua, time);
-    lua_setglobal(lua, "frame_time");
-
-    Script_CallVoidFunc(lua, "doTasks");
-    Script_CallVoidFunc(lua, "clearKeys");
-
-    return 0;
-}
-
-void Script_AddKey(lua_State *lua, int keycode, int state)
-{
-    int top = lua_gettop(lua);
-
-    lua_getglobal(lua, "addKey");
-
-    if(!lua_isfunction(lua, -1))
-    {
-        lua_settop(lua, top);
-        return;
-    }
-
-    lua_pushinteger(lua, keycode);
-    lua_pushinteger(lua, state);
-    lua_CallAndLog(lua, 2, 0, 0);
-
-    lua_settop(lua, top);
-}
-
 bool Script_CallVoidFunc(lua_State *lua, const char* func_name, bool destroy_after_call)
 {
     int top = lua_gettop(lua);
@@ -445,6 +416,24 @@ int Script_ParseRender(lua_State *lua, struct render_settings_s *rs)
         rs->fog_end_depth = lua_tonumber(lua, -1);
         lua_pop(lua, 1);
 
+        lua_getfield(lua, -1, "transparency_mode");
+        rs->transparency_mode = lua_tonumber(lua, -1);
+        lua_pop(lua, 1);
+
+        lua_getfield(lua, -1, "atlas_packer");
+        if(lua_isnumber(lua, -1))
+        {
+            rs->atlas_packer = lua_tonumber(lua, -1);
+        }
+        lua_pop(lua, 1);
+
+        lua_getfield(lua, -1, "skinning");
+        if(lua_isnumber(lua, -1))
+        {
+            rs->skinning = (lua_tonumber(lua, -1) != 0) ? (1) : (0);
+        }
+        lua_pop(lua, 1);
+
 
         lua_getfield(lua, -1, "fog_color");
         if(lua_istable(lua, -1))
@@ -469,6 +458,16 @@ int Script_ParseRender(lua_State *lua, struct render_settings_s *rs)
             rs->z_depth = 24;
         }
 
+        if(rs->transparency_mode != R_TRANSPARENCY_SORTED)
+        {
+            rs->transparency_mode = R_TRANSPARENCY_BSP;
+        }
+
+        if((rs->atlas_packer < 0) || (rs->atlas_packer >= RECT_PACKER_TYPES_COUNT))
+        {
+            rs->atlas_packer = RECT_PACKER_MAXRECTS;
+        }
+
         lua_settop(lua, top);
         return 1;
     }
@@ -1117,7 +1116,7 @@ void Script_LuaClearTasks()
     {
         int top = lua_gettop(engine_lua);
 
-        Script_CallVoidFunc(engine_lua, "clearTasks");
+        Script_ClearTasks(engine_lua);
 
         lua_getglobal(engine_lua, "tlist_Clear");
         if(lua_isfunction(engine_lua, -1))
@@ -1141,6 +1140,7 @@ void Script_LuaRegisterEntityFuncs(lua_State *lua);
 void Script_LuaRegisterCharacterFuncs(lua_State *lua);
 void Script_LuaRegisterWorldFuncs(lua_State *lua);
 void Script_LuaRegisterAudioFuncs(lua_State *lua);
+void Script_LuaRegisterTaskFuncs(lua_State *lua);
 
 
 void Script_LuaRegisterFuncs(lua_State *lua)
@@ -1166,4 +1166,5 @@ void Script_LuaRegisterFuncs(lua_State *lua)
     Script_LuaRegisterCharacterFuncs(lua);
     Script_LuaRegisterWorldFuncs(lua);
     Script_LuaRegisterAudioFuncs(lua);
+    Script_LuaRegisterTaskFuncs(lua);
 }
@@ -59,6 +59,9 @@ size_t Script_GetEntitySaveData(lua_State *lua, int id_entity, char *buf, size_t
 void Script_DoFlipEffect(lua_State *lua, int id_effect, int id_object, int param);
 size_t Script_GetFlipEffectsSaveData(lua_State *lua, char *buf, size_t buf_size);
 int  Script_DoTasks(lua_State *lua, float time);
+void Script_RunTasks(lua_State *lua, float time);
+void Script_ClearTasks(lua_State *lua);
+void Script_GetTasksCount(unsigned int *active, unsigned int *sleeping);
 bool Script_CallVoidFunc(lua_State *lua, const char* func_name, bool destroy_after_call = false);
 
 void Script_AddKey(lua_State *lua, int keycode, int state);
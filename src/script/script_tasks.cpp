@@ -0,0 +1,370 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern "C" {
+#include <lua.h>
+#include <lualib.h>
+#include <lauxlib.h>
+}
+
+#include "script.h"
+
+#include "../core/console.h"
+
+
+/*
+ * Script tasks scheduler. Every task is a function, run in its own
+ * coroutine; task result (or yield argument) tells what to do next:
+ *   false / nil      - task is done;
+ *   true / no value  - run it again next frame (yield resumes, return restarts);
+ *   number           - sleep for that many seconds.
+ * Active tasks are run every frame, sleeping ones wait in a heap ordered by
+ * wake up time and cost nothing until then. Done tasks are swap-removed.
+ */
+#define SCRIPT_TASK_DONE            (0)
+#define SCRIPT_TASK_ACTIVE          (1)
+#define SCRIPT_TASK_SLEEP           (2)
+
+#define SCRIPT_TASKS_CAPACITY_STEP  (64)
+#define SCRIPT_KEYS_MAX             (64)                                        // keys events of one frame
+
+typedef struct script_task_s
+{
+    int                     func_ref;                                           // LUA_REGISTRYINDEX refs
+    int                     thread_ref;
+    lua_State              *thread;
+    double                  wake_time;                                          // tasks time to wake up at, sleep is counted from it
+}script_task_t, *script_task_p;
+
+typedef struct script_tasks_list_s
+{
+    script_task_p           tasks;
+    uint32_t                count;
+    uint32_t                size;
+}script_tasks_list_t, *script_tasks_list_p;
+
+typedef struct script_key_s
+{
+    int32_t                 code;
+    int32_t                 first;                                              // pressed in this frame, not repeated
+}script_key_t, *script_key_p;
+
+static script_tasks_list_t  tasks_active = {NULL, 0, 0};
+static script_tasks_list_t  tasks_sleeping = {NULL, 0, 0};                      // binary min heap by wake_time
+static double               tasks_time = 0.0;
+static uint32_t             tasks_generation = 0;                               // changed by clear, stops current run
+static script_key_t         script_keys[SCRIPT_KEYS_MAX];
+static uint32_t             script_keys_count = 0;
+
+
+static script_task_p Script_TasksPush(script_tasks_list_p list, const script_task_t *task)
+{
+    if(list->count >= list->size)
+    {
+        list->size += SCRIPT_TASKS_CAPACITY_STEP;
+        list->tasks = (script_task_p)realloc(list->tasks, list->size * sizeof(script_task_t));
+    }
+    list->tasks[list->count] = *task;
+    return list->tasks + list->count++;
+}
+
+
+static void Script_TasksSleep(const script_task_t *task)
+{
+    script_task_p heap;
+    uint32_t i;
+
+    Script_TasksPush(&tasks_sleeping, task);
+    heap = tasks_sleeping.tasks;
+    for(i = tasks_sleeping.count - 1; (i > 0) && (heap[(i - 1) / 2].wake_time > task->wake_time); i = (i - 1) / 2)
+    {
+        heap[i] = heap[(i - 1) / 2];
+    }
+    heap[i] = *task;
+}
+
+
+static void Script_TasksWakeUp(script_task_p task)
+{
+    script_task_p heap = tasks_sleeping.tasks;
+    script_task_t last = heap[--tasks_sleeping.count];
+    uint32_t i = 0;
+
+    *task = heap[0];
+    for(uint32_t child = 1; child < tasks_sleeping.count; child = 2 * i + 1)
+    {
+        if((child + 1 < tasks_sleeping.count) && (heap[child + 1].wake_time < heap[child].wake_time))
+        {
+            child++;
+        }
+        if(heap[child].wake_time >= last.wake_time)
+        {
+            break;
+        }
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = last;
+}
+
+
+static void Script_TasksRelease(lua_State *lua, script_task_p task)
+{
+    luaL_unref(lua, LUA_REGISTRYINDEX, task->func_ref);
+    luaL_unref(lua, LUA_REGISTRYINDEX, task->thread_ref);
+    task->func_ref = LUA_NOREF;
+    task->thread_ref = LUA_NOREF;
+    task->thread = NULL;
+}
+
+/**
+ * Resumes suspended task coroutine or starts task function again in it
+ * (finished coroutine with empty stack can be resumed from C).
+ */
+static int Script_TasksResume(lua_State *lua, script_task_p task)
+{
+    lua_State *co = task->thread;
+    int top = lua_gettop(lua);
+    int ret = SCRIPT_TASK_DONE;
+    int status;
+
+    lua_rawgeti(lua, LUA_REGISTRYINDEX, task->thread_ref);                      // coroutine stays reachable, even if tasks are cleared
+    if(lua_status(co) != LUA_YIELD)
+    {
+        lua_settop(co, 0);
+        lua_rawgeti(co, LUA_REGISTRYINDEX, task->func_ref);
+    }
+
+    status = lua_resume(co, lua, 0);
+    if((status == LUA_OK) || (status == LUA_YIELD))
+    {
+        if((lua_gettop(co) > 0) && (lua_type(co, -1) == LUA_TNUMBER))
+        {
+            double wait = lua_tonumber(co, -1);
+            if(wait > 0.0)
+            {
+                task->wake_time += wait;                                        // periodic tasks do not drift
+                ret = SCRIPT_TASK_SLEEP;
+            }
+            else
+            {
+                task->wake_time = tasks_time;
+                ret = SCRIPT_TASK_ACTIVE;
+            }
+        }
+        else if(((status == LUA_YIELD) && (lua_gettop(co) == 0)) || ((lua_gettop(co) > 0) && lua_toboolean(co, -1)))
+        {
+            task->wake_time = tasks_time;
+            ret = SCRIPT_TASK_ACTIVE;
+        }
+        lua_settop(co, 0);
+    }
+    else
+    {
+        Con_Warning("Lua task error: %s", (lua_isstring(co, -1)) ? (lua_tostring(co, -1)) : ("no message"));
+    }
+
+    lua_settop(lua, top);
+    return ret;
+}
+
+
+void Script_RunTasks(lua_State *lua, float time)
+{
+    uint32_t generation = tasks_generation;
+    uint32_t run_count;
+
+    tasks_time += time;
+    while((tasks_sleeping.count > 0) && (tasks_sleeping.tasks[0].wake_time <= tasks_time))
+    {
+        script_task_t task;
+        Script_TasksWakeUp(&task);
+        Script_TasksPush(&tasks_active, &task);
+    }
+
+    // tasks, added while running, wait for the next frame; array may be reallocated by addTask
+    run_count = tasks_active.count;
+    for(uint32_t i = 0; i < run_count;)
+    {
+        script_task_t task = tasks_active.tasks[i];
+        int state = Script_TasksResume(lua, &task);
+        if(generation != tasks_generation)
+        {
+            return;                                                             // tasks were cleared by script
+        }
+
+        if(state == SCRIPT_TASK_ACTIVE)
+        {
+            tasks_active.tasks[i++] = task;
+            continue;
+        }
+
+        tasks_active.tasks[i] = tasks_active.tasks[--tasks_active.count];
+        if(tasks_active.count < run_count)
+        {
+            run_count = tasks_active.count;
+        }
+        else
+        {
+            i++;                                                                // new task came to i, it waits for the next frame
+        }
+
+        if(state == SCRIPT_TASK_SLEEP)
+        {
+            Script_TasksSleep(&task);
+        }
+        else
+        {
+            Script_TasksRelease(lua, &task);
+        }
+    }
+}
+
+
+void Script_ClearTasks(lua_State *lua)
+{
+    for(uint32_t i = 0; i < tasks_active.count; i++)
+    {
+        Script_TasksRelease(lua, tasks_active.tasks + i);
+    }
+    for(uint32_t i = 0; i < tasks_sleeping.count; i++)
+    {
+        Script_TasksRelease(lua, tasks_sleeping.tasks + i);
+    }
+    tasks_active.count = 0;
+    tasks_sleeping.count = 0;
+    tasks_time = 0.0;
+    tasks_generation++;
+}
+
+
+void Script_GetTasksCount(unsigned int *active, unsigned int *sleeping)
+{
+    *active = tasks_active.count;
+    *sleeping = tasks_sleeping.count;
+}
+
+
+int Script_DoTasks(lua_State *lua, float time)
+{
+    lua_pushnumber(lua, time);
+    lua_setglobal(lua, "frame_time");
+
+    Script_RunTasks(lua, time);
+    script_keys_count = 0;
+
+    return 0;
+}
+
+/*
+ * Debug keyboard input for scripts: keys events of the current frame.
+ */
+void Script_AddKey(lua_State *lua, int keycode, int state)
+{
+    uint32_t i = 0;
+    (void)lua;
+
+    for(; (i < script_keys_count) && (script_keys[i].code != keycode); i++);
+    if(state >= 1)
+    {
+        if(i < script_keys_count)
+        {
+            script_keys[i].first = 0;
+        }
+        else if(script_keys_count < SCRIPT_KEYS_MAX)
+        {
+            script_keys[script_keys_count].code = keycode;
+            script_keys[script_keys_count].first = 1;
+            script_keys_count++;
+        }
+    }
+    else if(i < script_keys_count)
+    {
+        script_keys[i] = script_keys[--script_keys_count];
+    }
+}
+
+
+int lua_AddTask(lua_State *lua)
+{
+    script_task_t task;
+
+    luaL_checktype(lua, 1, LUA_TFUNCTION);
+    task.wake_time = tasks_time + luaL_optnumber(lua, 2, 0.0);
+
+    lua_pushvalue(lua, 1);
+    task.func_ref = luaL_ref(lua, LUA_REGISTRYINDEX);
+    task.thread = lua_newthread(lua);
+    task.thread_ref = luaL_ref(lua, LUA_REGISTRYINDEX);
+
+    if(task.wake_time > tasks_time)
+    {
+        Script_TasksSleep(&task);
+    }
+    else
+    {
+        Script_TasksPush(&tasks_active, &task);
+    }
+
+    return 0;
+}
+
+
+int lua_ClearTasks(lua_State *lua)
+{
+    Script_ClearTasks(lua);
+    return 0;
+}
+
+
+int lua_GetTasksCount(lua_State *lua)
+{
+    lua_pushinteger(lua, tasks_active.count + tasks_sleeping.count);
+    return 1;
+}
+
+
+int lua_AddKey(lua_State *lua)
+{
+    Script_AddKey(lua, luaL_checkinteger(lua, 1), luaL_checkinteger(lua, 2));
+    return 0;
+}
+
+
+int lua_CheckKey(lua_State *lua)
+{
+    int32_t code = luaL_checkinteger(lua, 1);
+    uint32_t i = 0;
+
+    for(; (i < script_keys_count) && (script_keys[i].code != code); i++);
+    if(i < script_keys_count)
+    {
+        lua_pushboolean(lua, (lua_toboolean(lua, 2)) ? (script_keys[i].first) : (1));
+    }
+    else
+    {
+        lua_pushboolean(lua, 0);
+    }
+
+    return 1;
+}
+
+
+int lua_ClearKeys(lua_State *lua)
+{
+    (void)lua;
+    script_keys_count = 0;
+    return 0;
+}
+
+
+void Script_LuaRegisterTaskFuncs(lua_State *lua)
+{
+    lua_register(lua, "addTask", lua_AddTask);
+    lua_register(lua, "clearTasks", lua_ClearTasks);
+    lua_register(lua, "getTasksCount", lua_GetTasksCount);
+    lua_register(lua, "addKey", lua_AddKey);
+    lua_register(lua, "checkKey", lua_CheckKey);
+    lua_register(lua, "clearKeys", lua_ClearKeys);
+}
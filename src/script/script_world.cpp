@@ -324,14 +324,7 @@ int lua_SectorTriggerClear(lua_State * lua)
         {
             if(rs->trigger)
             {
-                for(trigger_command_p current_command = rs->trigger->commands; current_command; )
-                {
-                    trigger_command_p next_command = current_command->next;
-                    current_command->next = NULL;
-                    free(current_command);
-                    current_command = next_command;
-                }
-                free(rs->trigger);
+                Trigger_Delete(rs->trigger);
                 rs->trigger = NULL;
             }
         }
@@ -360,13 +353,7 @@ int lua_SectorAddTrigger(lua_State * lua)
 
         if(rs && !rs->trigger)
         {
-            rs->trigger = (trigger_header_p)malloc(sizeof(trigger_header_t));
-            rs->trigger->commands = NULL;
-            rs->trigger->function_value = lua_tointeger(lua, 4);
-            rs->trigger->sub_function = lua_tointeger(lua, 5);
-            rs->trigger->mask = lua_tointeger(lua, 6);
-            rs->trigger->once = lua_tointeger(lua, 7);
-            rs->trigger->timer = lua_tointeger(lua, 8);
+            rs->trigger = Trigger_Create(lua_tointeger(lua, 4), lua_tointeger(lua, 5), lua_tointeger(lua, 6), lua_tointeger(lua, 7), lua_tointeger(lua, 8));
         }
         else
         {
@@ -394,28 +381,15 @@ int lua_SectorAddTriggerCommand(lua_State * lua)
         room_sector_p rs = World_GetRoomSector(id, sx, sy);
         if(rs && rs->trigger)
         {
-            trigger_command_p cmd = (trigger_command_p)malloc(sizeof(trigger_command_t));
+            trigger_command_p cmd = Trigger_AddCommand(rs->trigger, lua_tointeger(lua, 4), lua_tointeger(lua, 5));
 
-            cmd->next = NULL;
-            cmd->function = lua_tointeger(lua, 4);
-            cmd->operands = lua_tointeger(lua, 5);
             cmd->once = lua_tointeger(lua, 6);
-            cmd->camera.index = 0;
-            cmd->camera.move = 0;
-            cmd->camera.timer = 0;
-            cmd->camera.unused = 0;
-
             if(top >= 9)
             {
                 cmd->camera.index = lua_tointeger(lua, 7);
                 cmd->camera.move =  lua_tointeger(lua, 8);
                 cmd->camera.timer = lua_tointeger(lua, 9);
-                cmd->camera.unused = 0;
             }
-
-            trigger_command_p *last = &rs->trigger->commands;
-            for(; *last; last = &(*last)->next);
-            *last = cmd;
         }
         else
         {
@@ -752,6 +726,23 @@ int lua_LoadMap(lua_State *lua)
 }
 
 
+int lua_SetLevelPreload(lua_State *lua)
+{
+    int top = lua_gettop(lua);
+    if(top >= 1)
+    {
+        uint32_t limit = (top >= 2) ? (1024 * 1024 * lua_tointeger(lua, 2)) : (WORLD_PRELOAD_DEFAULT_MEMORY_LIMIT);
+        World_SetPreloadParams(lua_tointeger(lua, 1), limit);
+    }
+    else
+    {
+        Con_Warning("setLevelPreload: expecting arguments (enabled, (memory_limit_mb))");
+    }
+
+    return 0;
+}
+
+
 int lua_SetPlayer(lua_State *lua)
 {
     if(lua_gettop(lua) >= 1)
@@ -1203,6 +1194,7 @@ void Script_LuaRegisterWorldFuncs(lua_State *lua)
 
     lua_register(lua, "setGame", lua_SetGame);
     lua_register(lua, "loadMap", lua_LoadMap);
+    lua_register(lua, "setLevelPreload", lua_SetLevelPreload);
 
     lua_register(lua, "setPlayer", lua_SetPlayer);
     lua_register(lua, "setFlipMap", lua_SetFlipMap);
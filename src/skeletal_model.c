@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <memory.h>
 
+#include "core/arena.h"
 #include "core/system.h"
 #include "core/gl_util.h"
 #include "core/vmath.h"
@@ -22,13 +23,13 @@ void SkeletalModel_Clear(skeletal_model_p model)
         if(model->mesh_tree)
         {
             model->mesh_count = 0;
-            free(model->mesh_tree);
+            Arena_Free(model->mesh_tree);
             model->mesh_tree = NULL;
         }
 
         if(model->collision_map)
         {
-            free(model->collision_map);
+            Arena_Free(model->collision_map);
             model->collision_map = NULL;
         }
 
@@ -39,7 +40,7 @@ void SkeletalModel_Clear(skeletal_model_p model)
                 Anim_Clear(model->animations + i);
             }
             model->animation_count= 0;
-            free(model->animations);
+            Arena_Free(model->animations);
             model->animations = NULL;
         }
     }
@@ -180,7 +181,7 @@ void SkeletalModel_CopyAnims(skeletal_model_p dst, skeletal_model_p src)
     {
         Anim_Clear(dst->animations + i);
     }
-    free(dst->animations);
+    Arena_Free(dst->animations);
     dst->animations = new_anims;
     dst->animation_count = src->animation_count;
 }
@@ -213,6 +214,7 @@ void SSBoneFrame_CreateFromModel(ss_bone_frame_p bf, skeletal_model_p model)
     vec3_set_zero(bf->centre);
     vec3_set_zero(bf->pos);
     bf->transform = NULL;
+    bf->skin_batch = NULL;
     bf->flags = 0x0000;
     bf->bone_tag_count = 0;
     bf->bone_tags = NULL;
@@ -307,6 +309,12 @@ void SSBoneFrame_Clear(ss_bone_frame_p bf)
         bf->bone_tags = NULL;
     }
 
+    if(bf->skin_batch)
+    {
+        BaseMesh_DeleteBatch(bf->skin_batch);
+        bf->skin_batch = NULL;
+    }
+
     for(ss_animation_p ss_anim = bf->animations.next; ss_anim;)
     {
         ss_animation_p ss_anim_next = ss_anim->next;
@@ -445,6 +453,29 @@ void SSBoneFrame_RotateBone(struct ss_bone_frame_s *bf, const float q_rotate[4],
     }
 }
 
+/**
+ * Bone matrices palette for skinned batch: rows x, y, z of every bone
+ * full_transform (see BaseMesh_SkinPart); returns bones count in palette.
+ */
+uint16_t SSBoneFrame_FillBonePalette(struct ss_bone_frame_s *bf, float *palette, uint16_t max_bones)
+{
+    uint16_t count = (bf->bone_tag_count < max_bones) ? (bf->bone_tag_count) : (max_bones);
+    ss_bone_tag_p btag = bf->bone_tags;
+
+    for(uint16_t i = 0; i < count; i++, btag++)
+    {
+        for(int r = 0; r < MESH_SKIN_PALETTE_ROWS; r++, palette += 4)
+        {
+            palette[0] = btag->full_transform[0 + r];
+            palette[1] = btag->full_transform[4 + r];
+            palette[2] = btag->full_transform[8 + r];
+            palette[3] = btag->full_transform[12 + r];
+        }
+    }
+
+    return count;
+}
+
 
 int  SSBoneFrame_CheckTargetBoneLimit(struct ss_bone_frame_s *bf, struct ss_bone_tag_s *b_tag, float target[3])
 {
@@ -671,12 +702,12 @@ void Anim_Clear(struct animation_frame_s *anim)
         for(uint16_t j = 0; j < anim->state_change_count; j++)
         {
             anim->state_change[j].anim_dispatch_count = 0;
-            free(anim->state_change[j].anim_dispatch);
+            Arena_Free(anim->state_change[j].anim_dispatch);
             anim->state_change[j].anim_dispatch = NULL;
             anim->state_change[j].id = 0;
         }
         anim->state_change_count = 0;
-        free(anim->state_change);
+        Arena_Free(anim->state_change);
         anim->state_change = NULL;
     }
 
@@ -687,13 +718,13 @@ void Anim_Clear(struct animation_frame_s *anim)
             if(anim->frames[j].bone_tag_count)
             {
                 anim->frames[j].bone_tag_count = 0;
-                free(anim->frames[j].bone_tags);
+                Arena_Free(anim->frames[j].bone_tags);
                 anim->frames[j].bone_tags = NULL;
             }
         }
         anim->frames_count = 0;
         anim->max_frame = 0;
-        free(anim->frames);
+        Arena_Free(anim->frames);
         anim->frames = NULL;
     }
 
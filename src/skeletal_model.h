@@ -40,6 +40,7 @@ extern "C" {
 #include "core/base_types.h"
     
 struct base_mesh_s;
+struct mesh_batch_s;
 
 /*
  * Animated skeletal model. Taken from openraider.
@@ -122,6 +123,7 @@ typedef struct ss_bone_frame_s
     float                       bb_max[3];                                      // bounding box max coordinates
     float                       centre[3];                                      // bounding box centre
     struct engine_transform_s  *transform;
+    struct mesh_batch_s        *skin_batch;                                     // all bones meshes for palette skinning, made by renderer
 
     struct ss_animation_s       animations;                                     // animations list
 }ss_bone_frame_t, *ss_bone_frame_p;
@@ -258,6 +260,7 @@ void SSBoneFrame_Clear(ss_bone_frame_p bf);
 void SSBoneFrame_Copy(struct ss_bone_frame_s *dst, struct ss_bone_frame_s *src);
 void SSBoneFrame_Update(struct ss_bone_frame_s *bf, float time);
 void SSBoneFrame_RotateBone(struct ss_bone_frame_s *bf, const float q_rotate[4], int bone);
+uint16_t SSBoneFrame_FillBonePalette(struct ss_bone_frame_s *bf, float *palette, uint16_t max_bones);
 int  SSBoneFrame_CheckTargetBoneLimit(struct ss_bone_frame_s *bf, struct ss_bone_tag_s *b_tag, float target[3]);
 void SSBoneFrame_TargetBoneToSlerp(struct ss_bone_frame_s *bf, struct ss_bone_tag_s *b_tag, float time);
 void SSBoneFrame_SetTarget(struct ss_bone_tag_s *b_tag, const float target_pos[3], const float bone_dir[3]);
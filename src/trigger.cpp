@@ -75,6 +75,58 @@ inline void Entity_SetLayoutEvent(entity_p ent, uint16_t status)
 }
 
 
+trigger_header_p Trigger_Create(uint16_t function_value, uint16_t sub_function, uint16_t mask, uint16_t once, uint16_t timer)
+{
+    trigger_header_p ret = (trigger_header_p)malloc(sizeof(trigger_header_t));
+
+    ret->function_value = function_value;
+    ret->sub_function = sub_function;
+    ret->mask = mask;
+    ret->once = once;
+    ret->timer = timer;
+    ret->commands_count = 0;
+    ret->functions_mask = 0;
+    ret->commands = NULL;
+
+    return ret;
+}
+
+
+void Trigger_Delete(trigger_header_p trigger)
+{
+    if(trigger)
+    {
+        if(trigger->commands)
+        {
+            free(trigger->commands);
+            trigger->commands = NULL;
+        }
+        trigger->commands_count = 0;
+        free(trigger);
+    }
+}
+
+
+trigger_command_p Trigger_AddCommand(trigger_header_p trigger, uint16_t function, uint16_t operands)
+{
+    trigger_command_p ret;
+
+    trigger->commands = (trigger_command_p)realloc(trigger->commands, (trigger->commands_count + 1) * sizeof(trigger_command_t));
+    ret = trigger->commands + trigger->commands_count++;
+    ret->function = function;
+    ret->operands = operands;
+    ret->camera.index = 0;
+    ret->camera.timer = 0;
+    ret->camera.move = 0;
+    ret->camera.unused = 0;
+    ret->once = 0;
+    ret->unused = 0;
+    trigger->functions_mask |= (function < TRIGGER_FUNCTION_OTHER_BIT) ? (1 << function) : (1 << TRIGGER_FUNCTION_OTHER_BIT);
+
+    return ret;
+}
+
+
 void Trigger_DoCommands(trigger_header_p trigger, struct entity_s *entity_activator)
 {
     if(entity_activator && entity_activator->character)
@@ -83,34 +135,28 @@ void Trigger_DoCommands(trigger_header_p trigger, struct entity_s *entity_activa
     }
     if(trigger && entity_activator)
     {
-        bool has_non_continuos_triggers = false;
-
-        for(trigger_command_p command = trigger->commands; command; command = command->next)
+        trigger_command_p commands_end = trigger->commands + trigger->commands_count;
+        if(entity_activator->character && (trigger->functions_mask & (1 << TR_FD_TRIGFUNC_UWCURRENT)))
         {
-            switch(command->function)
+            for(trigger_command_p command = trigger->commands; command < commands_end; ++command)
             {
-                case TR_FD_TRIGFUNC_UWCURRENT:
-                    if(entity_activator->character)
+                if(command->function == TR_FD_TRIGFUNC_UWCURRENT)
+                {
+                    static_camera_sink_p sink = World_GetStaticCameraSink(command->operands);
+                    if(sink && (entity_activator->self->sector != Room_GetSectorRaw(entity_activator->self->room, sink->pos)))
                     {
-                        static_camera_sink_p sink = World_GetStaticCameraSink(command->operands);
-                        if(sink && (entity_activator->self->sector != Room_GetSectorRaw(entity_activator->self->room, sink->pos)))
+                        if(entity_activator->move_type == MOVE_UNDERWATER)
                         {
-                            if(entity_activator->move_type == MOVE_UNDERWATER)
-                            {
-                                Entity_MoveToSink(entity_activator, sink);
-                            }
-                            entity_activator->character->state.uw_current = 0x01;
+                            Entity_MoveToSink(entity_activator, sink);
                         }
+                        entity_activator->character->state.uw_current = 0x01;
                     }
-                    break;
-
-                default:
-                    has_non_continuos_triggers = true;
-                    break;
-            };
+                }
+            }
         }
 
-        if(has_non_continuos_triggers)
+        // Commands other than UWCURRENT are not continuous ones.
+        if(trigger->functions_mask & ~(1 << TR_FD_TRIGFUNC_UWCURRENT))
         {
             int activator           = TR_ACTIVATOR_NORMAL;      // Activator is normal by default.
             int action_type         = TR_ACTIONTYPE_NORMAL;     // Action type is normal by default.
@@ -155,7 +201,7 @@ void Trigger_DoCommands(trigger_header_p trigger, struct entity_s *entity_activa
                 case TR_FD_TRIGTYPE_PAD:
                     // Check move type for triggering entity.
                     {
-                        room_sector_p lowest_sector  = Sector_GetLowest(entity_activator->self->sector);
+                        room_sector_p lowest_sector  = Entity_GetLowestSector(entity_activator);
                         header_condition = (entity_activator->move_type == MOVE_ON_FLOOR) && lowest_sector &&
                                            (entity_activator->transform.M4x4[12 + 2] <= lowest_sector->floor + 16);
                     }
@@ -233,7 +279,7 @@ void Trigger_DoCommands(trigger_header_p trigger, struct entity_s *entity_activa
             uint32_t switch_mask = 0;
             entity_p trig_entity = NULL;
             entity_p switch_entity = NULL;
-            for(trigger_command_p command = trigger->commands; command; command = command->next)
+            for(trigger_command_p command = trigger->commands; command < commands_end; ++command)
             {
                 switch(command->function)
                 {
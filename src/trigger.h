@@ -65,6 +65,11 @@
 #define TR_FD_TRIGFUNC_FLYBY            0x0C
 #define TR_FD_TRIGFUNC_CUTSCENE         0x0D
 
+// Bit of trigger functions_mask for any function past the known ones (from
+// scripts), so trigger of such commands only is not skipped.
+
+#define TRIGGER_FUNCTION_OTHER_BIT      15
+
 // Action type specifies a kind of action which trigger performs. Mostly
 // it's only related to item activation, as any other trigger operations
 // are not affected by action type in original engines.
@@ -124,8 +129,6 @@ typedef struct trigger_command_s
 
     uint8_t                     once;
     uint8_t                     unused;
-    
-    struct trigger_command_s   *next;
 }trigger_command_t, *trigger_command_p;
 
 
@@ -136,10 +139,16 @@ typedef struct trigger_header_s
     uint16_t    once : 2;
     uint16_t    timer;
     uint16_t    mask;
-    struct trigger_command_s       *commands;
+    uint16_t    commands_count;
+    uint16_t    functions_mask;                 // (1 << TR_FD_TRIGFUNC_xxx) of all commands, OTHER_BIT for the rest
+    struct trigger_command_s       *commands;   // flat commands array
 }trigger_header_t, *trigger_header_p;
 
 
+trigger_header_p Trigger_Create(uint16_t function_value, uint16_t sub_function, uint16_t mask, uint16_t once, uint16_t timer);
+void Trigger_Delete(trigger_header_p trigger);
+trigger_command_p Trigger_AddCommand(trigger_header_p trigger, uint16_t function, uint16_t operands);
+
 void Trigger_DoCommands(trigger_header_p trigger, struct entity_s *ent);
 
 void Trigger_TrigMaskToStr(char buf[8], uint8_t flag);
@@ -37,10 +37,10 @@ int8_t TR_Level::read_bit8(SDL_RWops * const src)
     int8_t data;
 
     if (src == NULL)
-        Sys_extError("read_bit8: src == NULL");
+        TR_extError("read_bit8: src == NULL");
 
     if (SDL_RWread(src, &data, 1, 1) < 1)
-        Sys_extError("read_bit8");
+        TR_extError("read_bit8");
 
     return data;
 }
@@ -54,10 +54,10 @@ uint8_t TR_Level::read_bitu8(SDL_RWops * const src)
     uint8_t data;
 
     if (src == NULL)
-        Sys_extError("read_bitu8: src == NULL");
+        TR_extError("read_bitu8: src == NULL");
 
     if (SDL_RWread(src, &data, 1, 1) < 1)
-        Sys_extError("read_bitu8");
+        TR_extError("read_bitu8");
 
     return data;
 }
@@ -71,10 +71,10 @@ int16_t TR_Level::read_bit16(SDL_RWops * const src)
     int16_t data;
 
     if (src == NULL)
-        Sys_extError("read_bit16: src == NULL");
+        TR_extError("read_bit16: src == NULL");
 
     if (SDL_RWread(src, &data, 2, 1) < 1)
-        Sys_extError("read_bit16");
+        TR_extError("read_bit16");
 
     data = SDL_SwapLE16(data);
 
@@ -90,10 +90,10 @@ uint16_t TR_Level::read_bitu16(SDL_RWops * const src)
     uint16_t data;
 
     if (src == NULL)
-        Sys_extError("read_bitu16: src == NULL");
+        TR_extError("read_bitu16: src == NULL");
 
     if (SDL_RWread(src, &data, 2, 1) < 1)
-        Sys_extError("read_bitu16");
+        TR_extError("read_bitu16");
 
     data = SDL_SwapLE16(data);
 
@@ -109,10 +109,10 @@ int32_t TR_Level::read_bit32(SDL_RWops * const src)
     int32_t data;
 
     if (src == NULL)
-        Sys_extError("read_bit32: src == NULL");
+        TR_extError("read_bit32: src == NULL");
 
     if (SDL_RWread(src, &data, 4, 1) < 1)
-        Sys_extError("read_bit32");
+        TR_extError("read_bit32");
 
     data = SDL_SwapLE32(data);
 
@@ -128,10 +128,10 @@ uint32_t TR_Level::read_bitu32(SDL_RWops * const src)
     uint32_t data;
 
     if (src == NULL)
-        Sys_extError("read_bitu32: src == NULL");
+        TR_extError("read_bitu32: src == NULL");
 
     if (SDL_RWread(src, &data, 4, 1) < 1)
-        Sys_extError("read_bitu32");
+        TR_extError("read_bitu32");
 
     data = SDL_SwapLE32(data);
 
@@ -147,10 +147,10 @@ float TR_Level::read_float(SDL_RWops * const src)
     float data;
 
     if (src == NULL)
-        Sys_extError("read_float: src == NULL");
+        TR_extError("read_float: src == NULL");
 
     if (SDL_RWread(src, &data, 4, 1) < 1)
-        Sys_extError("read_float");
+        TR_extError("read_float");
 
     data = SDL_SwapLE32(data);
 
@@ -167,10 +167,10 @@ float TR_Level::read_mixfloat(SDL_RWops * const src)
     uint16_t sign_int;
 
     if (src == NULL)
-        Sys_extError("read_mixfloat: src == NULL");
+        TR_extError("read_mixfloat: src == NULL");
 
     if ((SDL_RWread(src, &sign_int, 2, 1) < 1) || (SDL_RWread(src, &base_int, 2, 1) < 1))
-        Sys_extError("read_mixfloat");
+        TR_extError("read_mixfloat");
 
     base_int = SDL_SwapLE32(base_int);
     sign_int = SDL_SwapLE32(sign_int);
@@ -20,6 +20,7 @@
  */
 
 #include <SDL2/SDL.h>
+#include <stdarg.h>
 #include <string.h>
 
 #include "l_main.h"
@@ -44,10 +45,10 @@ void TR_Level::read_mesh_data(SDL_RWops * const src)
     buffer = new uint8_t[size];
 
     if (SDL_RWread(src, buffer, 1, size) < size)
-        Sys_extError("read_tr_mesh_data: SDL_RWread(buffer)");
+        TR_extError("read_tr_mesh_data: SDL_RWread(buffer)");
 
     if ((newsrc = SDL_RWFromMem(buffer, size)) == NULL)
-        Sys_extError("read_tr_mesh_data: SDL_RWFromMem");
+        TR_extError("read_tr_mesh_data: SDL_RWFromMem");
 
     this->mesh_indices_count = read_bitu32(src);
     this->mesh_indices = (uint32_t*)malloc(this->mesh_indices_count * sizeof(uint32_t));
@@ -98,10 +99,10 @@ void TR_Level::read_frame_moveable_data(SDL_RWops * const src)
     this->frame_data = (uint16_t*)malloc(this->frame_data_size * sizeof(uint16_t));
 
     if (SDL_RWread(src, this->frame_data, sizeof(uint16_t), this->frame_data_size) < frame_data_size)
-        Sys_extError("read_tr_level: frame_data: SDL_RWread(buffer)");
+        TR_extError("read_tr_level: frame_data: SDL_RWread(buffer)");
 
     if ((newsrc = SDL_RWFromMem(this->frame_data, this->frame_data_size)) == NULL)
-        Sys_extError("read_tr_level: frame_data: SDL_RWFromMem");
+        TR_extError("read_tr_level: frame_data: SDL_RWFromMem");
 
     this->moveables_count = read_bitu32(src);
     this->moveables = (tr_moveable_t*)calloc(this->moveables_count, sizeof(tr_moveable_t));
@@ -141,15 +142,31 @@ void TR_Level::read_frame_moveable_data(SDL_RWops * const src)
     newsrc = NULL;
 }
 
-void TR_Level::read_level(const char *filename, int32_t game_version)
+/** \brief reports broken level data.
+  *
+  * Terminates the engine as before, or throws TR_ReadError when the caller
+  * asked for recoverable errors (background loading must not exit).
+  */
+void TR_Level::read_error(const char *fmt, ...)
 {
-    int len, i, len2;
-    SDL_RWops *src = SDL_RWFromFile(filename, "rb");
+    TR_ReadError err;
+    va_list argptr;
 
-    if(src == NULL)
+    va_start(argptr, fmt);
+    vsnprintf(err.message, sizeof(err.message), fmt, argptr);
+    va_end(argptr);
+
+    if(this->throw_read_errors)
     {
-        return;
+        Sys_DebugLog(SYS_LOG_FILENAME, "Level read error: %s", err.message);
+        throw err;
     }
+    Sys_Error("%s", err.message);
+}
+
+void TR_Level::set_sfx_path(const char *filename)
+{
+    int len, i, len2;
 
     len = strlen(filename);
     len2 = 0;
@@ -167,7 +184,18 @@ void TR_Level::read_level(const char *filename, int32_t game_version)
         this->sfx_path[len2+1] = 0;
         strncat(this->sfx_path, "MAIN.SFX", 256);
     }
+}
+
+void TR_Level::read_level(const char *filename, int32_t game_version)
+{
+    SDL_RWops *src = SDL_RWFromFile(filename, "rb");
+
+    if(src == NULL)
+    {
+        return;
+    }
 
+    this->set_sfx_path(filename);
     this->read_level(src, game_version);
     SDL_RWclose(src);
 }
@@ -179,7 +207,7 @@ void TR_Level::read_level(const char *filename, int32_t game_version)
 void TR_Level::read_level(SDL_RWops * const src, int32_t game_version)
 {
     if (!src)
-        Sys_extError("Invalid SDL_RWops");
+        TR_extError("Invalid SDL_RWops");
 
     this->game_version = game_version;
 
@@ -209,7 +237,7 @@ void TR_Level::read_level(SDL_RWops * const src, int32_t game_version)
             read_tr5_level(src);
             break;
         default:
-            Sys_extError("Invalid game version");
+            TR_extError("Invalid game version");
             break;
     }
 }
@@ -29,6 +29,18 @@
 #define TR_AUDIO_DEFAULT_RANGE 8
 #define TR_AUDIO_DEFAULT_PITCH 1.0       // 0.0 - only noise
 
+/** \brief Level read failure.
+  *
+  * Thrown by TR_Level::read_error() instead of terminating the engine when
+  * TR_Level::throw_read_errors is set (level is read on a worker thread).
+  */
+struct TR_ReadError
+{
+    char message[256];
+};
+
+#define TR_extError(...) {Sys_LogCurrPlace this->read_error(__VA_ARGS__);}
+
 /** \brief A complete TR level.
   *
   * This contains all necessary functions to load a TR level.
@@ -42,6 +54,7 @@ class TR_Level
         TR_Level()
         {
             this->game_version = TR_UNKNOWN;
+            this->throw_read_errors = false;
             strncpy(this->sfx_path, "MAIN.SFX", 256);
             
             this->textile8_count = 0;
@@ -541,7 +554,9 @@ class TR_Level
     uint32_t *mesh_tree_data;
         
     char     sfx_path[256];
+    bool     throw_read_errors;         ///< \brief throw TR_ReadError on broken data instead of Sys_Error.
         
+    void set_sfx_path(const char *filename);
     void read_level(const char *filename, int32_t game_version);
     void read_level(SDL_RWops * const src, int32_t game_version);
     tr_mesh_thee_tag_t get_mesh_tree_tag_for_model(tr_moveable_t *model, int index);
@@ -555,6 +570,7 @@ class TR_Level
     uint32_t num_misc_textiles;     ///< \brief number of 256x256 misc textiles (TR4-5).
     bool read_32bit_textiles;       ///< \brief are other 32bit textiles than misc ones read?
 
+    void read_error(const char *fmt, ...);
     int8_t read_bit8(SDL_RWops * const src);
     uint8_t read_bitu8(SDL_RWops * const src);
     int16_t read_bit16(SDL_RWops * const src);
@@ -98,7 +98,7 @@ void TR_Level::read_tr_textile8(SDL_RWops * const src, tr_textile8_t & textile)
 {
     for (int i = 0; i < 256; i++)
         if (SDL_RWread(src, textile.pixels[i], 1, 256) < 256)
-                        Sys_extError("read_tr_textile8");
+                        TR_extError("read_tr_textile8");
 }
 
 /// \brief reads the lightmap.
@@ -625,7 +625,7 @@ void TR_Level::read_tr_level(SDL_RWops * const src, bool demo_or_ub)
     uint32_t file_version = read_bitu32(src);
 
     if (file_version != 0x00000020)
-        Sys_extError("Wrong level version");
+        TR_extError("Wrong level version");
 
     this->num_textiles = 0;
     this->num_room_textiles = 0;
@@ -45,7 +45,7 @@ void TR_Level::read_tr2_textile16(SDL_RWops * const src, tr2_textile16_t & texti
 {
     for (int i = 0; i < 256; i++) {
         if (SDL_RWread(src, textile.pixels[i], 2, 256) < 256)
-            Sys_extError("read_tr2_textile16");
+            TR_extError("read_tr2_textile16");
 
         for (int j = 0; j < 256; j++)
             textile.pixels[i][j] = SDL_SwapLE16(textile.pixels[i][j]);
@@ -247,7 +247,7 @@ void TR_Level::read_tr2_level(SDL_RWops * const src, bool demo)
     uint32_t file_version = read_bitu32(src);
 
     if (file_version != 0x0000002d)
-        Sys_extError("Wrong level version");
+        TR_extError("Wrong level version");
 
     read_tr_palette(src, this->palette);
     read_tr2_palette16(src, this->palette16);
@@ -196,7 +196,7 @@ void TR_Level::read_tr3_level(SDL_RWops *const src)
     uint32_t file_version = read_bitu32(src);
 
     if ((file_version != 0xFF080038) && (file_version != 0xFF180038) && (file_version != 0xFF180034) )
-        Sys_extError("Wrong level version");
+        TR_extError("Wrong level version");
 
     read_tr_palette(src, this->palette);
     read_tr2_palette16(src, this->palette16);
@@ -39,7 +39,7 @@ void TR_Level::read_tr4_textile32(SDL_RWops * const src, tr4_textile32_t & texti
 {
     for (int i = 0; i < 256; i++) {
         if (SDL_RWread(src, textile.pixels[i], 4, 256) < 256)
-            Sys_extError("read_tr4_textile32");
+            TR_extError("read_tr4_textile32");
 
         for (int j = 0; j < 256; j++)
             textile.pixels[i][j] = SDL_SwapLE32((textile.pixels[i][j] & 0xff00ff00) | ((textile.pixels[i][j] & 0x00ff0000) >> 16) | ((textile.pixels[i][j] & 0x000000ff) << 16));
@@ -353,7 +353,7 @@ void TR_Level::read_tr4_level(SDL_RWops * const _src)
     uint32_t file_version = read_bitu32(src);
 
     if (file_version != 0x00345254 /*&& file_version != 0x63345254*/)           // +TRLE
-            Sys_extError("Wrong level version");
+            TR_extError("Wrong level version");
 
     this->num_textiles = 0;
     this->num_room_textiles = 0;
@@ -375,7 +375,7 @@ void TR_Level::read_tr4_level(SDL_RWops * const _src)
 
         uncomp_size = read_bitu32(src);
         if (uncomp_size == 0)
-            Sys_extError("read_tr4_level: textiles32 uncomp_size == 0");
+            TR_extError("read_tr4_level: textiles32 uncomp_size == 0");
 
         comp_size = read_bitu32(src);
         if (comp_size > 0)
@@ -387,19 +387,19 @@ void TR_Level::read_tr4_level(SDL_RWops * const _src)
             comp_buffer = new uint8_t[comp_size];
 
             if (SDL_RWread(src, comp_buffer, 1, comp_size) < comp_size)
-                Sys_extError("read_tr4_level: textiles32");
+                TR_extError("read_tr4_level: textiles32");
 
             size = uncomp_size;
             if (uncompress(uncomp_buffer, &size, comp_buffer, comp_size) != Z_OK)
-                Sys_extError("read_tr4_level: uncompress");
+                TR_extError("read_tr4_level: uncompress");
 
             if (size != uncomp_size)
-                Sys_extError("read_tr4_level: uncompress size mismatch");
+                TR_extError("read_tr4_level: uncompress size mismatch");
             delete [] comp_buffer;
 
             comp_buffer = NULL;
             if ((newsrc = SDL_RWFromMem(uncomp_buffer, uncomp_size)) == NULL)
-                Sys_extError("read_tr4_level: SDL_RWFromMem");
+                TR_extError("read_tr4_level: SDL_RWFromMem");
 
             for (i = 0; i < (this->num_textiles - this->num_misc_textiles); i++)
                 read_tr4_textile32(newsrc, this->textile32[i]);
@@ -413,7 +413,7 @@ void TR_Level::read_tr4_level(SDL_RWops * const _src)
 
         uncomp_size = read_bitu32(src);
         if (uncomp_size == 0)
-            Sys_extError("read_tr4_level: textiles16 uncomp_size == 0");
+            TR_extError("read_tr4_level: textiles16 uncomp_size == 0");
 
         comp_size = read_bitu32(src);
         if (comp_size > 0)
@@ -430,7 +430,7 @@ void TR_Level::read_tr4_level(SDL_RWops * const _src)
                 {
                     delete [] comp_buffer;
                     delete [] uncomp_buffer;
-                    Sys_extError("read_tr4_level: textiles16");
+                    TR_extError("read_tr4_level: textiles16");
                 }
 
                 size = uncomp_size;
@@ -438,7 +438,7 @@ void TR_Level::read_tr4_level(SDL_RWops * const _src)
                 {
                     delete [] comp_buffer;
                     delete [] uncomp_buffer;
-                    Sys_extError("read_tr4_level: uncompress");
+                    TR_extError("read_tr4_level: uncompress");
                 }
 
                 delete [] comp_buffer;
@@ -447,13 +447,13 @@ void TR_Level::read_tr4_level(SDL_RWops * const _src)
                 if (size != uncomp_size)
                 {
                     delete [] uncomp_buffer;
-                    Sys_extError("read_tr4_level: uncompress size mismatch");
+                    TR_extError("read_tr4_level: uncompress size mismatch");
                 }
 
                 if ((newsrc = SDL_RWFromMem(uncomp_buffer, uncomp_size)) == NULL)
                 {
                     delete [] uncomp_buffer;
-                    Sys_extError("read_tr4_level: SDL_RWFromMem");
+                    TR_extError("read_tr4_level: SDL_RWFromMem");
                 }
 
                 for (i = 0; i < (this->num_textiles - this->num_misc_textiles); i++)
@@ -472,7 +472,7 @@ void TR_Level::read_tr4_level(SDL_RWops * const _src)
 
         uncomp_size = read_bitu32(src);
         if (uncomp_size == 0)
-            Sys_extError("read_tr4_level: textiles32d uncomp_size == 0");
+            TR_extError("read_tr4_level: textiles32d uncomp_size == 0");
 
         comp_size = read_bitu32(src);
         if (comp_size > 0)
@@ -493,7 +493,7 @@ void TR_Level::read_tr4_level(SDL_RWops * const _src)
             {
                 delete [] uncomp_buffer;
                 delete [] comp_buffer;
-                Sys_extError("read_tr4_level: misc_textiles");
+                TR_extError("read_tr4_level: misc_textiles");
             }
 
             size = uncomp_size;
@@ -501,7 +501,7 @@ void TR_Level::read_tr4_level(SDL_RWops * const _src)
             {
                 delete [] uncomp_buffer;
                 delete [] comp_buffer;
-                Sys_extError("read_tr4_level: uncompress");
+                TR_extError("read_tr4_level: uncompress");
             }
 
             delete [] comp_buffer;
@@ -509,13 +509,13 @@ void TR_Level::read_tr4_level(SDL_RWops * const _src)
             if (size != uncomp_size)
             {
                 delete [] uncomp_buffer;
-                Sys_extError("read_tr4_level: uncompress size mismatch");
+                TR_extError("read_tr4_level: uncompress size mismatch");
             }
 
             if ((newsrc = SDL_RWFromMem(uncomp_buffer, uncomp_size)) == NULL)
             {
                 delete [] uncomp_buffer;
-                Sys_extError("read_tr4_level: SDL_RWFromMem");
+                TR_extError("read_tr4_level: SDL_RWFromMem");
             }
 
             for (i = (this->num_textiles - this->num_misc_textiles); i < this->num_textiles; i++)
@@ -529,12 +529,12 @@ void TR_Level::read_tr4_level(SDL_RWops * const _src)
 
         uncomp_size = read_bitu32(src);
         if (uncomp_size == 0)
-            Sys_extError("read_tr4_level: packed geometry uncomp_size == 0");
+            TR_extError("read_tr4_level: packed geometry uncomp_size == 0");
 
         comp_size = read_bitu32(src);
 
         if (!comp_size)
-            Sys_extError("read_tr4_level: packed geometry");
+            TR_extError("read_tr4_level: packed geometry");
 
         uncomp_buffer = new uint8_t[uncomp_size];
         comp_buffer = new uint8_t[comp_size];
@@ -543,7 +543,7 @@ void TR_Level::read_tr4_level(SDL_RWops * const _src)
         {
             delete [] uncomp_buffer;
             delete [] comp_buffer;
-            Sys_extError("read_tr4_level: packed geometry");
+            TR_extError("read_tr4_level: packed geometry");
         }
 
         size = uncomp_size;
@@ -551,7 +551,7 @@ void TR_Level::read_tr4_level(SDL_RWops * const _src)
         {
             delete [] uncomp_buffer;
             delete [] comp_buffer;
-            Sys_extError("read_tr4_level: uncompress");
+            TR_extError("read_tr4_level: uncompress");
         }
 
         delete [] comp_buffer;
@@ -559,13 +559,13 @@ void TR_Level::read_tr4_level(SDL_RWops * const _src)
         if (size != uncomp_size)
         {
             delete [] uncomp_buffer;
-            Sys_extError("read_tr4_level: uncompress size mismatch");
+            TR_extError("read_tr4_level: uncompress size mismatch");
         }
 
         if ((newsrc = SDL_RWFromMem(uncomp_buffer, uncomp_size)) == NULL)
         {
             delete [] uncomp_buffer;
-            Sys_extError("read_tr4_level: SDL_RWFromMem");
+            TR_extError("read_tr4_level: SDL_RWFromMem");
         }
     }
 
@@ -618,13 +618,13 @@ void TR_Level::read_tr4_level(SDL_RWops * const _src)
         read_tr_staticmesh(newsrc, this->static_meshes[i]);
 
     if (read_bit8(newsrc) != 'S')
-        Sys_extError("read_tr4_level: 'SPR' not found");
+        TR_extError("read_tr4_level: 'SPR' not found");
 
     if (read_bit8(newsrc) != 'P')
-        Sys_extError("read_tr4_level: 'SPR' not found");
+        TR_extError("read_tr4_level: 'SPR' not found");
 
     if (read_bit8(newsrc) != 'R')
-        Sys_extError("read_tr4_level: 'SPR' not found");
+        TR_extError("read_tr4_level: 'SPR' not found");
 
     this->sprite_textures_count = read_bitu32(newsrc);
     this->sprite_textures = (tr_sprite_texture_t*)malloc(this->sprite_textures_count * sizeof(tr_sprite_texture_t));
@@ -709,13 +709,13 @@ void TR_Level::read_tr4_level(SDL_RWops * const _src)
     this->animated_textures_uv_count = read_bitu8(newsrc);
 
     if (read_bit8(newsrc) != 'T')
-        Sys_extError("read_tr4_level: '\\0TEX' not found");
+        TR_extError("read_tr4_level: '\\0TEX' not found");
 
     if (read_bit8(newsrc) != 'E')
-        Sys_extError("read_tr4_level: '\\0TEX' not found");
+        TR_extError("read_tr4_level: '\\0TEX' not found");
 
     if (read_bit8(newsrc) != 'X')
-        Sys_extError("read_tr4_level: '\\0TEX' not found");
+        TR_extError("read_tr4_level: '\\0TEX' not found");
 
     this->object_textures_count = read_bitu32(newsrc);
     this->object_textures = (tr4_object_texture_t*)malloc(this->object_textures_count * sizeof(tr4_object_texture_t));
@@ -129,18 +129,18 @@ void TR_Level::read_tr5_room(SDL_RWops * const src, tr5_room_t & room)
     uint8_t *buffer;
 
     if (read_bitu32(src) != 0x414C4558)
-        Sys_extError("read_tr5_room: 'XELA' not found");
+        TR_extError("read_tr5_room: 'XELA' not found");
 
     room_data_size = read_bitu32(src);
     buffer = new uint8_t[room_data_size];
 
     if (SDL_RWread(src, buffer, 1, room_data_size) < room_data_size)
-        Sys_extError("read_tr5_room: room_data");
+        TR_extError("read_tr5_room: room_data");
 
     if ((newsrc = SDL_RWFromMem(buffer, room_data_size)) == NULL)
     {
         delete [] buffer;
-        Sys_extError("read_tr5_room: SDL_RWFromMem");
+        TR_extError("read_tr5_room: SDL_RWFromMem");
     }
 
     room.intensity1 = 32767;
@@ -259,7 +259,7 @@ void TR_Level::read_tr5_room(SDL_RWops * const src, tr5_room_t & room)
     {
         SDL_RWclose(newsrc);
         delete [] buffer;
-        Sys_extError("read_tr5_room: room.num_lights2 != room.num_lights");
+        TR_extError("read_tr5_room: room.num_lights2 != room.num_lights");
     }
 
     room.unknown_r6 = read_bitu32(newsrc);
@@ -290,7 +290,7 @@ void TR_Level::read_tr5_room(SDL_RWops * const src, tr5_room_t & room)
     {
         SDL_RWclose(newsrc);
         delete [] buffer;
-        Sys_extError("read_tr5_room: poly_offset != poly_offset2");
+        TR_extError("read_tr5_room: poly_offset != poly_offset2");
     }
 
     vertices_size = read_bitu32(newsrc);
@@ -298,7 +298,7 @@ void TR_Level::read_tr5_room(SDL_RWops * const src, tr5_room_t & room)
     {
         SDL_RWclose(newsrc);
         delete [] buffer;
-        Sys_extError("read_tr5_room: vertices_size has wrong value");
+        TR_extError("read_tr5_room: vertices_size has wrong value");
     }
 
     if (read_bitu32(newsrc) != 0xCDCDCDCD)
@@ -420,7 +420,7 @@ void TR_Level::read_tr5_level(SDL_RWops * const src)
     uint32_t file_version = read_bitu32(src);
 
     if (file_version != 0x00345254)
-        Sys_extError("Wrong level version");
+        TR_extError("Wrong level version");
 
     this->num_textiles = 0;
     this->num_room_textiles = 0;
@@ -441,7 +441,7 @@ void TR_Level::read_tr5_level(SDL_RWops * const src)
 
     uncomp_size = read_bitu32(src);
     if (uncomp_size == 0)
-        Sys_extError("read_tr5_level: textiles32 uncomp_size == 0");
+        TR_extError("read_tr5_level: textiles32 uncomp_size == 0");
 
     comp_size = read_bitu32(src);
     if (comp_size > 0)
@@ -453,7 +453,7 @@ void TR_Level::read_tr5_level(SDL_RWops * const src)
         if (SDL_RWread(src, comp_buffer, 1, comp_size) < comp_size)
         {
             delete [] comp_buffer;
-            Sys_extError("read_tr5_level: textiles32");
+            TR_extError("read_tr5_level: textiles32");
         }
 
         uncomp_buffer = new uint8_t[uncomp_size];
@@ -462,7 +462,7 @@ void TR_Level::read_tr5_level(SDL_RWops * const src)
         {
             delete [] comp_buffer;
             delete [] uncomp_buffer;
-            Sys_extError("read_tr5_level: uncompress");
+            TR_extError("read_tr5_level: uncompress");
         }
 
         delete [] comp_buffer;
@@ -470,13 +470,13 @@ void TR_Level::read_tr5_level(SDL_RWops * const src)
         if (size != uncomp_size)
         {
             delete [] uncomp_buffer;
-            Sys_extError("read_tr5_level: uncompress size mismatch");
+            TR_extError("read_tr5_level: uncompress size mismatch");
         }
 
         if ((newsrc = SDL_RWFromMem(uncomp_buffer, uncomp_size)) == NULL)
         {
             delete [] uncomp_buffer;
-            Sys_extError("read_tr5_level: SDL_RWFromMem");
+            TR_extError("read_tr5_level: SDL_RWFromMem");
         }
 
         for (i = 0; i < (this->num_textiles - this->num_misc_textiles); i++)
@@ -492,7 +492,7 @@ void TR_Level::read_tr5_level(SDL_RWops * const src)
 
     uncomp_size = read_bitu32(src);
     if (uncomp_size == 0)
-        Sys_extError("read_tr5_level: textiles16 uncomp_size == 0");
+        TR_extError("read_tr5_level: textiles16 uncomp_size == 0");
 
     comp_size = read_bitu32(src);
     if (comp_size > 0)
@@ -506,7 +506,7 @@ void TR_Level::read_tr5_level(SDL_RWops * const src)
             if (SDL_RWread(src, comp_buffer, 1, comp_size) < comp_size)
             {
                 delete [] comp_buffer;
-                Sys_extError("read_tr5_level: textiles16");
+                TR_extError("read_tr5_level: textiles16");
             }
 
             uncomp_buffer = new uint8_t[uncomp_size];
@@ -515,7 +515,7 @@ void TR_Level::read_tr5_level(SDL_RWops * const src)
             {
                 delete [] comp_buffer;
                 delete [] uncomp_buffer;
-                Sys_extError("read_tr5_level: uncompress");
+                TR_extError("read_tr5_level: uncompress");
             }
             delete [] comp_buffer;
             comp_buffer = NULL;
@@ -523,13 +523,13 @@ void TR_Level::read_tr5_level(SDL_RWops * const src)
             if (size != uncomp_size)
             {
                 delete [] uncomp_buffer;
-                Sys_extError("read_tr5_level: uncompress size mismatch");
+                TR_extError("read_tr5_level: uncompress size mismatch");
             }
 
             if ((newsrc = SDL_RWFromMem(uncomp_buffer, uncomp_size)) == NULL)
             {
                 delete [] uncomp_buffer;
-                Sys_extError("read_tr5_level: SDL_RWFromMem");
+                TR_extError("read_tr5_level: SDL_RWFromMem");
             }
 
             for (i = 0; i < (this->num_textiles - this->num_misc_textiles); i++)
@@ -548,7 +548,7 @@ void TR_Level::read_tr5_level(SDL_RWops * const src)
 
     uncomp_size = read_bitu32(src);
     if (uncomp_size == 0)
-        Sys_extError("read_tr5_level: textiles32d uncomp_size == 0");
+        TR_extError("read_tr5_level: textiles32d uncomp_size == 0");
 
     comp_size = read_bitu32(src);
     if (comp_size > 0)
@@ -566,7 +566,7 @@ void TR_Level::read_tr5_level(SDL_RWops * const src)
         if (SDL_RWread(src, comp_buffer, 1, comp_size) < comp_size)
         {
             delete [] comp_buffer;
-            Sys_extError("read_tr5_level: misc_textiles");
+            TR_extError("read_tr5_level: misc_textiles");
         }
 
         uncomp_buffer = new uint8_t[uncomp_size];
@@ -575,7 +575,7 @@ void TR_Level::read_tr5_level(SDL_RWops * const src)
         {
             delete [] uncomp_buffer;
             delete [] comp_buffer;
-            Sys_extError("read_tr5_level: uncompress");
+            TR_extError("read_tr5_level: uncompress");
         }
         delete [] comp_buffer;
         comp_buffer = NULL;
@@ -583,13 +583,13 @@ void TR_Level::read_tr5_level(SDL_RWops * const src)
         if (size != uncomp_size)
         {
             delete [] uncomp_buffer;
-            Sys_extError("read_tr5_level: uncompress size mismatch");
+            TR_extError("read_tr5_level: uncompress size mismatch");
         }
 
         if ((newsrc = SDL_RWFromMem(uncomp_buffer, uncomp_size)) == NULL)
         {
             delete [] uncomp_buffer;
-            Sys_extError("read_tr5_level: SDL_RWFromMem");
+            TR_extError("read_tr5_level: SDL_RWFromMem");
         }
 
         for (i = (this->num_textiles - this->num_misc_textiles); i < this->num_textiles; i++)
@@ -693,16 +693,16 @@ void TR_Level::read_tr5_level(SDL_RWops * const src)
         read_tr_staticmesh(src, this->static_meshes[i]);
 
     if (read_bit8(src) != 'S')
-        Sys_extError("read_tr5_level: 'SPR' not found");
+        TR_extError("read_tr5_level: 'SPR' not found");
 
     if (read_bit8(src) != 'P')
-        Sys_extError("read_tr5_level: 'SPR' not found");
+        TR_extError("read_tr5_level: 'SPR' not found");
 
     if (read_bit8(src) != 'R')
-        Sys_extError("read_tr5_level: 'SPR' not found");
+        TR_extError("read_tr5_level: 'SPR' not found");
 
     if (read_bit8(src) != 0)
-        Sys_extError("read_tr5_level: 'SPR' not found");
+        TR_extError("read_tr5_level: 'SPR' not found");
 
     this->sprite_textures_count = read_bitu32(src);
     this->sprite_textures = (tr_sprite_texture_t*)malloc(this->sprite_textures_count * sizeof(tr_sprite_texture_t));
@@ -786,16 +786,16 @@ void TR_Level::read_tr5_level(SDL_RWops * const src)
     this->animated_textures_uv_count = read_bitu8(src);
 
     if (read_bit8(src) != 'T')
-        Sys_extError("read_tr5_level: '\\0TEX' not found");
+        TR_extError("read_tr5_level: '\\0TEX' not found");
 
     if (read_bit8(src) != 'E')
-        Sys_extError("read_tr5_level: '\\0TEX' not found");
+        TR_extError("read_tr5_level: '\\0TEX' not found");
 
     if (read_bit8(src) != 'X')
-        Sys_extError("read_tr5_level: '\\0TEX' not found");
+        TR_extError("read_tr5_level: '\\0TEX' not found");
 
     if (read_bit8(src) != 0)
-        Sys_extError("read_tr5_level: '\\0TEX' not found");
+        TR_extError("read_tr5_level: '\\0TEX' not found");
 
     this->object_textures_count = read_bitu32(src);
     this->object_textures = (tr4_object_texture_t*)malloc(this->object_textures_count * sizeof(tr4_object_texture_t));
@@ -3,8 +3,16 @@
 #include <stdio.h>
 #include "tr_versions.h"
 #include "vt_level.h"
+#include "../core/parallel.h"
 #include <ctype.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define VT_NEON 1
+#endif
+
 //#define RCSID "$Id: vt_level.cpp,v 1.1 2002/09/20 15:59:02 crow Exp $"
 
 int VT_Level::get_level_format(const char *name)
@@ -139,9 +147,119 @@ int VT_Level::get_PC_level_version(const char *name)
     return ret;
 }
 
+/*
+ * Pixels conversion kernels. Result is ABGR word (RGBA bytes), the same as
+ * scalar code gives: 5 bit channels are shifted to high bits, low bits are
+ * zero; transparent pixels (alpha bit or palette index 0) are fully zero.
+ */
+static inline uint32_t VT_Pixel16To32(uint16_t col)
+{
+    if (col & 0x8000)
+        return ((col & 0x00007c00) >> 7) | (((col & 0x000003e0) >> 2) << 8) | (((col & 0x0000001f) << 3) << 16) | 0xff000000;
+    return 0x00000000;
+}
+
+static void VT_ConvertPixels16To32(const uint16_t *src, uint32_t *dst, size_t count)
+{
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i mask_r = _mm_set1_epi32(0x000000f8);
+    const __m128i mask_g = _mm_set1_epi32(0x0000f800);
+    const __m128i mask_b = _mm_set1_epi32(0x00f80000);
+    const __m128i alpha = _mm_set1_epi32(0xff000000);
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i c16 = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i c[2] = {_mm_unpacklo_epi16(c16, zero), _mm_unpackhi_epi16(c16, zero)};
+        for (int k = 0; k < 2; k++)
+        {
+            __m128i px = _mm_and_si128(_mm_srli_epi32(c[k], 7), mask_r);
+            px = _mm_or_si128(px, _mm_and_si128(_mm_slli_epi32(c[k], 6), mask_g));
+            px = _mm_or_si128(px, _mm_and_si128(_mm_slli_epi32(c[k], 19), mask_b));
+            px = _mm_or_si128(px, alpha);
+            px = _mm_and_si128(px, _mm_srai_epi32(_mm_slli_epi32(c[k], 16), 31));    // alpha bit to mask
+            _mm_storeu_si128((__m128i*)(dst + i + 4 * k), px);
+        }
+    }
+#elif defined(VT_NEON)
+    const uint32x4_t mask_r = vdupq_n_u32(0x000000f8);
+    const uint32x4_t mask_g = vdupq_n_u32(0x0000f800);
+    const uint32x4_t mask_b = vdupq_n_u32(0x00f80000);
+    const uint32x4_t alpha = vdupq_n_u32(0xff000000);
+    for (; i + 8 <= count; i += 8)
+    {
+        uint16x8_t c16 = vld1q_u16(src + i);
+        uint32x4_t c[2] = {vmovl_u16(vget_low_u16(c16)), vmovl_u16(vget_high_u16(c16))};
+        for (int k = 0; k < 2; k++)
+        {
+            uint32x4_t px = vandq_u32(vshrq_n_u32(c[k], 7), mask_r);
+            px = vorrq_u32(px, vandq_u32(vshlq_n_u32(c[k], 6), mask_g));
+            px = vorrq_u32(px, vandq_u32(vshlq_n_u32(c[k], 19), mask_b));
+            px = vorrq_u32(px, alpha);
+            px = vandq_u32(px, vreinterpretq_u32_s32(vshrq_n_s32(vreinterpretq_s32_u32(vshlq_n_u32(c[k], 16)), 31)));
+            vst1q_u32(dst + i + 4 * k, px);
+        }
+    }
+#endif
+    for (; i < count; i++)
+        dst[i] = VT_Pixel16To32(src[i]);
+}
+
+/*
+ * Palette expansion is a table lookup, there is no gather in SSE2 / NEON,
+ * so the palette is converted to ready pixels once and the loop is unrolled.
+ */
+static void VT_GenPaletteTable(const tr2_palette_t *pal, uint32_t table[256])
+{
+    table[0] = 0x00000000;
+    for (int i = 1; i < 256; i++)
+        table[i] = ((uint32_t)pal->colour[i].r) | ((uint32_t)pal->colour[i].g << 8) | ((uint32_t)pal->colour[i].b << 16) | 0xff000000;
+}
+
+static void VT_ConvertPixels8To32(const uint8_t *src, const uint32_t table[256], uint32_t *dst, size_t count)
+{
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        uint32_t p0 = table[src[i + 0]];
+        uint32_t p1 = table[src[i + 1]];
+        uint32_t p2 = table[src[i + 2]];
+        uint32_t p3 = table[src[i + 3]];
+        dst[i + 0] = p0;
+        dst[i + 1] = p1;
+        dst[i + 2] = p2;
+        dst[i + 3] = p3;
+    }
+    for (; i < count; i++)
+        dst[i] = table[src[i]];
+}
+
+typedef struct vt_textiles_job_s
+{
+    VT_Level   *level;
+    uint32_t    palette_table[256];
+}vt_textiles_job_t;
+
+static void VT_ConvertTextile16Job(void *data, uint32_t index)
+{
+    VT_Level *level = ((vt_textiles_job_t*)data)->level;
+    VT_ConvertPixels16To32(&level->textile16[index].pixels[0][0], &level->textile32[index].pixels[0][0], 256 * 256);
+}
+
+static void VT_ConvertTextile8Job(void *data, uint32_t index)
+{
+    vt_textiles_job_t *job = (vt_textiles_job_t*)data;
+    VT_ConvertPixels8To32(&job->level->textile8[index].pixels[0][0], job->palette_table, &job->level->textile32[index].pixels[0][0], 256 * 256);
+}
+
+/*
+ * Textiles are converted in parallel, one job per textile.
+ */
 void VT_Level::prepare_level()
 {
-    uint32_t i;
+    vt_textiles_job_t job;
+    job.level = this;
 
     if ((game_version >= TR_II) && (game_version <= TR_V))
     {
@@ -152,16 +270,15 @@ void VT_Level::prepare_level()
                 this->textile32_count = this->num_textiles;
                 this->textile32 = (tr4_textile32_t*)malloc(this->textile32_count * sizeof(tr4_textile32_t));
             }
-            for (i = 0; i < (num_textiles - num_misc_textiles); i++)
-                convert_textile16_to_textile32(textile16[i], textile32[i]);
+            Parallel_For(num_textiles - num_misc_textiles, VT_ConvertTextile16Job, &job);
         }
     }
     else
     {
         this->textile32_count = this->num_textiles;
             this->textile32 = (tr4_textile32_t*)malloc(this->textile32_count * sizeof(tr4_textile32_t));
-        for (i = 0; i < num_textiles; i++)
-            convert_textile8_to_textile32(textile8[i], palette, textile32[i]);
+        VT_GenPaletteTable(&palette, job.palette_table);
+        Parallel_For(num_textiles, VT_ConvertTextile8Job, &job);
     }
 }
 
@@ -199,6 +316,22 @@ tr_moveable_t *VT_Level::find_moveable_id(uint32_t object_id)
 }
 
 void VT_Level::convert_textile8_to_textile32(tr_textile8_t & tex, tr2_palette_t & pal, tr4_textile32_t & dst)
+{
+    uint32_t table[256];
+
+    VT_GenPaletteTable(&pal, table);
+    VT_ConvertPixels8To32(&tex.pixels[0][0], table, &dst.pixels[0][0], 256 * 256);
+}
+
+void VT_Level::convert_textile16_to_textile32(tr2_textile16_t & tex, tr4_textile32_t & dst)
+{
+    VT_ConvertPixels16To32(&tex.pixels[0][0], &dst.pixels[0][0], 256 * 256);
+}
+
+/*
+ * Original scalar conversion loops, reference for check_textiles().
+ */
+static void VT_ReferenceTextile8To32(const tr_textile8_t & tex, const tr2_palette_t & pal, tr4_textile32_t & dst)
 {
     int x, y;
 
@@ -216,7 +349,7 @@ void VT_Level::convert_textile8_to_textile32(tr_textile8_t & tex, tr2_palette_t
     }
 }
 
-void VT_Level::convert_textile16_to_textile32(tr2_textile16_t & tex, tr4_textile32_t & dst)
+static void VT_ReferenceTextile16To32(const tr2_textile16_t & tex, tr4_textile32_t & dst)
 {
     int x, y;
 
@@ -234,6 +367,86 @@ void VT_Level::convert_textile16_to_textile32(tr2_textile16_t & tex, tr4_textile
     }
 }
 
+static uint32_t VT_CountDiffPixels(const uint32_t *a, const uint32_t *b, size_t count)
+{
+    uint32_t ret = 0;
+    for (size_t i = 0; i < count; i++)
+        ret += (a[i] != b[i]) ? 1 : 0;
+    return ret;
+}
+
+/*
+ * Compares the conversion kernels and the converted level textiles (call
+ * after prepare_level()) with the reference loops; returns the number of
+ * differing pixels. Kernels get all 65536 16 bit values and all palette
+ * indices, also from unaligned start with a scalar tail.
+ */
+uint32_t VT_Level::check_textiles()
+{
+    tr2_textile16_t *src16 = (tr2_textile16_t*)malloc(sizeof(tr2_textile16_t));
+    tr_textile8_t *src8 = (tr_textile8_t*)malloc(sizeof(tr_textile8_t));
+    tr4_textile32_t *dst = (tr4_textile32_t*)malloc(sizeof(tr4_textile32_t));
+    tr4_textile32_t *ref = (tr4_textile32_t*)malloc(sizeof(tr4_textile32_t));
+    uint32_t *flat_dst = &dst->pixels[0][0];
+    uint32_t table[256];
+    tr2_palette_t pal;
+    uint32_t ret = 0;
+
+    for (uint32_t i = 0; i < 256 * 256; i++)
+    {
+        (&src16->pixels[0][0])[i] = (uint16_t)i;
+        (&src8->pixels[0][0])[i] = (uint8_t)(i * 37 + (i >> 8));
+    }
+    for (int i = 0; i < 256; i++)
+    {
+        pal.colour[i].r = (uint8_t)(i * 7 + 1);
+        pal.colour[i].g = (uint8_t)(i * 13 + 2);
+        pal.colour[i].b = (uint8_t)(i * 29 + 3);
+    }
+
+    VT_ReferenceTextile16To32(*src16, *ref);
+    VT_ConvertPixels16To32(&src16->pixels[0][0], flat_dst, 256 * 256);
+    ret += VT_CountDiffPixels(flat_dst, &ref->pixels[0][0], 256 * 256);
+    memset(dst, 0, sizeof(tr4_textile32_t));
+    VT_ConvertPixels16To32(&src16->pixels[0][0] + 3, flat_dst + 3, 256 * 256 - 3 - 5);
+    ret += VT_CountDiffPixels(flat_dst + 3, &ref->pixels[0][0] + 3, 256 * 256 - 3 - 5);
+    ret += (flat_dst[256 * 256 - 5] != 0) ? 1 : 0;
+
+    VT_ReferenceTextile8To32(*src8, pal, *ref);
+    VT_GenPaletteTable(&pal, table);
+    VT_ConvertPixels8To32(&src8->pixels[0][0], table, flat_dst, 256 * 256);
+    ret += VT_CountDiffPixels(flat_dst, &ref->pixels[0][0], 256 * 256);
+    memset(dst, 0, sizeof(tr4_textile32_t));
+    VT_ConvertPixels8To32(&src8->pixels[0][0] + 1, table, flat_dst + 1, 256 * 256 - 1 - 2);
+    ret += VT_CountDiffPixels(flat_dst + 1, &ref->pixels[0][0] + 1, 256 * 256 - 1 - 2);
+    ret += (flat_dst[256 * 256 - 2] != 0) ? 1 : 0;
+
+    // level textiles, converted as prepare_level() does
+    if ((game_version >= TR_II) && (game_version <= TR_V))
+    {
+        for (uint32_t i = 0; !read_32bit_textiles && (i < num_textiles - num_misc_textiles); i++)
+        {
+            VT_ReferenceTextile16To32(textile16[i], *ref);
+            ret += VT_CountDiffPixels(&textile32[i].pixels[0][0], &ref->pixels[0][0], 256 * 256);
+        }
+    }
+    else
+    {
+        for (uint32_t i = 0; i < num_textiles; i++)
+        {
+            VT_ReferenceTextile8To32(textile8[i], palette, *ref);
+            ret += VT_CountDiffPixels(&textile32[i].pixels[0][0], &ref->pixels[0][0], 256 * 256);
+        }
+    }
+
+    free(src16);
+    free(src8);
+    free(dst);
+    free(ref);
+
+    return ret;
+}
+
 void WriteTGAfile(const char *filename, const uint8_t *data, const int width, const int height, char invY)
 {
     unsigned char c;
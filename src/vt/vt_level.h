@@ -17,6 +17,7 @@ class VT_Level : public TR_Level
     static int get_level_format(const char *name);
     static int get_PC_level_version(const char *name);
     void prepare_level();
+    uint32_t check_textiles();
     void dump_textures();
     tr_staticmesh_t *find_staticmesh_id(uint32_t object_id);
     tr2_item_t *find_item_id(int32_t object_id);
@@ -3,6 +3,8 @@
 #include <stdlib.h>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_rwops.h>
+#include <SDL2/SDL_atomic.h>
+#include <SDL2/SDL_thread.h>
 
 extern "C" {
 #include <lua.h>
@@ -10,6 +12,7 @@ extern "C" {
 #include <lauxlib.h>
 }
 
+#include "core/arena.h"
 #include "core/avl.h"
 #include "core/gl_util.h"
 #include "core/console.h"
@@ -94,6 +97,22 @@ extern "C" {
     struct flyby_camera_sequence_s *flyby_camera_sequences;
 } global_world;
 
+#define WORLD_PRELOAD_NONE      (0)
+#define WORLD_PRELOAD_RUNNING   (1)
+#define WORLD_PRELOAD_READY     (2)
+#define WORLD_PRELOAD_FAILED    (3)
+
+struct world_preload_s
+{
+    SDL_Thread                     *thread;
+    SDL_atomic_t                    state;
+    SDL_atomic_t                    cancel;                 // worker stops reading as soon as it is set
+    class VT_Level                 *level;                  // valid only in READY state
+    int                             enabled;
+    uint32_t                        memory_limit;
+    char                            path[MAX_ENGINE_PATH];
+} world_preload = {NULL, {WORLD_PRELOAD_NONE}, {0}, NULL, 1, WORLD_PRELOAD_DEFAULT_MEMORY_LIMIT, {0}};
+
 
 // private load level functions prototipes:
 void World_SetEntityModelProperties(struct entity_s *ent);
@@ -174,11 +193,250 @@ void World_Prepare()
 }
 
 
-void World_Open(const char *path, int trv)
+/*
+ * Level preloading: worker thread does only file reading and CPU-side
+ * conversions (VT_Level::read_level, prepare_level); GL resources and
+ * world structures are created by World_Open() on the main thread.
+ * Loader runs with throw_read_errors, so a broken file fails the preload
+ * instead of terminating the engine from the worker.
+ */
+
+/**
+ * Unpacked level size estimation from the file header, made before anything
+ * is allocated: TR1-3 - file + 32 bit textile copies made by prepare_level(),
+ * TR4-5 - file + uncompressed sizes of zlib chunks.
+ */
+static uint64_t World_PreloadEstimateSize(SDL_RWops *f, int trv)
+{
+    uint64_t ret = SDL_RWsize(f);
+    uint32_t chunks = 0;
+
+    switch(trv)
+    {
+        case TR_I:
+        case TR_I_DEMO:
+        case TR_I_UB:
+            SDL_RWseek(f, 4, RW_SEEK_SET);                  // version
+            ret += (uint64_t)SDL_ReadLE32(f) * sizeof(tr4_textile32_t);
+            break;
+
+        case TR_II:
+        case TR_II_DEMO:
+        case TR_III:
+            SDL_RWseek(f, 4 + 768 + 1024, RW_SEEK_SET);     // version, palette, palette16
+            ret += (uint64_t)SDL_ReadLE32(f) * sizeof(tr4_textile32_t);
+            break;
+
+        case TR_IV:
+        case TR_IV_DEMO:
+            chunks = 4;                                     // textiles32, textiles16, misc, geometry
+            break;
+
+        case TR_V:
+            chunks = 3;                                     // textiles32, textiles16, misc
+            break;
+    };
+
+    if(chunks)
+    {
+        SDL_RWseek(f, 4 + 3 * 2, RW_SEEK_SET);              // version, textile counts
+        for(uint32_t i = 0; i < chunks; i++)
+        {
+            uint32_t uncomp_size = SDL_ReadLE32(f);
+            uint32_t comp_size = SDL_ReadLE32(f);
+            ret += uncomp_size;
+            if(SDL_RWseek(f, comp_size, RW_SEEK_CUR) < 0)
+            {
+                break;
+            }
+        }
+    }
+
+    return ret;
+}
+
+/*
+ * File wrapper for the worker: reads fail once cancel is requested, so the
+ * loader unwinds through its usual short read error.
+ */
+static Sint64 SDLCALL World_PreloadRWsize(SDL_RWops *context)
+{
+    return SDL_RWsize((SDL_RWops*)context->hidden.unknown.data1);
+}
+
+static Sint64 SDLCALL World_PreloadRWseek(SDL_RWops *context, Sint64 offset, int whence)
 {
-    VT_Level *tr = new VT_Level();
-    tr->read_level(path, trv);
+    return SDL_RWseek((SDL_RWops*)context->hidden.unknown.data1, offset, whence);
+}
+
+static size_t SDLCALL World_PreloadRWread(SDL_RWops *context, void *ptr, size_t size, size_t maxnum)
+{
+    if(SDL_AtomicGet(&world_preload.cancel))
+    {
+        return 0;
+    }
+    return SDL_RWread((SDL_RWops*)context->hidden.unknown.data1, ptr, size, maxnum);
+}
+
+static size_t SDLCALL World_PreloadRWwrite(SDL_RWops *context, const void *ptr, size_t size, size_t num)
+{
+    return 0;
+}
+
+static int SDLCALL World_PreloadRWclose(SDL_RWops *context)
+{
+    int ret = SDL_RWclose((SDL_RWops*)context->hidden.unknown.data1);
+    SDL_FreeRW(context);
+    return ret;
+}
+
+static int World_PreloadThread(void *data)
+{
+    VT_Level *tr;
+    SDL_RWops *f = SDL_RWFromFile(world_preload.path, "rb");
+    SDL_RWops *src;
+    int trv, failed = 0;
+
+    trv = VT_Level::get_PC_level_version(world_preload.path);
+    if(!f || (trv == TR_UNKNOWN) || (World_PreloadEstimateSize(f, trv) > world_preload.memory_limit) ||
+       (SDL_RWseek(f, 0, RW_SEEK_SET) != 0) || !(src = SDL_AllocRW()))
+    {
+        if(f)
+        {
+            SDL_RWclose(f);
+        }
+        SDL_AtomicSet(&world_preload.state, WORLD_PRELOAD_FAILED);
+        return 0;
+    }
+
+    src->size = World_PreloadRWsize;
+    src->seek = World_PreloadRWseek;
+    src->read = World_PreloadRWread;
+    src->write = World_PreloadRWwrite;
+    src->close = World_PreloadRWclose;
+    src->type = SDL_RWOPS_UNKNOWN;
+    src->hidden.unknown.data1 = f;
+
+    tr = new VT_Level();
+    tr->throw_read_errors = true;
+    tr->set_sfx_path(world_preload.path);
+    try
+    {
+        tr->read_level(src, trv);
+    }
+    catch(TR_ReadError &err)
+    {
+        failed = 1;
+    }
+    SDL_RWclose(src);
+
+    if(failed || SDL_AtomicGet(&world_preload.cancel))
+    {
+        delete tr;
+        SDL_AtomicSet(&world_preload.state, WORLD_PRELOAD_FAILED);
+        return 0;
+    }
+
     tr->prepare_level();
+    world_preload.level = tr;
+    SDL_AtomicSet(&world_preload.state, WORLD_PRELOAD_READY);
+
+    return 0;
+}
+
+
+void World_SetPreloadParams(int enabled, uint32_t memory_limit)
+{
+    world_preload.enabled = enabled;
+    world_preload.memory_limit = memory_limit;
+    if(!enabled)
+    {
+        World_PreloadCancel();
+    }
+}
+
+
+int World_PreloadStart(const char *path)
+{
+    if(!world_preload.enabled || !path)
+    {
+        return 0;
+    }
+
+    if(world_preload.thread || (SDL_AtomicGet(&world_preload.state) != WORLD_PRELOAD_NONE))
+    {
+        if(0 == strncmp(world_preload.path, path, MAX_ENGINE_PATH))
+        {
+            return 1;
+        }
+        World_PreloadCancel();
+    }
+
+    strncpy(world_preload.path, path, MAX_ENGINE_PATH - 1);
+    world_preload.path[MAX_ENGINE_PATH - 1] = 0;
+    world_preload.level = NULL;
+    SDL_AtomicSet(&world_preload.cancel, 0);
+    SDL_AtomicSet(&world_preload.state, WORLD_PRELOAD_RUNNING);
+    world_preload.thread = SDL_CreateThread(World_PreloadThread, "level_preload", NULL);
+    if(!world_preload.thread)
+    {
+        SDL_AtomicSet(&world_preload.state, WORLD_PRELOAD_NONE);
+        return 0;
+    }
+
+    return 1;
+}
+
+/**
+ * Waits for the worker and returns preloaded level if it was made for
+ * given path; any other preloaded level is freed.
+ */
+static VT_Level *World_PreloadTake(const char *path)
+{
+    VT_Level *ret = NULL;
+
+    if(world_preload.thread)
+    {
+        SDL_WaitThread(world_preload.thread, NULL);
+        world_preload.thread = NULL;
+    }
+
+    if(SDL_AtomicGet(&world_preload.state) == WORLD_PRELOAD_READY)
+    {
+        if(path && (0 == strncmp(world_preload.path, path, MAX_ENGINE_PATH)))
+        {
+            ret = world_preload.level;
+        }
+        else
+        {
+            delete world_preload.level;
+        }
+    }
+
+    world_preload.level = NULL;
+    world_preload.path[0] = 0;
+    SDL_AtomicSet(&world_preload.state, WORLD_PRELOAD_NONE);
+
+    return ret;
+}
+
+
+void World_PreloadCancel()
+{
+    SDL_AtomicSet(&world_preload.cancel, 1);
+    World_PreloadTake(NULL);
+}
+
+
+void World_Open(const char *path, int trv)
+{
+    VT_Level *tr = World_PreloadTake(path);
+    if(!tr)
+    {
+        tr = new VT_Level();
+        tr->read_level(path, trv);
+        tr->prepare_level();
+    }
     //tr_level->dump_textures();
     World_Clear();
 
@@ -193,6 +451,8 @@ void World_Open(const char *path, int trv)
     World_GenAnimTextures(tr);          // Generate animated textures
     Gui_DrawLoadScreen(320);
 
+    BaseMesh_ResetBuffersStats();
+
     World_GenMeshes(tr);                // Generate all meshes
     Gui_DrawLoadScreen(400);
 
@@ -268,6 +528,26 @@ void World_Open(const char *path, int trv)
         global_world.tex_atlas = NULL;
     }
 
+    {
+        const mesh_buffers_stats_t *stats = BaseMesh_GetBuffersStats();
+        Con_Notify("geometry buffers: vertices %u -> %u KB, indices %u -> %u KB",
+                   stats->vertex_bytes_full / 1024, stats->vertex_bytes / 1024,
+                   stats->index_bytes_full / 1024, stats->index_bytes / 1024);
+        Sys_DebugLog(SYS_LOG_FILENAME, "\"%s\": %u meshes, vertices %u -> %u bytes, indices %u -> %u bytes", path, stats->meshes,
+                     stats->vertex_bytes_full, stats->vertex_bytes, stats->index_bytes_full, stats->index_bytes);
+    }
+
+    {
+        const arena_stats_t *stats = Arena_GetStats();
+        Con_Notify("level arena: %u KB in %u blocks", (uint32_t)(stats->used_bytes / 1024), stats->allocations);
+        Sys_DebugLog(SYS_LOG_FILENAME, "\"%s\": level arena %u bytes in %u blocks, %u chunks", path,
+                     (uint32_t)stats->used_bytes, stats->allocations, stats->chunks);
+        for(uint16_t i = 0; i < ARENA_TAGS_COUNT; i++)
+        {
+            Sys_DebugLog(SYS_LOG_FILENAME, "    %s: %u bytes", Arena_GetTagName(i), (uint32_t)stats->tag_bytes[i]);
+        }
+    }
+
     delete tr;
 }
 
@@ -299,15 +579,15 @@ void World_Clear()
         Room_Clear(global_world.rooms + i);
     }
     global_world.rooms_count = 0;
-    free(global_world.rooms);
+    Arena_Free(global_world.rooms);
     global_world.rooms = NULL;
 
     if(global_world.flip_count)
     {
         global_world.flip_count = 0;
         global_world.global_flip_state = 0;
-        free(global_world.flip_map);
-        free(global_world.flip_state);
+        Arena_Free(global_world.flip_map);
+        Arena_Free(global_world.flip_state);
         global_world.flip_map = NULL;
         global_world.flip_state = NULL;
     }
@@ -315,35 +595,35 @@ void World_Clear()
     if(global_world.room_boxes_count)
     {
         global_world.room_boxes_count = 0;
-        free(global_world.room_boxes);
+        Arena_Free(global_world.room_boxes);
         global_world.room_boxes = NULL;
     }
 
     if(global_world.overlaps_count)
     {
         global_world.overlaps_count = 0;
-        free(global_world.overlaps);
+        Arena_Free(global_world.overlaps);
         global_world.overlaps = NULL;
     }
 
     if(global_world.cameras_sinks_count)
     {
         global_world.cameras_sinks_count = 0;
-        free(global_world.cameras_sinks);
+        Arena_Free(global_world.cameras_sinks);
         global_world.cameras_sinks = NULL;
     }
 
     if(global_world.flyby_frames_count)
     {
         global_world.flyby_frames_count = 0;
-        free(global_world.flyby_frames);
+        Arena_Free(global_world.flyby_frames);
         global_world.flyby_frames = NULL;
     }
 
     if(global_world.cinematic_frames_count)
     {
         global_world.cinematic_frames_count = 0;
-        free(global_world.cinematic_frames);
+        Arena_Free(global_world.cinematic_frames);
         global_world.cinematic_frames = NULL;
     }
 
@@ -360,7 +640,7 @@ void World_Clear()
     if(global_world.sprites_count)
     {
         global_world.sprites_count = 0;
-        free(global_world.sprites);
+        Arena_Free(global_world.sprites);
         global_world.sprites = NULL;
     }
 
@@ -374,7 +654,7 @@ void World_Clear()
             SkeletalModel_Clear(global_world.skeletal_models + i);
         }
         global_world.skeletal_models_count = 0;
-        free(global_world.skeletal_models);
+        Arena_Free(global_world.skeletal_models);
         global_world.skeletal_models = NULL;
     }
 
@@ -386,7 +666,7 @@ void World_Clear()
             BaseMesh_Clear(global_world.meshes+i);
         }
         global_world.meshes_count = 0;
-        free(global_world.meshes);
+        Arena_Free(global_world.meshes);
         global_world.meshes = NULL;
     }
 
@@ -394,7 +674,7 @@ void World_Clear()
     {
         qglDeleteTextures(global_world.tex_count, global_world.textures);
         global_world.tex_count = 0;
-        free(global_world.textures);
+        Arena_Free(global_world.textures);
         global_world.textures = NULL;
     }
 
@@ -410,9 +690,9 @@ void World_Clear()
         {
             if(global_world.anim_sequences[i].frames_count != 0)
             {
-                free(global_world.anim_sequences[i].frame_list);
+                Arena_Free(global_world.anim_sequences[i].frame_list);
                 global_world.anim_sequences[i].frame_list = NULL;
-                free(global_world.anim_sequences[i].frames);
+                Arena_Free(global_world.anim_sequences[i].frames);
                 global_world.anim_sequences[i].frames = NULL;
             }
             global_world.anim_sequences[i].frames_count = 0;
@@ -421,6 +701,9 @@ void World_Clear()
         free(global_world.anim_sequences);
         global_world.anim_sequences = NULL;
     }
+
+    // all level data allocated from arena is dropped at once
+    Arena_Release();
 }
 
 
@@ -1005,7 +1288,14 @@ void World_UpdateFlipCollisions()
                 r->content->physics_alt_tween = Physics_GenRoomRigidBody(r, NULL, 0, room_tween, num_tweens);
                 if(r->content->physics_alt_tween)
                 {
-                    Physics_EnableObject(r->content->physics_alt_tween);
+                    if(r->is_collision_active)
+                    {
+                        Physics_EnableObject(r->content->physics_alt_tween);
+                    }
+                    else
+                    {
+                        Physics_DisableObject(r->content->physics_alt_tween);
+                    }
                 }
             }
 
@@ -1015,6 +1305,109 @@ void World_UpdateFlipCollisions()
 }
 
 
+static void World_AddCollisionLODSeed(room_p room, uint8_t *depth, uint32_t *queue, uint32_t *queue_size)
+{
+    if(room && room->real_room)
+    {
+        uint32_t index = room->real_room - global_world.rooms;
+        if(depth[index] != 0)
+        {
+            depth[index] = 0;
+            queue[(*queue_size)++] = index;
+        }
+    }
+}
+
+
+void World_UpdateCollisionLOD()
+{
+    if((ROOM_COLLISION_LOD_DEPTH < 0) || (global_world.rooms_count == 0))
+    {
+        return;
+    }
+
+    size_t buff_size = global_world.rooms_count * (sizeof(uint32_t) + sizeof(uint8_t));
+    uint32_t *queue = (uint32_t*)Sys_GetTempMem(buff_size);
+    uint8_t *depth = (uint8_t*)(queue + global_world.rooms_count);
+    uint32_t queue_size = 0;
+
+    memset(depth, 0xFF, global_world.rooms_count * sizeof(uint8_t));
+
+    // Seeds: camera, player and everything that may move by physics.
+    World_AddCollisionLODSeed(engine_camera.current_room, depth, queue, &queue_size);
+    for(avl_node_p p = global_world.entity_tree.list; p; p = p->next)
+    {
+        entity_p ent = (entity_p)p->data;
+        if(ent->self->room &&
+           ((ent == global_world.player) || (ent->type_flags & ENTITY_TYPE_DYNAMIC) ||
+            (ent->character && ((ent->state_flags & (ENTITY_STATE_ENABLED | ENTITY_STATE_ACTIVE)) == (ENTITY_STATE_ENABLED | ENTITY_STATE_ACTIVE)))))
+        {
+            World_AddCollisionLODSeed(ent->self->room, depth, queue, &queue_size);
+        }
+    }
+
+    // Breadth-first walk over near rooms lists.
+    for(uint32_t qi = 0; qi < queue_size; ++qi)
+    {
+        room_p r = global_world.rooms + queue[qi];
+        uint8_t next_depth = depth[queue[qi]] + 1;
+        if(next_depth > ROOM_COLLISION_LOD_DEPTH)
+        {
+            continue;
+        }
+        for(uint16_t i = 0; i < r->content->near_room_list_size; ++i)
+        {
+            uint32_t index = r->content->near_room_list[i]->real_room - global_world.rooms;
+            if(depth[index] > next_depth)
+            {
+                depth[index] = next_depth;
+                queue[queue_size++] = index;
+            }
+        }
+    }
+
+    room_p r = global_world.rooms;
+    for(uint32_t i = 0; i < global_world.rooms_count; ++i, ++r)
+    {
+        if(r->real_room == r)
+        {
+            if((depth[i] != 0xFF) && !r->is_collision_active)
+            {
+                Room_EnableStaticCollision(r);
+            }
+            else if((depth[i] == 0xFF) && r->is_collision_active)
+            {
+                Room_DisableStaticCollision(r);
+            }
+        }
+    }
+
+    Sys_ReturnTempMem(buff_size);
+}
+
+
+/*
+ * Enables static collision of room and of its near rooms at once; for entity,
+ * activated after World_UpdateCollisionLOD() in current frame.
+ */
+void World_EnableCollisionNear(struct room_s *room)
+{
+    room = room->real_room;
+    if(!room->is_collision_active)
+    {
+        Room_EnableStaticCollision(room);
+    }
+    for(uint16_t i = 0; i < room->content->near_room_list_size; ++i)
+    {
+        room_p r = room->content->near_room_list[i]->real_room;
+        if(!r->is_collision_active)
+        {
+            Room_EnableStaticCollision(r);
+        }
+    }
+}
+
+
 uint16_t World_GetGlobalFlipState()
 {
     return global_world.global_flip_state;
@@ -1317,10 +1710,17 @@ void World_GenTextures(class VT_Level *tr)
                                                   tr->object_textures_count,
                                                   tr->object_textures,
                                                   tr->sprite_textures_count,
-                                                  tr->sprite_textures);
+                                                  tr->sprite_textures,
+                                                  renderer.settings.atlas_packer);
 
     global_world.tex_count = (uint32_t) global_world.tex_atlas->getNumAtlasPages();
-    global_world.textures = (GLuint*)malloc(global_world.tex_count * sizeof(GLuint));
+    Sys_DebugLog(SYS_LOG_FILENAME, "texture atlas (%s): %u pages", RectPacker_GetName(renderer.settings.atlas_packer), global_world.tex_count);
+    for(uint32_t i = 0; i < global_world.tex_count; i++)
+    {
+        Sys_DebugLog(SYS_LOG_FILENAME, "    page %u: %ux%u, %.1f%% used", i, global_world.tex_atlas->getPageWidth(),
+                     global_world.tex_atlas->getPageHeight(i), 100.0f * global_world.tex_atlas->getPageOccupancy(i));
+    }
+    global_world.textures = (GLuint*)Arena_Alloc(ARENA_TAG_TEXTURES, global_world.tex_count * sizeof(GLuint));
 
     qglPixelStorei(GL_UNPACK_ALIGNMENT, 1);
     qglPixelZoom(1, 1);
@@ -1391,7 +1791,7 @@ void World_GenAnimTextures(class VT_Level *tr)
         for(uint16_t i = 0; i < num_sequences; i++, seq++)
         {
             seq->frames_count = *(pointer++) + 1;
-            seq->frame_list   =  (uint32_t*)calloc(seq->frames_count, sizeof(uint32_t));
+            seq->frame_list   =  (uint32_t*)Arena_Calloc(ARENA_TAG_TEXTURES, seq->frames_count, sizeof(uint32_t));
 
             // Fill up new sequence with frame list.
             seq->anim_type         = TR_ANIMTEXTURE_FORWARD;
@@ -1422,7 +1822,7 @@ void World_GenAnimTextures(class VT_Level *tr)
                 seq->uvrotate   = true;
                 seq->frame_rate = 0.05f * 16;
             }
-            seq->frames = (tex_frame_p)calloc(seq->frames_count, sizeof(tex_frame_t));
+            seq->frames = (tex_frame_p)Arena_Calloc(ARENA_TAG_TEXTURES, seq->frames_count, sizeof(tex_frame_t));
             global_world.tex_atlas->getCoordinates(&p0, seq->frame_list[0], false);
             for(uint16_t j = 0; j < seq->frames_count; j++)
             {
@@ -1476,7 +1876,7 @@ void World_GenMeshes(class VT_Level *tr)
     base_mesh_p base_mesh;
 
     global_world.meshes_count = tr->meshes_count;
-    base_mesh = global_world.meshes = (base_mesh_p)calloc(global_world.meshes_count, sizeof(base_mesh_t));
+    base_mesh = global_world.meshes = (base_mesh_p)Arena_Calloc(ARENA_TAG_MESHES, global_world.meshes_count, sizeof(base_mesh_t));
     for(uint32_t i = 0; i < global_world.meshes_count; i++, base_mesh++)
     {
         TR_GenMesh(base_mesh, i, global_world.anim_sequences, global_world.anim_sequences_count, global_world.tex_atlas, tr);
@@ -1498,7 +1898,7 @@ void World_GenSprites(class VT_Level *tr)
     }
 
     global_world.sprites_count = tr->sprite_textures_count;
-    s = global_world.sprites = (sprite_p)calloc(global_world.sprites_count, sizeof(sprite_t));
+    s = global_world.sprites = (sprite_p)Arena_Calloc(ARENA_TAG_WORLD, global_world.sprites_count, sizeof(sprite_t));
 
     for(uint32_t i = 0; i < global_world.sprites_count; i++, s++)
     {
@@ -1529,7 +1929,7 @@ void World_GenBoxes(class VT_Level *tr)
 
     if(global_world.overlaps_count)
     {
-        global_world.overlaps = (box_overlap_p)malloc(global_world.overlaps_count * sizeof(box_overlap_t));
+        global_world.overlaps = (box_overlap_p)Arena_Alloc(ARENA_TAG_WORLD, global_world.overlaps_count * sizeof(box_overlap_t));
         for(uint32_t i = 0; i < global_world.overlaps_count; i++)
         {
             global_world.overlaps[i].box = tr->overlaps[i] & 0x7FFF;
@@ -1543,7 +1943,7 @@ void World_GenBoxes(class VT_Level *tr)
 
     if(global_world.room_boxes_count)
     {
-        global_world.room_boxes = (room_box_p)malloc(global_world.room_boxes_count * sizeof(room_box_t));
+        global_world.room_boxes = (room_box_p)Arena_Alloc(ARENA_TAG_WORLD, global_world.room_boxes_count * sizeof(room_box_t));
         for(uint32_t i = 0; i < global_world.room_boxes_count; i++)
         {
             room_box_p r_box = global_world.room_boxes + i;
@@ -1589,7 +1989,7 @@ void World_GenCameras(class VT_Level *tr)
 
     if(global_world.cameras_sinks_count)
     {
-        global_world.cameras_sinks = (static_camera_sink_p)malloc(global_world.cameras_sinks_count * sizeof(static_camera_sink_t));
+        global_world.cameras_sinks = (static_camera_sink_p)Arena_Alloc(ARENA_TAG_CAMERAS, global_world.cameras_sinks_count * sizeof(static_camera_sink_t));
         for(uint32_t i = 0; i < global_world.cameras_sinks_count; i++)
         {
             global_world.cameras_sinks[i].pos[0]              =  tr->cameras[i].x;
@@ -1610,7 +2010,7 @@ void World_GenCinematicCameras(class VT_Level *tr)
 
     if(global_world.cinematic_frames_count)
     {
-        global_world.cinematic_frames = (camera_frame_p)calloc(global_world.cinematic_frames_count, sizeof(camera_frame_t));
+        global_world.cinematic_frames = (camera_frame_p)Arena_Calloc(ARENA_TAG_CAMERAS, global_world.cinematic_frames_count, sizeof(camera_frame_t));
         for(uint32_t i = 0; i < global_world.cinematic_frames_count; i++)
         {
             global_world.cinematic_frames[i].pos[0] = tr->cinematic_frames[i].posx;
@@ -1634,7 +2034,7 @@ void World_GenFlyByCameras(class VT_Level *tr)
     {
         uint32_t start_index = 0;
         flyby_camera_sequence_p *last_seq_ptr = &global_world.flyby_camera_sequences;
-        global_world.flyby_frames = (camera_frame_p)malloc(global_world.flyby_frames_count * sizeof(camera_frame_t));
+        global_world.flyby_frames = (camera_frame_p)Arena_Alloc(ARENA_TAG_CAMERAS, global_world.flyby_frames_count * sizeof(camera_frame_t));
         for(uint32_t i = 0; i < global_world.flyby_frames_count; i++)
         {
             union
@@ -1701,6 +2101,7 @@ void World_GenRoom(struct room_s *room, class VT_Level *tr)
     room->containers = NULL;
     room->is_in_r_list = 0;
     room->is_swapped = 0;
+    room->is_collision_active = 1;
 
     Mat4_E_macro(room->transform);
     TR_vertex_to_arr(room->transform + 12, &tr->rooms[room->id].offset);
@@ -1714,7 +2115,7 @@ void World_GenRoom(struct room_s *room, class VT_Level *tr)
     room->self->collision_shape = COLLISION_SHAPE_TRIMESH;
     room->self->object_type = OBJECT_ROOM_BASE;
 
-    room->content = (room_content_p)malloc(sizeof(room_content_t));
+    room->content = (room_content_p)Arena_Alloc(ARENA_TAG_ROOMS, sizeof(room_content_t));
     room->original_content = room->content;
     room->content->original_room_id = room->id;
     room->content->room_flags = tr->rooms[room->id].flags;
@@ -1749,7 +2150,7 @@ void World_GenRoom(struct room_s *room, class VT_Level *tr)
     room->sectors_x = tr_room->num_xsectors;
     room->sectors_y = tr_room->num_zsectors;
     room->sectors_count = room->sectors_x * room->sectors_y;
-    room->content->sectors = (room_sector_p)malloc(room->sectors_count * sizeof(room_sector_t));
+    room->content->sectors = (room_sector_p)Arena_Alloc(ARENA_TAG_ROOMS, room->sectors_count * sizeof(room_sector_t));
 
     /*
      * base sectors information loading and collisional mesh creation
@@ -1890,7 +2291,7 @@ void World_GenRoom(struct room_s *room, class VT_Level *tr)
     room->content->lights_count = tr_room->num_lights;
     if(room->content->lights_count > 0)
     {
-        room->content->lights = (light_p)malloc(room->content->lights_count * sizeof(light_t));
+        room->content->lights = (light_p)Arena_Alloc(ARENA_TAG_ROOMS, room->content->lights_count * sizeof(light_t));
         for(uint16_t i = 0; i < tr_room->num_lights; i++)
         {
             Res_RoomLightCalculate(room->content->lights + i, tr_room->lights + i);
@@ -1901,13 +2302,13 @@ void World_GenRoom(struct room_s *room, class VT_Level *tr)
      * portals loading / calculation!!!
      */
     room->content->portals_count = tr_room->num_portals;
-    p = room->content->portals = (portal_p)calloc(room->content->portals_count, sizeof(portal_t));
+    p = room->content->portals = (portal_p)Arena_Calloc(ARENA_TAG_ROOMS, room->content->portals_count, sizeof(portal_t));
     tr_portal = tr_room->portals;
     for(uint16_t i = 0; i < room->content->portals_count; i++, p++, tr_portal++)
     {
         r_dest = global_world.rooms + tr_portal->adjoining_room;
         p->vertex_count = 4;                                                    // in original TR all portals are axis aligned rectangles
-        p->vertex = (float*)malloc(3 * p->vertex_count * sizeof(float));
+        p->vertex = (float*)Arena_Alloc(ARENA_TAG_ROOMS, 3 * p->vertex_count * sizeof(float));
         p->dest_room = r_dest;
         TR_vertex_to_arr(p->vertex, &tr_portal->vertices[3]);
         vec3_add(p->vertex, p->vertex, room->transform + 12);
@@ -1987,7 +2388,7 @@ void World_GenRoom(struct room_s *room, class VT_Level *tr)
     room->content->static_mesh_count = tr_room->num_static_meshes;
     if(room->content->static_mesh_count)
     {
-        room->content->static_mesh = (static_mesh_p)calloc(room->content->static_mesh_count, sizeof(static_mesh_t));
+        room->content->static_mesh = (static_mesh_p)Arena_Calloc(ARENA_TAG_ROOMS, room->content->static_mesh_count, sizeof(static_mesh_t));
     }
 
     r_static = room->content->static_mesh;
@@ -2071,7 +2472,7 @@ void World_GenRoom(struct room_s *room, class VT_Level *tr)
     if(room->content->sprites_count != 0)
     {
         uint32_t actual_sprites_count = 0;
-        room->content->sprites = (room_sprite_p)calloc(room->content->sprites_count, sizeof(room_sprite_t));
+        room->content->sprites = (room_sprite_p)Arena_Calloc(ARENA_TAG_ROOMS, room->content->sprites_count, sizeof(room_sprite_t));
         for(uint32_t i = 0; i < room->content->sprites_count; i++)
         {
             if((tr_room->sprites[i].texture >= 0) && ((uint32_t)tr_room->sprites[i].texture < global_world.sprites_count))
@@ -2086,7 +2487,7 @@ void World_GenRoom(struct room_s *room, class VT_Level *tr)
         room->content->sprites_count = actual_sprites_count;
         if(actual_sprites_count == 0)
         {
-            free(room->content->sprites);
+            Arena_Free(room->content->sprites);
             room->content->sprites = NULL;
         }
     }
@@ -2096,7 +2497,7 @@ void World_GenRoom(struct room_s *room, class VT_Level *tr)
 void World_GenRooms(class VT_Level *tr)
 {
     global_world.rooms_count = tr->rooms_count;
-    room_p r = global_world.rooms = (room_p)malloc(global_world.rooms_count * sizeof(room_t));
+    room_p r = global_world.rooms = (room_p)Arena_Alloc(ARENA_TAG_ROOMS, global_world.rooms_count * sizeof(room_t));
     for(uint32_t i = 0; i < global_world.rooms_count; i++, r++)
     {
         r->id = i;
@@ -2110,8 +2511,8 @@ void World_GenRoomFlipMap()
     // Flipmap count is hardcoded, as no original levels contain such info.
     global_world.flip_count = FLIPMAP_MAX_NUMBER;
 
-    global_world.flip_map   = (uint8_t*)malloc(global_world.flip_count * sizeof(uint8_t));
-    global_world.flip_state = (uint8_t*)malloc(global_world.flip_count * sizeof(uint8_t));
+    global_world.flip_map   = (uint8_t*)Arena_Alloc(ARENA_TAG_ROOMS, global_world.flip_count * sizeof(uint8_t));
+    global_world.flip_state = (uint8_t*)Arena_Alloc(ARENA_TAG_ROOMS, global_world.flip_count * sizeof(uint8_t));
 
     memset(global_world.flip_map,   0, global_world.flip_count);
     memset(global_world.flip_state, 0, global_world.flip_count);
@@ -2124,7 +2525,7 @@ void World_GenSkeletalModels(class VT_Level *tr)
     tr_moveable_t *tr_moveable;
 
     global_world.skeletal_models_count = tr->moveables_count;
-    smodel = global_world.skeletal_models = (skeletal_model_p)calloc(global_world.skeletal_models_count, sizeof(skeletal_model_t));
+    smodel = global_world.skeletal_models = (skeletal_model_p)Arena_Calloc(ARENA_TAG_ANIMATIONS, global_world.skeletal_models_count, sizeof(skeletal_model_t));
 
     for(uint32_t i = 0; i < global_world.skeletal_models_count; i++, smodel++)
     {
@@ -2198,14 +2599,19 @@ void World_GenEntities(class VT_Level *tr)
             sprite_p sp = World_GetSpriteByID(tr_item->object_id);
             if(sp && entity->self->room)
             {
-                room_sprite_p rsp;
-                int sz = ++entity->self->room->content->sprites_count;
-                entity->self->room->content->sprites = (room_sprite_p)realloc(entity->self->room->content->sprites, sz * sizeof(room_sprite_t));
-                rsp = entity->self->room->content->sprites + sz - 1;
-                rsp->sprite = sp;
-                rsp->pos[0] = entity->transform.M4x4[12 + 0];
-                rsp->pos[1] = entity->transform.M4x4[12 + 1];
-                rsp->pos[2] = entity->transform.M4x4[12 + 2];
+                room_content_p content = entity->self->room->content;
+                uint32_t sz = content->sprites_count + 1;
+                room_sprite_p rsp = (room_sprite_p)Arena_Realloc(ARENA_TAG_ROOMS, content->sprites, (sz - 1) * sizeof(room_sprite_t), sz * sizeof(room_sprite_t));
+                if(rsp)
+                {
+                    content->sprites = rsp;
+                    content->sprites_count = sz;
+                    rsp += sz - 1;
+                    rsp->sprite = sp;
+                    rsp->pos[0] = entity->transform.M4x4[12 + 0];
+                    rsp->pos[1] = entity->transform.M4x4[12 + 1];
+                    rsp->pos[2] = entity->transform.M4x4[12 + 2];
+                }
             }
 
             Entity_Delete(entity);
@@ -2372,11 +2778,11 @@ void World_GenRoomProperties(class VT_Level *tr)
         {
             room_sector_p rs = r->content->sectors + j;
             Res_Sector_TranslateFloorData(global_world.rooms, global_world.rooms_count, rs, tr);
-            for(trigger_command_p cmd = (rs->trigger) ? (rs->trigger->commands) : (NULL); cmd; cmd = cmd->next)
+            for(uint16_t k = 0; rs->trigger && (k < rs->trigger->commands_count); ++k)
             {
-                if(cmd->function == TR_FD_TRIGFUNC_PLAYTRACK)
+                if(rs->trigger->commands[k].function == TR_FD_TRIGFUNC_PLAYTRACK)
                 {
-                    Audio_CacheTrack(cmd->operands);
+                    Audio_CacheTrack(rs->trigger->commands[k].operands);
                 }
             }
         }
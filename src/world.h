@@ -8,12 +8,20 @@
 #define FLIP_STATE_ON       (0x01)
 #define FLIP_STATE_BY_FLAG  (0x03)
 
+// Next level file is read and prepared by worker thread while current
+// level is played; it is dropped if estimated size exceeds the limit.
+#define WORLD_PRELOAD_DEFAULT_MEMORY_LIMIT  (256 * 1024 * 1024)
+
 
 void World_Prepare();
 void World_Open(const char *path, int trv);
 void World_Clear();
 int  World_GetVersion();
 
+void World_SetPreloadParams(int enabled, uint32_t memory_limit);
+int  World_PreloadStart(const char *path);
+void World_PreloadCancel();
+
 uint32_t World_SpawnEntity(uint32_t model_id, uint32_t room_id, float pos[3], float ang[3], int32_t id);
 struct entity_s *World_GetEntityByID(uint32_t id);
 void World_SetPlayer(struct entity_s *entity);
@@ -52,6 +60,8 @@ void World_SetGlobalFlipState(int flip_state);
 int World_SetFlipState(uint32_t flip_index, uint32_t flip_state);
 int World_SetFlipMap(uint32_t flip_index, uint8_t flip_mask, uint8_t flip_operation);
 void World_UpdateFlipCollisions();
+void World_UpdateCollisionLOD();
+void World_EnableCollisionNear(struct room_s *room);
 uint32_t World_GetFlipMap(uint32_t flip_index);
 uint32_t World_GetFlipState(uint32_t flip_index);
 